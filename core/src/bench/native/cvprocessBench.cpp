@@ -0,0 +1,408 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Throughput of every CVProcessNode, and of the preprocessing chains workers build from them, at the resolutions
+// FRC cameras typically run at. Results are meant to be compared across commits and across coprocessors:
+//   wfcore_bench --benchmark_out=results.json --benchmark_out_format=json
+// Filter with --benchmark_filter, e.g. --benchmark_filter='ColorConvert/YUYV.*1280x720'
+
+#include "wfcore/video/processing.h"
+#include "wfcore/hardware/CameraConfiguration.h"
+#include "wfcore/video/video_utils.h"
+#include "wfcore/simd/simd.h"
+#include "wfcore/fiducial/ApriltagThreshold.h"
+#include "wfcore/fiducial/ApriltagDetector.h"
+
+#include <array>
+#include <format>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+// Like the tests, only for development environments, run from the build directory
+#define RESOURCE_PATH "../../../test-resources"
+
+namespace {
+    using namespace wf;
+
+    using NodeFactory = std::function<std::unique_ptr<CVProcessNode<cv::Mat>>()>;
+    using NodeChain = std::vector<std::unique_ptr<CVProcessNode<cv::Mat>>>;
+
+    // Common camera modes, from 640x480 up to 1920x1200
+    const std::array<cv::Size,7> RESOLUTIONS = {
+        cv::Size(640,480),
+        cv::Size(800,600),
+        cv::Size(1280,720),
+        cv::Size(1280,800),
+        cv::Size(1600,1200),
+        cv::Size(1920,1080),
+        cv::Size(1920,1200)
+    };
+
+    constexpr std::array<ImageEncoding,9> RAW_ENCODINGS = {
+        ImageEncoding::BGR24,
+        ImageEncoding::RGB24,
+        ImageEncoding::RGB565,
+        ImageEncoding::Y8,
+        ImageEncoding::Y16,
+        ImageEncoding::YUYV,
+        ImageEncoding::UYVY,
+        ImageEncoding::RGBA,
+        ImageEncoding::BGRA
+    };
+
+    std::string formatName(const FrameFormat& format) {
+        return std::format("{}/{}x{}",getEncodingName(format.encoding),format.width,format.height);
+    }
+
+    cv::Mat makeFrame(const FrameFormat& format) {
+        cv::Mat frame = generateEmptyCVImg<cv::Mat>(format);
+        cv::randu(frame,cv::Scalar::all(0),cv::Scalar::all(frame.depth() == CV_16U ? 65536 : 256));
+        return frame;
+    }
+
+    // A camera MJPEG frame of the given size. Blurred noise compresses about as well as a real scene
+    std::vector<uchar> makeJPEG(cv::Size size) {
+        cv::Mat bgr(size,CV_8UC3);
+        cv::randu(bgr,cv::Scalar::all(0),cv::Scalar::all(256));
+        cv::GaussianBlur(bgr,bgr,cv::Size(9,9),3);
+        std::vector<uchar> jpeg;
+        cv::imencode(".jpg",bgr,jpeg,{cv::IMWRITE_JPEG_QUALITY,85});
+        return jpeg;
+    }
+
+    cv::Mat makeInput(const FrameFormat& format, std::vector<uchar>& jpeg) {
+        if (format.encoding != ImageEncoding::MJPEG) return makeFrame(format);
+        jpeg = makeJPEG(format.size());
+        return cv::Mat(1,static_cast<int>(jpeg.size()),CV_8UC1,jpeg.data());
+    }
+
+    void reportThroughput(benchmark::State& state, const cv::Mat& in, size_t bytesTouched) {
+        state.SetItemsProcessed(state.iterations());
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * in.total() * in.elemSize()));
+        state.counters["bytesTouched"] = benchmark::Counter(static_cast<double>(bytesTouched));
+    }
+
+    // One node processing whole frames
+    void benchNode(benchmark::State& state, const NodeFactory& factory, const FrameFormat& format) {
+        std::vector<uchar> jpeg;
+        cv::Mat in = makeInput(format,jpeg);
+        auto node = factory();
+        node->setInpad(&in,&format.encoding);
+        for (auto _ : state) {
+            node->process();
+            benchmark::DoNotOptimize(node->getOutpad().data);
+            benchmark::ClobberMemory();
+        }
+        reportThroughput(state,in,node->estimateBytesTouched());
+        state.SetLabel(node->describe());
+    }
+
+    // A whole pipe, planned and (when sequential) fused the way workers get it
+    void benchPipe(benchmark::State& state, const std::function<NodeChain()>& makeNodes, const FrameFormat& format, PipeExecution execution) {
+        std::vector<uchar> jpeg;
+        cv::Mat in = makeInput(format,jpeg);
+        CVProcessPipe<cv::Mat> pipe(format,makeNodes(),execution);
+        cv::Mat out;
+        for (auto _ : state) {
+            pipe.processDirect(in,out);
+            benchmark::DoNotOptimize(out.data);
+            benchmark::ClobberMemory();
+        }
+        reportThroughput(state,in,pipe.getPlan().bytesTouched);
+    }
+
+    // Nodes reject encodings they don't support when they're linked, which is cheap to find out on a tiny frame
+    bool supports(const NodeFactory& factory, ImageEncoding encoding) {
+        const FrameFormat format(encoding,16,16);
+        cv::Mat in = generateEmptyCVImg<cv::Mat>(format);
+        try {
+            auto node = factory();
+            node->setInpad(&in,&format.encoding);
+            return true;
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+
+    void registerNode(const std::string& name, NodeFactory factory, const FrameFormat& format) {
+        benchmark::RegisterBenchmark(name,[factory,format](benchmark::State& state){
+            benchNode(state,factory,format);
+        })->Unit(benchmark::kMicrosecond)->UseRealTime();
+    }
+
+    void registerPipe(const std::string& name, std::function<NodeChain()> makeNodes, const FrameFormat& format) {
+        for (auto [execution, mode] : {
+            std::pair{PipeExecution::Sequential,"Sequential"},
+            std::pair{PipeExecution::Striped,"Striped"}
+        }) {
+            benchmark::RegisterBenchmark(std::format("Pipe/{}/{}/{}",name,mode,formatName(format)),[makeNodes,format,execution](benchmark::State& state){
+                benchPipe(state,makeNodes,format,execution);
+            })->Unit(benchmark::kMicrosecond)->UseRealTime();
+        }
+    }
+
+    void registerColorConvert() {
+        for (auto from : RAW_ENCODINGS) {
+            for (auto to : RAW_ENCODINGS) {
+                NodeFactory factory = [to](){ return std::make_unique<ColorConvertNode<cv::Mat>>(to); };
+                if (!supports(factory,from)) continue;
+                for (const auto& size : RESOLUTIONS) {
+                    const FrameFormat format(from,size.width,size.height);
+                    registerNode(std::format("ColorConvert/{}->{}/{}x{}",getEncodingName(from),getEncodingName(to),size.width,size.height),factory,format);
+                }
+            }
+        }
+    }
+
+    void registerGeometric() {
+        for (auto encoding : {ImageEncoding::Y8,ImageEncoding::BGR24}) {
+            for (const auto& size : RESOLUTIONS) {
+                const FrameFormat format(encoding,size.width,size.height);
+                for (auto [interpolation, interpolationName] : {
+                    std::pair{cv::INTER_NEAREST,"nearest"},
+                    std::pair{cv::INTER_LINEAR,"linear"},
+                    std::pair{cv::INTER_AREA,"area"}
+                }) {
+                    const cv::Size half(size.width / 2,size.height / 2);
+                    registerNode(std::format("Resize/half/{}/{}",interpolationName,formatName(format)),[interpolation,half](){
+                        return std::make_unique<ResizeNode<cv::Mat>>(interpolation,half.width,half.height);
+                    },format);
+                }
+                for (auto [rotation, rotationName] : {
+                    std::pair{cv::ROTATE_90_CLOCKWISE,"90cw"},
+                    std::pair{cv::ROTATE_180,"180"},
+                    std::pair{cv::ROTATE_90_COUNTERCLOCKWISE,"90ccw"}
+                }) {
+                    registerNode(std::format("Rotate/{}/{}",rotationName,formatName(format)),[rotation](){
+                        return std::make_unique<RotateNode<cv::Mat>>(rotation);
+                    },format);
+                }
+                registerNode(std::format("Letterbox/640x640/{}",formatName(format)),[](){
+                    return std::make_unique<LetterboxNode<cv::Mat>>(640,640);
+                },format);
+            }
+        }
+    }
+
+    void registerCameraNodes() {
+        cv::Mat cameraMatrix = (cv::Mat_<double>(3,3) << 500.0, 0.0, 320.0, 0.0, 500.0, 240.0, 0.0, 0.0, 1.0);
+        cv::Mat distCoeffs = (cv::Mat_<double>(1,5) << -0.3, 0.1, 0.001, -0.001, 0.0);
+        const CameraIntrinsics intrinsics(cv::Size(640,480),cameraMatrix,distCoeffs);
+        for (const auto& size : RESOLUTIONS) {
+            for (auto encoding : {ImageEncoding::YUYV,ImageEncoding::UYVY}) {
+                const FrameFormat format(encoding,size.width,size.height);
+                for (bool decimate : {false,true}) {
+                    registerNode(std::format("LumaExtract/{}/{}",decimate ? "decimated" : "full",formatName(format)),[decimate](){
+                        return std::make_unique<LumaExtractNode>(decimate);
+                    },format);
+                }
+            }
+            const FrameFormat mjpeg(ImageEncoding::MJPEG,size.width,size.height);
+            for (auto outcoding : {ImageEncoding::Y8,ImageEncoding::BGR24}) {
+                for (int denom : {1,2,4}) {
+                    registerNode(std::format("MJPEGDecode/{}/1:{}/{}",getEncodingName(outcoding),denom,formatName(mjpeg)),[size,outcoding,denom](){
+                        return std::make_unique<MJPEGDecodeNode>(size,outcoding,denom);
+                    },mjpeg);
+                }
+            }
+            for (auto encoding : {ImageEncoding::Y8,ImageEncoding::BGR24}) {
+                const FrameFormat format(encoding,size.width,size.height);
+                registerNode(std::format("Undistort/{}",formatName(format)),[intrinsics](){
+                    return std::make_unique<UndistortNode>(intrinsics);
+                },format);
+            }
+        }
+    }
+
+    // The chains VisionWorkerManager builds for common camera modes
+    void registerPipes() {
+        for (const auto& size : RESOLUTIONS) {
+            const cv::Size half(size.width / 2,size.height / 2);
+            registerPipe("AprilTag",[](){
+                NodeChain nodes;
+                nodes.push_back(std::make_unique<ColorConvertNode<cv::Mat>>(ImageEncoding::Y8));
+                return nodes;
+            },FrameFormat(ImageEncoding::BGR24,size.width,size.height));
+            registerPipe("AprilTagHalf",[half](){
+                NodeChain nodes;
+                nodes.push_back(std::make_unique<ResizeNode<cv::Mat>>(cv::INTER_AREA,half.width,half.height));
+                nodes.push_back(std::make_unique<ColorConvertNode<cv::Mat>>(ImageEncoding::Y8));
+                return nodes;
+            },FrameFormat(ImageEncoding::BGR24,size.width,size.height));
+            registerPipe("AprilTagHalf",[](){
+                NodeChain nodes;
+                nodes.push_back(std::make_unique<LumaExtractNode>(true));
+                return nodes;
+            },FrameFormat(ImageEncoding::YUYV,size.width,size.height));
+            registerPipe("AprilTagHalf",[size](){
+                NodeChain nodes;
+                nodes.push_back(std::make_unique<MJPEGDecodeNode>(size,ImageEncoding::Y8,2));
+                return nodes;
+            },FrameFormat(ImageEncoding::MJPEG,size.width,size.height));
+            registerPipe("ObjectDetection",[](){
+                NodeChain nodes;
+                nodes.push_back(std::make_unique<LetterboxNode<cv::Mat>>(640,640));
+                nodes.push_back(std::make_unique<ColorConvertNode<cv::Mat>>(ImageEncoding::RGB24));
+                return nodes;
+            },FrameFormat(ImageEncoding::BGR24,size.width,size.height));
+            registerPipe("ObjectDetection",[](){
+                NodeChain nodes;
+                nodes.push_back(std::make_unique<ColorConvertNode<cv::Mat>>(ImageEncoding::BGR24));
+                nodes.push_back(std::make_unique<LetterboxNode<cv::Mat>>(640,640));
+                return nodes;
+            },FrameFormat(ImageEncoding::YUYV,size.width,size.height));
+        }
+    }
+
+    // Each SIMD kernel at every level this machine supports, against the scalar reference, over a 1280x720 frame
+    void registerSimdKernels() {
+        using Kernel = std::function<void(const simd::Kernels&, const uint8_t*, uint8_t*, float*, size_t)>;
+        const std::array<std::pair<const char*,Kernel>,9> kernels = {{
+            {"swapRB3",[](const simd::Kernels& k, const uint8_t* src, uint8_t* dst, float*, size_t n){ k.swapRB3(src,dst,n); }},
+            {"addAlpha",[](const simd::Kernels& k, const uint8_t* src, uint8_t* dst, float*, size_t n){ k.addAlpha(src,dst,n); }},
+            {"dropAlpha",[](const simd::Kernels& k, const uint8_t* src, uint8_t* dst, float*, size_t n){ k.dropAlpha(src,dst,n); }},
+            {"grayTo3",[](const simd::Kernels& k, const uint8_t* src, uint8_t* dst, float*, size_t n){ k.grayTo3(src,dst,n); }},
+            {"deinterleave3",[](const simd::Kernels& k, const uint8_t* src, uint8_t* dst, float*, size_t n){
+                uint8_t* const planes[3] = {dst,dst + n,dst + 2 * n};
+                k.deinterleave3(src,planes,n);
+            }},
+            {"normalize3",[](const simd::Kernels& k, const uint8_t* src, uint8_t*, float* dst, size_t n){
+                const float scale[3] = {1.0f / 255.0f,1.0f / 255.0f,1.0f / 255.0f};
+                const float bias[3] = {-0.5f,-0.5f,-0.5f};
+                k.normalize(src,dst,3 * n,3,scale,bias);
+            }},
+            {"boxDownsample2x3",[](const simd::Kernels& k, const uint8_t* src, uint8_t* dst, float*, size_t n){
+                // Rows of 1280 BGR pixels, halved in both directions
+                for (size_t y = 0; y + 1 < n / 1280; y += 2)
+                    k.boxDownsample2x(src + y * 3840,src + (y + 1) * 3840,dst + (y / 2) * 1920,640,3);
+            }},
+            {"fill3",[](const simd::Kernels& k, const uint8_t*, uint8_t* dst, float*, size_t n){
+                const uint8_t pixel[3] = {114,114,114};
+                k.fill(dst,n,pixel,3);
+            }},
+            {"tileMinMax4",[](const simd::Kernels& k, const uint8_t* src, uint8_t* dst, float*, size_t n){
+                // Gray rows of 1280 pixels, 320 tiles each
+                for (size_t y = 0; y + 3 < n / 1280; y += 4)
+                    k.tileMinMax4(src + y * 1280,1280,dst + (y / 4) * 320,dst + n / 2 + (y / 4) * 320,320);
+            }}
+        }};
+        for (auto level : {simd::SimdLevel::Scalar,simd::SimdLevel::SSE41,simd::SimdLevel::AVX2,simd::SimdLevel::NEON}) {
+            if (!simd::isSupported(level)) continue;
+            for (const auto& entry : kernels) {
+                const Kernel kernel = entry.second;
+                benchmark::RegisterBenchmark(std::format("Simd/{}/{}/1280x720",entry.first,simd::getLevelName(level)),[level,kernel](benchmark::State& state){
+                    constexpr size_t pixels = 1280 * 720;
+                    std::vector<uint8_t> src(4 * pixels), dst(4 * pixels);
+                    std::vector<float> floats(3 * pixels);
+                    cv::randu(cv::Mat(1,static_cast<int>(src.size()),CV_8UC1,src.data()),cv::Scalar::all(0),cv::Scalar::all(256));
+                    const auto& table = simd::getKernels(level);
+                    for (auto _ : state) {
+                        kernel(table,src.data(),dst.data(),floats.data(),pixels);
+                        benchmark::DoNotOptimize(dst.data());
+                        benchmark::DoNotOptimize(floats.data());
+                        benchmark::ClobberMemory();
+                    }
+                    state.SetItemsProcessed(state.iterations() * pixels);
+                })->Unit(benchmark::kMicrosecond)->UseRealTime();
+            }
+        }
+    }
+
+    // apriltag's adaptive threshold as a whole at every level and resolution, against the scalar kernels it falls back to.
+    // Random frames give every tile enough contrast to take the full thresholding path
+    void registerApriltagThreshold() {
+        for (auto level : {simd::SimdLevel::Scalar,simd::SimdLevel::SSE41,simd::SimdLevel::AVX2,simd::SimdLevel::NEON}) {
+            if (!simd::isSupported(level)) continue;
+            for (const auto& size : RESOLUTIONS) {
+                benchmark::RegisterBenchmark(std::format("ApriltagThreshold/{}/{}x{}",simd::getLevelName(level),size.width,size.height),[level,size](benchmark::State& state){
+                    cv::Mat gray(size,CV_8UC1);
+                    cv::randu(gray,cv::Scalar::all(0),cv::Scalar::all(256));
+                    cv::Mat out;
+                    ApriltagThreshold threshold;
+                    const auto& table = simd::getKernels(level);
+                    for (auto _ : state) {
+                        threshold.apply(gray,out,table);
+                        benchmark::DoNotOptimize(out.data);
+                        benchmark::ClobberMemory();
+                    }
+                    state.SetItemsProcessed(state.iterations() * size.area());
+                })->Unit(benchmark::kMicrosecond)->UseRealTime();
+            }
+        }
+    }
+
+    // Whole detections, to see how much of the threshold stage's speedup makes it through. Scalar is apriltag's own code
+    void registerApriltagDetect() {
+        for (auto level : {simd::SimdLevel::Scalar,simd::SimdLevel::SSE41,simd::SimdLevel::AVX2,simd::SimdLevel::NEON}) {
+            if (!simd::isSupported(level)) continue;
+            for (const char* name : {"cubes","robots"}) {
+                for (int numThreads : {1,4}) {
+                    benchmark::RegisterBenchmark(std::format("ApriltagDetect/{}/{}/{}threads",simd::getLevelName(level),name,numThreads),[level,name,numThreads](benchmark::State& state){
+                        const cv::Mat image = cv::imread(std::format(RESOURCE_PATH "/apriltag/{}.jpg",name),cv::IMREAD_GRAYSCALE);
+                        if (image.empty()) {
+                            state.SkipWithError("test-resources not found, run from the build directory");
+                            return;
+                        }
+                        ApriltagDetector detector;
+                        detector.setConfig({.numThreads = numThreads});
+                        detector.setSimdLevel(level);
+                        if (!detector.addFamily("tag36h11")) {
+                            state.SkipWithError("Couldn't add tag36h11");
+                            return;
+                        }
+                        std::vector<ApriltagDetection> detections;
+                        for (auto _ : state) {
+                            detections.clear();
+                            auto res = detector.detect(image,2.0f,detections);
+                            benchmark::DoNotOptimize(res);
+                            benchmark::ClobberMemory();
+                        }
+                        state.counters["detections"] = static_cast<double>(detections.size());
+                        state.SetItemsProcessed(state.iterations() * image.total());
+                    })->Unit(benchmark::kMillisecond)->UseRealTime();
+                }
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    benchmark::AddCustomContext("opencv_version",CV_VERSION);
+    benchmark::AddCustomContext("opencv_threads",std::to_string(cv::getNumThreads()));
+    benchmark::AddCustomContext("wf_simd_level",std::string(simd::getLevelName(simd::getActiveLevel())));
+    benchmark::Initialize(&argc,argv);
+    if (benchmark::ReportUnrecognizedArguments(argc,argv)) return 1;
+    registerColorConvert();
+    registerGeometric();
+    registerCameraNodes();
+    registerPipes();
+    registerSimdKernels();
+    registerApriltagThreshold();
+    registerApriltagDetect();
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -72,7 +72,14 @@ namespace jval {
                 { "tagSize", getPrimitiveValidator<double>() }, 
                 { "detectorExcludes", get__z42Droot_detectorExcludes_validator() }, 
                 { "solvePnPExcludes", get__z42Droot_solvePnPExcludes_validator() }, 
-                { "solveTagRelative", getPrimitiveValidator<bool>() }
+                { "solveTagRelative", getPrimitiveValidator<bool>() }, 
+                { "adaptiveDecimate", getPrimitiveValidator<bool>() }, 
+                { "maxQuadDecimate", getPrimitiveValidator<double>() }, 
+                { "decimateProbeInterval", getPrimitiveValidator<int>() }, 
+                { "trackTags", getPrimitiveValidator<bool>() }, 
+                { "trackRefreshInterval", getPrimitiveValidator<int>() }, 
+                { "trackPadding", getPrimitiveValidator<double>() }, 
+                { "trackVelocity", getPrimitiveValidator<bool>() }
             },
             {
             },
@@ -46,7 +46,8 @@ namespace impl {
             "LIBCAMERA", 
             "CSCORE", 
             "REALSENSE", 
-            "GSTREAMER"
+            "GSTREAMER", 
+            "REPLAY"
         });
         return static_cast<JSONValidationFunctor*>(&validator);
     }
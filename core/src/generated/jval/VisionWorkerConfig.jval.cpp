@@ -50,6 +50,35 @@ namespace impl {
         });
         return static_cast<JSONValidationFunctor*>(&validator);
     }
+    const JSONValidationFunctor* get__z42Droot_dropPolicy_validator() {        
+        static JSONEnumValidator validator({
+            "LatestOnly", 
+            "Block"
+        });
+        return static_cast<JSONValidationFunctor*>(&validator);
+    }
+    const JSONValidationFunctor* get__z42Droot_threadPriority_validator() {        
+        static JSONEnumValidator validator({
+            "LOWEST", 
+            "LOW", 
+            "NORMAL", 
+            "HIGH", 
+            "HIGHEST", 
+            "SENSITIVE", 
+            "CRITICAL", 
+            "REALTIME", 
+            "ELEVEN"
+        });
+        return static_cast<JSONValidationFunctor*>(&validator);
+    }
+    const JSONValidationFunctor* get__z42Droot_cpuAffinity_validator() {        
+        static JSONArrayValidator validator(
+            getPrimitiveValidator<int>(),
+            0,
+            array_maxsize
+        );
+        return static_cast<JSONValidationFunctor*>(&validator);
+    }
     const JSONValidationFunctor* get__z42Droot_pipelineConfig_validator() {        
         static JSONUnionValidator validator(
             {
@@ -72,7 +101,16 @@ namespace jval {
                 { "raw_port", getPrimitiveValidator<int>() }, 
                 { "processed_port", getPrimitiveValidator<int>() }, 
                 { "pipelineType", get__z42Droot_pipelineType_validator() }, 
-                { "pipelineConfig", get__z42Droot_pipelineConfig_validator() }
+                { "pipelineConfig", get__z42Droot_pipelineConfig_validator() }, 
+                { "pipelined", getPrimitiveValidator<bool>() }, 
+                { "pipelineDepth", getPrimitiveValidator<int>() }, 
+                { "dropPolicy", get__z42Droot_dropPolicy_validator() }, 
+                { "threadPriority", get__z42Droot_threadPriority_validator() }, 
+                { "cpuAffinity", get__z42Droot_cpuAffinity_validator() }, 
+                { "stripedPreprocessing", getPrimitiveValidator<bool>() },
+                { "decoderThreads", getPrimitiveValidator<int>() },
+                { "undistort", getPrimitiveValidator<bool>() },
+                { "rotation", getPrimitiveValidator<int>() }
             },
             {
                 "camera_nickname", 
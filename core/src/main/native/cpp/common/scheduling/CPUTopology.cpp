@@ -0,0 +1,180 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "wfcore/common/scheduling/CPUTopology.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <fstream>
+#include <format>
+#include <optional>
+#include <thread>
+
+namespace impl {
+    using namespace wf;
+
+    static std::optional<std::string> readLine(const std::filesystem::path& path) {
+        std::ifstream file(path);
+        std::string line;
+        if (!file || !std::getline(file,line)) return std::nullopt;
+        return line;
+    }
+
+    static std::optional<int> readInt(const std::filesystem::path& path) {
+        auto line = readLine(path);
+        if (!line) return std::nullopt;
+        int value;
+        auto [ptr, ec] = std::from_chars(line->data(), line->data() + line->size(), value);
+        if (ec != std::errc()) return std::nullopt;
+        return value;
+    }
+
+    // Finds the list of CPUs sharing this CPU's unified or data L2 cache
+    static std::optional<std::vector<int>> readL2Siblings(const std::filesystem::path& cpuDir) {
+        for (int index = 0; ; ++index) {
+            auto cacheDir = cpuDir / "cache" / std::format("index{}",index);
+            auto level = readInt(cacheDir / "level");
+            if (!level) return std::nullopt;
+            if (*level != 2) continue;
+            auto type = readLine(cacheDir / "type");
+            if (type && *type == "Instruction") continue;
+            auto shared = readLine(cacheDir / "shared_cpu_list");
+            if (!shared) return std::nullopt;
+            return parseCPUList(*shared);
+        }
+    }
+}
+
+namespace wf {
+
+    std::vector<int> parseCPUList(std::string_view list) {
+        std::vector<int> cpus;
+        while (!list.empty()) {
+            auto comma = list.find(',');
+            auto entry = list.substr(0, comma);
+            list = (comma == std::string_view::npos) ? std::string_view{} : list.substr(comma + 1);
+            while (!entry.empty() && std::isspace(static_cast<unsigned char>(entry.back()))) entry.remove_suffix(1);
+            while (!entry.empty() && std::isspace(static_cast<unsigned char>(entry.front()))) entry.remove_prefix(1);
+            int first, last;
+            auto dash = entry.find('-');
+            auto firstEnd = entry.data() + (dash == std::string_view::npos ? entry.size() : dash);
+            if (std::from_chars(entry.data(), firstEnd, first).ec != std::errc()) continue;
+            last = first;
+            if (dash != std::string_view::npos
+                && std::from_chars(entry.data() + dash + 1, entry.data() + entry.size(), last).ec != std::errc())
+                continue;
+            for (int cpu = first; cpu <= last; ++cpu)
+                cpus.push_back(cpu);
+        }
+        std::sort(cpus.begin(),cpus.end());
+        cpus.erase(std::unique(cpus.begin(),cpus.end()),cpus.end());
+        return cpus;
+    }
+
+    CPUTopology CPUTopology::detect(const std::filesystem::path& sysfsRoot) {
+        std::vector<int> online;
+        if (auto list = impl::readLine(sysfsRoot / "online"))
+            online = parseCPUList(*list);
+        if (online.empty()) {
+            // No sysfs, so all we know is how many CPUs there are
+            const int count = std::max(1u, std::thread::hardware_concurrency());
+            for (int cpu = 0; cpu < count; ++cpu) online.push_back(cpu);
+        }
+
+        std::vector<CPUCore> cores;
+        cores.reserve(online.size());
+        for (int cpu : online) {
+            const auto cpuDir = sysfsRoot / std::format("cpu{}",cpu);
+            CPUCore core;
+            core.cpu = cpu;
+            // cpu_capacity is the kernel's own normalized performance figure, and is what tells big cores from little ones.
+            // Max frequency is the next best thing, since clusters on one die usually differ by clock
+            auto capacity = impl::readInt(cpuDir / "cpu_capacity");
+            if (!capacity) capacity = impl::readInt(cpuDir / "cpufreq" / "cpuinfo_max_freq");
+            core.capacity = capacity.value_or(0);
+            core.package = impl::readInt(cpuDir / "topology" / "physical_package_id").value_or(0);
+            auto smt = impl::readLine(cpuDir / "topology" / "core_cpus_list");
+            if (!smt) smt = impl::readLine(cpuDir / "topology" / "thread_siblings_list");
+            core.smtSiblings = smt ? parseCPUList(*smt) : std::vector<int>{};
+            core.l2Siblings = impl::readL2Siblings(cpuDir).value_or(std::vector<int>{});
+            cores.push_back(std::move(core));
+        }
+        // Offline CPUs can still show up as siblings, but nothing can be placed on them
+        for (auto& core : cores) {
+            for (auto* siblings : {&core.smtSiblings, &core.l2Siblings}) {
+                std::erase_if(*siblings,[&online](int cpu){
+                    return !std::binary_search(online.begin(),online.end(),cpu);
+                });
+                if (siblings->empty()) *siblings = {core.cpu};
+            }
+        }
+        return CPUTopology(std::move(cores));
+    }
+
+    int CPUTopology::maxCapacity() const noexcept {
+        int max = 0;
+        for (const auto& core : cores_)
+            max = std::max(max, core.capacity);
+        return max;
+    }
+
+    bool CPUTopology::isHeterogeneous() const noexcept {
+        return std::any_of(cores_.begin(),cores_.end(),[this, max = maxCapacity()](const CPUCore& core){
+            return core.capacity != max;
+        });
+    }
+
+    std::vector<int> CPUTopology::getPerformanceCPUs() const {
+        const int max = maxCapacity();
+        std::vector<int> cpus;
+        for (const auto& core : cores_) {
+            if (core.capacity == max) cpus.push_back(core.cpu);
+        }
+        return cpus;
+    }
+
+    std::vector<int> CPUTopology::getEfficiencyCPUs() const {
+        const int max = maxCapacity();
+        std::vector<int> cpus;
+        for (const auto& core : cores_) {
+            if (core.capacity != max) cpus.push_back(core.cpu);
+        }
+        return cpus;
+    }
+
+    std::vector<std::vector<int>> CPUTopology::getPerformanceCores() const {
+        const int max = maxCapacity();
+        // Physical cores are identified by their lowest SMT sibling, and ordered by the L2 domain they belong to
+        std::vector<const CPUCore*> primaries;
+        for (const auto& core : cores_) {
+            if (core.capacity == max && core.smtSiblings.front() == core.cpu)
+                primaries.push_back(&core);
+        }
+        std::stable_sort(primaries.begin(),primaries.end(),[](const CPUCore* a, const CPUCore* b){
+            if (a->package != b->package) return a->package < b->package;
+            return a->l2Siblings.front() < b->l2Siblings.front();
+        });
+        std::vector<std::vector<int>> physical;
+        physical.reserve(primaries.size());
+        for (const auto* core : primaries)
+            physical.push_back(core->smtSiblings);
+        return physical;
+    }
+}
@@ -0,0 +1,143 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "wfcore/common/scheduling/SharedWorkerPool.h"
+#include "wfcore/common/scheduling/CPUTopology.h"
+#include "wfcore/common/scheduling/threadutils.h"
+#include "wfcore/common/envutils.h"
+#include "wfcore/common/logging.h"
+
+#include <algorithm>
+#include <format>
+#include <pthread.h>
+
+namespace wf {
+
+    static loggerPtr logger = LoggerManager::getInstance().getLogger("SharedWorkerPool");
+
+    SharedWorkerPool& SharedWorkerPool::getInstance() {
+        static SharedWorkerPool pool = [] {
+            auto cpus = CPUTopology::detect().getPerformanceCPUs();
+            size_t numThreads = cpus.size() > 1 ? cpus.size() - 1 : 1;
+            if (auto budget = env::getInt("WF_DETECTOR_THREADS")) {
+                if (*budget >= 0) {
+                    numThreads = static_cast<size_t>(*budget);
+                } else {
+                    logger->warn("Ignoring negative WF_DETECTOR_THREADS {}",*budget);
+                }
+            }
+            logger->info("Starting the shared detector pool with {} threads",numThreads);
+            return SharedWorkerPool(numThreads,std::move(cpus));
+        }();
+        return pool;
+    }
+
+    SharedWorkerPool::SharedWorkerPool(size_t numThreads, std::vector<int> cpus_)
+    : cpus(std::move(cpus_)) {
+        workers.reserve(numThreads);
+        for (size_t i = 0; i < numThreads; ++i) {
+            workers.emplace_back([this,i](std::stop_token stoken) {
+                this->work(stoken,i);
+            });
+        }
+    }
+
+    SharedWorkerPool::~SharedWorkerPool() {
+        for (auto& worker : workers)
+            worker.request_stop();
+        workers.clear();
+    }
+
+    bool SharedWorkerPool::isJoinable(const Section& section) noexcept {
+        return section.helpers < section.maxHelpers
+            && section.next.load(std::memory_order_relaxed) < section.tasks.size();
+    }
+
+    size_t SharedWorkerPool::runTasks(Section& section) noexcept {
+        size_t ran = 0;
+        for (size_t i = section.next.fetch_add(1,std::memory_order_relaxed); i < section.tasks.size();
+             i = section.next.fetch_add(1,std::memory_order_relaxed)) {
+            section.tasks[i].fn(section.tasks[i].arg);
+            ++ran;
+        }
+        return ran;
+    }
+
+    void SharedWorkerPool::run(std::span<const Task> tasks, size_t maxHelpers) noexcept {
+        if (tasks.empty()) return;
+        sectionsRun.fetch_add(1,std::memory_order_relaxed);
+        tasksRun.fetch_add(tasks.size(),std::memory_order_relaxed);
+        maxHelpers = std::min({maxHelpers,workers.size(),tasks.size() - 1});
+        if (maxHelpers == 0) {
+            for (const auto& task : tasks) task.fn(task.arg);
+            return;
+        }
+
+        Section section{tasks,maxHelpers};
+        {
+            std::lock_guard lock(mtx);
+            sections.push_back(&section);
+        }
+        for (size_t i = 0; i < maxHelpers; ++i) available.notify_one();
+
+        runTasks(section);
+
+        // Every task has been claimed. Wait for the helpers still running the last of them
+        std::unique_lock lock(mtx);
+        std::erase(sections,&section);
+        section.done.wait(lock,[&section] { return section.helpers == 0; });
+    }
+
+    void SharedWorkerPool::work(std::stop_token stoken, size_t index) noexcept {
+        pthread_setname_np(pthread_self(),std::format("wf_pool_{}",index).substr(0,15).c_str());
+        if (!cpus.empty()) setCurrentThreadAffinity(cpus);
+        std::unique_lock lock(mtx);
+        while (true) {
+            Section* section = nullptr;
+            if (!available.wait(lock,stoken,[this] {
+                return std::any_of(sections.begin(),sections.end(),[](const Section* s) { return isJoinable(*s); });
+            })) return;
+            for (size_t n = 0; n < sections.size(); ++n) {
+                auto* candidate = sections[(nextSection + n) % sections.size()];
+                if (isJoinable(*candidate)) {
+                    section = candidate;
+                    break;
+                }
+            }
+            ++nextSection;
+            ++section->helpers;
+
+            lock.unlock();
+            tasksHelped.fetch_add(runTasks(*section),std::memory_order_relaxed);
+            lock.lock();
+
+            // Notified under the lock, the caller can't return and destroy the section until it is released
+            std::erase(sections,section);
+            if (--section->helpers == 0) section->done.notify_all();
+        }
+    }
+
+    SharedWorkerPool::Stats SharedWorkerPool::getStats() const noexcept {
+        return {
+            sectionsRun.load(std::memory_order_relaxed),
+            tasksRun.load(std::memory_order_relaxed),
+            tasksHelped.load(std::memory_order_relaxed)
+        };
+    }
+}
@@ -0,0 +1,49 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "wfcore/common/scheduling/ThreadPlacement.h"
+
+#include <algorithm>
+
+namespace wf {
+
+    std::vector<ThreadPlacement> planThreadPlacements(const CPUTopology& topology, size_t workers) {
+        std::vector<ThreadPlacement> placements(workers);
+        if (workers == 0) return placements;
+
+        const auto physical = topology.getPerformanceCores();
+        const auto efficiency = topology.getEfficiencyCPUs();
+        const size_t numCores = physical.size();
+        for (size_t i = 0; i < workers; ++i) {
+            auto& placement = placements[i];
+            if (workers <= numCores) {
+                // Spread any leftover cores over the first workers
+                const size_t begin = i * numCores / workers;
+                const size_t end = (i + 1) * numCores / workers;
+                for (size_t core = begin; core < end; ++core)
+                    placement.computeCPUs.insert(placement.computeCPUs.end(),physical[core].begin(),physical[core].end());
+            } else {
+                placement.computeCPUs = topology.getPerformanceCPUs();
+            }
+            std::sort(placement.computeCPUs.begin(),placement.computeCPUs.end());
+            placement.auxCPUs = efficiency.empty() ? placement.computeCPUs : efficiency;
+        }
+        return placements;
+    }
+}
@@ -30,7 +30,8 @@
 #include <sched.h>
 #include <unordered_set>
 #include <unordered_map>
-#include <sys/resource.h> 
+#include <sys/resource.h>
+#include <stdexcept>
 
 namespace wf {
     static std::unordered_set<ThreadPriority> RTPriorities = {
@@ -49,8 +50,7 @@ namespace wf {
         {ThreadPriority::REALTIME,80},
         {ThreadPriority::ELEVEN,99}
     };
-    int setCPUAffinity(std::thread& thread, const std::vector<int>& cpus) {
-        pthread_t pt = thread.native_handle();
+    static int setAffinity(pthread_t pt, const std::vector<int>& cpus) {
         cpu_set_t cpuset;
         CPU_ZERO(&cpuset);
         for (int cpu : cpus) {
@@ -59,8 +59,7 @@ namespace wf {
         return pthread_setaffinity_np(pt, sizeof(cpu_set_t), &cpuset);
     }
 
-    int setThreadPriority(std::thread& thread, ThreadPriority priority) {
-        pthread_t pt = thread.native_handle();
+    static int setPriority(pthread_t pt, ThreadPriority priority) {
         if (rt_priority_map.contains(priority)) {
             sched_param param;
             param.sched_priority = rt_priority_map.at(priority);
@@ -72,6 +71,22 @@ namespace wf {
         }
     }
 
+    int setCPUAffinity(std::thread& thread, const std::vector<int>& cpus) {
+        return setAffinity(thread.native_handle(), cpus);
+    }
+
+    int setThreadPriority(std::thread& thread, ThreadPriority priority) {
+        return setPriority(thread.native_handle(), priority);
+    }
+
+    int setCurrentThreadAffinity(const std::vector<int>& cpus) {
+        return setAffinity(pthread_self(), cpus);
+    }
+
+    int setCurrentThreadPriority(ThreadPriority priority) {
+        return setPriority(pthread_self(), priority);
+    }
+
     std::vector<int> getCPUAffinity(std::thread& thread) {
         cpu_set_t cpuset;
         CPU_ZERO(&cpuset);
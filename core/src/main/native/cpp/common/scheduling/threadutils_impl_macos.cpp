@@ -30,5 +30,14 @@ namespace wf {
     // Sets thread priority of a thread
     int setThreadPriority(const std::thread& thread, int priority);
 
+    // macOS has no hard affinity, so placement is left to the scheduler
+    int setCurrentThreadAffinity(const std::vector<int>& cores) {
+        return 0;
+    }
+
+    int setCurrentThreadPriority(ThreadPriority priority) {
+        return 0; // Placeholder
+    }
+
 }
 #endif //defined(__APPLE__) && defined(__MACH__)
\ No newline at end of file
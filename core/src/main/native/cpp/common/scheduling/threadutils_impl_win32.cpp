@@ -33,5 +33,13 @@ namespace wf {
     int setThreadPriority(const std::thread& thread, int priority) {
         return 0; // Placeholder
     }
+
+    int setCurrentThreadAffinity(const std::vector<int>& cores) {
+        return 0; // Placeholder
+    }
+
+    int setCurrentThreadPriority(ThreadPriority priority) {
+        return 0; // Placeholder
+    }
 }
 #endif // _WIN32
\ No newline at end of file
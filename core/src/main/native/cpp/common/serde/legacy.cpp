@@ -26,38 +26,12 @@
 
 #include <gtsam/geometry/Point3.h>
 #include <gtsam/geometry/Rot3.h>
-#include <unordered_map>
 #include <opencv2/core.hpp>
 
 // This file is now DEPRECATED. Serde shim code should be rewritten with WIPSSerializable
 
 namespace impl {
 
-    // TODO: Figure out a better way to do this
-    static std::unordered_map<std::string, wips_u8_t> tagFamilyIDs = {
-        {"tag36h11", 0},
-        {"tag36h10", 1},
-        {"tag25h9", 2},
-        {"tag16h5", 3},
-        {"tagCircle21h7", 4},
-        {"tagCircle49h12", 5},
-        {"tagCustom48h12", 6},
-        {"tagStandard41h12", 7},
-        {"tagStandard52h13", 8}
-    };
-
-    static std::unordered_map<wips_u8_t, std::string> tagFamilyNames = {
-        {0, "tag36h11"},
-        {1, "tag36h10"},
-        {2, "tag25h9"},
-        {3, "tag16h5"},
-        {4, "tagCircle21h7"},
-        {5, "tagCircle49h12"},
-        {6, "tagCustom48h12"},
-        {7, "tagStandard41h12"},
-        {8, "tagStandard52h13"}
-    };
-
     static wips_pose3_t wfcore2wips_pose3_shim(const gtsam::Pose3& pose) {
         auto q = pose.rotation().toQuaternion();
         wips_pose3_t wipspacket = {
@@ -97,7 +71,7 @@ namespace impl {
             detection.corners[3].x,detection.corners[3].y,
             detection.decisionMargin,
             detection.hammingDistance,
-            tagFamilyIDs.at(detection.family)
+            static_cast<wips_u8_t>(detection.family)
         };
     }
 
@@ -112,7 +86,7 @@ namespace impl {
             },
             detection.decision_margin,
             detection.hamming_distance,
-            tagFamilyNames.at(detection.tag_family_id)
+            wf::getTagFamily(detection.tag_family_id).value()
         };
     }
 
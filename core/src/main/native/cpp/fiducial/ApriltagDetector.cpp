@@ -19,8 +19,10 @@
 
 
 #include "wfcore/fiducial/ApriltagDetector.h"
+#include "wfcore/fiducial/ApriltagThreshold.h"
 #include "wfcore/common/logging.h"
 #include "wfcore/common/wfexcept.h"
+#include "wfcore/common/scheduling/SharedWorkerPool.h"
 
 #include <apriltag.h>
 #include <tag36h11.h>
@@ -33,8 +35,20 @@
 #include <tagStandard41h12.h>
 #include <tagStandard52h13.h>
 
+#include <common/workerpool.h>
+#include <common/image_u8.h>
+#include <common/zarray.h>
+
+#include <opencv2/core.hpp>
+
+#include <algorithm>
+#include <cstring>
 #include <map>
+#include <new>
+#include <thread>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 #include <format>
 #include "wfcore/common/wfassert.h"
 
@@ -62,6 +76,12 @@
         return x;                                                   \
     } while (0)
 
+namespace impl {
+    // The kernels for the quad detection stages of the detection running on this thread, null for apriltag's own code.
+    // apriltag calls the stages from the thread that called apriltag_detector_detect
+    static thread_local const wf::simd::Kernels* stageKernels = nullptr;
+}
+
     // TODO: Maybe this code is too defensive. I feel like a lot of the checks can be removed
 namespace wf {
     using enum WFStatus;
@@ -112,20 +132,31 @@ namespace wf {
     }
 
     WFResult<std::vector<ApriltagDetection>> ApriltagDetector::detect(int width, int height, int stride, uint8_t* buf) const noexcept {
+        std::vector<ApriltagDetection> detections;
+        auto res = detect(width,height,stride,buf,detections);
+        if (!res) return WFResult<std::vector<ApriltagDetection>>::propagateFail(res);
+        return WFResult<std::vector<ApriltagDetection>>::success(std::move(detections));
+    }
+
+    WFStatusResult ApriltagDetector::detect(int width, int height, int stride, uint8_t* buf, std::vector<ApriltagDetection>& out) const noexcept {
         image_u8_t im = {width,height,stride,buf};
 
         // Perform detection, returns a zarray of results
+        impl::stageKernels = simdLevel == simd::SimdLevel::Scalar ? nullptr : &simd::getKernels(simdLevel);
         auto rawDetections = apriltag_detector_detect(C_DETECTOR,&im);
+        impl::stageKernels = nullptr;
         WF_FatalAssert(rawDetections);
 
-        std::vector<ApriltagDetection> detections;
-        detections.reserve(zarray_size(rawDetections));
+        out.reserve(out.size() + zarray_size(rawDetections));
         //WF_DEBUGLOG(globalLogger(),"{} detections in zarray",zarray_size(rawDetections));
-        // Destructively converts rawDetections into a vector of wf::ApriltagDetections
+        // Destructively converts rawDetections into wf::ApriltagDetections
         for (int i = 0; i < zarray_size(rawDetections); i++) {
             apriltag_detection_t* det;
             zarray_get(rawDetections, i, &det);
-            detections.emplace_back(
+            // Only families from family_creators can be added, so every detection has a known family
+            auto family = parseTagFamily(det->family->name);
+            WF_FatalAssertAlways(family.has_value());
+            out.emplace_back(
                 det->id,
                 std::array<cv::Point2d, 4>{
                     cv::Point2d{det->p[0][0],det->p[0][1]},
@@ -135,14 +166,23 @@ namespace wf {
                 },
                 det->decision_margin,
                 det->hamming,
-                det->family->name
+                *family
             );
             apriltag_detection_destroy(det);
         }
         //WF_DEBUGLOG(globalLogger(),"Destroying zarray");
         zarray_destroy(rawDetections);
 
-        return WFResult<std::vector<ApriltagDetection>>::success(std::move(detections));
+        return WFStatusResult::success();
+    }
+
+    WFStatusResult ApriltagDetector::detect(const cv::Mat& im, float quadDecimate, std::vector<ApriltagDetection>& out) noexcept {
+        assert(im.type() == CV_8UC1);
+        const float configured = C_DETECTOR->quad_decimate;
+        C_DETECTOR->quad_decimate = quadDecimate;
+        auto res = detect(im.cols,im.rows,im.step[0],im.data,out);
+        C_DETECTOR->quad_decimate = configured;
+        return res;
     }
 
     QuadThresholdParams ApriltagDetector::getQuadThresholdParams() const noexcept {
@@ -247,4 +287,149 @@ namespace wf {
         }
     }
 
-}
\ No newline at end of file
+}
+// apriltag's workerpool, reimplemented on top of the shared pool. The library is built without its own workerpool.c
+// (see thirdparty/apriltag), so the parallel sections of every detector run on wf::SharedWorkerPool instead of a set of
+// threads per detector. nthreads still bounds how many threads a single detection uses, the caller included
+struct workerpool {
+    int nthreads;
+    std::vector<wf::SharedWorkerPool::Task> tasks; // Kept between runs, so a detection only allocates on its first frames
+};
+
+extern "C" {
+
+    workerpool_t* workerpool_create(int nthreads) {
+        auto* wp = new (std::nothrow) workerpool_t();
+        if (wp) wp->nthreads = std::max(nthreads,1);
+        return wp;
+    }
+
+    void workerpool_destroy(workerpool_t* wp) {
+        delete wp;
+    }
+
+    int workerpool_get_nthreads(workerpool_t* wp) {
+        return wp->nthreads;
+    }
+
+    void workerpool_add_task(workerpool_t* wp, void (*f)(void* p), void* p) {
+        wp->tasks.push_back({f,p});
+    }
+
+    void workerpool_run_single(workerpool_t* wp) {
+        for (const auto& task : wp->tasks) task.fn(task.arg);
+        wp->tasks.clear();
+    }
+
+    void workerpool_run(workerpool_t* wp) {
+        if (wp->nthreads <= 1) {
+            workerpool_run_single(wp);
+            return;
+        }
+        wf::SharedWorkerPool::getInstance().run(wp->tasks,static_cast<size_t>(wp->nthreads - 1));
+        wp->tasks.clear();
+    }
+
+    int workerpool_get_nprocs(void) {
+        return static_cast<int>(std::max(std::thread::hardware_concurrency(),1u));
+    }
+
+}
+
+// The quad detection stages wfcore runs itself. thirdparty/apriltag builds apriltag_quad_thresh.c with its calls to
+// threshold() and gradient_clusters() sent here, and with the wf_apriltag_upstream_ shims to the originals
+struct unionfind;
+
+namespace impl {
+    // A run of rows for isolateEdges to mask, with the originals of the rows just outside it, taken before any band is masked
+    struct EdgeBand {
+        const wf::simd::Kernels* kernels;
+        uint8_t* buf;
+        int w;
+        int ts;
+        int firstRow;
+        int endRow;
+        uint8_t* rows; // The row above, the row below, and room for the row being masked
+    };
+
+    static void isolateEdgeBand(void* arg) noexcept {
+        const auto& band = *static_cast<const EdgeBand*>(arg);
+        const int w = band.w, ts = band.ts;
+        uint8_t* above = band.rows;
+        const uint8_t* below = band.rows + w;
+        uint8_t* row = band.rows + 2 * static_cast<size_t>(w);
+        for (int y = band.firstRow; y < band.endRow; ++y) {
+            uint8_t* line = band.buf + static_cast<size_t>(y) * ts;
+            const uint8_t* next = (y + 1 == band.endRow) ? below : line + ts;
+            std::memcpy(row,line,w);
+            band.kernels->isolateEdges(above + 1,row + 1,next + 1,line + 1,w - 2);
+            std::swap(above,row);
+        }
+    }
+
+    // Sets the pixels of a thresholded frame that gradient clustering would pass over to 127, which it skips without
+    // looking up their components. Clustering pairs up neighbouring pixels that add up to 255, and a pixel without such
+    // a neighbour isn't one for any of its neighbours either, so nothing else changes. Only pixels with all 8 neighbours
+    // in the frame are masked. Rows are masked in place, in bands that up to maxHelpers of the shared pool's threads
+    // work through alongside the caller
+    static void isolateEdges(const wf::simd::Kernels& kernels, uint8_t* buf, int w, int h, int ts, size_t maxHelpers) {
+        // Only grow, so steady state frames don't allocate
+        thread_local std::vector<uint8_t> rows;
+        thread_local std::vector<EdgeBand> bands;
+        thread_local std::vector<wf::SharedWorkerPool::Task> tasks;
+        const int inner = h - 2;
+        const int numBands = static_cast<int>(std::min<size_t>(inner, 4 * (maxHelpers + 1)));
+        const size_t bandBytes = 3 * static_cast<size_t>(w);
+        if (rows.size() < numBands * bandBytes) rows.resize(numBands * bandBytes);
+        bands.clear();
+        for (int b = 0; b < numBands; ++b) {
+            const int firstRow = 1 + inner * b / numBands, endRow = 1 + inner * (b + 1) / numBands;
+            uint8_t* bandRows = rows.data() + b * bandBytes;
+            std::memcpy(bandRows,buf + static_cast<size_t>(firstRow - 1) * ts,w);
+            std::memcpy(bandRows + w,buf + static_cast<size_t>(endRow) * ts,w);
+            bands.push_back({&kernels, buf, w, ts, firstRow, endRow, bandRows});
+        }
+        if (bands.size() == 1) {
+            isolateEdgeBand(bands.data());
+            return;
+        }
+        tasks.clear();
+        for (auto& band : bands) tasks.push_back({isolateEdgeBand, &band});
+        wf::SharedWorkerPool::getInstance().run(tasks,maxHelpers);
+    }
+
+    // Helpers from the shared pool for a detector's stages, as its workerpool would use
+    static size_t helpersFor(const apriltag_detector_t* td) {
+        return static_cast<size_t>(std::max(td->nthreads,1) - 1);
+    }
+}
+
+extern "C" {
+
+    image_u8_t* wf_apriltag_upstream_threshold(apriltag_detector_t* td, image_u8_t* im);
+    zarray_t* wf_apriltag_upstream_gradient_clusters(apriltag_detector_t* td, image_u8_t* threshim, int w, int h, int ts, unionfind* uf);
+
+    image_u8_t* wf_apriltag_threshold(apriltag_detector_t* td, image_u8_t* im) {
+        // Deglitching is left to apriltag
+        if (!impl::stageKernels || td->qtp.deglitch)
+            return wf_apriltag_upstream_threshold(td,im);
+        thread_local wf::ApriltagThreshold threshold;
+        threshold.setMinWhiteBlackDiff(td->qtp.min_white_black_diff);
+        image_u8_t* threshim = image_u8_create(im->width,im->height);
+        const cv::Mat gray(im->height,im->width,CV_8UC1,im->buf,im->stride);
+        cv::Mat out(threshim->height,threshim->width,CV_8UC1,threshim->buf,threshim->stride);
+        if (const size_t helpers = impl::helpersFor(td))
+            threshold.apply(gray,out,*impl::stageKernels,wf::SharedWorkerPool::getInstance(),helpers);
+        else
+            threshold.apply(gray,out,*impl::stageKernels);
+        return threshim;
+    }
+
+    zarray_t* wf_apriltag_gradient_clusters(apriltag_detector_t* td, image_u8_t* threshim, int w, int h, int ts, unionfind* uf) {
+        // Debug output may write the threshold image out, so it's left whole
+        if (impl::stageKernels && !td->debug && w > 2 && h > 2)
+            impl::isolateEdges(*impl::stageKernels,threshim->buf,w,h,ts,impl::helpersFor(td));
+        return wf_apriltag_upstream_gradient_clusters(td,threshim,w,h,ts,uf);
+    }
+
+}
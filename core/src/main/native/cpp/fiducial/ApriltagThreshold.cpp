@@ -0,0 +1,149 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "wfcore/fiducial/ApriltagThreshold.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace impl {
+
+    // Replaces each value of a width x height map with the extreme of its 3x3 neighbourhood, clipped to the map.
+    // A rectangle's extreme is the extreme of its rows' extremes, so this matches apriltag's direct 3x3 pass
+    template <typename Pick>
+    static void blur3x3(uint8_t* map, uint8_t* scratch, size_t width, size_t height, Pick pick) noexcept {
+        for (size_t y = 0; y < height; ++y) {
+            const uint8_t* row = map + y * width;
+            uint8_t* out = scratch + y * width;
+            for (size_t x = 0; x < width; ++x) {
+                uint8_t v = row[x];
+                if (x > 0) v = pick(v, row[x - 1]);
+                if (x + 1 < width) v = pick(v, row[x + 1]);
+                out[x] = v;
+            }
+        }
+        for (size_t y = 0; y < height; ++y) {
+            const uint8_t* above = scratch + (y > 0 ? y - 1 : y) * width;
+            const uint8_t* row = scratch + y * width;
+            const uint8_t* below = scratch + (y + 1 < height ? y + 1 : y) * width;
+            uint8_t* out = map + y * width;
+            for (size_t x = 0; x < width; ++x)
+                out[x] = pick(pick(above[x], row[x]), below[x]);
+        }
+    }
+}
+
+namespace wf {
+
+    void ApriltagThreshold::apply(const cv::Mat& gray, cv::Mat& out, const simd::Kernels& kernels) {
+        run(gray,out,kernels,nullptr,0);
+    }
+
+    void ApriltagThreshold::apply(const cv::Mat& gray, cv::Mat& out, const simd::Kernels& kernels, SharedWorkerPool& pool, size_t maxHelpers) {
+        run(gray,out,kernels,&pool,maxHelpers);
+    }
+
+    void ApriltagThreshold::run(const cv::Mat& gray, cv::Mat& out, const simd::Kernels& kernels, SharedWorkerPool* pool, size_t maxHelpers) {
+        assert(gray.type() == CV_8UC1);
+        out.create(gray.size(), CV_8UC1);
+        tilesWide = gray.cols / TILE_SIZE;
+        tilesHigh = gray.rows / TILE_SIZE;
+        if (tilesWide == 0 || tilesHigh == 0) {
+            out.setTo(0);
+            return;
+        }
+        const size_t tiles = tilesWide * tilesHigh;
+        if (mins.size() < tiles) {
+            mins.resize(tiles);
+            maxs.resize(tiles);
+            scratch.resize(tiles);
+        }
+
+        // A few bands per thread, so a thread that starts late doesn't hold the rest up
+        const size_t numBands = pool ? std::min(tilesHigh, 4 * (maxHelpers + 1)) : 1;
+        bands.clear();
+        for (size_t b = 0; b < numBands; ++b)
+            bands.push_back({this, &gray, &out, &kernels, tilesHigh * b / numBands, tilesHigh * (b + 1) / numBands});
+
+        runBands(findExtremes, pool, maxHelpers);
+        impl::blur3x3(mins.data(), scratch.data(), tilesWide, tilesHigh, [](uint8_t a, uint8_t b){ return std::min(a,b); });
+        impl::blur3x3(maxs.data(), scratch.data(), tilesWide, tilesHigh, [](uint8_t a, uint8_t b){ return std::max(a,b); });
+        runBands(binarize, pool, maxHelpers);
+    }
+
+    void ApriltagThreshold::runBands(void (*pass)(void*) noexcept, SharedWorkerPool* pool, size_t maxHelpers) {
+        if (!pool || bands.size() == 1) {
+            for (auto& band : bands) pass(&band);
+            return;
+        }
+        tasks.clear();
+        for (auto& band : bands) tasks.push_back({pass, &band});
+        pool->run(tasks, maxHelpers);
+    }
+
+    void ApriltagThreshold::findExtremes(void* arg) noexcept {
+        const auto& band = *static_cast<const Band*>(arg);
+        auto& self = *band.self;
+        const size_t tilesWide = self.tilesWide;
+        for (size_t ty = band.firstTileRow; ty < band.endTileRow; ++ty) {
+            band.kernels->tileMinMax4(
+                band.gray->ptr(ty * TILE_SIZE), band.gray->step,
+                self.mins.data() + ty * tilesWide, self.maxs.data() + ty * tilesWide, tilesWide
+            );
+        }
+    }
+
+    void ApriltagThreshold::binarize(void* arg) noexcept {
+        const auto& band = *static_cast<const Band*>(arg);
+        const auto& self = *band.self;
+        const cv::Mat& gray = *band.gray;
+        cv::Mat& out = *band.out;
+        const size_t tilesWide = self.tilesWide, tilesHigh = self.tilesHigh;
+        const uint8_t* mins = self.mins.data();
+        const uint8_t* maxs = self.maxs.data();
+
+        // Tiles never have more than 255 of contrast, so a larger minimum leaves them all gray
+        const bool allGray = self.minWhiteBlackDiff > 255;
+        const uint8_t minContrast = static_cast<uint8_t>(std::clamp(self.minWhiteBlackDiff, 0, 255));
+        const int firstRow = static_cast<int>(band.firstTileRow) * TILE_SIZE;
+        const int endRow = static_cast<int>(band.endTileRow) * TILE_SIZE;
+        for (int y = firstRow; y < endRow; ++y) {
+            const size_t ty = y / TILE_SIZE;
+            if (allGray)
+                std::memset(out.ptr(y), 127, tilesWide * TILE_SIZE);
+            else
+                band.kernels->thresholdTiles4(gray.ptr(y), out.ptr(y), mins + ty * tilesWide, maxs + ty * tilesWide, tilesWide, minContrast);
+        }
+
+        // The partial tiles along the right and bottom edges use their nearest whole tile. Like apriltag, they skip the contrast check
+        const int lastRow = band.endTileRow == tilesHigh ? gray.rows : endRow;
+        for (int y = firstRow; y < lastRow; ++y) {
+            const int x0 = (y >= static_cast<int>(tilesHigh) * TILE_SIZE) ? 0 : static_cast<int>(tilesWide) * TILE_SIZE;
+            const size_t ty = std::min<size_t>(y / TILE_SIZE, tilesHigh - 1);
+            const uint8_t* src = gray.ptr(y);
+            uint8_t* dst = out.ptr(y);
+            for (int x = x0; x < gray.cols; ++x) {
+                const size_t tx = std::min<size_t>(x / TILE_SIZE, tilesWide - 1);
+                const int lo = mins[ty * tilesWide + tx], hi = maxs[ty * tilesWide + tx];
+                dst[x] = src[x] > lo + (hi - lo) / 2 ? 255 : 0;
+            }
+        }
+    }
+}
@@ -0,0 +1,122 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "wfcore/fiducial/DecimationController.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace wf {
+
+    // apriltag has a dedicated path for 1.5, every other level is a whole number of pixels
+    static constexpr std::array<float,5> STANDARD_LEVELS = {1.0f,1.5f,2.0f,3.0f,4.0f};
+
+    DecimationController::DecimationController(Params params_)
+    : params(std::move(params_)) {
+        params.minDecimate = std::max(params.minDecimate,1.0f);
+        params.maxDecimate = std::max(params.maxDecimate,params.minDecimate);
+        params.window = std::max(params.window,1);
+        levels.push_back(params.minDecimate);
+        for (float decimate : STANDARD_LEVELS) {
+            if (decimate > params.minDecimate && decimate < params.maxDecimate)
+                levels.push_back(decimate);
+        }
+        if (params.maxDecimate > params.minDecimate)
+            levels.push_back(params.maxDecimate);
+        initialLevel = findLevel(params.initialDecimate);
+        reset();
+    }
+
+    size_t DecimationController::findLevel(float decimate) const noexcept {
+        size_t closest = 0;
+        for (size_t i = 1; i < levels.size(); ++i) {
+            if (std::abs(levels[i] - decimate) < std::abs(levels[closest] - decimate))
+                closest = i;
+        }
+        return closest;
+    }
+
+    void DecimationController::reset() noexcept {
+        smallestAreas.assign(params.window,std::nullopt);
+        head = 0;
+        level = initialLevel;
+        raiseStreak = 0;
+        framesSinceProbe = 0;
+        probing = false;
+    }
+
+    float DecimationController::next() noexcept {
+        probing = params.probeInterval > 0 && level > 0 && framesSinceProbe >= params.probeInterval;
+        if (probing) {
+            framesSinceProbe = 0;
+            return levels.front();
+        }
+        ++framesSinceProbe;
+        return levels[level];
+    }
+
+    void DecimationController::observe(std::span<const ApriltagDetection> detections) noexcept {
+        std::optional<double> smallest;
+        for (const auto& detection : detections) {
+            const double area = getTagArea(detection);
+            if (!smallest || area < *smallest) smallest = area;
+        }
+        smallestAreas[head] = smallest;
+        head = (head + 1) % smallestAreas.size();
+
+        std::optional<double> recent;
+        for (const auto& area : smallestAreas) {
+            if (area && (!recent || *area < *recent)) recent = area;
+        }
+        if (!recent) {
+            // Nothing in view for a whole window, so there is nothing to size the decimation by
+            level = initialLevel;
+            raiseStreak = 0;
+            return;
+        }
+
+        const double side = std::sqrt(*recent);
+        if (side / levels[level] < params.minTagSide) {
+            // Back off right away, to the coarsest level the smallest tag still fits at
+            while (level > 0 && side / levels[level] < params.minTagSide) --level;
+            raiseStreak = 0;
+            return;
+        }
+        if (level + 1 < levels.size() && side / levels[level + 1] >= params.minTagSide * params.raiseMargin) {
+            if (++raiseStreak >= params.raiseAfter) {
+                ++level;
+                raiseStreak = 0;
+            }
+        } else {
+            raiseStreak = 0;
+        }
+    }
+
+    double DecimationController::getTagArea(const ApriltagDetection& detection) noexcept {
+        // Shoelace formula, the winding of the corners depends on which way up the tag is
+        double twiceArea = 0.0;
+        for (size_t i = 0; i < detection.corners.size(); ++i) {
+            const auto& a = detection.corners[i];
+            const auto& b = detection.corners[(i + 1) % detection.corners.size()];
+            twiceArea += a.x * b.y - b.x * a.y;
+        }
+        return std::abs(twiceArea) / 2.0;
+    }
+}
@@ -0,0 +1,134 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "wfcore/fiducial/TagTracker.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace wf {
+
+    TagTracker::TagTracker(Params params_)
+    : params(std::move(params_)) {
+        params.padding = std::max(params.padding,0.0);
+        params.minPadding = std::max(params.minPadding,0);
+    }
+
+    void TagTracker::reset() noexcept {
+        tracks.clear();
+        regions.clear();
+        framesSinceRefresh = 0;
+        fullFrame = true;
+        lost = false;
+    }
+
+    bool TagTracker::plan(cv::Size frameSize, bool forceFullFrame) noexcept {
+        regions.clear();
+        fullFrame = forceFullFrame || lost || tracks.empty() || framesSinceRefresh + 1 >= params.refreshInterval;
+        if (fullFrame) {
+            framesSinceRefresh = 0;
+            return false;
+        }
+        ++framesSinceRefresh;
+
+        const cv::Rect frame(0,0,frameSize.width,frameSize.height);
+        for (const auto& track : tracks) {
+            cv::Rect2d predicted = track.bounds;
+            double pad = std::max<double>(params.padding * std::max(predicted.width,predicted.height),params.minPadding);
+            if (params.useVelocity) {
+                predicted.x += track.velocity.x;
+                predicted.y += track.velocity.y;
+                // The faster a tag moves, the less its velocity over the last frame says about the next one
+                pad += std::max(std::abs(track.velocity.x),std::abs(track.velocity.y));
+            }
+            cv::Rect region(
+                cv::Point(static_cast<int>(std::floor(predicted.x - pad)),static_cast<int>(std::floor(predicted.y - pad))),
+                cv::Point(static_cast<int>(std::ceil(predicted.br().x + pad)),static_cast<int>(std::ceil(predicted.br().y + pad)))
+            );
+            region &= frame;
+            if (region.empty()) {
+                // The tag is predicted to have left the frame. Searching the whole frame next is what notices if it didn't
+                continue;
+            }
+            regions.push_back(region);
+        }
+
+        // Merge overlapping regions until none are left, otherwise a tag in the overlap would be detected twice
+        bool merged = true;
+        while (merged) {
+            merged = false;
+            for (size_t i = 0; i < regions.size() && !merged; ++i) {
+                for (size_t j = i + 1; j < regions.size(); ++j) {
+                    if ((regions[i] & regions[j]).empty()) continue;
+                    regions[i] |= regions[j];
+                    regions.erase(regions.begin() + j);
+                    merged = true;
+                    break;
+                }
+            }
+        }
+        if (regions.empty()) {
+            fullFrame = true;
+            framesSinceRefresh = 0;
+            return false;
+        }
+        return true;
+    }
+
+    void TagTracker::observe(std::span<const ApriltagDetection> detections) noexcept {
+        nextTracks.clear();
+        for (const auto& detection : detections) {
+            cv::Point2d center(0.0,0.0);
+            double minX = detection.corners[0].x, maxX = minX;
+            double minY = detection.corners[0].y, maxY = minY;
+            for (const auto& corner : detection.corners) {
+                center += corner;
+                minX = std::min(minX,corner.x);
+                maxX = std::max(maxX,corner.x);
+                minY = std::min(minY,corner.y);
+                maxY = std::max(maxY,corner.y);
+            }
+            center *= 1.0 / detection.corners.size();
+            cv::Point2d velocity(0.0,0.0);
+            auto previous = std::find_if(tracks.begin(),tracks.end(),[&detection](const Track& track) {
+                return track.id == detection.id && track.family == detection.family;
+            });
+            if (previous != tracks.end())
+                velocity = center - previous->center;
+            nextTracks.push_back({
+                detection.id,
+                detection.family,
+                center,
+                velocity,
+                cv::Rect2d(minX,minY,maxX - minX,maxY - minY)
+            });
+        }
+        // A tracked tag missing from its region has either left the frame or moved out of its region
+        lost = false;
+        if (!fullFrame) {
+            for (const auto& track : tracks) {
+                lost = std::none_of(nextTracks.begin(),nextTracks.end(),[&track](const Track& next) {
+                    return next.id == track.id && next.family == track.family;
+                });
+                if (lost) break;
+            }
+        }
+        std::swap(tracks,nextTracks);
+    }
+}
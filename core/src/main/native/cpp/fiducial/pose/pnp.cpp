@@ -29,6 +29,16 @@
 #include <gtsam/geometry/Pose3.h>
 #include <array>
 
+namespace impl {
+    using namespace wf;
+
+    // Rectified frames have no distortion left, and passing no coefficients lets OpenCV skip the distortion model for every point
+    static const cv::Mat& getDistortion(const CameraIntrinsics& intrinsics) noexcept {
+        static const cv::Mat noDistortion;
+        return intrinsics.isDistortionFree() ? noDistortion : intrinsics.distCoeffs;
+    }
+}
+
 namespace wf {
 
     std::optional<ApriltagFieldPoseObservation> solvePNPApriltag(
@@ -144,7 +154,7 @@ namespace wf {
                 objectPoints,
                 imagePoints,
                 cameraIntrinsics.cameraMatrix,
-                cameraIntrinsics.distCoeffs,
+                impl::getDistortion(cameraIntrinsics),
                 rvecs,
                 tvecs,
                 false,
@@ -183,7 +193,7 @@ namespace wf {
                 objectPoints,
                 imagePoints,
                 cameraIntrinsics.cameraMatrix,
-                cameraIntrinsics.distCoeffs,
+                impl::getDistortion(cameraIntrinsics),
                 rvecs,
                 tvecs,
                 false,
@@ -233,7 +243,7 @@ namespace wf {
             objectPoints,
             imagePoints,
             cameraIntrinsics.cameraMatrix,
-            cameraIntrinsics.distCoeffs,
+            impl::getDistortion(cameraIntrinsics),
             rvecs,
             tvecs,
             false,
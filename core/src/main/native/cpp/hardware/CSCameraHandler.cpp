@@ -49,19 +49,25 @@ namespace wf {
         enable();
     }
 
-    WFResult<std::shared_ptr<CameraSink>> CSCameraHandler::getCameraSink(const std::string& name){
+    WFResult<std::shared_ptr<CameraSink>> CSCameraHandler::getCameraSink(const std::string& name, FrameDropPolicy policy){
         if (!ok()) return WFResult<std::shared_ptr<CameraSink>>::failure(getStatus(),getError());
         auto it = sinks_.find(name);
         if (it != sinks_.end()) {
             // If a frame provider with that name already exists in the sink registry and the pointer is valid, return it
-            if (auto locked = it->second.lock()) 
+            if (auto locked = it->second.lock()) {
+                // A subscriber's policy is fixed, so handing it to a caller that asked for another one would silently change its behavior
+                if (locked->getDropPolicy() != policy)
+                    return WFResult<std::shared_ptr<CameraSink>>::failure(BAD_ARGUMENT,"Sink {} of camera {} already exists with a different drop policy",name,name_);
                 return WFResult<std::shared_ptr<CameraSink>>::success(std::move(locked));
+            }
             // If the pointer is not valid, remove the entry from the sink registry
             sinks_.erase(it);
         }
-        cs::CvSink appsink;
-        auto provider = std::make_shared<CSCameraSink>(shared_from_this(),name);
-        std::weak_ptr<CSCameraSink> provider_registry_ref(provider);
+        // The hub's own sink is the only one that actually pulls frames from cscore
+        if (!hub_)
+            hub_ = CameraBroadcastHub::create(std::make_shared<CSCameraSink>(shared_from_this(),std::format("{}_broadcast",name_)));
+        auto provider = hub_->subscribe(name,policy);
+        std::weak_ptr<CameraSink> provider_registry_ref(provider);
         sinks_.insert({name,provider_registry_ref});
         // TODO: Check if operation was successful
         return WFResult<std::shared_ptr<CameraSink>>::success(std::move(provider));
@@ -33,36 +33,67 @@ namespace wf {
     static loggerPtr logger = LoggerManager::getInstance().getLogger("CSCameraSink");
 
     CSCameraSink::CSCameraSink(std::shared_ptr<CSCameraHandler> handler, std::string name)
-    : cs::RawSink(name), handler_(handler) {
+    : cs::RawSink(name), handler_(handler), handlerView_(handler.get()) {
         acquireSource(handler);
     }
 
     FrameMetadata CSCameraSink::getFrame(cv::Mat& data) noexcept {
-        auto locked = handler_.lock();
-        if (!locked) return FrameMetadata::badFrame(BAD_ACQUIRE);
-        if (!locked->ok()) return FrameMetadata::badFrame(locked->getStatus());
+        cv::Mat view;
+        FrameLease lease;
+        auto meta = acquireFrame(view,lease);
+        if (meta) view.copyTo(data);
+        releaseFrame(lease);
+        return meta;
+    }
+
+    FrameMetadata CSCameraSink::acquireFrame(cv::Mat& data, FrameLease& lease) noexcept {
+        lease = NULL_LEASE;
+        if (!handlerView_->ok()) return FrameMetadata::badFrame(handlerView_->getStatus());
+
+        // Find a buffer that isn't currently lent out, starting from the one after the last grab
+        const int slot = slots_.findFree();
+        if (slot == NULL_LEASE) {
+            // Every buffer is still held downstream, this is a transient condition
+            WF_DEBUGLOG(logger,"All {} buffers of sink {} are lent out",LEND_SLOTS,GetName());
+            return FrameMetadata::badFrame(BAD_ACQUIRE);
+        }
 
-        auto micros = GrabFrame(raw_buffer_);
+        auto& raw = lendBuffers_[slot];
+        auto micros = GrabFrame(raw);
         if (!micros) {
             // A camera fault was not detected by the Hardware Manager, report it here
             logger->error("CSCore error from sink {}: {}",GetName(),GetError());
             return FrameMetadata::badFrame(HARDWARE_CSCORE);
         }
 
-        auto format = locked->getStreamFormat().frameFormat;
-        int cvType = getCVTypeFromEncoding(format.encoding);
-        WF_FatalAssert(format.height == raw_buffer_.height && format.width == raw_buffer_.width);
-
-        data.create(format.height, format.width, cvType);
-
-        WF_FatalAssert(data.step == raw_buffer_.stride);
-        size_t totalBytes = format.height * raw_buffer_.stride;
-        WF_FatalAssert(data.isContinuous());
-        std::memcpy(data.data, raw_buffer_.data, totalBytes);
+        // The grabbed frame describes itself, so there is no need to query the handler's stream format
+        FrameFormat format(
+            getEncodingFromPixelFormat(static_cast<cs::VideoMode::PixelFormat>(raw.pixelFormat)),
+            raw.width,
+            raw.height
+        );
+        // Wrap the grabbed buffer directly, no copy. A compressed frame is passed on as a single row of its bitstream
+        if (format.encoding == ImageEncoding::MJPEG) {
+            data = cv::Mat(1, static_cast<int>(raw.size), CV_8UC1, raw.data);
+        } else {
+            data = cv::Mat(
+                raw.height,
+                raw.width,
+                getCVTypeFromEncoding(format.encoding),
+                raw.data,
+                static_cast<size_t>(raw.stride)
+            );
+        }
 
+        slots_.lend(slot);
+        lease = slot;
         return FrameMetadata(micros, getMasterTime(), format);
     }
 
+    void CSCameraSink::releaseFrame(FrameLease lease) noexcept {
+        slots_.release(lease);
+    }
+
     WFResult<StreamFormat> CSCameraSink::getStreamFormat() const noexcept {
         auto locked = handler_.lock();
         return locked 
@@ -0,0 +1,282 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "wfcore/hardware/CameraBroadcastHub.h"
+#include "wfcore/common/logging.h"
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <pthread.h>
+
+namespace wf {
+    using enum WFStatus;
+    static loggerPtr logger = LoggerManager::getInstance().getLogger("CameraBroadcastHub");
+
+    // Matches the default grab timeout of a direct cscore sink
+    static constexpr auto SUBSCRIBER_TIMEOUT = std::chrono::milliseconds(250);
+
+    class BroadcastSubscriber : public CameraSink {
+    public:
+        BroadcastSubscriber(
+            std::shared_ptr<CameraBroadcastHub> hub,
+            std::shared_ptr<CameraBroadcastHub::Subscription> subscription,
+            std::string name
+        ) : hub_(std::move(hub)), subscription_(std::move(subscription)), name_(std::move(name)) {}
+
+        ~BroadcastSubscriber() override {
+            hub_->unsubscribe(subscription_);
+        }
+
+        FrameMetadata getFrame(cv::Mat& data) noexcept override {
+            cv::Mat view;
+            FrameLease lease;
+            auto meta = acquireFrame(view,lease);
+            if (meta) view.copyTo(data);
+            releaseFrame(lease);
+            return meta;
+        }
+
+        FrameMetadata acquireFrame(cv::Mat& data, FrameLease& lease) noexcept override {
+            lease = NULL_LEASE;
+            auto index = hub_->takeNext(*subscription_);
+            if (!index) {
+                auto status = hub_->lastStatus_.load(std::memory_order_relaxed);
+                return FrameMetadata::badFrame(status == OK ? BAD_ACQUIRE : status);
+            }
+            auto& entry = hub_->entries_[*index];
+            data = entry.frame;
+            lease = *index;
+            return *entry.meta;
+        }
+
+        void releaseFrame(FrameLease lease) noexcept override {
+            if (lease < 0 || lease >= hub_->slots_) return;
+            hub_->release(lease);
+        }
+
+        int getLendSlots() const noexcept override { return hub_->slots_; }
+
+        std::string getName() const override { return name_; }
+
+        WFResult<std::string> getCameraNickname() const override {
+            return hub_->getSource()->getCameraNickname();
+        }
+
+        WFResult<StreamFormat> getStreamFormat() const noexcept override {
+            return hub_->getSource()->getStreamFormat();
+        }
+
+        FramePyramid* getPyramid(FrameLease lease) noexcept override {
+            if (lease < 0 || lease >= hub_->slots_) return nullptr;
+            return &hub_->entries_[lease].pyramid;
+        }
+
+        FrameDropPolicy getDropPolicy() const noexcept override { return subscription_->policy; }
+
+        uint64_t getDroppedFrames() const noexcept override {
+            return subscription_->dropped.load(std::memory_order_relaxed);
+        }
+    private:
+        std::shared_ptr<CameraBroadcastHub> hub_;
+        std::shared_ptr<CameraBroadcastHub::Subscription> subscription_;
+        std::string name_;
+    };
+
+    CameraBroadcastHub::CameraBroadcastHub(std::shared_ptr<CameraSink> source)
+    : source_(std::move(source))
+    , slots_(source_->getLendSlots() > 0 ? source_->getLendSlots() : DEFAULT_HUB_SLOTS)
+    , entries_(std::make_unique<Entry[]>(slots_))
+    , lastStatus_(OK) {}
+
+    CameraBroadcastHub::~CameraBroadcastHub() {
+        // Subscribers keep the hub alive, so there are none left by the time it is destroyed
+        if (thread_.joinable()) {
+            thread_.request_stop();
+            thread_.join();
+        }
+    }
+
+    std::shared_ptr<CameraSink> CameraBroadcastHub::subscribe(std::string name, FrameDropPolicy policy) {
+        auto subscription = std::make_shared<Subscription>();
+        subscription->policy = policy;
+        subscription->capacity = (policy == FrameDropPolicy::LatestOnly) ? 1 : BLOCK_QUEUE_DEPTH;
+        {
+            std::lock_guard lock(subscriptionsMtx_);
+            subscriptions_.push_back(subscription);
+            if (!thread_.joinable()) {
+                thread_ = std::jthread([this](std::stop_token stoken) {
+                    this->run(stoken);
+                });
+            }
+        }
+        logger->info("Sink {} subscribed to the broadcast of {}",name,source_->getName());
+        return std::make_shared<BroadcastSubscriber>(shared_from_this(),std::move(subscription),std::move(name));
+    }
+
+    void CameraBroadcastHub::unsubscribe(const std::shared_ptr<Subscription>& subscription) noexcept {
+        // Close the subscription first, so the hub stops waiting on it if it is blocked publishing
+        {
+            std::lock_guard lock(subscription->mtx);
+            subscription->closed = true;
+        }
+        subscription->cv.notify_all();
+        {
+            std::lock_guard lock(subscriptionsMtx_);
+            std::erase(subscriptions_,subscription);
+        }
+        // Hand back anything the subscriber never picked up
+        std::lock_guard lock(subscription->mtx);
+        while (subscription->count > 0) {
+            release(subscription->queue[subscription->head]);
+            subscription->head = (subscription->head + 1) % subscription->queue.size();
+            --subscription->count;
+        }
+    }
+
+    std::optional<int> CameraBroadcastHub::takeNext(Subscription& subscription) noexcept {
+        std::unique_lock lock(subscription.mtx);
+        if (!subscription.cv.wait_for(lock,SUBSCRIBER_TIMEOUT,[&subscription]{
+            return subscription.count > 0 || subscription.closed;
+        }) || subscription.count == 0) {
+            return std::nullopt;
+        }
+        int index = subscription.queue[subscription.head];
+        subscription.head = (subscription.head + 1) % subscription.queue.size();
+        --subscription.count;
+        lock.unlock();
+        // Wake the hub if it is waiting for room in a Block subscription
+        subscription.cv.notify_all();
+        return index;
+    }
+
+    void CameraBroadcastHub::retain(int index) noexcept {
+        entries_[index].refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void CameraBroadcastHub::release(int index) noexcept {
+        auto& entry = entries_[index];
+        if (entry.refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+        // Last reference. The entry can't be reused until it is marked free, so its upstream lease is still ours
+        source_->releaseFrame(entry.upstreamLease);
+        entry.upstreamLease = NULL_LEASE;
+        {
+            // Under the lock, so the hub can't miss the wakeup between finding every entry held and waiting
+            std::lock_guard lock(entriesMtx_);
+            entry.inUse.store(false, std::memory_order_release);
+        }
+        entryFreed_.notify_one();
+    }
+
+    int CameraBroadcastHub::claimEntry(std::stop_token stoken) {
+        int index = -1;
+        auto tryClaim = [this,&index]{
+            for (int i = 0; i < slots_; ++i) {
+                bool expected = false;
+                if (entries_[i].inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                    index = i;
+                    return true;
+                }
+            }
+            return false;
+        };
+        std::unique_lock lock(entriesMtx_);
+        entryFreed_.wait_for(lock,stoken,SUBSCRIBER_TIMEOUT,tryClaim);
+        return index;
+    }
+
+    void CameraBroadcastHub::publish(int index, std::stop_token stoken) {
+        // Work from a snapshot, so waiting on a Block subscriber below doesn't hold up the others or (un)subscribing.
+        // A subscription closed after the snapshot is skipped under its own lock, and unsubscribe drains anything queued before
+        {
+            std::lock_guard subscriptionsLock(subscriptionsMtx_);
+            publishList_.assign(subscriptions_.begin(),subscriptions_.end());
+        }
+        for (auto& subscription : publishList_) {
+            std::unique_lock lock(subscription->mtx);
+            if (subscription->closed) continue;
+            if (subscription->count == subscription->capacity) {
+                if (subscription->policy == FrameDropPolicy::LatestOnly) {
+                    // Replace the frame the subscriber hasn't picked up yet
+                    release(subscription->queue[subscription->head]);
+                    subscription->head = (subscription->head + 1) % subscription->queue.size();
+                    --subscription->count;
+                    subscription->dropped.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    while (subscription->count == subscription->capacity && !subscription->closed && !stoken.stop_requested())
+                        subscription->cv.wait_for(lock,SUBSCRIBER_TIMEOUT);
+                    if (subscription->closed || stoken.stop_requested()) continue;
+                }
+            }
+            retain(index);
+            subscription->queue[(subscription->head + subscription->count) % subscription->queue.size()] = index;
+            ++subscription->count;
+            lock.unlock();
+            subscription->cv.notify_all();
+        }
+        // Don't keep closed subscriptions alive until the next frame
+        publishList_.clear();
+    }
+
+    void CameraBroadcastHub::run(std::stop_token stoken) noexcept {
+        pthread_setname_np(pthread_self(), std::format("{}_hub",source_->getName()).substr(0, 15).c_str());
+        while (!stoken.stop_requested()) {
+            try {
+            bool idle;
+            {
+                std::lock_guard lock(subscriptionsMtx_);
+                idle = subscriptions_.empty();
+            }
+            if (idle) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                continue;
+            }
+
+            // Wait for an entry nobody holds anymore. Every entry being held by subscribers is a transient condition
+            int index = claimEntry(stoken);
+            if (index < 0) continue;
+
+            auto& entry = entries_[index];
+            auto meta = source_->acquireFrame(entry.frame,entry.upstreamLease);
+            if (!meta) {
+                entry.inUse.store(false, std::memory_order_release);
+                if (meta.status == BAD_ACQUIRE) {
+                    // The source has nothing to lend yet. The hub never holds more frames than the source lends, so
+                    // this is a slow source, or another consumer of it holding its buffers
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    continue;
+                }
+                lastStatus_.store(meta.status, std::memory_order_relaxed);
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                continue;
+            }
+            lastStatus_.store(OK, std::memory_order_relaxed);
+            entry.meta.emplace(meta);
+            entry.pyramid.reset(entry.frame,meta.format.encoding);
+            // The hub holds its own reference while publishing, so a subscriber releasing early can't free the entry
+            entry.refs.store(1, std::memory_order_relaxed);
+            publish(index,stoken);
+            release(index);
+            } catch (...) {
+                logger->error("Unknown exception in the broadcast hub of {}",source_->getName());
+                lastStatus_.store(UNKNOWN, std::memory_order_relaxed);
+            }
+        }
+    }
+}
@@ -42,14 +42,16 @@ namespace impl {
         {CameraBackend::CSCORE,"CSCORE"},
         {CameraBackend::REALSENSE,"REALSENSE"},
         {CameraBackend::GSTREAMER,"GSTREAMER"},
-        {CameraBackend::LIBCAMERA,"LIBCAMERA"}
+        {CameraBackend::LIBCAMERA,"LIBCAMERA"},
+        {CameraBackend::REPLAY,"REPLAY"}
     };
 
     static const std::unordered_map<std::string,CameraBackend> backendMap = {
         {"CSCORE",CameraBackend::CSCORE},
         {"REALSENSE",CameraBackend::REALSENSE},
         {"GSTREAMER",CameraBackend::GSTREAMER},
-        {"LIBCAMERA",CameraBackend::LIBCAMERA}
+        {"LIBCAMERA",CameraBackend::LIBCAMERA},
+        {"REPLAY",CameraBackend::REPLAY}
     };
 
     static const std::unordered_map<CamControl,std::string> camControlStringMap = {
@@ -162,6 +164,15 @@ namespace wf {
         return cvmeq(cameraMatrix,other.cameraMatrix) && cvmeq(distCoeffs,other.distCoeffs) && cvseq(resolution,other.resolution);
     }
 
+    CameraIntrinsics CameraIntrinsics::rectified() const {
+        // Zeroed rather than empty, so the result still serializes like any other calibration
+        return CameraIntrinsics(resolution,cameraMatrix.clone(),cv::Mat::zeros(1,5,CV_64FC1));
+    }
+
+    bool CameraIntrinsics::isDistortionFree() const noexcept {
+        return distCoeffs.empty() || (distCoeffs.channels() == 1 && cv::countNonZero(distCoeffs) == 0);
+    }
+
     const jval::JSONValidationFunctor* CameraConfiguration::getValidator_impl() {
         return jval::get_CameraConfig_validator();
     }
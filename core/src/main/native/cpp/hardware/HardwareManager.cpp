@@ -19,6 +19,7 @@
 
 #include "wfcore/hardware/HardwareManager.h"
 #include "wfcore/hardware/CSCameraHandler.h"
+#include "wfcore/hardware/ReplayCameraHandler.h"
 #include "wfcore/common/logging/LoggerManager.h"
 #include "wfcore/common/logging.h"
 
@@ -67,6 +68,17 @@ namespace wf {
                         return WFStatusResult::failure(e.status());
                     }
                 }
+            case CameraBackend::REPLAY:
+                {
+                    try {
+                        auto handlerPtr = ReplayCameraHandler::create(config);
+                        cameras.emplace(config.nickname,std::move(handlerPtr));
+                        return WFStatusResult::success();
+                    } catch (const wfexception& e) {
+                        logger()->error(e.what());
+                        return WFStatusResult::failure(e.status());
+                    }
+                }
             case CameraBackend::REALSENSE: 
                 logger()->error("Realsense is not supported yet. Failed to register camera {}.",config.nickname);
                 return WFStatusResult::failure(NOT_IMPLEMENTED);
@@ -96,13 +108,13 @@ namespace wf {
         return getCamera_(nickname)->getBackend();
     }
 
-    WFResult<std::shared_ptr<CameraSink>> HardwareManager::getCameraSink(const std::string& nickname, const std::string& name) {
+    WFResult<std::shared_ptr<CameraSink>> HardwareManager::getCameraSink(const std::string& nickname, const std::string& name, FrameDropPolicy policy) {
         std::shared_lock lock(cameras_mtx);
         if (!cameraRegistered_impl_(nickname)) {
             logger()->warn("Camera '{}' is not registered",nickname);
             return WFResult<std::shared_ptr<CameraSink>>::failure(HARDWARE_BAD_CAMERA);
         }
-        if (auto res = getCamera_(nickname)->getCameraSink(name)) {
+        if (auto res = getCamera_(nickname)->getCameraSink(name,policy)) {
             return res;
         } else {
             logger()->error(res.what());
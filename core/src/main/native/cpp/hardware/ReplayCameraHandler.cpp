@@ -0,0 +1,130 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "wfcore/hardware/ReplayCameraHandler.h"
+#include "wfcore/common/wfexcept.h"
+#include <format>
+
+namespace wf {
+    using enum WFStatus;
+
+    ReplayCameraHandler::ReplayCameraHandler(const CameraConfiguration& config)
+    : name_(config.nickname)
+    , devpath_(config.devpath)
+    , configuredFormat_(config.format)
+    , calibrations_(config.calibrations) {
+        auto readerRes = openReplayReader(devpath_);
+        if (!readerRes) throw file_not_opened(readerRes.what());
+        reader_ = std::move(readerRes.value());
+
+        const auto recorded = reader_->getFormat();
+        const auto& requested = configuredFormat_.frameFormat;
+        if ((requested.width != 0 || requested.height != 0) && !(requested == recorded.frameFormat))
+            throw invalid_stream_format("Replay {} is configured with a format that doesn't match its recording",name_);
+
+        if (configuredFormat_.fps > 0) mode_ = ReplayMode::FixedRate;
+        else if (configuredFormat_.fps < 0) mode_ = ReplayMode::AsFastAsPossible;
+        else mode_ = ReplayMode::RealTime;
+        // Reported to workers as the rate frames actually arrive at, where that is known
+        const int fps = (mode_ == ReplayMode::FixedRate) ? configuredFormat_.fps : recorded.fps;
+        format_ = StreamFormat(fps,recorded.frameFormat);
+        supportedFormats_.push_back(format_);
+    }
+
+    WFResult<std::shared_ptr<CameraSink>> ReplayCameraHandler::getCameraSink(const std::string& name, FrameDropPolicy policy) {
+        if (!ok()) return WFResult<std::shared_ptr<CameraSink>>::failure(getStatus(),getError());
+        auto it = sinks_.find(name);
+        if (it != sinks_.end()) {
+            if (auto locked = it->second.lock()) {
+                // A subscriber's policy is fixed, so handing it to a caller that asked for another one would silently change its behavior
+                if (locked->getDropPolicy() != policy)
+                    return WFResult<std::shared_ptr<CameraSink>>::failure(BAD_ARGUMENT,"Sink {} of camera {} already exists with a different drop policy",name,name_);
+                return WFResult<std::shared_ptr<CameraSink>>::success(std::move(locked));
+            }
+            sinks_.erase(it);
+        }
+        if (!hub_) {
+            hub_ = CameraBroadcastHub::create(std::make_shared<ReplayCameraSink>(
+                shared_from_this(),
+                std::move(reader_),
+                mode_,
+                configuredFormat_.fps,
+                std::format("{}_replay",name_)
+            ));
+        }
+        auto provider = hub_->subscribe(name,policy);
+        sinks_.insert({name,std::weak_ptr<CameraSink>(provider)});
+        return WFResult<std::shared_ptr<CameraSink>>::success(std::move(provider));
+    }
+
+    WFStatusResult ReplayCameraHandler::setStreamFormat(const StreamFormat& format) {
+        if (format == format_ || format == configuredFormat_) return WFStatusResult::success();
+        return WFStatusResult::failure(HARDWARE_BAD_FORMAT,"Replay {} can only play its recording's format",name_);
+    }
+
+    std::optional<CameraIntrinsics> ReplayCameraHandler::getIntrinsics() {
+        cv::Size res(format_.frameFormat.width,format_.frameFormat.height);
+        for (const auto& calibration : calibrations_) {
+            if (calibration.resolution == res)
+                return calibration;
+        }
+        return std::nullopt;
+    }
+
+    WFStatusResult ReplayCameraHandler::setControl(CamControl control, int value) {
+        return WFStatusResult::failure(HARDWARE_BAD_CONTROL,"Replay {} has no camera controls",name_);
+    }
+
+    WFResult<int> ReplayCameraHandler::getControl(CamControl control) {
+        return WFResult<int>::failure(HARDWARE_BAD_CONTROL,"Replay {} has no camera controls",name_);
+    }
+
+    CameraConfiguration ReplayCameraHandler::getConfiguration() {
+        return CameraConfiguration(
+            name_,
+            devpath_,
+            CameraBackend::REPLAY,
+            configuredFormat_,
+            {},
+            calibrations_,
+            {}
+        );
+    }
+
+    WFStatusResult ReplayCameraHandler::setConfiguration(const CameraConfiguration& config) {
+        if (config.nickname != name_ || config.devpath != devpath_ || config.backend != CameraBackend::REPLAY
+            || config.format != configuredFormat_ || config.calibrations != calibrations_
+            || !config.controls.empty()) {
+            return WFStatusResult::failure(
+                CONFIG_INVALID_ATTRIBUTE,
+                "Attempted to set incompatible camera configuration for replay {}",name_
+            );
+        }
+        return WFStatusResult::success();
+    }
+
+    void ReplayCameraHandler::disable() {
+        this->reportError(HARDWARE_DISABLED);
+    }
+
+    void ReplayCameraHandler::enable() {
+        if (getStatus() != HARDWARE_DISABLED) return;
+        this->reportOk();
+    }
+}
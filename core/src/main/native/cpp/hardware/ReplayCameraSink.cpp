@@ -0,0 +1,179 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "wfcore/hardware/ReplayCameraSink.h"
+#include "wfcore/hardware/ReplayCameraHandler.h"
+#include "wfcore/common/logging.h"
+#include "wfcore/network/MasterTime.h"
+
+#include <wpi/timestamp.h>
+#include <algorithm>
+#include <format>
+#include <pthread.h>
+
+namespace wf {
+    using enum WFStatus;
+    static loggerPtr logger = LoggerManager::getInstance().getLogger("ReplayCameraSink");
+
+    ReplayCameraSink::ReplayCameraSink(
+        std::shared_ptr<ReplayCameraHandler> handler,
+        std::unique_ptr<ReplayReader> reader,
+        ReplayMode mode, int fps,
+        std::string name
+    ) : handler_(handler), handlerView_(handler.get()), reader_(std::move(reader)), mode_(mode)
+    , period_(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / std::max(fps,1))))
+    , name_(std::move(name)) {
+        if (reader_->isZeroCopy()) return;
+        // The pool covers every frame that can be queued, lent out, or in the middle of being decoded
+        pool_ = FramePool::create(reader_->getFormat().frameFormat, READ_AHEAD_FRAMES + LEND_SLOTS + 1);
+        decoded_ = std::make_unique<SPSCRing<DecodedFrame>>(READ_AHEAD_FRAMES);
+        readAheadThread_ = std::jthread([this](std::stop_token stoken){
+            this->readAhead(stoken);
+        });
+    }
+
+    ReplayCameraSink::~ReplayCameraSink() {
+        if (readAheadThread_.joinable()) {
+            readAheadThread_.request_stop();
+            readAheadThread_.join();
+        }
+    }
+
+    bool ReplayCameraSink::readNext(cv::Mat& frame, uint64_t& micros) {
+        if (reader_->next(frame,micros)) return true;
+        WF_DEBUGLOG(logger,"Replay {} reached the end of its recording, looping",name_);
+        reader_->rewind();
+        return reader_->next(frame,micros);
+    }
+
+    void ReplayCameraSink::readAhead(std::stop_token stoken) noexcept {
+        pthread_setname_np(pthread_self(), std::format("{}_read",name_).substr(0, 15).c_str());
+        while (!stoken.stop_requested()) {
+            try {
+                auto frame = pool_->acquire();
+                if (!frame) {
+                    // Every frame is queued or lent out, the consumer is behind
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    continue;
+                }
+                uint64_t micros;
+                if (!readNext(frame.mat(),micros)) {
+                    logger->error("Replay {} can't read any frames from its recording",name_);
+                    readerFailed_.store(true, std::memory_order_release);
+                    return;
+                }
+                decoded_->push(stoken,DecodedFrame{std::move(frame),micros});
+            } catch (const std::exception& e) {
+                logger->error("Replay {} failed to read a frame: {}",name_,e.what());
+                readerFailed_.store(true, std::memory_order_release);
+                return;
+            }
+        }
+    }
+
+    void ReplayCameraSink::pace(uint64_t micros) {
+        const auto now = Clock::now();
+        Clock::time_point due = now;
+        switch (mode_) {
+            case ReplayMode::RealTime:
+                // Timing restarts whenever the recording's clock goes backwards, which is what looping looks like
+                if (!started_ || micros < lastMicros_) {
+                    playbackStart_ = now;
+                    firstMicros_ = micros;
+                }
+                due = playbackStart_ + std::chrono::microseconds(micros - firstMicros_);
+                break;
+            case ReplayMode::FixedRate:
+                // A consumer that fell behind picks up from now, rather than getting a burst of frames to catch up
+                if (started_ && lastDue_ + period_ > now) due = lastDue_ + period_;
+                break;
+            case ReplayMode::AsFastAsPossible:
+                break;
+        }
+        started_ = true;
+        lastMicros_ = micros;
+        lastDue_ = due;
+        std::this_thread::sleep_until(due);
+    }
+
+    FrameMetadata ReplayCameraSink::getFrame(cv::Mat& data) noexcept {
+        cv::Mat view;
+        FrameLease lease;
+        auto meta = acquireFrame(view,lease);
+        if (meta) view.copyTo(data);
+        releaseFrame(lease);
+        return meta;
+    }
+
+    FrameMetadata ReplayCameraSink::acquireFrame(cv::Mat& data, FrameLease& lease) noexcept {
+        lease = NULL_LEASE;
+        if (!handlerView_->ok()) return FrameMetadata::badFrame(handlerView_->getStatus());
+        try {
+            uint64_t micros;
+            if (reader_->isZeroCopy()) {
+                // The mapping outlives every frame, so there is nothing to lease
+                if (!readNext(data,micros)) return FrameMetadata::badFrame(FILE_NOT_OPENED);
+            } else {
+                const int slot = slots_.findFree();
+                if (slot == NULL_LEASE) return FrameMetadata::badFrame(BAD_ACQUIRE);
+                auto decoded = decoded_->tryPop();
+                if (!decoded) {
+                    if (readerFailed_.load(std::memory_order_acquire))
+                        return FrameMetadata::badFrame(FILE_NOT_OPENED);
+                    // Decoding is behind. Waiting here is the same as waiting on a slow camera
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    return FrameMetadata::badFrame(BAD_ACQUIRE);
+                }
+                micros = decoded->micros;
+                data = decoded->frame.mat();
+                lent_[slot] = std::move(decoded->frame);
+                slots_.lend(slot);
+                lease = slot;
+            }
+            pace(micros);
+            const auto format = reader_->getFormat().frameFormat;
+            return FrameMetadata(wpi::Now(), getMasterTime(), format);
+        } catch (...) {
+            releaseFrame(lease);
+            lease = NULL_LEASE;
+            return FrameMetadata::badFrame(UNKNOWN);
+        }
+    }
+
+    void ReplayCameraSink::releaseFrame(FrameLease lease) noexcept {
+        if (!LendSlots<LEND_SLOTS>::isValid(lease)) return;
+        // Only the consumer thread ever fills a slot, and it only reuses slots that have been released
+        lent_[lease].reset();
+        slots_.release(lease);
+    }
+
+    WFResult<std::string> ReplayCameraSink::getCameraNickname() const {
+        auto locked = handler_.lock();
+        return locked
+            ? WFResult<std::string>::success(locked->getNickname())
+            : WFResult<std::string>::failure(BAD_ACQUIRE);
+    }
+
+    WFResult<StreamFormat> ReplayCameraSink::getStreamFormat() const noexcept {
+        auto locked = handler_.lock();
+        return locked
+            ? WFResult<StreamFormat>::success(locked->getStreamFormat())
+            : WFResult<StreamFormat>::failure(BAD_ACQUIRE);
+    }
+}
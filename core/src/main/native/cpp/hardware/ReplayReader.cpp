@@ -0,0 +1,305 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "wfcore/hardware/ReplayReader.h"
+#include "wfcore/video/video_utils.h"
+#include "wfcore/common/logging.h"
+#include "wfcore/common/wfexcept.h"
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/videoio.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace impl {
+    using namespace wf;
+    namespace fs = std::filesystem;
+    using enum WFStatus;
+
+    static loggerPtr logger = LoggerManager::getInstance().getLogger("ReplayReader");
+
+    static ImageEncoding getEncodingFromCVType(int type) {
+        switch (type) {
+            case CV_8UC1: return ImageEncoding::Y8;
+            case CV_8UC3: return ImageEncoding::BGR24;
+            case CV_8UC4: return ImageEncoding::BGRA;
+            case CV_16UC1: return ImageEncoding::Y16;
+            default: return ImageEncoding::UNKNOWN;
+        }
+    }
+
+    // Falls back to this rate when a recording carries no timing information at all
+    static constexpr double DEFAULT_FPS = 30.0;
+
+    class RawDumpReader : public ReplayReader {
+    public:
+        ~RawDumpReader() override {
+            if (base_ != MAP_FAILED) ::munmap(base_, size_);
+        }
+
+        static WFResult<std::unique_ptr<ReplayReader>> open(const std::string& path) {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+                return WFResult<std::unique_ptr<ReplayReader>>::failure(FILE_NOT_OPENED,"Failed to open raw dump {}",path);
+            struct stat st;
+            if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(RawDumpHeader)) {
+                ::close(fd);
+                return WFResult<std::unique_ptr<ReplayReader>>::failure(FILE_NOT_OPENED,"Raw dump {} is truncated",path);
+            }
+            std::unique_ptr<RawDumpReader> reader(new RawDumpReader());
+            reader->size_ = static_cast<size_t>(st.st_size);
+            // A private writable mapping means a consumer that scribbles on a frame only dirties its own copy of the page
+            reader->base_ = ::mmap(nullptr, reader->size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (reader->base_ == MAP_FAILED)
+                return WFResult<std::unique_ptr<ReplayReader>>::failure(FILE_NOT_OPENED,"Failed to map raw dump {}",path);
+            ::madvise(reader->base_, reader->size_, MADV_SEQUENTIAL);
+
+            RawDumpHeader header;
+            std::memcpy(&header, reader->base_, sizeof(header));
+            const auto encoding = static_cast<ImageEncoding>(header.encoding);
+            const int cvType = getCVTypeFromEncoding(encoding);
+            if (std::memcmp(header.magic, RawDumpHeader::MAGIC, sizeof(header.magic)) != 0
+                || cvType == 0 || header.width == 0 || header.height == 0
+                || header.stride < header.width * CV_ELEM_SIZE(cvType))
+                return WFResult<std::unique_ptr<ReplayReader>>::failure(FILE_NOT_OPENED,"{} is not a valid raw dump",path);
+
+            reader->format_ = StreamFormat(0,FrameFormat(encoding,static_cast<int>(header.width),static_cast<int>(header.height)));
+            reader->cvType_ = cvType;
+            reader->stride_ = header.stride;
+            reader->recordSize_ = sizeof(uint64_t) + static_cast<size_t>(header.stride) * header.height;
+            reader->frameCount_ = (reader->size_ - sizeof(RawDumpHeader)) / reader->recordSize_;
+            if (reader->frameCount_ == 0)
+                return WFResult<std::unique_ptr<ReplayReader>>::failure(FILE_NOT_OPENED,"Raw dump {} has no frames",path);
+            return std::unique_ptr<ReplayReader>(std::move(reader));
+        }
+
+        bool next(cv::Mat& frame, uint64_t& micros) override {
+            if (index_ >= frameCount_) return false;
+            auto* record = static_cast<uint8_t*>(base_) + sizeof(RawDumpHeader) + index_ * recordSize_;
+            std::memcpy(&micros, record, sizeof(micros));
+            frame = cv::Mat(format_.frameFormat.height, format_.frameFormat.width, cvType_, record + sizeof(uint64_t), stride_);
+            // Ask the kernel to start paging in what comes next, so consumers never stall on a page fault
+            const size_t ahead = std::min(READ_AHEAD, frameCount_ - index_ - 1);
+            if (ahead > 0) {
+                auto* nextRecord = record + recordSize_;
+                auto pageStart = reinterpret_cast<uintptr_t>(nextRecord) & ~static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE) - 1);
+                ::madvise(reinterpret_cast<void*>(pageStart), ahead * recordSize_ + (reinterpret_cast<uintptr_t>(nextRecord) - pageStart), MADV_WILLNEED);
+            }
+            ++index_;
+            return true;
+        }
+
+        void rewind() override { index_ = 0; }
+        StreamFormat getFormat() const noexcept override { return format_; }
+        bool isZeroCopy() const noexcept override { return true; }
+    private:
+        static constexpr size_t READ_AHEAD = 4; // Frames
+        RawDumpReader() = default;
+        void* base_ = MAP_FAILED;
+        size_t size_ = 0;
+        StreamFormat format_;
+        int cvType_ = 0;
+        size_t stride_ = 0;
+        size_t recordSize_ = 0;
+        size_t frameCount_ = 0;
+        size_t index_ = 0;
+    };
+
+    class ImageSequenceReader : public ReplayReader {
+    public:
+        static WFResult<std::unique_ptr<ReplayReader>> open(const std::string& path) {
+            std::unique_ptr<ImageSequenceReader> reader(new ImageSequenceReader());
+            std::error_code ec;
+            for (const auto& entry : fs::directory_iterator(path, ec)) {
+                if (!entry.is_regular_file()) continue;
+                auto ext = entry.path().extension().string();
+                std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c){ return std::tolower(c); });
+                if (ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".bmp"
+                    || ext == ".pgm" || ext == ".ppm" || ext == ".tif" || ext == ".tiff")
+                    reader->files_.push_back(entry.path());
+            }
+            if (ec || reader->files_.empty())
+                return WFResult<std::unique_ptr<ReplayReader>>::failure(FILE_NOT_FOUND,"No images found in {}",path);
+            std::sort(reader->files_.begin(), reader->files_.end());
+
+            if (std::ifstream timestamps(fs::path(path) / "timestamps.txt"); timestamps) {
+                uint64_t micros;
+                while (timestamps >> micros)
+                    reader->timestamps_.push_back(micros);
+                if (reader->timestamps_.size() != reader->files_.size()) {
+                    logger->warn("{}/timestamps.txt has {} entries for {} images, ignoring it",path,reader->timestamps_.size(),reader->files_.size());
+                    reader->timestamps_.clear();
+                }
+            }
+
+            // The first image decides the format of the whole sequence
+            cv::Mat first = cv::imread(reader->files_.front().string(), cv::IMREAD_UNCHANGED);
+            const auto encoding = getEncodingFromCVType(first.empty() ? -1 : first.type());
+            if (encoding == ImageEncoding::UNKNOWN)
+                return WFResult<std::unique_ptr<ReplayReader>>::failure(FILE_NOT_OPENED,"Unsupported image {}",reader->files_.front().string());
+            int fps = 0;
+            if (reader->timestamps_.size() > 1) {
+                const double span = static_cast<double>(reader->timestamps_.back() - reader->timestamps_.front());
+                if (span > 0) fps = static_cast<int>(std::lround((reader->timestamps_.size() - 1) * 1e6 / span));
+            }
+            reader->format_ = StreamFormat(fps,FrameFormat(encoding,first.cols,first.rows));
+            return std::unique_ptr<ReplayReader>(std::move(reader));
+        }
+
+        bool next(cv::Mat& frame, uint64_t& micros) override {
+            while (index_ < files_.size()) {
+                const size_t index = index_++;
+                std::ifstream file(files_[index], std::ios::binary | std::ios::ate);
+                if (!file) {
+                    logger->warn("Skipping unreadable image {}",files_[index].string());
+                    continue;
+                }
+                // The encoded bytes and the decoded frame both reuse their buffers from the previous image
+                encoded_.resize(static_cast<size_t>(file.tellg()));
+                file.seekg(0);
+                file.read(reinterpret_cast<char*>(encoded_.data()), static_cast<std::streamsize>(encoded_.size()));
+                cv::imdecode(encoded_, cv::IMREAD_UNCHANGED, &frame);
+                if (frame.empty() || frame.cols != format_.frameFormat.width || frame.rows != format_.frameFormat.height
+                    || frame.type() != getCVTypeFromEncoding(format_.frameFormat.encoding)) {
+                    logger->warn("Skipping image {}, which doesn't match the format of the sequence",files_[index].string());
+                    continue;
+                }
+                micros = timestamps_.empty()
+                    ? static_cast<uint64_t>(index * 1e6 / DEFAULT_FPS)
+                    : timestamps_[index];
+                return true;
+            }
+            return false;
+        }
+
+        void rewind() override { index_ = 0; }
+        StreamFormat getFormat() const noexcept override { return format_; }
+    private:
+        ImageSequenceReader() = default;
+        std::vector<fs::path> files_;
+        std::vector<uint64_t> timestamps_;
+        std::vector<uchar> encoded_;
+        StreamFormat format_;
+        size_t index_ = 0;
+    };
+
+    class VideoReader : public ReplayReader {
+    public:
+        static WFResult<std::unique_ptr<ReplayReader>> open(const std::string& path) {
+            std::unique_ptr<VideoReader> reader(new VideoReader());
+            reader->path_ = path;
+            if (!reader->capture_.open(path))
+                return WFResult<std::unique_ptr<ReplayReader>>::failure(FILE_NOT_OPENED,"Failed to open video {}",path);
+            reader->fps_ = reader->capture_.get(cv::CAP_PROP_FPS);
+            reader->format_ = StreamFormat(
+                static_cast<int>(std::lround(reader->fps_)),
+                FrameFormat(
+                    ImageEncoding::BGR24,
+                    static_cast<int>(reader->capture_.get(cv::CAP_PROP_FRAME_WIDTH)),
+                    static_cast<int>(reader->capture_.get(cv::CAP_PROP_FRAME_HEIGHT))
+                )
+            );
+            if (reader->format_.frameFormat.width <= 0 || reader->format_.frameFormat.height <= 0)
+                return WFResult<std::unique_ptr<ReplayReader>>::failure(FILE_NOT_OPENED,"Video {} has no usable frame size",path);
+            return std::unique_ptr<ReplayReader>(std::move(reader));
+        }
+
+        bool next(cv::Mat& frame, uint64_t& micros) override {
+            if (!capture_.read(frame)) return false;
+            // Not every backend reports positions, in which case the nominal frame rate stands in
+            const double posMs = capture_.get(cv::CAP_PROP_POS_MSEC);
+            micros = (posMs > 0 || index_ == 0)
+                ? static_cast<uint64_t>(posMs * 1000.0)
+                : static_cast<uint64_t>(index_ * 1e6 / (fps_ > 0 ? fps_ : DEFAULT_FPS));
+            ++index_;
+            return true;
+        }
+
+        void rewind() override {
+            // Seeking is unreliable on some containers, reopening always lands on the first frame
+            if (!capture_.set(cv::CAP_PROP_POS_FRAMES, 0))
+                capture_.open(path_);
+            index_ = 0;
+        }
+
+        StreamFormat getFormat() const noexcept override { return format_; }
+    private:
+        VideoReader() = default;
+        std::string path_;
+        cv::VideoCapture capture_;
+        double fps_ = 0;
+        StreamFormat format_;
+        size_t index_ = 0;
+    };
+}
+
+namespace wf {
+    using enum WFStatus;
+
+    WFResult<std::unique_ptr<ReplayReader>> openReplayReader(const std::string& path) {
+        std::error_code ec;
+        if (!std::filesystem::exists(path, ec))
+            return WFResult<std::unique_ptr<ReplayReader>>::failure(FILE_NOT_FOUND,"Recording {} not found",path);
+        if (std::filesystem::is_directory(path, ec))
+            return impl::ImageSequenceReader::open(path);
+        if (std::filesystem::path(path).extension() == ".wfraw")
+            return impl::RawDumpReader::open(path);
+        return impl::VideoReader::open(path);
+    }
+
+    RawDumpWriter::RawDumpWriter(const std::string& path, FrameFormat format)
+    : file_(path, std::ios::binary | std::ios::trunc), format_(format) {
+        const int cvType = getCVTypeFromEncoding(format_.encoding);
+        if (cvType == 0 || format_.width <= 0 || format_.height <= 0)
+            throw invalid_stream_format("Raw dumps need a raw encoding and a nonzero size");
+        if (!file_)
+            throw file_not_opened("Failed to open raw dump {} for writing",path);
+        rowBytes_ = static_cast<size_t>(format_.width) * CV_ELEM_SIZE(cvType);
+        RawDumpHeader header;
+        std::memcpy(header.magic, RawDumpHeader::MAGIC, sizeof(header.magic));
+        header.encoding = static_cast<uint32_t>(format_.encoding);
+        header.width = static_cast<uint32_t>(format_.width);
+        header.height = static_cast<uint32_t>(format_.height);
+        header.stride = static_cast<uint32_t>(rowBytes_);
+        file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    WFStatusResult RawDumpWriter::write(const cv::Mat& frame, uint64_t micros) {
+        if (frame.cols != format_.width || frame.rows != format_.height || frame.type() != getCVTypeFromEncoding(format_.encoding))
+            return WFStatusResult::failure(PIPELINE_BAD_FRAME,"Frame doesn't match the format of the raw dump");
+        file_.write(reinterpret_cast<const char*>(&micros), sizeof(micros));
+        // Rows are written one at a time, so frames with padded strides are packed tightly
+        for (int row = 0; row < frame.rows; ++row)
+            file_.write(reinterpret_cast<const char*>(frame.ptr(row)), static_cast<std::streamsize>(rowBytes_));
+        if (!file_)
+            return WFStatusResult::failure(FILE_NOT_OPENED,"Failed to write to raw dump");
+        return WFStatusResult::success();
+    }
+}
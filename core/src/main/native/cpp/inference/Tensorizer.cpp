@@ -19,6 +19,7 @@
 
 
 #include "wfcore/inference/Tensorizer.h"
+#include "wfcore/simd/simd.h"
 
 #include <cassert>
 #include <cstring>
@@ -33,9 +34,44 @@ namespace wf {
         for (int i = 0; i < params.channels; ++i) {
             channels.emplace_back(params.height, params.width, CV_32FC1);
         }
+        for (int c = 0; c < 4; ++c) {
+            channelScales[c] = static_cast<float>(this->params.scale / this->params.stds[c]);
+            channelBiases[c] = static_cast<float>(-this->params.means[c]);
+        }
+        planeRow.resize(static_cast<size_t>(this->params.width) * this->params.channels);
     }
 
     void Tensorizer::tensorize(const cv::Mat& input, float* output) const noexcept {
+        if (input.depth() != CV_8U || params.channels < 1 || params.channels > 4 || (!params.interleaved && params.channels == 2)) {
+            tensorizeWithOpenCV(input, output);
+            return;
+        }
+        const auto& kernels = simd::kernels();
+        const size_t width = params.width;
+        const size_t planeSize = width * params.height;
+        if (params.interleaved || params.channels == 1) {
+            for (int h = 0; h < params.height; ++h) {
+                float* dstrow = output + h * width * params.channels;
+                kernels.normalize(input.ptr<uint8_t>(h), dstrow, width * params.channels, params.channels, channelScales.data(), channelBiases.data());
+            }
+            return;
+        }
+        uint8_t* planes[4];
+        for (int c = 0; c < params.channels; ++c)
+            planes[c] = planeRow.data() + c * width;
+        for (int h = 0; h < params.height; ++h) {
+            if (params.channels == 3)
+                kernels.deinterleave3(input.ptr<uint8_t>(h), planes, width);
+            else
+                kernels.deinterleave4(input.ptr<uint8_t>(h), planes, width);
+            for (int c = 0; c < params.channels; ++c) {
+                float* dstrow = output + c * planeSize + h * width;
+                kernels.normalize(planes[c], dstrow, width, 1, &channelScales[c], &channelBiases[c]);
+            }
+        }
+    }
+
+    void Tensorizer::tensorizeWithOpenCV(const cv::Mat& input, float* output) const noexcept {
         input.convertTo(temp, CV_32F, params.scale);
         cv::divide(temp, params.stds, temp);
         cv::subtract(temp, params.means, temp);
@@ -34,4 +34,22 @@ namespace wf {
         pipelineResultPub.Set(std::span<const uint8_t>(bin->base,bin->offset));
         wips_blob_destroy(bin);
     }
+
+    void NTDataPublisher::publishStageLatencies(const std::vector<StageLatency>& stages) {
+        for (const auto& [stage,histogram] : stages) {
+            auto it = latencyPubs.find(stage);
+            if (it == latencyPubs.end()) {
+                it = latencyPubs.emplace(
+                    stage,
+                    table->GetSubTable("latency")->GetDoubleArrayTopic(stage).Publish()
+                ).first;
+            }
+            const double summary[3] = {
+                histogram->percentile(50.0) / 1000.0,
+                histogram->percentile(99.0) / 1000.0,
+                histogram->max() / 1000.0
+            };
+            it->second.Set(summary);
+        }
+    }
 }
\ No newline at end of file
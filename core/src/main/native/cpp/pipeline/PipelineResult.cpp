@@ -0,0 +1,62 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "wfcore/pipeline/PipelineResult.h"
+
+#include <gtsam/geometry/Rot3.h>
+
+#include <algorithm>
+#include <numbers>
+
+namespace wf {
+
+    void mapResultToView(PipelineResult& result, const ViewTransform& view) {
+        if (view.isIdentity()) return;
+        for (auto& detection : result.aprilTagDetections) {
+            for (auto& corner : detection.corners)
+                corner = view.apply(corner);
+        }
+        for (auto& detection : result.objectDetections) {
+            // A turned box has its corners swapped around, so the box is rebuilt from both of them
+            const cv::Point2d a = view.apply(detection.bboxTopLeftPixels);
+            const cv::Point2d b = view.apply(detection.bboxBottomRightPixels);
+            detection.bboxTopLeftPixels = cv::Point2d(std::min(a.x,b.x),std::min(a.y,b.y));
+            detection.bboxBottomRightPixels = cv::Point2d(std::max(a.x,b.x),std::max(a.y,b.y));
+            const cv::Point2d an = view.applyNormalized(detection.bboxTopLeftNorm);
+            const cv::Point2d bn = view.applyNormalized(detection.bboxBottomRightNorm);
+            detection.bboxTopLeftNorm = cv::Point2d(std::min(an.x,bn.x),std::min(an.y,bn.y));
+            detection.bboxBottomRightNorm = cv::Point2d(std::max(an.x,bn.x),std::max(an.y,bn.y));
+        }
+
+        if (view.getQuarterTurns() == 0) return;
+        // Turning the image clockwise turns the camera about its optical axis, which is +x in WPILib coordinates.
+        // A point's coordinates in the turned camera are its coordinates in the original one turned by cameraTurn
+        const gtsam::Pose3 cameraTurn(gtsam::Rot3::Rx(view.getQuarterTurns() * std::numbers::pi / 2),gtsam::Point3(0,0,0));
+        const gtsam::Pose3 cameraTurnInverse = cameraTurn.inverse();
+        for (auto& pose : result.aprilTagPoses) {
+            pose.camPose0 = cameraTurn.compose(pose.camPose0);
+            pose.camPose1 = cameraTurn.compose(pose.camPose1);
+        }
+        if (result.cameraPose) {
+            result.cameraPose->fieldPose0 = result.cameraPose->fieldPose0.compose(cameraTurnInverse);
+            if (result.cameraPose->fieldPose1)
+                result.cameraPose->fieldPose1 = result.cameraPose->fieldPose1->compose(cameraTurnInverse);
+        }
+    }
+}
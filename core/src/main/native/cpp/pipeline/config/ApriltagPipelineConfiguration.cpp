@@ -61,6 +61,13 @@ namespace wf {
         auto tagField = getJSONOpt<std::string>(jobject,"tagField",WFDefaults::getTagField());
         auto tagFamily = getJSONOpt<std::string>(jobject,"tagFamily",WFDefaults::getTagFamily());
         auto tagSize = getJSONOpt<double>(jobject,"tagSize",WFDefaults::getTagSize());
+        auto adaptiveDecimate = getJSONOpt<bool>(jobject,"adaptiveDecimate",false);
+        auto maxQuadDecimate = getJSONOpt<float>(jobject,"maxQuadDecimate",3.0f);
+        auto decimateProbeInterval = getJSONOpt<int>(jobject,"decimateProbeInterval",30);
+        auto trackTags = getJSONOpt<bool>(jobject,"trackTags",false);
+        auto trackRefreshInterval = getJSONOpt<int>(jobject,"trackRefreshInterval",10);
+        auto trackPadding = getJSONOpt<double>(jobject,"trackPadding",0.5);
+        auto trackVelocity = getJSONOpt<bool>(jobject,"trackVelocity",true);
         return WFResult<ApriltagPipelineConfiguration>::success(
             std::in_place,
             solvePnP,
@@ -71,7 +78,14 @@ namespace wf {
             tagSize,
             detectorExcludes,
             solvePnPExcludes,
-            solveTagRelative
+            solveTagRelative,
+            adaptiveDecimate,
+            maxQuadDecimate,
+            decimateProbeInterval,
+            trackTags,
+            trackRefreshInterval,
+            trackPadding,
+            trackVelocity
         );
     }
     WFResult<JSON> ApriltagPipelineConfiguration::toJSON_impl(const ApriltagPipelineConfiguration& object) {
@@ -98,7 +112,14 @@ namespace wf {
                 {"tagSize", object.apriltagSize},
                 {"detectorExcludes", object.detectorExcludes},
                 {"solvePnPExcludes", object.SolvePNPExcludes},
-                {"solveTagRelative", object.solveTagRelative}
+                {"solveTagRelative", object.solveTagRelative},
+                {"adaptiveDecimate", object.adaptiveDecimate},
+                {"maxQuadDecimate", object.maxQuadDecimate},
+                {"decimateProbeInterval", object.decimateProbeInterval},
+                {"trackTags", object.trackTags},
+                {"trackRefreshInterval", object.trackRefreshInterval},
+                {"trackPadding", object.trackPadding},
+                {"trackVelocity", object.trackVelocity}
             };
             return WFResult<JSON>::success(std::move(jobject));
         } catch (const JSON::exception& e) {
@@ -28,7 +28,7 @@
 namespace wf {
     ApriltagPipelineConsumer::ApriltagPipelineConsumer(
         std::string pipelineName_, std::string camLabel_, 
-        CameraIntrinsics intrinsics_, FrameFormat inputFormat_,
+        CameraIntrinsics intrinsics_, FrameFormat inputFormat_, ViewTransform view_,
         int rawPort, int processedPort, 
         StreamFormat streamFormat, double tagSize_,
         std::weak_ptr<NTDataPublisher> ntpub_
@@ -44,12 +44,23 @@ namespace wf {
             throw invalid_image_encoding("As of now, output pixel format for OpenCV stream MUST be BGR24");
         }
         std::vector<std::unique_ptr<CVProcessNode<cv::Mat>>> nodes;
-        if (streamFormat.frameFormat.width != inputFormat.width || streamFormat.frameFormat.height != inputFormat.height) {
+        // Scale before turning, the stream is usually the smaller of the two
+        const int turns = view_.getQuarterTurns();
+        const int scaledWidth = (turns % 2) ? streamFormat.frameFormat.height : streamFormat.frameFormat.width;
+        const int scaledHeight = (turns % 2) ? streamFormat.frameFormat.width : streamFormat.frameFormat.height;
+        if (scaledWidth != inputFormat.width || scaledHeight != inputFormat.height) {
             nodes.emplace_back(
                 std::make_unique<ResizeNode<cv::Mat>>(
                     cv::INTER_LINEAR,
-                    streamFormat.frameFormat.width,
-                    streamFormat.frameFormat.height
+                    scaledWidth,
+                    scaledHeight
+                )
+            );
+        }
+        if (turns != 0) {
+            nodes.emplace_back(
+                std::make_unique<RotateNode<cv::Mat>>(
+                    turns == 1 ? cv::ROTATE_90_CLOCKWISE : turns == 2 ? cv::ROTATE_180 : cv::ROTATE_90_COUNTERCLOCKWISE
                 )
             );
         }
@@ -27,98 +27,167 @@
 #include <cassert>
 #include "wfcore/common/wfexcept.h"
 #include <type_traits>
+#include <chrono>
 
 
 namespace wf {
 
     static loggerPtr logger = LoggerManager::getInstance().getLogger("ApriltagPipeline");
 
+    // Detects in each region separately and moves the corners back into full frame coordinates
+    static WFStatusResult detectInRegions(
+        ApriltagDetector& detector,
+        const cv::Mat& data,
+        const std::vector<cv::Rect>& regions,
+        float quadDecimate,
+        std::vector<ApriltagDetection>& out
+    ) noexcept {
+        for (const auto& region : regions) {
+            const size_t first = out.size();
+            auto res = detector.detect(data(region),quadDecimate,out);
+            if (!res) return res;
+            for (size_t i = first; i < out.size(); ++i) {
+                for (auto& corner : out[i].corners) {
+                    corner.x += region.x;
+                    corner.y += region.y;
+                }
+            }
+        }
+        return WFStatusResult::success();
+    }
+
     ApriltagPipeline::ApriltagPipeline(ApriltagPipelineConfiguration config_, CameraIntrinsics intrinsics_, ApriltagFieldHandler fieldHandler_)
-    : config(std::move(config_)), intrinsics(std::move(intrinsics_)), tagConfig(config.apriltagFamily,config.apriltagSize), fieldHandler(std::move(fieldHandler_)) {
-        auto fres = updateFieldHandler();
-        if (!fres) throw wf_result_error(fres);
-        
-        auto dres = updateDetectorConfig();
-        if (!dres) throw wf_result_error(dres);
+    : intrinsics(std::move(intrinsics_)) {
+        auto sres = buildState(std::move(config_),fieldHandler_);
+        if (!sres) throw wf_result_error(sres);
+        state.store(std::move(sres.value()), std::memory_order_release);
+    }
+
+    WFResult<std::shared_ptr<const ApriltagPipeline::DetectionState>> ApriltagPipeline::buildState(
+        ApriltagPipelineConfiguration config,
+        const ApriltagFieldHandler& fieldHandler
+    ) {
+        auto newState = std::make_shared<DetectionState>(std::move(config),fieldHandler);
+        // Fields are only reloaded when they change, loading one means parsing it from disk
+        if (newState->fieldHandler.getFieldName() != newState->config.apriltagField) {
+            auto fres = newState->fieldHandler.loadField(newState->config.apriltagField);
+            if (!fres) return WFResult<std::shared_ptr<const DetectionState>>::propagateFail(fres);
+        }
+        auto dres = newState->detector.addFamily(newState->tagConfig.tagFamily);
+        if (!dres) return WFResult<std::shared_ptr<const DetectionState>>::propagateFail(dres);
+        newState->detector.setQuadThresholdParams(newState->config.detQTPs);
+        newState->detector.setConfig(newState->config.detConfig);
+        if (newState->config.adaptiveDecimate) {
+            DecimationController::Params params;
+            params.initialDecimate = newState->config.detConfig.quadDecimate;
+            params.maxDecimate = std::max(newState->config.maxQuadDecimate,params.initialDecimate);
+            params.probeInterval = newState->config.decimateProbeInterval;
+            newState->decimation.emplace(params);
+        }
+        if (newState->config.trackTags) {
+            TagTracker::Params params;
+            params.refreshInterval = newState->config.trackRefreshInterval;
+            params.padding = newState->config.trackPadding;
+            params.useVelocity = newState->config.trackVelocity;
+            newState->tracker.emplace(params);
+        }
+        return std::shared_ptr<const DetectionState>(std::move(newState));
     }
 
     WFStatusResult ApriltagPipeline::setConfig(PipelineConfigVariant config) {
         if (getConfigType(config) != PipelineType::Apriltag)
             return WFStatusResult::failure(WFStatus::PIPELINE_BAD_CONFIG);
-        this->config = std::get<ApriltagPipelineConfiguration>(config);
-        return updateDetectorConfig();
+        auto current = state.load(std::memory_order_acquire);
+        auto sres = buildState(std::get<ApriltagPipelineConfiguration>(config),current->fieldHandler);
+        if (!sres) return WFStatusResult::propagateFail(sres);
+        state.store(std::move(sres.value()), std::memory_order_release);
+        return WFStatusResult::success();
+    }
+
+    void ApriltagPipeline::inheritAdaptiveState(const DetectionState& from, const DetectionState& to) noexcept {
+        // What was detected under other detector settings says nothing about what the new ones will find
+        if (from.tagConfig.tagFamily != to.tagConfig.tagFamily
+            || from.config.detConfig != to.config.detConfig
+            || from.config.detQTPs != to.config.detQTPs)
+            return;
+        if (from.decimation && to.decimation && from.decimation->getParams() == to.decimation->getParams())
+            to.decimation = from.decimation;
+        if (from.tracker && to.tracker && from.tracker->getParams() == to.tracker->getParams())
+            to.tracker = from.tracker;
     }
     
     void ApriltagPipeline::setIntrinsics(const CameraIntrinsics& intrinsics) {
         this->intrinsics = intrinsics;
     }
 
-    WFStatusResult ApriltagPipeline::updateFieldHandler() {
-        if (fieldHandler.getFieldName() == config.apriltagField) 
-            return WFStatusResult::success();
-
-        return fieldHandler.loadField(config.apriltagField);
-    }
-
-    // TODO: Refactor this???
-    WFStatusResult ApriltagPipeline::updateDetectorConfig() {     
-        detector.clearFamilies();
-
-        auto res = detector.addFamily(tagConfig.tagFamily);
-        if (!res) return res;
-
-        detector.setQuadThresholdParams(config.detQTPs);
-        detector.setConfig(config.detConfig);
-        return WFStatusResult::success();
-    }
-
-    WFResult<PipelineResult> ApriltagPipeline::process(const cv::Mat& data, const FrameMetadata& meta) noexcept {
+    WFStatusResult ApriltagPipeline::process(const cv::Mat& data, const FrameMetadata& meta, PipelineResult& result) noexcept {
         WF_FatalAssert(data.type() == CV_8UC1);
-        auto detectres = detector.detect(data);
+        // Holding the state for the whole frame means a concurrent setConfig only takes effect on the next one
+        if (auto published = state.load(std::memory_order_acquire); published != frameState) {
+            if (frameState) inheritAdaptiveState(*frameState,*published);
+            frameState = std::move(published);
+        }
+        const auto& config = frameState->config;
+        const auto& tagConfig = frameState->tagConfig;
+        result.reset(meta.micros,meta.server_time_us,PipelineType::Apriltag);
+        auto& detections = result.aprilTagDetections;
+        auto detectStart = std::chrono::steady_clock::now();
+        auto& decimation = frameState->decimation;
+        auto& tracker = frameState->tracker;
+        const float quadDecimate = decimation ? decimation->next() : config.detConfig.quadDecimate;
+        // Full resolution probes are there to find tags nothing is tracking yet, so they always search the whole frame
+        const bool tracked = tracker && tracker->plan(data.size(),decimation && decimation->isProbing());
+        auto detectres = tracked
+            ? detectInRegions(frameState->detector,data,tracker->getRegions(),quadDecimate,detections)
+            : frameState->detector.detect(data,quadDecimate,detections);
+        detectLatency.record(std::chrono::steady_clock::now() - detectStart);
         if (!detectres)
-            return WFResult<PipelineResult>::propagateFail(detectres);
+            return detectres;
         
-        auto detections = std::move(detectres.value());
-        std::erase_if(detections, [this](ApriltagDetection detection) {
-            return this->config.detectorExcludes.contains(detection.id);
+        std::erase_if(detections, [&config](const ApriltagDetection& detection) {
+            return config.detectorExcludes.contains(detection.id);
         });
-        if (!config.solvePnP) {
-            return PipelineResult::ApriltagResult(
-                meta.micros,
-                meta.server_time_us,
-                std::move(detections),
-                {},
-                {}
-            );
+        if (decimation) {
+            const float previous = decimation->getDecimate();
+            decimation->observe(detections);
+            if (decimation->getDecimate() != previous)
+                WF_DEBUGLOG(logger,"Quad decimation changed from {} to {}",previous,decimation->getDecimate());
         }
+        if (tracker) tracker->observe(detections);
+        if (!config.solvePnP)
+            return WFStatusResult::success();
 
-        std::vector<ApriltagRelativePoseObservation> atagPoses;
         if (config.solveTagRelative) {
-            for (auto detection : detections) {
+            ScopedLatencyTimer timer(tagPnPLatency);
+            for (const auto& detection : detections) {
                 auto atagPose = solvePNPApriltagRelative(
                     detection,
                     tagConfig,
                     intrinsics
                 );
                 if (atagPose.has_value()) {
-                    atagPoses.push_back(atagPose.value());
+                    result.aprilTagPoses.push_back(atagPose.value());
                 }
             }
         }
-        auto fieldPose = solvePNPApriltag(
+        auto fieldPnPStart = std::chrono::steady_clock::now();
+        result.cameraPose = solvePNPApriltag(
             detections,
             tagConfig,
-            fieldHandler.getField(),
+            frameState->fieldHandler.getField(),
             intrinsics,
             config.SolvePNPExcludes
         );
-        return PipelineResult::ApriltagResult(
-            meta.micros,
-            meta.server_time_us,
-            std::move(detections),
-            std::move(atagPoses),
-            std::move(fieldPose)
-        );
+        fieldPnPLatency.record(std::chrono::steady_clock::now() - fieldPnPStart);
+        return WFStatusResult::success();
+    }
+
+    std::vector<StageLatency> ApriltagPipeline::getStageLatencies() const {
+        return {
+            {"detect",&detectLatency},
+            {"tag_pnp",&tagPnPLatency},
+            {"field_pnp",&fieldPnPLatency}
+        };
     }
 
 }
@@ -31,13 +31,14 @@ namespace wf {
     : config(std::move(config_)), modelColorSpace(modelColorSpace_), engine(std::move(engine_)), intrinsics(std::move(intrinsics_)) {
         updatePostprocParams();
     }
-    WFResult<PipelineResult> ObjectDetectionPipeline::process(const cv::Mat& data, const FrameMetadata& meta) noexcept {
+    WFStatusResult ObjectDetectionPipeline::process(const cv::Mat& data, const FrameMetadata& meta, PipelineResult& result) noexcept {
         WF_FatalAssert(data.rows == engine->getTensorParameters().height && data.cols == engine->getTensorParameters().width);
         auto infres = engine->infer(data,meta,bbox_buffer);
         if (!infres)
-            return WFResult<PipelineResult>::propagateFail(infres);
+            return WFStatusResult::propagateFail(infres);
         
-        std::vector<ObjectDetection> detections;
+        result.reset(meta.micros,meta.server_time_us,PipelineType::ObjDetect);
+        auto& detections = result.objectDetections;
         detections.reserve(bbox_buffer.size());
         pixelCorner_buffer.clear();
         normCorner_buffer.clear();
@@ -62,13 +63,25 @@ namespace wf {
             scale
         );
 
-        // Normalization
-        cv::undistortPoints(
-            resizedPixelCorner_buffer,
-            normCorner_buffer,
-            intrinsics.cameraMatrix,
-            intrinsics.distCoeffs
-        );
+        // Normalization. Rectified frames only need the pinhole model inverted, which skips cv::undistortPoints' iterative solve
+        if (intrinsics.isDistortionFree()) {
+            const double fx = intrinsics.cameraMatrix.at<double>(0,0);
+            const double skew = intrinsics.cameraMatrix.at<double>(0,1);
+            const double cx = intrinsics.cameraMatrix.at<double>(0,2);
+            const double fy = intrinsics.cameraMatrix.at<double>(1,1);
+            const double cy = intrinsics.cameraMatrix.at<double>(1,2);
+            for (const auto& corner : resizedPixelCorner_buffer) {
+                const double y = (corner.y - cy) / fy;
+                normCorner_buffer.emplace_back((corner.x - cx - skew * y) / fx,y);
+            }
+        } else {
+            cv::undistortPoints(
+                resizedPixelCorner_buffer,
+                normCorner_buffer,
+                intrinsics.cameraMatrix,
+                intrinsics.distCoeffs
+            );
+        }
 
         // Postprocessing
         const auto native_frame_size = intrinsics.resolution.width * intrinsics.resolution.height;
@@ -88,11 +101,7 @@ namespace wf {
             );
         }
 
-        return PipelineResult::ObjectDetectionResult(
-            meta.micros,
-            meta.server_time_us,
-            std::move(detections)
-        );
+        return WFStatusResult::success();
     }
     void ObjectDetectionPipeline::updatePostprocParams() {
         const auto& tensorParams = engine->getTensorParameters();
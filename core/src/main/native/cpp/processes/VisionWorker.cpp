@@ -21,28 +21,53 @@
 #include "wfcore/video/video_utils.h"
 #include "wfcore/common/logging.h"
 #include "wfcore/video/video_types.h"
+#include "wfcore/video/processing/UndistortNode.h"
 #include "wfcore/pipeline/visitors/PipelineConfigApplier.h"
 #include "wfcore/pipeline/visitors/PipelineConfigGetter.h"
 #include <pthread.h>
 #include "wfcore/pipeline/output/visitors/PortGetter.h"
 #include "wfcore/pipeline/output/visitors/OutputFormatGetter.h"
 #include "wfcore/pipeline/output/visitors/StreamVisitors.h"
+#include "wfcore/network/MasterTime.h"
+#include <wpi/timestamp.h>
 #include <chrono>
+#include <algorithm>
+#include <format>
 
 namespace impl {
     using namespace wf;
+    using Clock = std::chrono::steady_clock;
     [[ nodiscard ]]
     static inline bool validateFrame(const cv::Mat& frame,const wf::FrameMetadata& meta) noexcept {
+        // MJPEG frames are a single row holding the compressed bitstream
+        if (meta.format.encoding == wf::ImageEncoding::MJPEG)
+            return frame.rows == 1 && frame.cols > 0 && frame.type() == CV_8UC1;
         return (frame.rows == meta.format.height) 
             && (frame.cols == meta.format.width) 
             && (frame.type() == wf::getCVTypeFromEncoding(meta.format.encoding));
     }
 
+    // Returns a lent frame to its provider when it goes out of scope
+    class FrameLeaseGuard {
+        FrameProvider& provider;
+    public:
+        FrameLeaseGuard(FrameProvider& provider_) : provider(provider_), lease(NULL_LEASE) {}
+        ~FrameLeaseGuard() { provider.releaseFrame(lease); }
+        FrameLeaseGuard(const FrameLeaseGuard&) = delete;
+        FrameLeaseGuard& operator=(const FrameLeaseGuard&) = delete;
+        FrameLease lease;
+    };
+
     std::string setThreadName(const std::string& name) {
         // pthread_setname_np limits names to 16 characters including null terminator
         pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
         return name.substr(0, 15);
     }
+
+    // Names a pipeline stage thread, keeping the stage suffix visible within the 15 character limit
+    void setStageThreadName(const std::string& name, const char* stage) {
+        pthread_setname_np(pthread_self(), std::format("{}/{}", name.substr(0, 11), stage).substr(0, 15).c_str());
+    }
 }
 
 namespace wf {
@@ -54,25 +79,37 @@ namespace wf {
         std::shared_ptr<CameraSink> frameProvider_,
         CVProcessPipe<cv::Mat> preprocesser_, 
         std::unique_ptr<Pipeline> pipeline_,
-        std::unique_ptr<PipelineOutputConsumer> outputConsumer_
+        std::unique_ptr<PipelineOutputConsumer> outputConsumer_,
+        bool pipelined_,
+        int pipelineDepth_,
+        ThreadPriority threadPriority_,
+        std::vector<int> cpuAffinity_,
+        std::vector<CVProcessPipe<cv::Mat>> extraPreprocessers_,
+        int preprocessLevel_
     )
     : name(std::move(name_))
     , preprocesser(std::move(preprocesser_))
+    , extraPreprocessers(std::move(extraPreprocessers_))
+    , preprocessLevel(preprocessLevel_)
+    , view(preprocesser.getViewTransform())
     , frameProvider(frameProvider_)
     , pipeline(std::move(pipeline_))
     , outputConsumer(std::move(outputConsumer_)) 
+    , pipelined(pipelined_)
+    , pipelineDepth(std::max(pipelineDepth_,1))
+    , threadPriority(threadPriority_)
+    , cpuAffinity(cpuAffinity_)
+    , placement{cpuAffinity_,cpuAffinity_}
     , WFConcurrentLoggedStatusfulObject(name,LogGroup::General) {
+        // rawFrameBuffer is only ever a header over a buffer lent by the frame provider, so nothing is allocated here
         auto sfres = frameProvider->getStreamFormat();
         if (!sfres)
             throw wf_result_error(sfres);
-        auto rawformat = sfres.value().frameFormat;
-        rawFrameBuffer.create(
-            rawformat.height,
-            rawformat.width,
-            getCVTypeFromEncoding(
-                rawformat.encoding
-            )
-        );
+        // Nothing is running yet, so this is the one time the configuration is queried from the components directly
+        auto cres = queryConfig();
+        if (!cres)
+            throw wf_result_error(cres);
+        configSnapshot.store(std::make_shared<const VisionWorkerConfig>(std::move(cres.value())));
         running = false;
     }
 
@@ -82,6 +119,10 @@ namespace wf {
 
     void VisionWorker::start() {
         if (running.load()) return;
+        if (pipelined) {
+            startPipelined();
+            return;
+        }
         try {
             thread = std::jthread([this](std::stop_token stoken){
                 this->run(stoken);
@@ -92,17 +133,73 @@ namespace wf {
     }
 
     void VisionWorker::stop() {
+        // Every stage is asked to stop before any is joined, so none of them is left waiting on a stopped neighbour
+        for (auto& stage : stageThreads)
+            stage.request_stop();
         if (thread.joinable()){
             thread.request_stop(); // cooperative stop
             thread.join();
             thread = std::jthread{};
         }
+        for (auto& stage : stageThreads) {
+            if (stage.joinable())
+                stage.join();
+        }
+        stageThreads.clear();
+        drainStages();
     }
 
 
-    WFResult<VisionWorkerConfig> VisionWorker::getConfig() {
-        bool wasRunning = running.load();
-        if (wasRunning) stop();
+    WFResult<VisionWorkerConfig> VisionWorker::getConfig() const {
+        return *configSnapshot.load(std::memory_order_acquire);
+    }
+
+    bool VisionWorker::requiresRebuild(const VisionWorkerConfig& config) const {
+        const auto current = configSnapshot.load(std::memory_order_acquire);
+        // The output consumer draws tag outlines with the tag size it was built with
+        const auto* newTags = std::get_if<ApriltagPipelineConfiguration>(&config.pipelineConfig);
+        const auto* currentTags = std::get_if<ApriltagPipelineConfiguration>(&current->pipelineConfig);
+        if (newTags && currentTags && newTags->apriltagSize != currentTags->apriltagSize)
+            return true;
+        return config.camera_nickname != current->camera_nickname
+            || config.name != current->name
+            || !(config.inputFormat == current->inputFormat)
+            || !(config.outputFormat == current->outputFormat)
+            || config.raw_port != current->raw_port
+            || config.processed_port != current->processed_port
+            || config.pipelineType != current->pipelineType
+            || config.pipelined != current->pipelined
+            || config.pipelineDepth != current->pipelineDepth
+            || config.dropPolicy != current->dropPolicy
+            || config.threadPriority != current->threadPriority
+            || config.cpuAffinity != current->cpuAffinity
+            || config.stripedPreprocessing != current->stripedPreprocessing
+            || config.decoderThreads != current->decoderThreads
+            || config.undistort != current->undistort
+            || config.rotation != current->rotation;
+    }
+
+    WFStatusResult VisionWorker::applyConfig(VisionWorkerConfig& config) {
+        std::lock_guard lock(configMutex);
+        if (requiresRebuild(config))
+            return WFStatusResult::failure(PIPELINE_BAD_CONFIG,"Configuration for worker {} can't be applied without rebuilding it",name);
+        // The pipeline builds its new state on this thread and swaps it in between frames
+        PipelineConfigApplier pcapply(config.pipelineConfig);
+        auto applyResult = pipeline->accept(pcapply);
+        if (!applyResult) return applyResult;
+
+        StreamSetter sset(config.stream);
+        auto ssetResult = outputConsumer->accept(sset);
+        if (!ssetResult) return ssetResult;
+
+        auto next = std::make_shared<VisionWorkerConfig>(*configSnapshot.load(std::memory_order_acquire));
+        next->stream = config.stream;
+        next->pipelineConfig = config.pipelineConfig;
+        configSnapshot.store(std::move(next), std::memory_order_release);
+        return WFStatusResult::success();
+    }
+
+    WFResult<VisionWorkerConfig> VisionWorker::queryConfig() {
         // acquire nickname
         auto nickResult = frameProvider->getCameraNickname();
         if (!nickResult) return WFResult<VisionWorkerConfig>::propagateFail(nickResult);
@@ -111,8 +208,12 @@ namespace wf {
         auto getResult = pipeline->accept(pcget);
         if (!getResult) return WFResult<VisionWorkerConfig>::propagateFail(getResult);
 
-        // Acquire input format from preprocessor
-        auto inputFormat = preprocesser.getOutformat();
+        // Acquire input format from preprocessor. Skipped resizes still count towards it, the rotation is reported on its own
+        const auto& ppFormat = preprocesser.getOutformat();
+        const cv::Size viewSize = view.getViewSize();
+        FrameFormat inputFormat = (view.getQuarterTurns() % 2)
+            ? FrameFormat(ppFormat.encoding,viewSize.height,viewSize.width)
+            : FrameFormat(ppFormat.encoding,viewSize.width,viewSize.height);
 
         OutputFormatGetter ofget;
         auto ofgetResult = outputConsumer->accept(ofget);
@@ -128,8 +229,6 @@ namespace wf {
         
         PipelineType ptype = pipeline->getType();
 
-        if (wasRunning) start();
-
         return VisionWorkerConfig(
             nickResult.value(),
             name,
@@ -139,21 +238,48 @@ namespace wf {
             pget.rawPort,
             pget.processedPort,
             ptype,
-            pcget.get()
+            pcget.get(),
+            pipelined,
+            pipelineDepth,
+            frameProvider->getDropPolicy(),
+            threadPriority,
+            cpuAffinity,
+            preprocesser.getExecution() == PipeExecution::Striped,
+            static_cast<int>(extraPreprocessers.size()) + 1,
+            preprocesser.hasNode<UndistortNode>(),
+            view.getQuarterTurns() * 90
         );
     }
 
+    // Called by each of the worker's threads as it starts. Threads the caller spawns later,
+    // such as an inference runtime's workers, inherit the affinity and priority
+    void VisionWorker::placeThread(const std::vector<int>& cpus) noexcept {
+        if (!cpus.empty() && setCurrentThreadAffinity(cpus) != 0)
+            this->logger()->warn("Failed to pin a thread of worker {} to its CPUs",name);
+        if (setCurrentThreadPriority(threadPriority) != 0)
+            this->logger()->warn("Failed to set the priority of a thread of worker {}",name);
+    }
+
     // TODO: Add more robust error handling
     void VisionWorker::run(std::stop_token stoken) noexcept {
         running.store(true);
         threadName = impl::setThreadName(name);
+        // Everything runs on this one thread, so it belongs on the compute cores
+        placeThread(placement.computeCPUs);
+        // Reused for every frame, so the result's vectors keep their storage
+        PipelineResult result;
         while (!stoken.stop_requested()) {
             try {
             if (!ok()) {
                 std::this_thread::sleep_for(std::chrono::milliseconds(5));
                 continue;
             }
-            auto rawmeta = frameProvider->getFrame(rawFrameBuffer);
+            // The raw frame is lent by the provider and handed back when leaseGuard goes out of scope,
+            // which happens after the output consumer is done with this iteration
+            impl::FrameLeaseGuard leaseGuard(*frameProvider);
+            auto stageStart = impl::Clock::now();
+            auto rawmeta = frameProvider->acquireFrame(rawFrameBuffer,leaseGuard.lease);
+            grabLatency.record(impl::Clock::now() - stageStart);
             if (!rawmeta) {
                 //const auto errmsg(frameProvider.getError().value());
                 this->reportError(rawmeta.status);
@@ -164,17 +290,29 @@ namespace wf {
                 this->reportError(PIPELINE_BAD_FRAME,"Bad frame received from source");
                 continue;
             }
-            auto ppmeta = preprocesser.processFrame(rawFrameBuffer,ppFrameBuffer,rawmeta);
+            stageStart = impl::Clock::now();
+            auto ppmeta = preprocesser.processFrame(
+                selectPreprocessInput(rawFrameBuffer,rawmeta,leaseGuard.lease,localPyramid),
+                ppFrameBuffer,
+                rawmeta
+            );
+            preprocessLatency.record(impl::Clock::now() - stageStart);
             if (!impl::validateFrame(ppFrameBuffer,ppmeta)) {
                 this->reportError(PIPELINE_BAD_FRAME,"Bad frame received from preprocesser");
                 continue;
             }
-            auto res = pipeline->process(ppFrameBuffer,ppmeta);
+            stageStart = impl::Clock::now();
+            auto res = pipeline->process(ppFrameBuffer,ppmeta,result);
+            if (res) mapResultToView(result,view);
+            pipelineLatency.record(impl::Clock::now() - stageStart);
             if (!res) {
                 this->reportError(res);
                 continue;
             }
-            outputConsumer->consume(ppFrameBuffer,ppmeta,res.value());
+            stageStart = impl::Clock::now();
+            outputConsumer->consume(ppFrameBuffer,ppmeta,result);
+            outputLatency.record(impl::Clock::now() - stageStart);
+            recordPublished(ppmeta);
             } catch (...) {
                 this->reportError(WFStatus::UNKNOWN,"An unknown exception occurred");
                 continue;
@@ -182,4 +320,256 @@ namespace wf {
         }
         running.store(false);
     }
-}
\ No newline at end of file
+
+    std::vector<StageLatency> VisionWorker::getStageLatencies() const {
+        std::vector<StageLatency> stages = {
+            {"grab",&grabLatency},
+            {"preprocess",&preprocessLatency},
+            {"pipeline",&pipelineLatency},
+            {"output",&outputLatency}
+        };
+        for (auto& stage : pipeline->getStageLatencies()) {
+            stage.stage = std::format("pipeline/{}",stage.stage);
+            stages.push_back(std::move(stage));
+        }
+        return stages;
+    }
+
+    VisionWorkerStats VisionWorker::getStats() const noexcept {
+        VisionWorkerStats stats;
+        stats.framesProcessed = framesProcessed.load(std::memory_order_relaxed);
+        stats.framesDropped = framesDropped.load(std::memory_order_relaxed) + frameProvider->getDroppedFrames();
+        stats.lastCaptureAgeUs = lastCaptureAgeUs.load(std::memory_order_relaxed);
+        stats.meanCaptureAgeUs = stats.framesProcessed
+            ? captureAgeSumUs.load(std::memory_order_relaxed) / static_cast<int64_t>(stats.framesProcessed)
+            : 0;
+        stats.maxCaptureAgeUs = maxCaptureAgeUs.load(std::memory_order_relaxed);
+        stats.lastAcquireAgeUs = lastAcquireAgeUs.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    // Only ever called from the thread that runs the output consumer, so plain loads and stores are enough here
+    void VisionWorker::recordPublished(const FrameMetadata& meta) noexcept {
+        const int64_t captureAge = static_cast<int64_t>(wpi::Now()) - static_cast<int64_t>(meta.micros);
+        const int64_t acquireAge = getMasterTime() - meta.server_time_us;
+        lastCaptureAgeUs.store(captureAge, std::memory_order_relaxed);
+        lastAcquireAgeUs.store(acquireAge, std::memory_order_relaxed);
+        captureAgeSumUs.store(captureAgeSumUs.load(std::memory_order_relaxed) + captureAge, std::memory_order_relaxed);
+        if (captureAge > maxCaptureAgeUs.load(std::memory_order_relaxed))
+            maxCaptureAgeUs.store(captureAge, std::memory_order_relaxed);
+        framesProcessed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const cv::Mat& VisionWorker::selectPreprocessInput(const cv::Mat& raw, const FrameMetadata& meta, FrameLease lease, FramePyramid& fallback) {
+        if (preprocessLevel == 0) return raw;
+        // Workers sharing a camera share the levels of each frame, so only the first one to ask pays for them
+        FramePyramid* pyramid = frameProvider->getPyramid(lease);
+        if (!pyramid) {
+            fallback.reset(raw,meta.format.encoding);
+            pyramid = &fallback;
+        }
+        return pyramid->getLevel(preprocessLevel);
+    }
+
+    void VisionWorker::startPipelined() {
+        const size_t depth = static_cast<size_t>(pipelineDepth);
+        const size_t numLanes = extraPreprocessers.size() + 1;
+        // Past acquisition, every frame lives in the staging pool. Each staged queue can hold depth frames,
+        // and every preprocessing lane, the pipeline stage, and the output stage can each be working on one more
+        const size_t numFrames = numLanes * (depth + 1) + depth + 2;
+        const auto ppFormat = preprocesser.getOutformat();
+        if (!stagePool || stagePool->size() != numFrames || !(stagePool->getFormat() == ppFormat))
+            stagePool = FramePool::create(ppFormat,numFrames);
+        // Raw frames are lent by the provider, which only has a handful of lend slots,
+        // so at most one waits for each preprocessing lane while it works on another
+        lanes.clear();
+        lanes.reserve(numLanes);
+        for (size_t i = 0; i < numLanes; ++i) {
+            lanes.push_back(PreprocessLane{
+                i == 0 ? &preprocesser : &extraPreprocessers[i - 1],
+                std::make_unique<FramePyramid>(),
+                cv::Mat(),
+                std::make_unique<SPSCRing<RawStageFrame>>(1),
+                std::make_unique<SPSCRing<StagedFrame>>(depth)
+            });
+        }
+        resultQueue = std::make_unique<SPSCRing<StagedFrame>>(depth);
+        // Every result in flight can come back, the ones queued for output plus the one being consumed
+        recycledResults = std::make_unique<SPSCRing<PipelineResult>>(depth + 1);
+
+        latestOnly = (frameProvider->getDropPolicy() == FrameDropPolicy::LatestOnly);
+        thread = std::jthread([this](std::stop_token stoken){
+            this->runAcquisition(stoken);
+        });
+        for (auto& lane : lanes) {
+            stageThreads.emplace_back([this,&lane](std::stop_token stoken){
+                this->runPreprocessing(stoken,lane);
+            });
+        }
+        stageThreads.emplace_back([this](std::stop_token stoken){
+            this->runPipeline(stoken);
+        });
+        stageThreads.emplace_back([this](std::stop_token stoken){
+            this->runOutput(stoken);
+        });
+    }
+
+    void VisionWorker::drainStages() noexcept {
+        // Lent frames still queued when the stages stopped have to go back to the provider
+        for (auto& lane : lanes) {
+            while (auto item = lane.rawQueue->tryPop())
+                frameProvider->releaseFrame(item->lease);
+        }
+        lanes.clear();
+        resultQueue.reset();
+    }
+
+    void VisionWorker::runAcquisition(std::stop_token stoken) noexcept {
+        running.store(true);
+        threadName = impl::setThreadName(name);
+        placeThread(placement.auxCPUs);
+        size_t nextLane = 0;
+        while (!stoken.stop_requested()) {
+            try {
+            if (!ok()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                continue;
+            }
+            impl::FrameLeaseGuard leaseGuard(*frameProvider);
+            cv::Mat frame;
+            auto grabStart = impl::Clock::now();
+            auto rawmeta = frameProvider->acquireFrame(frame,leaseGuard.lease);
+            grabLatency.record(impl::Clock::now() - grabStart);
+            if (!rawmeta) {
+                this->reportError(rawmeta.status);
+                continue;
+            }
+            if (!impl::validateFrame(frame,rawmeta)) {
+                this->reportError(PIPELINE_BAD_FRAME,"Bad frame received from source");
+                continue;
+            }
+            auto& lane = lanes[nextLane];
+            // Acquisition never waits on the later stages. If they have fallen behind,
+            // the frame is dropped and goes straight back to the provider
+            if (lanes.size() > 1) {
+                // With several lanes more frames are in flight than the provider has lend slots, so each frame is
+                // copied out and its lease returned right away. Lanes are only set up for MJPEG sources,
+                // where this copies the compressed bitstream
+                if (lane.rawQueue->tryPush(RawStageFrame{frame.clone(),rawmeta,NULL_LEASE}))
+                    nextLane = (nextLane + 1) % lanes.size();
+                else
+                    framesDropped.fetch_add(1, std::memory_order_relaxed);
+            } else if (lane.rawQueue->tryPush(RawStageFrame{frame,rawmeta,leaseGuard.lease})) {
+                leaseGuard.lease = NULL_LEASE; // Ownership of the lease passes to the preprocessing stage
+            } else {
+                framesDropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            } catch (...) {
+                this->reportError(WFStatus::UNKNOWN,"An unknown exception occurred");
+                continue;
+            }
+        }
+        running.store(false);
+    }
+
+    void VisionWorker::runPreprocessing(std::stop_token stoken, PreprocessLane& lane) noexcept {
+        impl::setStageThreadName(name,"pre");
+        placeThread(placement.auxCPUs);
+        while (!stoken.stop_requested()) {
+            auto raw = lane.rawQueue->pop(stoken);
+            if (!raw) continue;
+            impl::FrameLeaseGuard leaseGuard(*frameProvider);
+            leaseGuard.lease = raw->lease;
+            bool staged = false;
+            try {
+            // Includes the copy into the pooled frame, which is part of this stage's cost in pipelined mode
+            auto stageStart = impl::Clock::now();
+            auto ppmeta = lane.preprocesser->processFrame(
+                selectPreprocessInput(raw->frame,raw->meta,raw->lease,*lane.pyramid),
+                lane.frameBuffer,
+                raw->meta
+            );
+            if (!impl::validateFrame(lane.frameBuffer,ppmeta) || !(ppmeta.format == stagePool->getFormat())) {
+                this->reportError(PIPELINE_BAD_FRAME,"Bad frame received from preprocesser");
+            } else if (auto frame = stagePool->acquire()) {
+                // The frame buffer may alias the lent frame or a node's internal buffer, both of which are reused
+                // while this frame is still in flight, so it is copied into a pooled frame of the same format
+                lane.frameBuffer.copyTo(frame.mat());
+                preprocessLatency.record(impl::Clock::now() - stageStart);
+                staged = lane.preprocessedQueue->push(stoken,StagedFrame{std::move(frame),ppmeta,PipelineResult()});
+            } else {
+                // The pool is sized so it can't run dry in steady state, but if it ever does the frame is dropped
+                framesDropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            } catch (...) {
+                this->reportError(WFStatus::UNKNOWN,"An unknown exception occurred");
+            }
+            // The pipeline stage collects frames from the lanes in the order they were dealt, so with several lanes
+            // a dropped frame still leaves an empty placeholder behind to keep the lanes in step
+            if (!staged && lanes.size() > 1)
+                lane.preprocessedQueue->push(stoken,StagedFrame{FrameHandle(),raw->meta,PipelineResult()});
+        }
+    }
+
+    void VisionWorker::runPipeline(std::stop_token stoken) noexcept {
+        impl::setStageThreadName(name,"pipe");
+        placeThread(placement.computeCPUs);
+        size_t nextLane = 0;
+        while (!stoken.stop_requested()) {
+            auto staged = lanes[nextLane].preprocessedQueue->pop(stoken);
+            if (!staged) continue;
+            nextLane = (nextLane + 1) % lanes.size();
+            if (latestOnly) {
+                // Latest frame wins. Anything newer that finished preprocessing in the meantime replaces this frame,
+                // so the pipeline never spends time on a frame that is already stale
+                while (auto newer = lanes[nextLane].preprocessedQueue->tryPop()) {
+                    nextLane = (nextLane + 1) % lanes.size();
+                    if (!newer->frame) continue;
+                    if (staged->frame)
+                        framesDropped.fetch_add(1, std::memory_order_relaxed);
+                    staged.reset();
+                    staged.emplace(std::move(*newer));
+                }
+            }
+            // Placeholder for a frame a preprocessing lane dropped
+            if (!staged->frame) continue;
+            try {
+            auto stageStart = impl::Clock::now();
+            // Fill in a result the output stage is done with, if there is one, so its storage gets reused
+            if (auto recycled = recycledResults->tryPop())
+                staged->result = std::move(*recycled);
+            auto res = pipeline->process(staged->frame.mat(),staged->meta,staged->result);
+            if (res) mapResultToView(staged->result,view);
+            pipelineLatency.record(impl::Clock::now() - stageStart);
+            if (!res) {
+                this->reportError(res);
+                continue;
+            }
+            resultQueue->push(stoken,std::move(*staged));
+            } catch (...) {
+                this->reportError(WFStatus::UNKNOWN,"An unknown exception occurred");
+                continue;
+            }
+        }
+    }
+
+    void VisionWorker::runOutput(std::stop_token stoken) noexcept {
+        impl::setStageThreadName(name,"out");
+        placeThread(placement.auxCPUs);
+        while (!stoken.stop_requested()) {
+            auto staged = resultQueue->pop(stoken);
+            if (!staged) continue;
+            try {
+            auto stageStart = impl::Clock::now();
+            outputConsumer->consume(staged->frame.mat(),staged->meta,staged->result);
+            outputLatency.record(impl::Clock::now() - stageStart);
+            recordPublished(staged->meta);
+            // Hand the result back to the pipeline stage. If its ring is full the result is simply dropped
+            recycledResults->tryPush(std::move(staged->result));
+            } catch (...) {
+                this->reportError(WFStatus::UNKNOWN,"An unknown exception occurred");
+                continue;
+            }
+        }
+    }
+}
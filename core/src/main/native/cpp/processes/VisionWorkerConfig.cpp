@@ -66,6 +66,44 @@ namespace impl {
             default: return "NullType";
         }
     }
+
+    static FrameDropPolicy decodeDropPolicy(const std::string& str) {
+        if (str == "Block") return FrameDropPolicy::Block;
+        return FrameDropPolicy::LatestOnly;
+    }
+
+    static std::string encodeDropPolicy(FrameDropPolicy policy) {
+        switch (policy) {
+            case FrameDropPolicy::Block: return "Block";
+            default: return "LatestOnly";
+        }
+    }
+
+    static ThreadPriority decodeThreadPriority(const std::string& str) {
+        if (str == "LOWEST") return ThreadPriority::LOWEST;
+        if (str == "LOW") return ThreadPriority::LOW;
+        if (str == "HIGH") return ThreadPriority::HIGH;
+        if (str == "HIGHEST") return ThreadPriority::HIGHEST;
+        if (str == "SENSITIVE") return ThreadPriority::SENSITIVE;
+        if (str == "CRITICAL") return ThreadPriority::CRITICAL;
+        if (str == "REALTIME") return ThreadPriority::REALTIME;
+        if (str == "ELEVEN") return ThreadPriority::ELEVEN;
+        return ThreadPriority::NORMAL;
+    }
+
+    static std::string encodeThreadPriority(ThreadPriority priority) {
+        switch (priority) {
+            case ThreadPriority::LOWEST: return "LOWEST";
+            case ThreadPriority::LOW: return "LOW";
+            case ThreadPriority::HIGH: return "HIGH";
+            case ThreadPriority::HIGHEST: return "HIGHEST";
+            case ThreadPriority::SENSITIVE: return "SENSITIVE";
+            case ThreadPriority::CRITICAL: return "CRITICAL";
+            case ThreadPriority::REALTIME: return "REALTIME";
+            case ThreadPriority::ELEVEN: return "ELEVEN";
+            default: return "NORMAL";
+        }
+    }
 }
 
 namespace wf {
@@ -92,7 +130,16 @@ namespace wf {
             getJSONOpt(jobject,"raw_port",0),
             getJSONOpt(jobject,"processed_port",0),
             impl::decodePipelineType(jobject["pipelineType"]),
-            std::move(pcfgRes.value())
+            std::move(pcfgRes.value()),
+            getJSONOpt(jobject,"pipelined",false),
+            getJSONOpt(jobject,"pipelineDepth",2),
+            impl::decodeDropPolicy(getJSONOpt<std::string>(jobject,"dropPolicy","LatestOnly")),
+            impl::decodeThreadPriority(getJSONOpt<std::string>(jobject,"threadPriority","NORMAL")),
+            getJSONOpt(jobject,"cpuAffinity",std::vector<int>{}),
+            getJSONOpt(jobject,"stripedPreprocessing",false),
+            getJSONOpt(jobject,"decoderThreads",1),
+            getJSONOpt(jobject,"undistort",false),
+            getJSONOpt(jobject,"rotation",0)
         );
     }
     WFResult<JSON> VisionWorkerConfig::toJSON_impl(const VisionWorkerConfig& config) {
@@ -150,7 +197,16 @@ namespace wf {
                 {"raw_port",config.raw_port},
                 {"processed_port",config.processed_port},
                 {"pipelineType",impl::encodePipelineType(config.pipelineType)},
-                {"pipelineConfig",std::move(pcfg_jobject)}
+                {"pipelineConfig",std::move(pcfg_jobject)},
+                {"pipelined",config.pipelined},
+                {"pipelineDepth",config.pipelineDepth},
+                {"dropPolicy",impl::encodeDropPolicy(config.dropPolicy)},
+                {"threadPriority",impl::encodeThreadPriority(config.threadPriority)},
+                {"cpuAffinity",config.cpuAffinity},
+                {"stripedPreprocessing",config.stripedPreprocessing},
+                {"decoderThreads",config.decoderThreads},
+                {"undistort",config.undistort},
+                {"rotation",config.rotation}
             };
             return jobject;
         } catch (const JSON::exception& e) {
@@ -21,16 +21,26 @@
 
 #include "wfcore/processes/VisionWorkerManager.h"
 #include "wfcore/video/processing.h"
+#include "wfcore/video/FramePyramid.h"
 #include "wfcore/hardware/HardwareManager.h"
 #include "wfcore/network/NetworkTablesManager.h"
 #include "wfcore/common/logging.h"
 #include "wfcore/pipeline/output/ApriltagPipelineConsumer.h"
 #include "wfcore/common/wfexcept.h"
+#include "wfcore/common/scheduling/ThreadPlacement.h"
 #include <format>
 #include <stdexcept>
+#include <algorithm>
 
 namespace impl {
     using namespace wf;
+
+    static std::string formatCPUList(const std::vector<int>& cpus) {
+        std::string list;
+        for (int cpu : cpus)
+            list += list.empty() ? std::to_string(cpu) : std::format(",{}",cpu);
+        return list.empty() ? "any" : list;
+    }
 }
 
 namespace wf {
@@ -38,7 +48,15 @@ namespace wf {
 
     VisionWorkerManager::VisionWorkerManager(NetworkTablesManager& ntManager_, HardwareManager& hardwareManager_, InferenceEngineFactory& engineFactory, ApriltagPipelineFactory& apriltagPipelineFactory_)
     : ntManager(ntManager_), hardwareManager(hardwareManager_), engineFactory(engineFactory)
-    , WFLoggedStatusfulObject("VisionWorkerManager",LogGroup::General), apriltagPipelineFactory(apriltagPipelineFactory_) {}
+    , WFLoggedStatusfulObject("VisionWorkerManager",LogGroup::General), apriltagPipelineFactory(apriltagPipelineFactory_)
+    , topology(CPUTopology::detect()) {
+        this->logger()->info(
+            "Detected {} CPUs, {} in the performance tier{}",
+            topology.getCores().size(),
+            topology.getPerformanceCPUs().size(),
+            topology.isHeterogeneous() ? " (heterogeneous)" : ""
+        );
+    }
 
     // TODO: Refactor this with Status codes?
     WFResult<std::shared_ptr<VisionWorker>> VisionWorkerManager::buildVisionWorker(VisionWorkerConfig config) {
@@ -65,14 +83,20 @@ namespace wf {
                             WFStatus::APRILTAG_NO_INTRINSICS,
                             "Pipeline {} is configured to solve PnP, but no intrinsics were provided", config.name
                         );
+                    if ((!intrinsics_res) && config.undistort)
+                        return WFResult<std::shared_ptr<VisionWorker>>::failure(
+                            WFStatus::APRILTAG_NO_INTRINSICS,
+                            "Worker {} is configured to undistort frames, but no intrinsics were provided", config.name
+                        );
                     CameraIntrinsics intrinsics = intrinsics_res
                         ? std::move(intrinsics_res.value())
                         : CameraIntrinsics{};
 
-                    // Fetch frame provider from the hardware manager
+                    // Fetch frame provider from the hardware manager. Each worker gets its own subscription to the camera's broadcast
                     auto frameProviderRes = hardwareManager.getCameraSink(
                         config.camera_nickname,
-                        std::format("{}_frameprovider",config.camera_nickname)
+                        std::format("{}_frameprovider",config.name),
+                        config.dropPolicy
                     );
                     if (!frameProviderRes)
                         throw wf_result_error(frameProviderRes);
@@ -93,38 +117,131 @@ namespace wf {
                     if (config.outputFormat == nullStreamFormat)
                         config.outputFormat = hardwareFormat;
 
-                    // Build preprocesser
-                    std::vector<std::unique_ptr<CVProcessNode<cv::Mat>>> nodes;
-                    if (config.inputFormat == hardwareFormat.frameFormat) {
-                        nodes.emplace_back(std::move(std::make_unique<IdentityNode<cv::Mat>>()));
-                    } else {
-                        if (
-                            config.inputFormat.height != hardwareFormat.frameFormat.height
-                            || config.inputFormat.width != hardwareFormat.frameFormat.width
-                        ) {
-                            this->logger()->warn("Resolution for pipeline {} differs from native resolution for camera {}. This could cause issues with calibration",config.name,config.camera_nickname);
-                            nodes.push_back(std::move(std::make_unique<ResizeNode<cv::Mat>>(
-                                config.inputFormat.width,
-                                config.inputFormat.height
-                            )));
+                    int rotation = -1;
+                    switch (config.rotation) {
+                        case 0: break;
+                        case 90: rotation = cv::ROTATE_90_CLOCKWISE; break;
+                        case 180: rotation = cv::ROTATE_180; break;
+                        case 270: rotation = cv::ROTATE_90_COUNTERCLOCKWISE; break;
+                        default:
+                            return WFResult<std::shared_ptr<VisionWorker>>::failure(
+                                WFStatus::PIPELINE_BAD_CONFIG,
+                                "Worker {} has a rotation of {} degrees, only quarter turns are supported",config.name,config.rotation
+                            );
+                    }
+
+                    const bool mjpeg = hardwareFormat.frameFormat.encoding == ImageEncoding::MJPEG;
+                    // Compressed frames are no use to the pipeline, and AprilTag detection only needs the luma
+                    if (mjpeg && config.inputFormat.encoding == ImageEncoding::MJPEG)
+                        config.inputFormat.encoding = ImageEncoding::Y8;
+
+                    // A downscaling preprocesser starts from the deepest level of the camera's image pyramid that is still
+                    // at least the input size. Workers sharing the camera share the pyramid, so the full resolution frame
+                    // is only filtered once however many of them shrink it
+                    const int preprocessLevel = mjpeg ? 0 : FramePyramid::chooseLevel(
+                        hardwareFormat.frameFormat,
+                        cv::Size(config.inputFormat.width,config.inputFormat.height)
+                    );
+                    const cv::Size sourceSize = FramePyramid::getLevelSize(hardwareFormat.frameFormat.size(),preprocessLevel);
+                    const FrameFormat sourceFormat(hardwareFormat.frameFormat.encoding,sourceSize.width,sourceSize.height);
+
+                    // Build preprocesser. Every preprocessing lane gets its own, so this may run more than once
+                    auto buildPreprocesser = [&]() {
+                        std::vector<std::unique_ptr<CVProcessNode<cv::Mat>>> nodes;
+                        const bool resized = config.inputFormat.height != sourceFormat.height
+                            || config.inputFormat.width != sourceFormat.width;
+                        if (mjpeg) {
+                            // Decode straight to the closest DCT scaled size at or above the input size,
+                            // and only resize whatever is left over
+                            const cv::Size encodedSize(hardwareFormat.frameFormat.width,hardwareFormat.frameFormat.height);
+                            const cv::Size inputSize(config.inputFormat.width,config.inputFormat.height);
+                            const int scaleDenom = MJPEGDecodeNode::chooseScaleDenom(encodedSize,inputSize);
+                            const auto decodedEncoding = config.inputFormat.encoding == ImageEncoding::Y8 ? ImageEncoding::Y8 : ImageEncoding::BGR24;
+                            nodes.push_back(std::make_unique<MJPEGDecodeNode>(encodedSize,decodedEncoding,scaleDenom));
+                            if (MJPEGDecodeNode::getDecodedSize(encodedSize,scaleDenom) != inputSize) {
+                                nodes.push_back(std::make_unique<ResizeNode<cv::Mat>>(
+                                    config.inputFormat.width,
+                                    config.inputFormat.height
+                                ));
+                            }
+                            if (config.inputFormat.encoding != decodedEncoding) {
+                                nodes.push_back(std::make_unique<ColorConvertNode<cv::Mat>>(
+                                    config.inputFormat.encoding
+                                ));
+                            }
+                        } else if (config.inputFormat == sourceFormat) {
+                            nodes.emplace_back(std::move(std::make_unique<IdentityNode<cv::Mat>>()));
+                        } else {
+                            // Packed YUV to gray only needs the luma plane, and a 2x decimation can come out of the same pass
+                            const bool extractLuma = config.inputFormat.encoding == ImageEncoding::Y8
+                                && (sourceFormat.encoding == ImageEncoding::YUYV || sourceFormat.encoding == ImageEncoding::UYVY);
+                            const bool halved = config.inputFormat.width * 2 == sourceFormat.width
+                                && config.inputFormat.height * 2 == sourceFormat.height;
+                            if (extractLuma && (!resized || halved)) {
+                                nodes.push_back(std::make_unique<LumaExtractNode>(resized));
+                            } else if (resized) {
+                                nodes.push_back(std::move(std::make_unique<ResizeNode<cv::Mat>>(
+                                    config.inputFormat.width,
+                                    config.inputFormat.height
+                                )));
+                            }
+                            if (extractLuma && resized && !halved) {
+                                nodes.push_back(std::make_unique<LumaExtractNode>());
+                            } else if (!extractLuma && config.inputFormat.encoding != sourceFormat.encoding) {
+                                nodes.push_back(std::move(std::make_unique<ColorConvertNode<cv::Mat>>(
+                                    config.inputFormat.encoding
+                                )));
+                            }
                         }
-                        if (config.inputFormat.encoding != hardwareFormat.frameFormat.encoding) {
-                            nodes.push_back(std::move(std::make_unique<ColorConvertNode<cv::Mat>>(
-                                config.inputFormat.encoding
-                            )));
+                        // Undistortion goes last, where frames are smallest and no longer packed YUV
+                        if (config.undistort)
+                            nodes.push_back(std::make_unique<UndistortNode>(intrinsics));
+                        if (rotation >= 0)
+                            nodes.push_back(std::make_unique<RotateNode<cv::Mat>>(rotation));
+                        // Detection only needs to know where things are, so trailing turns are skipped, and the results
+                        // are mapped onto the turned view instead. Resizes are kept, as detection has to run at the
+                        // configured input size whatever level of the pyramid it starts from
+                        return CVProcessPipe<cv::Mat>(
+                            sourceFormat,
+                            std::move(nodes),
+                            config.stripedPreprocessing ? PipeExecution::Striped : PipeExecution::Sequential,
+                            GeometryElision::Turns
+                        );
+                    };
+                    CVProcessPipe preprocesser = buildPreprocesser();
+                    const ViewTransform view = preprocesser.getViewTransform();
+                    const FrameFormat pipelineFormat = preprocesser.getOutformat();
+                    if (!view.isIdentity())
+                        this->logger()->info(
+                            "Worker {} detects on {}x{} frames, results are mapped onto its {}x{} view",
+                            config.name,pipelineFormat.width,pipelineFormat.height,view.getViewSize().width,view.getViewSize().height
+                        );
+                    // Consecutive MJPEG frames can be decoded in parallel by extra preprocessing lanes in pipelined mode
+                    std::vector<CVProcessPipe<cv::Mat>> extraPreprocessers;
+                    if (config.decoderThreads > 1) {
+                        if (mjpeg && config.pipelined) {
+                            for (int i = 1; i < config.decoderThreads; ++i)
+                                extraPreprocessers.push_back(buildPreprocesser());
+                        } else {
+                            this->logger()->warn("Worker {} only uses one decoder thread, decoder threads need a pipelined worker with an MJPEG camera",config.name);
                         }
                     }
-                    CVProcessPipe preprocesser(hardwareFormat.frameFormat,std::move(nodes));
+                    // Everything downstream of the preprocesser sees rectified frames
+                    if (config.undistort)
+                        intrinsics = intrinsics.rectified();
+                    // The pipeline gets the calibration scaled to the frames it actually sees, and the output consumer
+                    // the calibration of the view the results are mapped onto
+                    const CameraIntrinsics pipelineIntrinsics = ViewTransform::identity(pipelineFormat.size()).apply(intrinsics);
                     auto pipeline = apriltagPipelineFactory.createPipeline(
                         pipelineConfig,
-                        intrinsics
+                        pipelineIntrinsics
                     );
 
                     // Build output consumer
                     auto outputConsumer = std::make_unique<ApriltagPipelineConsumer>(
                         config.name, config.camera_nickname,
-                        intrinsics, 
-                        config.inputFormat, 
+                        view.apply(pipelineIntrinsics),
+                        pipelineFormat, view,
                         config.raw_port, config.processed_port,
                         config.outputFormat,
                         pipelineConfig.apriltagSize,
@@ -137,7 +254,13 @@ namespace wf {
                         frameProvider,
                         std::move(preprocesser),
                         std::move(pipeline.value()),
-                        std::move(outputConsumer)
+                        std::move(outputConsumer),
+                        config.pipelined,
+                        config.pipelineDepth,
+                        config.threadPriority,
+                        config.cpuAffinity,
+                        std::move(extraPreprocessers),
+                        preprocessLevel
                     );
                     workers.insert({config.name,worker});
                     return worker;
@@ -171,6 +294,26 @@ namespace wf {
         return it->second;
     }
 
+    void VisionWorkerManager::placeWorkers() {
+        // Sorted so the same set of workers always lands on the same cores
+        std::vector<std::string> placed;
+        for (const auto& [name,worker] : workers) {
+            if (worker->getCPUAffinityOverride().empty())
+                placed.push_back(name);
+        }
+        std::sort(placed.begin(),placed.end());
+        auto placements = planThreadPlacements(topology,placed.size());
+        for (size_t i = 0; i < placed.size(); ++i) {
+            auto& worker = workers.at(placed[i]);
+            if (worker->isRunning()) continue; // Running workers keep their cores until they restart
+            this->logger()->info(
+                "Placing worker {} on CPUs {} (auxiliary stages on {})",
+                placed[i],impl::formatCPUList(placements[i].computeCPUs),impl::formatCPUList(placements[i].auxCPUs)
+            );
+            worker->setPlacement(std::move(placements[i]));
+        }
+    }
+
     // TODO: Switch to WFResult
     void VisionWorkerManager::startWorker(const std::string& name) {
         this->logger()->info("Starting worker {}",name);
@@ -179,6 +322,7 @@ namespace wf {
             this->logger()->warn("Vision worker {} not found",name);
             return;
         }
+        placeWorkers();
         it->second->start();
     }
 
@@ -210,6 +354,7 @@ namespace wf {
 
     void VisionWorkerManager::startAllWorkers() {
         this->logger()->info("Starting all workers");
+        placeWorkers();
         for (auto& [name,worker] : workers) {
             this->logger()->info("Starting worker {}",name);
             if (worker->isRunning()) { 
@@ -247,4 +392,65 @@ namespace wf {
             return worker->getConfig();
         });
     }
+
+    WFStatusResult VisionWorkerManager::setWorkerConfig(const std::string& name, VisionWorkerConfig config) {
+        auto workerRes = getWorker(name);
+        if (!workerRes) return WFStatusResult::propagateFail(workerRes);
+        if (config.name != name)
+            return WFStatusResult::failure(WFStatus::PIPELINE_BAD_CONFIG,"Configuration for worker {} is named {}",name,config.name);
+        auto worker = std::move(workerRes.value());
+        if (!worker->requiresRebuild(config))
+            return worker->applyConfig(config);
+
+        this->logger()->info("Rebuilding worker {} to apply its new configuration",name);
+        const bool wasRunning = worker->isRunning();
+        worker.reset();
+        destroyWorker(name);
+        auto buildRes = buildVisionWorker(std::move(config));
+        if (!buildRes) return WFStatusResult::propagateFail(buildRes);
+        if (wasRunning) buildRes.value()->start();
+        return WFStatusResult::success();
+    }
+
+    WFResult<JSON> VisionWorkerManager::getWorkerLatencies_JSON(const std::string& name) {
+        return getWorker(name).and_then([](const std::shared_ptr<VisionWorker>& worker){
+            try {
+                return WFResult<JSON>::success(stageLatenciesToJSON(worker->getStageLatencies()));
+            } catch (const JSON::exception& e) {
+                return WFResult<JSON>::failure(WFStatus::JSON_UNKNOWN,e.what());
+            }
+        });
+    }
+
+    WFResult<JSON> VisionWorkerManager::getWorkerPlan_JSON(const std::string& name) {
+        return getWorker(name).and_then([](const std::shared_ptr<VisionWorker>& worker){
+            try {
+                return WFResult<JSON>::success(pipePlanToJSON(worker->getPreprocessPlan()));
+            } catch (const JSON::exception& e) {
+                return WFResult<JSON>::failure(WFStatus::JSON_UNKNOWN,e.what());
+            }
+        });
+    }
+
+    void VisionWorkerManager::periodic() noexcept {
+        // Latency summaries only need to be fresh enough for a human watching a dashboard
+        constexpr auto LATENCY_PUBLISH_PERIOD = std::chrono::seconds(1);
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastLatencyPublish < LATENCY_PUBLISH_PERIOD) return;
+        lastLatencyPublish = now;
+        try {
+            for (const auto& [name,worker] : workers) {
+                if (auto publisher = ntManager.getDataPublisher(name).lock())
+                    publisher->publishStageLatencies(worker->getStageLatencies());
+            }
+        } catch (...) {
+            this->logger()->error("Unknown exception while publishing worker latencies");
+        }
+    }
+
+    WFResult<VisionWorkerStats> VisionWorkerManager::getWorkerStats(const std::string& name) {
+        return getWorker(name).and_then([](const std::shared_ptr<VisionWorker>& worker){
+            return WFResult<VisionWorkerStats>::success(worker->getStats());
+        });
+    }
 }
\ No newline at end of file
@@ -0,0 +1,38 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "wfcore/processes/VisionWorkerStats.h"
+
+namespace wf {
+    WFResult<JSON> VisionWorkerStats::toJSON_impl(const VisionWorkerStats& stats) {
+        try {
+            JSON jobject = {
+                {"framesProcessed",stats.framesProcessed},
+                {"framesDropped",stats.framesDropped},
+                {"lastCaptureAgeUs",stats.lastCaptureAgeUs},
+                {"meanCaptureAgeUs",stats.meanCaptureAgeUs},
+                {"maxCaptureAgeUs",stats.maxCaptureAgeUs},
+                {"lastAcquireAgeUs",stats.lastAcquireAgeUs}
+            };
+            return jobject;
+        } catch (const JSON::exception& e) {
+            return WFResult<JSON>::failure(WFStatus::JSON_UNKNOWN,e.what());
+        }
+    }
+}
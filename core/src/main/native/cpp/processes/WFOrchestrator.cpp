@@ -57,6 +57,7 @@ namespace wf {
 
     void WFOrchestrator::periodic() noexcept {
         hardwareManager_.periodic();
+        workerManager_.periodic();
     }
 
     WFOrchestrator WFOrchestrator::createFromEnv() {
@@ -140,4 +141,20 @@ namespace wf {
     WFResult<VisionWorkerConfig> WFOrchestrator::getWorkerConfig(const std::string& name) {
         return workerManager_.getWorkerConfig(name);
     }
+
+    WFStatusResult WFOrchestrator::setWorkerConfig(const std::string& name, VisionWorkerConfig config) {
+        return workerManager_.setWorkerConfig(name,std::move(config));
+    }
+
+    WFResult<JSON> WFOrchestrator::getWorkerLatencies_JSON(const std::string& name) {
+        return workerManager_.getWorkerLatencies_JSON(name);
+    }
+
+    WFResult<JSON> WFOrchestrator::getWorkerPlan_JSON(const std::string& name) {
+        return workerManager_.getWorkerPlan_JSON(name);
+    }
+
+    WFResult<VisionWorkerStats> WFOrchestrator::getWorkerStats(const std::string& name) {
+        return workerManager_.getWorkerStats(name);
+    }
 }
\ No newline at end of file
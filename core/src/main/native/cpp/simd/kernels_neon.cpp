@@ -0,0 +1,338 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "wfdetail/simd/simd_kernels.h"
+
+#if defined(__ARM_NEON)
+
+#include <arm_neon.h>
+
+#include <cstring>
+#include <initializer_list>
+
+namespace impl {
+    using namespace wf::simd;
+    using namespace wf::simd::detail;
+
+    static void swapRB3NEON(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept {
+        size_t i = 0;
+        for (; i + 16 <= pixels; i += 16) {
+            uint8x16x3_t v = vld3q_u8(src + 3 * i);
+            const uint8x16_t b = v.val[0];
+            v.val[0] = v.val[2];
+            v.val[2] = b;
+            vst3q_u8(dst + 3 * i, v);
+        }
+        scalar::swapRB3(src + 3 * i, dst + 3 * i, pixels - i);
+    }
+
+    static void swapRB4NEON(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept {
+        size_t i = 0;
+        for (; i + 16 <= pixels; i += 16) {
+            uint8x16x4_t v = vld4q_u8(src + 4 * i);
+            const uint8x16_t b = v.val[0];
+            v.val[0] = v.val[2];
+            v.val[2] = b;
+            vst4q_u8(dst + 4 * i, v);
+        }
+        scalar::swapRB4(src + 4 * i, dst + 4 * i, pixels - i);
+    }
+
+    template <bool swap>
+    static void addAlphaNEON(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept {
+        size_t i = 0;
+        for (; i + 16 <= pixels; i += 16) {
+            const uint8x16x3_t v = vld3q_u8(src + 3 * i);
+            uint8x16x4_t out;
+            out.val[0] = v.val[swap ? 2 : 0];
+            out.val[1] = v.val[1];
+            out.val[2] = v.val[swap ? 0 : 2];
+            out.val[3] = vdupq_n_u8(255);
+            vst4q_u8(dst + 4 * i, out);
+        }
+        if constexpr (swap)
+            scalar::addAlphaSwapRB(src + 3 * i, dst + 4 * i, pixels - i);
+        else
+            scalar::addAlpha(src + 3 * i, dst + 4 * i, pixels - i);
+    }
+
+    template <bool swap>
+    static void dropAlphaNEON(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept {
+        size_t i = 0;
+        for (; i + 16 <= pixels; i += 16) {
+            const uint8x16x4_t v = vld4q_u8(src + 4 * i);
+            uint8x16x3_t out;
+            out.val[0] = v.val[swap ? 2 : 0];
+            out.val[1] = v.val[1];
+            out.val[2] = v.val[swap ? 0 : 2];
+            vst3q_u8(dst + 3 * i, out);
+        }
+        if constexpr (swap)
+            scalar::dropAlphaSwapRB(src + 4 * i, dst + 3 * i, pixels - i);
+        else
+            scalar::dropAlpha(src + 4 * i, dst + 3 * i, pixels - i);
+    }
+
+    static void grayTo3NEON(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept {
+        size_t i = 0;
+        for (; i + 16 <= pixels; i += 16) {
+            const uint8x16_t g = vld1q_u8(src + i);
+            vst3q_u8(dst + 3 * i, uint8x16x3_t{{g, g, g}});
+        }
+        scalar::grayTo3(src + i, dst + 3 * i, pixels - i);
+    }
+
+    static void grayTo4NEON(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept {
+        const uint8x16_t alpha = vdupq_n_u8(255);
+        size_t i = 0;
+        for (; i + 16 <= pixels; i += 16) {
+            const uint8x16_t g = vld1q_u8(src + i);
+            vst4q_u8(dst + 4 * i, uint8x16x4_t{{g, g, g, alpha}});
+        }
+        scalar::grayTo4(src + i, dst + 4 * i, pixels - i);
+    }
+
+    static void deinterleave3NEON(const uint8_t* src, uint8_t* const* planes, size_t pixels) noexcept {
+        size_t i = 0;
+        for (; i + 16 <= pixels; i += 16) {
+            const uint8x16x3_t v = vld3q_u8(src + 3 * i);
+            vst1q_u8(planes[0] + i, v.val[0]);
+            vst1q_u8(planes[1] + i, v.val[1]);
+            vst1q_u8(planes[2] + i, v.val[2]);
+        }
+        uint8_t* const rest[3] = {planes[0] + i, planes[1] + i, planes[2] + i};
+        scalar::deinterleave3(src + 3 * i, rest, pixels - i);
+    }
+
+    static void deinterleave4NEON(const uint8_t* src, uint8_t* const* planes, size_t pixels) noexcept {
+        size_t i = 0;
+        for (; i + 16 <= pixels; i += 16) {
+            const uint8x16x4_t v = vld4q_u8(src + 4 * i);
+            vst1q_u8(planes[0] + i, v.val[0]);
+            vst1q_u8(planes[1] + i, v.val[1]);
+            vst1q_u8(planes[2] + i, v.val[2]);
+            vst1q_u8(planes[3] + i, v.val[3]);
+        }
+        uint8_t* const rest[4] = {planes[0] + i, planes[1] + i, planes[2] + i, planes[3] + i};
+        scalar::deinterleave4(src + 4 * i, rest, pixels - i);
+    }
+
+    static inline void normalize4(uint16x4_t samples, float* dst, const float* scale, const float* bias) noexcept {
+        const float32x4_t v = vcvtq_f32_u32(vmovl_u16(samples));
+        // Kept as a separate multiply and add so the results match the scalar kernel
+        vst1q_f32(dst, vaddq_f32(vmulq_f32(v, vld1q_f32(scale)), vld1q_f32(bias)));
+    }
+
+    static void normalizeNEON(const uint8_t* src, float* dst, size_t samples, int channels, const float* scale, const float* bias) noexcept {
+        alignas(16) float scales[PATTERN_LENGTH];
+        alignas(16) float biases[PATTERN_LENGTH];
+        expandPattern(channels, scale, bias, scales, biases);
+        size_t i = 0;
+        for (; i + PATTERN_LENGTH <= samples; i += PATTERN_LENGTH) {
+            for (size_t k = 0; k < PATTERN_LENGTH; k += 16) {
+                const uint8x16_t b = vld1q_u8(src + i + k);
+                const uint16x8_t lo = vmovl_u8(vget_low_u8(b));
+                const uint16x8_t hi = vmovl_u8(vget_high_u8(b));
+                normalize4(vget_low_u16(lo), dst + i + k, scales + k, biases + k);
+                normalize4(vget_high_u16(lo), dst + i + k + 4, scales + k + 4, biases + k + 4);
+                normalize4(vget_low_u16(hi), dst + i + k + 8, scales + k + 8, biases + k + 8);
+                normalize4(vget_high_u16(hi), dst + i + k + 12, scales + k + 12, biases + k + 12);
+            }
+        }
+        scalar::normalize(src + i, dst + i, samples - i, channels, scale, bias);
+    }
+
+    // Sums horizontal pairs of both rows and rounds the quarter, vrshrn adds the 2 before shifting
+    static inline uint8x8_t boxAverage(uint8x16_t top, uint8x16_t bottom) noexcept {
+        return vrshrn_n_u16(vaddq_u16(vpaddlq_u8(top), vpaddlq_u8(bottom)), 2);
+    }
+
+    static void boxDownsample2xNEON(const uint8_t* row0, const uint8_t* row1, uint8_t* dst, size_t dstPixels, int channels) noexcept {
+        size_t x = 0;
+        switch (channels) {
+            case 1:
+                for (; x + 8 <= dstPixels; x += 8)
+                    vst1_u8(dst + x, boxAverage(vld1q_u8(row0 + 2 * x), vld1q_u8(row1 + 2 * x)));
+                break;
+            case 2:
+                for (; x + 8 <= dstPixels; x += 8) {
+                    const uint8x16x2_t a = vld2q_u8(row0 + 4 * x), b = vld2q_u8(row1 + 4 * x);
+                    vst2_u8(dst + 2 * x, uint8x8x2_t{{boxAverage(a.val[0], b.val[0]), boxAverage(a.val[1], b.val[1])}});
+                }
+                break;
+            case 3:
+                for (; x + 8 <= dstPixels; x += 8) {
+                    const uint8x16x3_t a = vld3q_u8(row0 + 6 * x), b = vld3q_u8(row1 + 6 * x);
+                    vst3_u8(dst + 3 * x, uint8x8x3_t{{
+                        boxAverage(a.val[0], b.val[0]),
+                        boxAverage(a.val[1], b.val[1]),
+                        boxAverage(a.val[2], b.val[2])
+                    }});
+                }
+                break;
+            case 4:
+                for (; x + 8 <= dstPixels; x += 8) {
+                    const uint8x16x4_t a = vld4q_u8(row0 + 8 * x), b = vld4q_u8(row1 + 8 * x);
+                    vst4_u8(dst + 4 * x, uint8x8x4_t{{
+                        boxAverage(a.val[0], b.val[0]),
+                        boxAverage(a.val[1], b.val[1]),
+                        boxAverage(a.val[2], b.val[2]),
+                        boxAverage(a.val[3], b.val[3])
+                    }});
+                }
+                break;
+            default:
+                break;
+        }
+        const size_t cn = static_cast<size_t>(channels);
+        scalar::boxDownsample2x(row0 + 2 * x * cn, row1 + 2 * x * cn, dst + x * cn, dstPixels - x, channels);
+    }
+
+    static void fillNEON(uint8_t* dst, size_t pixels, const uint8_t* pixel, int channels) noexcept {
+        alignas(16) uint8_t pattern[PATTERN_LENGTH];
+        expandPattern(channels, pixel, pattern);
+        const size_t bytes = pixels * channels;
+        // 48 bytes hold a whole number of pixels of any size
+        const uint8x16_t p0 = vld1q_u8(pattern), p1 = vld1q_u8(pattern + 16), p2 = vld1q_u8(pattern + 32);
+        size_t i = 0;
+        for (; i + 48 <= bytes; i += 48) {
+            vst1q_u8(dst + i, p0);
+            vst1q_u8(dst + i + 16, p1);
+            vst1q_u8(dst + i + 32, p2);
+        }
+        if (i < bytes) std::memcpy(dst + i, pattern, bytes - i);
+    }
+
+    static void extractLumaNEON(const uint8_t* src, uint8_t* dst, size_t pixels, int offset) noexcept {
+        size_t x = 0;
+        for (; x + 16 <= pixels; x += 16) {
+            const uint8x16x2_t v = vld2q_u8(src + 2 * x);
+            vst1q_u8(dst + x, v.val[offset]);
+        }
+        scalar::extractLuma(src + 2 * x, dst + x, pixels - x, offset);
+    }
+
+    static void extractLumaDecimatedNEON(const uint8_t* row0, const uint8_t* row1, uint8_t* dst, size_t dstPixels, int offset) noexcept {
+        size_t x = 0;
+        // De-interleaving 4 ways splits the macropixels into their first Y, U, second Y, and V (or U, Y, V, Y)
+        for (; x + 16 <= dstPixels; x += 16) {
+            const uint8x16x4_t a = vld4q_u8(row0 + 4 * x);
+            const uint8x16x4_t b = vld4q_u8(row1 + 4 * x);
+            uint16x8_t lo = vaddl_u8(vget_low_u8(a.val[offset]), vget_low_u8(a.val[offset + 2]));
+            lo = vaddw_u8(vaddw_u8(lo, vget_low_u8(b.val[offset])), vget_low_u8(b.val[offset + 2]));
+            uint16x8_t hi = vaddl_u8(vget_high_u8(a.val[offset]), vget_high_u8(a.val[offset + 2]));
+            hi = vaddw_u8(vaddw_u8(hi, vget_high_u8(b.val[offset])), vget_high_u8(b.val[offset + 2]));
+            vst1q_u8(dst + x, vcombine_u8(vrshrn_n_u16(lo, 2), vrshrn_n_u16(hi, 2)));
+        }
+        scalar::extractLumaDecimated(row0 + 4 * x, row1 + 4 * x, dst + x, dstPixels - x, offset);
+    }
+
+    static void tileMinMax4NEON(const uint8_t* src, size_t stride, uint8_t* mins, uint8_t* maxs, size_t tiles) noexcept {
+        size_t t = 0;
+        for (; t + 8 <= tiles; t += 8) {
+            const uint8_t* p = src + 4 * t;
+            const uint8x16_t a0 = vld1q_u8(p), a1 = vld1q_u8(p + stride), a2 = vld1q_u8(p + 2 * stride), a3 = vld1q_u8(p + 3 * stride);
+            const uint8x16_t b0 = vld1q_u8(p + 16), b1 = vld1q_u8(p + stride + 16), b2 = vld1q_u8(p + 2 * stride + 16), b3 = vld1q_u8(p + 3 * stride + 16);
+            const uint8x16_t lo0 = vminq_u8(vminq_u8(a0, a1), vminq_u8(a2, a3));
+            const uint8x16_t lo1 = vminq_u8(vminq_u8(b0, b1), vminq_u8(b2, b3));
+            const uint8x16_t hi0 = vmaxq_u8(vmaxq_u8(a0, a1), vmaxq_u8(a2, a3));
+            const uint8x16_t hi1 = vmaxq_u8(vmaxq_u8(b0, b1), vmaxq_u8(b2, b3));
+            // Two rounds of pairwise extremes reduce every 4 bytes, one tile, to one
+            const uint8x8_t pairLo0 = vpmin_u8(vget_low_u8(lo0), vget_high_u8(lo0));
+            const uint8x8_t pairLo1 = vpmin_u8(vget_low_u8(lo1), vget_high_u8(lo1));
+            const uint8x8_t pairHi0 = vpmax_u8(vget_low_u8(hi0), vget_high_u8(hi0));
+            const uint8x8_t pairHi1 = vpmax_u8(vget_low_u8(hi1), vget_high_u8(hi1));
+            vst1_u8(mins + t, vpmin_u8(pairLo0, pairLo1));
+            vst1_u8(maxs + t, vpmax_u8(pairHi0, pairHi1));
+        }
+        scalar::tileMinMax4(src + 4 * t, stride, mins + t, maxs + t, tiles - t);
+    }
+
+    // Repeats each of 8 tile values over the 4 pixels of its tile
+    static inline uint8x16x2_t spreadTiles(const uint8_t* values) noexcept {
+        const uint8x8_t v = vld1_u8(values);
+        const uint8x8x2_t pairs = vzip_u8(v, v);
+        const uint8x8x2_t low = vzip_u8(pairs.val[0], pairs.val[0]);
+        const uint8x8x2_t high = vzip_u8(pairs.val[1], pairs.val[1]);
+        return {{vcombine_u8(low.val[0], low.val[1]), vcombine_u8(high.val[0], high.val[1])}};
+    }
+
+    static inline uint8x16_t thresholdPixels(uint8x16_t v, uint8x16_t lo, uint8x16_t hi, uint8x16_t minContrast) noexcept {
+        const uint8x16_t range = vsubq_u8(hi, lo);
+        const uint8x16_t thresh = vaddq_u8(lo, vshrq_n_u8(range, 1));
+        return vbslq_u8(vcltq_u8(range, minContrast), vdupq_n_u8(127), vcgtq_u8(v, thresh));
+    }
+
+    static void thresholdTiles4NEON(const uint8_t* src, uint8_t* dst, const uint8_t* mins, const uint8_t* maxs, size_t tiles, uint8_t minContrast) noexcept {
+        const uint8x16_t contrast = vdupq_n_u8(minContrast);
+        size_t t = 0;
+        for (; t + 8 <= tiles; t += 8) {
+            const uint8x16x2_t lo = spreadTiles(mins + t), hi = spreadTiles(maxs + t);
+            const uint8_t* p = src + 4 * t;
+            vst1q_u8(dst + 4 * t, thresholdPixels(vld1q_u8(p), lo.val[0], hi.val[0], contrast));
+            vst1q_u8(dst + 4 * t + 16, thresholdPixels(vld1q_u8(p + 16), lo.val[1], hi.val[1], contrast));
+        }
+        scalar::thresholdTiles4(src + 4 * t, dst + 4 * t, mins + t, maxs + t, tiles - t, minContrast);
+    }
+
+    static void isolateEdgesNEON(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint8_t* dst, size_t pixels) noexcept {
+        const uint8x16_t gray = vdupq_n_u8(127);
+        size_t i = 0;
+        for (; i + 16 <= pixels; i += 16) {
+            const uint8x16_t v = vld1q_u8(row + i);
+            const uint8x16_t opposite = vmvnq_u8(v);
+            uint8x16_t edge = vorrq_u8(vceqq_u8(vld1q_u8(row + i - 1), opposite), vceqq_u8(vld1q_u8(row + i + 1), opposite));
+            for (const uint8_t* neighbours : {above + i, below + i}) {
+                edge = vorrq_u8(edge, vceqq_u8(vld1q_u8(neighbours - 1), opposite));
+                edge = vorrq_u8(edge, vceqq_u8(vld1q_u8(neighbours), opposite));
+                edge = vorrq_u8(edge, vceqq_u8(vld1q_u8(neighbours + 1), opposite));
+            }
+            vst1q_u8(dst + i, vbslq_u8(edge, v, gray));
+        }
+        scalar::isolateEdges(above + i, row + i, below + i, dst + i, pixels - i);
+    }
+}
+
+namespace wf::simd::detail {
+
+    Kernels makeNEONKernels() noexcept {
+        return {
+            impl::swapRB3NEON,
+            impl::swapRB4NEON,
+            impl::addAlphaNEON<false>,
+            impl::addAlphaNEON<true>,
+            impl::dropAlphaNEON<false>,
+            impl::dropAlphaNEON<true>,
+            impl::grayTo3NEON,
+            impl::grayTo4NEON,
+            impl::deinterleave3NEON,
+            impl::deinterleave4NEON,
+            impl::normalizeNEON,
+            impl::boxDownsample2xNEON,
+            impl::fillNEON,
+            impl::extractLumaNEON,
+            impl::extractLumaDecimatedNEON,
+            impl::tileMinMax4NEON,
+            impl::thresholdTiles4NEON,
+            impl::isolateEdgesNEON
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,204 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "wfdetail/simd/simd_kernels.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace wf::simd::detail {
+
+    namespace scalar {
+
+        void swapRB3(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept {
+            for (size_t i = 0; i < pixels; ++i, src += 3, dst += 3) {
+                const uint8_t b = src[0], g = src[1], r = src[2];
+                dst[0] = r; dst[1] = g; dst[2] = b;
+            }
+        }
+
+        void swapRB4(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept {
+            for (size_t i = 0; i < pixels; ++i, src += 4, dst += 4) {
+                const uint8_t b = src[0], g = src[1], r = src[2], a = src[3];
+                dst[0] = r; dst[1] = g; dst[2] = b; dst[3] = a;
+            }
+        }
+
+        void addAlpha(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept {
+            for (size_t i = 0; i < pixels; ++i, src += 3, dst += 4) {
+                dst[0] = src[0]; dst[1] = src[1]; dst[2] = src[2]; dst[3] = 255;
+            }
+        }
+
+        void addAlphaSwapRB(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept {
+            for (size_t i = 0; i < pixels; ++i, src += 3, dst += 4) {
+                dst[0] = src[2]; dst[1] = src[1]; dst[2] = src[0]; dst[3] = 255;
+            }
+        }
+
+        void dropAlpha(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept {
+            for (size_t i = 0; i < pixels; ++i, src += 4, dst += 3) {
+                dst[0] = src[0]; dst[1] = src[1]; dst[2] = src[2];
+            }
+        }
+
+        void dropAlphaSwapRB(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept {
+            for (size_t i = 0; i < pixels; ++i, src += 4, dst += 3) {
+                dst[0] = src[2]; dst[1] = src[1]; dst[2] = src[0];
+            }
+        }
+
+        void grayTo3(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept {
+            for (size_t i = 0; i < pixels; ++i, dst += 3) {
+                dst[0] = dst[1] = dst[2] = src[i];
+            }
+        }
+
+        void grayTo4(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept {
+            for (size_t i = 0; i < pixels; ++i, dst += 4) {
+                dst[0] = dst[1] = dst[2] = src[i];
+                dst[3] = 255;
+            }
+        }
+
+        void deinterleave3(const uint8_t* src, uint8_t* const* planes, size_t pixels) noexcept {
+            for (size_t i = 0; i < pixels; ++i, src += 3) {
+                planes[0][i] = src[0]; planes[1][i] = src[1]; planes[2][i] = src[2];
+            }
+        }
+
+        void deinterleave4(const uint8_t* src, uint8_t* const* planes, size_t pixels) noexcept {
+            for (size_t i = 0; i < pixels; ++i, src += 4) {
+                planes[0][i] = src[0]; planes[1][i] = src[1]; planes[2][i] = src[2]; planes[3][i] = src[3];
+            }
+        }
+
+        void normalize(const uint8_t* src, float* dst, size_t samples, int channels, const float* scale, const float* bias) noexcept {
+            for (size_t i = 0; i < samples; ++i) {
+                const int c = static_cast<int>(i % channels);
+                dst[i] = static_cast<float>(src[i]) * scale[c] + bias[c];
+            }
+        }
+
+        void boxDownsample2x(const uint8_t* row0, const uint8_t* row1, uint8_t* dst, size_t dstPixels, int channels) noexcept {
+            const size_t cn = static_cast<size_t>(channels);
+            for (size_t x = 0; x < dstPixels; ++x) {
+                for (size_t c = 0; c < cn; ++c) {
+                    const size_t i = 2 * x * cn + c;
+                    dst[x * cn + c] = static_cast<uint8_t>((row0[i] + row0[i + cn] + row1[i] + row1[i + cn] + 2) >> 2);
+                }
+            }
+        }
+
+        void fill(uint8_t* dst, size_t pixels, const uint8_t* pixel, int channels) noexcept {
+            if (channels == 1) {
+                if (pixels > 0) std::memset(dst, pixel[0], pixels);
+                return;
+            }
+            for (size_t i = 0; i < pixels; ++i, dst += channels)
+                std::memcpy(dst, pixel, channels);
+        }
+
+        void extractLuma(const uint8_t* src, uint8_t* dst, size_t pixels, int offset) noexcept {
+            for (size_t x = 0; x < pixels; ++x)
+                dst[x] = src[2 * x + offset];
+        }
+
+        void extractLumaDecimated(const uint8_t* row0, const uint8_t* row1, uint8_t* dst, size_t dstPixels, int offset) noexcept {
+            for (size_t x = 0; x < dstPixels; ++x) {
+                const size_t i = 4 * x + offset;
+                dst[x] = static_cast<uint8_t>((row0[i] + row0[i + 2] + row1[i] + row1[i + 2] + 2) >> 2);
+            }
+        }
+
+        void tileMinMax4(const uint8_t* src, size_t stride, uint8_t* mins, uint8_t* maxs, size_t tiles) noexcept {
+            for (size_t t = 0; t < tiles; ++t) {
+                uint8_t lo = 255, hi = 0;
+                for (size_t dy = 0; dy < 4; ++dy) {
+                    const uint8_t* row = src + dy * stride + 4 * t;
+                    for (size_t dx = 0; dx < 4; ++dx) {
+                        lo = std::min(lo, row[dx]);
+                        hi = std::max(hi, row[dx]);
+                    }
+                }
+                mins[t] = lo;
+                maxs[t] = hi;
+            }
+        }
+
+        void thresholdTiles4(const uint8_t* src, uint8_t* dst, const uint8_t* mins, const uint8_t* maxs, size_t tiles, uint8_t minContrast) noexcept {
+            for (size_t t = 0; t < tiles; ++t, src += 4, dst += 4) {
+                const int lo = mins[t], hi = maxs[t];
+                if (hi - lo < minContrast) {
+                    std::memset(dst, 127, 4);
+                    continue;
+                }
+                const int thresh = lo + (hi - lo) / 2;
+                for (size_t dx = 0; dx < 4; ++dx)
+                    dst[dx] = src[dx] > thresh ? 255 : 0;
+            }
+        }
+
+        void isolateEdges(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint8_t* dst, size_t pixels) noexcept {
+            for (size_t i = 0; i < pixels; ++i) {
+                // n == 255 - v, for the same n as v + n == 255
+                const uint8_t opposite = static_cast<uint8_t>(255 - row[i]);
+                bool edge = row[i - 1] == opposite || row[i + 1] == opposite;
+                for (ptrdiff_t dx = -1; dx <= 1; ++dx)
+                    edge = edge || above[i + dx] == opposite || below[i + dx] == opposite;
+                dst[i] = edge ? row[i] : 127;
+            }
+        }
+    }
+
+    void expandPattern(int channels, const float* scale, const float* bias, float* scalePattern, float* biasPattern) noexcept {
+        for (size_t i = 0; i < PATTERN_LENGTH; ++i) {
+            scalePattern[i] = scale[i % channels];
+            biasPattern[i] = bias[i % channels];
+        }
+    }
+
+    void expandPattern(int channels, const uint8_t* pixel, uint8_t* pattern) noexcept {
+        for (size_t i = 0; i < PATTERN_LENGTH; ++i)
+            pattern[i] = pixel[i % channels];
+    }
+
+    Kernels makeScalarKernels() noexcept {
+        return {
+            scalar::swapRB3,
+            scalar::swapRB4,
+            scalar::addAlpha,
+            scalar::addAlphaSwapRB,
+            scalar::dropAlpha,
+            scalar::dropAlphaSwapRB,
+            scalar::grayTo3,
+            scalar::grayTo4,
+            scalar::deinterleave3,
+            scalar::deinterleave4,
+            scalar::normalize,
+            scalar::boxDownsample2x,
+            scalar::fill,
+            scalar::extractLuma,
+            scalar::extractLumaDecimated,
+            scalar::tileMinMax4,
+            scalar::thresholdTiles4,
+            scalar::isolateEdges
+        };
+    }
+}
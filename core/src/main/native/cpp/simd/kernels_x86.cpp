@@ -0,0 +1,636 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "wfdetail/simd/simd_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>
+
+#include <cstring>
+#include <initializer_list>
+
+// The kernels are compiled for their instruction set regardless of the flags the rest of wfcore is built with,
+// and only run after the dispatcher has checked the CPU supports it
+#define WF_SSE41 __attribute__((target("sse4.1")))
+#define WF_AVX2 __attribute__((target("avx2")))
+
+namespace impl {
+    using namespace wf::simd;
+    using namespace wf::simd::detail;
+
+    // pshufb controls. A negative index zeroes the byte
+    alignas(16) static constexpr int8_t SWAP_RB3[16] = {2,1,0,5,4,3,8,7,6,11,10,9,14,13,12,15};
+    alignas(16) static constexpr int8_t SWAP_RB4[16] = {2,1,0,3,6,5,4,7,10,9,8,11,14,13,12,15};
+    // Alpha bytes are ORed with 0xFF afterwards, so what lands in them doesn't matter
+    alignas(16) static constexpr int8_t ADD_ALPHA[16] = {0,1,2,-1,3,4,5,-1,6,7,8,-1,9,10,11,-1};
+    alignas(16) static constexpr int8_t ADD_ALPHA_SWAP_RB[16] = {2,1,0,-1,5,4,3,-1,8,7,6,-1,11,10,9,-1};
+    alignas(16) static constexpr int8_t DROP_ALPHA[16] = {0,1,2,4,5,6,8,9,10,12,13,14,-1,-1,-1,-1};
+    alignas(16) static constexpr int8_t DROP_ALPHA_SWAP_RB[16] = {2,1,0,6,5,4,10,9,8,14,13,12,-1,-1,-1,-1};
+    alignas(16) static constexpr int8_t GRAY_TO_3[3][16] = {
+        {0,0,0,1,1,1,2,2,2,3,3,3,4,4,4,5},
+        {5,5,6,6,6,7,7,7,8,8,8,9,9,9,10,10},
+        {10,11,11,11,12,12,12,13,13,13,14,14,14,15,15,15}
+    };
+    alignas(16) static constexpr int8_t GRAY_TO_4[16] = {0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3};
+    // Gathers channel c of 16 three channel pixels spread over three vectors: GATHER_3[c][v] picks its bytes out of vector v
+    alignas(16) static constexpr int8_t GATHER_3[3][3][16] = {
+        {
+            {0,3,6,9,12,15,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1},
+            {-1,-1,-1,-1,-1,-1,2,5,8,11,14,-1,-1,-1,-1,-1},
+            {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,1,4,7,10,13}
+        },
+        {
+            {1,4,7,10,13,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1},
+            {-1,-1,-1,-1,-1,0,3,6,9,12,15,-1,-1,-1,-1,-1},
+            {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,2,5,8,11,14}
+        },
+        {
+            {2,5,8,11,14,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1},
+            {-1,-1,-1,-1,-1,1,4,7,10,13,-1,-1,-1,-1,-1,-1},
+            {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,0,3,6,9,12,15}
+        }
+    };
+    // Groups the bytes of four 4 channel pixels by channel
+    alignas(16) static constexpr int8_t GROUP_4[16] = {0,4,8,12,1,5,9,13,2,6,10,14,3,7,11,15};
+    // Widens the first and third, or the second and fourth, 3 channel pixel of a vector to 16 bits
+    alignas(16) static constexpr int8_t EVEN_3[16] = {0,-1,1,-1,2,-1,6,-1,7,-1,8,-1,-1,-1,-1,-1};
+    alignas(16) static constexpr int8_t ODD_3[16] = {3,-1,4,-1,5,-1,9,-1,10,-1,11,-1,-1,-1,-1,-1};
+    // Packs the two 6 byte halves of a vector together
+    alignas(16) static constexpr int8_t COMPACT_3[16] = {0,1,2,3,4,5,8,9,10,11,12,13,-1,-1,-1,-1};
+    // Gathers the first byte of each 32 bit lane, where the tile kernels leave the extremes of each 4 pixel tile
+    alignas(16) static constexpr int8_t TILE_FIRSTS[16] = {0,4,8,12,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1};
+
+    WF_SSE41 static inline __m128i loadMask(const int8_t* mask) noexcept {
+        return _mm_load_si128(reinterpret_cast<const __m128i*>(mask));
+    }
+
+    WF_SSE41 static inline __m128i load128(const uint8_t* src) noexcept {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    }
+
+    WF_SSE41 static inline void store128(uint8_t* dst, __m128i v) noexcept {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), v);
+    }
+
+    // Stores the low 12 bytes of a vector
+    WF_SSE41 static inline void store96(uint8_t* dst, __m128i v) noexcept {
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), v);
+        const int32_t high = _mm_extract_epi32(v, 2);
+        std::memcpy(dst + 8, &high, sizeof(high));
+    }
+
+    WF_SSE41 static inline __m128i load32(const uint8_t* src) noexcept {
+        int32_t v;
+        std::memcpy(&v, src, sizeof(v));
+        return _mm_cvtsi32_si128(v);
+    }
+
+    WF_SSE41 static inline void store32(uint8_t* dst, __m128i v) noexcept {
+        const int32_t low = _mm_cvtsi128_si32(v);
+        std::memcpy(dst, &low, sizeof(low));
+    }
+
+    WF_AVX2 static inline __m256i load256(const uint8_t* src) noexcept {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+    }
+
+    WF_AVX2 static inline void store256(uint8_t* dst, __m256i v) noexcept {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), v);
+    }
+
+    // SSE4.1
+
+    WF_SSE41 static void swapRB3SSE41(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept {
+        const __m128i mask = loadMask(SWAP_RB3);
+        size_t i = 0;
+        // Each vector holds 5 whole pixels and the first byte of the next, which the next store overwrites
+        for (; i + 6 <= pixels; i += 5)
+            store128(dst + 3 * i, _mm_shuffle_epi8(load128(src + 3 * i), mask));
+        scalar::swapRB3(src + 3 * i, dst + 3 * i, pixels - i);
+    }
+
+    WF_SSE41 static void swapRB4SSE41(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept {
+        const __m128i mask = loadMask(SWAP_RB4);
+        size_t i = 0;
+        for (; i + 4 <= pixels; i += 4)
+            store128(dst + 4 * i, _mm_shuffle_epi8(load128(src + 4 * i), mask));
+        scalar::swapRB4(src + 4 * i, dst + 4 * i, pixels - i);
+    }
+
+    WF_SSE41 static void addAlphaOrderedSSE41(const uint8_t* src, uint8_t* dst, size_t pixels, const int8_t* order) noexcept {
+        const __m128i mask = loadMask(order);
+        const __m128i alpha = _mm_set1_epi32(static_cast<int32_t>(0xFF000000u));
+        size_t i = 0;
+        // Reads 16 bytes to expand 12
+        for (; i + 6 <= pixels; i += 4)
+            store128(dst + 4 * i, _mm_or_si128(_mm_shuffle_epi8(load128(src + 3 * i), mask), alpha));
+        if (order == ADD_ALPHA)
+            scalar::addAlpha(src + 3 * i, dst + 4 * i, pixels - i);
+        else
+            scalar::addAlphaSwapRB(src + 3 * i, dst + 4 * i, pixels - i);
+    }
+
+    WF_SSE41 static void addAlphaSSE41(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept {
+        addAlphaOrderedSSE41(src, dst, pixels, ADD_ALPHA);
+    }
+
+    WF_SSE41 static void addAlphaSwapRBSSE41(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept {
+        addAlphaOrderedSSE41(src, dst, pixels, ADD_ALPHA_SWAP_RB);
+    }
+
+    WF_SSE41 static void dropAlphaOrderedSSE41(const uint8_t* src, uint8_t* dst, size_t pixels, const int8_t* order) noexcept {
+        const __m128i mask = loadMask(order);
+        size_t i = 0;
+        for (; i + 4 <= pixels; i += 4)
+            store96(dst + 3 * i, _mm_shuffle_epi8(load128(src + 4 * i), mask));
+        if (order == DROP_ALPHA)
+            scalar::dropAlpha(src + 4 * i, dst + 3 * i, pixels - i);
+        else
+            scalar::dropAlphaSwapRB(src + 4 * i, dst + 3 * i, pixels - i);
+    }
+
+    WF_SSE41 static void dropAlphaSSE41(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept {
+        dropAlphaOrderedSSE41(src, dst, pixels, DROP_ALPHA);
+    }
+
+    WF_SSE41 static void dropAlphaSwapRBSSE41(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept {
+        dropAlphaOrderedSSE41(src, dst, pixels, DROP_ALPHA_SWAP_RB);
+    }
+
+    WF_SSE41 static void grayTo3SSE41(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept {
+        const __m128i m0 = loadMask(GRAY_TO_3[0]);
+        const __m128i m1 = loadMask(GRAY_TO_3[1]);
+        const __m128i m2 = loadMask(GRAY_TO_3[2]);
+        size_t i = 0;
+        for (; i + 16 <= pixels; i += 16) {
+            const __m128i g = load128(src + i);
+            store128(dst + 3 * i, _mm_shuffle_epi8(g, m0));
+            store128(dst + 3 * i + 16, _mm_shuffle_epi8(g, m1));
+            store128(dst + 3 * i + 32, _mm_shuffle_epi8(g, m2));
+        }
+        scalar::grayTo3(src + i, dst + 3 * i, pixels - i);
+    }
+
+    WF_SSE41 static void grayTo4SSE41(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept {
+        const __m128i m0 = loadMask(GRAY_TO_4);
+        const __m128i step = _mm_set1_epi8(4);
+        const __m128i alpha = _mm_set1_epi32(static_cast<int32_t>(0xFF000000u));
+        size_t i = 0;
+        for (; i + 16 <= pixels; i += 16) {
+            const __m128i g = load128(src + i);
+            __m128i mask = m0;
+            for (int k = 0; k < 4; ++k, mask = _mm_add_epi8(mask, step))
+                store128(dst + 4 * i + 16 * k, _mm_or_si128(_mm_shuffle_epi8(g, mask), alpha));
+        }
+        scalar::grayTo4(src + i, dst + 4 * i, pixels - i);
+    }
+
+    WF_SSE41 static void deinterleave3SSE41(const uint8_t* src, uint8_t* const* planes, size_t pixels) noexcept {
+        size_t i = 0;
+        for (; i + 16 <= pixels; i += 16) {
+            const __m128i v[3] = {load128(src + 3 * i), load128(src + 3 * i + 16), load128(src + 3 * i + 32)};
+            for (int c = 0; c < 3; ++c) {
+                const __m128i plane = _mm_or_si128(
+                    _mm_or_si128(_mm_shuffle_epi8(v[0], loadMask(GATHER_3[c][0])), _mm_shuffle_epi8(v[1], loadMask(GATHER_3[c][1]))),
+                    _mm_shuffle_epi8(v[2], loadMask(GATHER_3[c][2]))
+                );
+                store128(planes[c] + i, plane);
+            }
+        }
+        uint8_t* const rest[3] = {planes[0] + i, planes[1] + i, planes[2] + i};
+        scalar::deinterleave3(src + 3 * i, rest, pixels - i);
+    }
+
+    WF_SSE41 static void deinterleave4SSE41(const uint8_t* src, uint8_t* const* planes, size_t pixels) noexcept {
+        const __m128i mask = loadMask(GROUP_4);
+        size_t i = 0;
+        for (; i + 16 <= pixels; i += 16) {
+            // Each vector ends up with one 32 bit lane per channel, so a 4x4 transpose of the lanes gives the planes
+            const __m128i v0 = _mm_shuffle_epi8(load128(src + 4 * i), mask);
+            const __m128i v1 = _mm_shuffle_epi8(load128(src + 4 * i + 16), mask);
+            const __m128i v2 = _mm_shuffle_epi8(load128(src + 4 * i + 32), mask);
+            const __m128i v3 = _mm_shuffle_epi8(load128(src + 4 * i + 48), mask);
+            const __m128i t0 = _mm_unpacklo_epi32(v0, v1);
+            const __m128i t1 = _mm_unpacklo_epi32(v2, v3);
+            const __m128i t2 = _mm_unpackhi_epi32(v0, v1);
+            const __m128i t3 = _mm_unpackhi_epi32(v2, v3);
+            store128(planes[0] + i, _mm_unpacklo_epi64(t0, t1));
+            store128(planes[1] + i, _mm_unpackhi_epi64(t0, t1));
+            store128(planes[2] + i, _mm_unpacklo_epi64(t2, t3));
+            store128(planes[3] + i, _mm_unpackhi_epi64(t2, t3));
+        }
+        uint8_t* const rest[4] = {planes[0] + i, planes[1] + i, planes[2] + i, planes[3] + i};
+        scalar::deinterleave4(src + 4 * i, rest, pixels - i);
+    }
+
+    WF_SSE41 static inline void normalize4(__m128i bytes, float* dst, const float* scale, const float* bias) noexcept {
+        const __m128 v = _mm_cvtepi32_ps(_mm_cvtepu8_epi32(bytes));
+        _mm_storeu_ps(dst, _mm_add_ps(_mm_mul_ps(v, _mm_loadu_ps(scale)), _mm_loadu_ps(bias)));
+    }
+
+    WF_SSE41 static void normalizeSSE41(const uint8_t* src, float* dst, size_t samples, int channels, const float* scale, const float* bias) noexcept {
+        alignas(16) float scales[PATTERN_LENGTH];
+        alignas(16) float biases[PATTERN_LENGTH];
+        expandPattern(channels, scale, bias, scales, biases);
+        size_t i = 0;
+        for (; i + PATTERN_LENGTH <= samples; i += PATTERN_LENGTH) {
+            for (size_t k = 0; k < PATTERN_LENGTH; k += 16) {
+                const __m128i b = load128(src + i + k);
+                normalize4(b, dst + i + k, scales + k, biases + k);
+                normalize4(_mm_srli_si128(b, 4), dst + i + k + 4, scales + k + 4, biases + k + 4);
+                normalize4(_mm_srli_si128(b, 8), dst + i + k + 8, scales + k + 8, biases + k + 8);
+                normalize4(_mm_srli_si128(b, 12), dst + i + k + 12, scales + k + 12, biases + k + 12);
+            }
+        }
+        // Blocks are a whole number of pixels, so the remaining samples still start at the first channel
+        scalar::normalize(src + i, dst + i, samples - i, channels, scale, bias);
+    }
+
+    WF_SSE41 static inline __m128i roundedQuarter(__m128i sums) noexcept {
+        return _mm_srli_epi16(_mm_add_epi16(sums, _mm_set1_epi16(2)), 2);
+    }
+
+    WF_SSE41 static inline __m128i pairSums3(const uint8_t* src) noexcept {
+        const __m128i v = load128(src);
+        return _mm_add_epi16(_mm_shuffle_epi8(v, loadMask(EVEN_3)), _mm_shuffle_epi8(v, loadMask(ODD_3)));
+    }
+
+    WF_SSE41 static void boxDownsample2xSSE41(const uint8_t* row0, const uint8_t* row1, uint8_t* dst, size_t dstPixels, int channels) noexcept {
+        size_t x = 0;
+        if (channels == 1) {
+            const __m128i ones = _mm_set1_epi8(1);
+            for (; x + 16 <= dstPixels; x += 16) {
+                // Multiplying by one and adding neighbours sums each horizontal pair into 16 bits
+                const __m128i a = _mm_add_epi16(_mm_maddubs_epi16(load128(row0 + 2 * x), ones), _mm_maddubs_epi16(load128(row1 + 2 * x), ones));
+                const __m128i b = _mm_add_epi16(_mm_maddubs_epi16(load128(row0 + 2 * x + 16), ones), _mm_maddubs_epi16(load128(row1 + 2 * x + 16), ones));
+                store128(dst + x, _mm_packus_epi16(roundedQuarter(a), roundedQuarter(b)));
+            }
+        } else if (channels == 3) {
+            const __m128i compact = loadMask(COMPACT_3);
+            // Each step reads 28 bytes of both rows for 4 output pixels
+            for (; x + 5 <= dstPixels; x += 4) {
+                const __m128i a = _mm_add_epi16(pairSums3(row0 + 6 * x), pairSums3(row1 + 6 * x));
+                const __m128i b = _mm_add_epi16(pairSums3(row0 + 6 * x + 12), pairSums3(row1 + 6 * x + 12));
+                store96(dst + 3 * x, _mm_shuffle_epi8(_mm_packus_epi16(roundedQuarter(a), roundedQuarter(b)), compact));
+            }
+        } else if (channels == 4) {
+            const __m128i zero = _mm_setzero_si128();
+            for (; x + 4 <= dstPixels; x += 4) {
+                const __m128i r0a = load128(row0 + 8 * x), r0b = load128(row0 + 8 * x + 16);
+                const __m128i r1a = load128(row1 + 8 * x), r1b = load128(row1 + 8 * x + 16);
+                // Vertical sums of pixels 0-1, 2-3, 4-5 and 6-7
+                const __m128i s0 = _mm_add_epi16(_mm_cvtepu8_epi16(r0a), _mm_cvtepu8_epi16(r1a));
+                const __m128i s1 = _mm_add_epi16(_mm_unpackhi_epi8(r0a, zero), _mm_unpackhi_epi8(r1a, zero));
+                const __m128i s2 = _mm_add_epi16(_mm_cvtepu8_epi16(r0b), _mm_cvtepu8_epi16(r1b));
+                const __m128i s3 = _mm_add_epi16(_mm_unpackhi_epi8(r0b, zero), _mm_unpackhi_epi8(r1b, zero));
+                const __m128i a = _mm_add_epi16(_mm_unpacklo_epi64(s0, s1), _mm_unpackhi_epi64(s0, s1));
+                const __m128i b = _mm_add_epi16(_mm_unpacklo_epi64(s2, s3), _mm_unpackhi_epi64(s2, s3));
+                store128(dst + 4 * x, _mm_packus_epi16(roundedQuarter(a), roundedQuarter(b)));
+            }
+        }
+        const size_t cn = static_cast<size_t>(channels);
+        scalar::boxDownsample2x(row0 + 2 * x * cn, row1 + 2 * x * cn, dst + x * cn, dstPixels - x, channels);
+    }
+
+    WF_SSE41 static void fillSSE41(uint8_t* dst, size_t pixels, const uint8_t* pixel, int channels) noexcept {
+        alignas(16) uint8_t pattern[PATTERN_LENGTH];
+        expandPattern(channels, pixel, pattern);
+        const size_t bytes = pixels * channels;
+        // 48 bytes hold a whole number of pixels of any size
+        const __m128i p0 = load128(pattern), p1 = load128(pattern + 16), p2 = load128(pattern + 32);
+        size_t i = 0;
+        for (; i + 48 <= bytes; i += 48) {
+            store128(dst + i, p0);
+            store128(dst + i + 16, p1);
+            store128(dst + i + 32, p2);
+        }
+        if (i < bytes) std::memcpy(dst + i, pattern, bytes - i);
+    }
+
+    // Packed YUV keeps a Y sample in every other byte, so each 16 bit lane holds one at the bottom (YUYV) or top (UYVY)
+    WF_SSE41 static inline __m128i lumaLanes(__m128i v, int offset) noexcept {
+        return offset ? _mm_srli_epi16(v, 8) : _mm_and_si128(v, _mm_set1_epi16(0x00FF));
+    }
+
+    WF_SSE41 static void extractLumaSSE41(const uint8_t* src, uint8_t* dst, size_t pixels, int offset) noexcept {
+        size_t x = 0;
+        for (; x + 16 <= pixels; x += 16) {
+            const __m128i a = lumaLanes(load128(src + 2 * x), offset);
+            const __m128i b = lumaLanes(load128(src + 2 * x + 16), offset);
+            store128(dst + x, _mm_packus_epi16(a, b));
+        }
+        scalar::extractLuma(src + 2 * x, dst + x, pixels - x, offset);
+    }
+
+    WF_SSE41 static void extractLumaDecimatedSSE41(const uint8_t* row0, const uint8_t* row1, uint8_t* dst, size_t dstPixels, int offset) noexcept {
+        const __m128i ones = _mm_set1_epi16(1);
+        const __m128i two = _mm_set1_epi32(2);
+        size_t x = 0;
+        for (; x + 8 <= dstPixels; x += 8) {
+            const __m128i s0 = _mm_add_epi16(lumaLanes(load128(row0 + 4 * x), offset), lumaLanes(load128(row1 + 4 * x), offset));
+            const __m128i s1 = _mm_add_epi16(lumaLanes(load128(row0 + 4 * x + 16), offset), lumaLanes(load128(row1 + 4 * x + 16), offset));
+            // Adding neighbouring 16 bit lanes finishes each 2x2 sum
+            const __m128i h0 = _mm_srli_epi32(_mm_add_epi32(_mm_madd_epi16(s0, ones), two), 2);
+            const __m128i h1 = _mm_srli_epi32(_mm_add_epi32(_mm_madd_epi16(s1, ones), two), 2);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(_mm_packs_epi32(h0, h1), _mm_setzero_si128()));
+        }
+        scalar::extractLumaDecimated(row0 + 4 * x, row1 + 4 * x, dst + x, dstPixels - x, offset);
+    }
+
+    // Reduces each 32 bit lane to its extremes in its first byte. The other bytes are left with partial results
+    WF_SSE41 static inline void reduceTiles(__m128i& lo, __m128i& hi) noexcept {
+        lo = _mm_min_epu8(lo, _mm_srli_epi32(lo, 8));
+        lo = _mm_min_epu8(lo, _mm_srli_epi32(lo, 16));
+        hi = _mm_max_epu8(hi, _mm_srli_epi32(hi, 8));
+        hi = _mm_max_epu8(hi, _mm_srli_epi32(hi, 16));
+    }
+
+    WF_SSE41 static void tileMinMax4SSE41(const uint8_t* src, size_t stride, uint8_t* mins, uint8_t* maxs, size_t tiles) noexcept {
+        const __m128i firsts = loadMask(TILE_FIRSTS);
+        size_t t = 0;
+        for (; t + 4 <= tiles; t += 4) {
+            const uint8_t* p = src + 4 * t;
+            const __m128i r0 = load128(p), r1 = load128(p + stride), r2 = load128(p + 2 * stride), r3 = load128(p + 3 * stride);
+            __m128i lo = _mm_min_epu8(_mm_min_epu8(r0, r1), _mm_min_epu8(r2, r3));
+            __m128i hi = _mm_max_epu8(_mm_max_epu8(r0, r1), _mm_max_epu8(r2, r3));
+            reduceTiles(lo, hi);
+            store32(mins + t, _mm_shuffle_epi8(lo, firsts));
+            store32(maxs + t, _mm_shuffle_epi8(hi, firsts));
+        }
+        scalar::tileMinMax4(src + 4 * t, stride, mins + t, maxs + t, tiles - t);
+    }
+
+    // lo and hi hold the extremes of the tile of each pixel in v
+    WF_SSE41 static inline __m128i thresholdPixels(__m128i v, __m128i lo, __m128i hi, __m128i minContrast) noexcept {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i range = _mm_sub_epi8(hi, lo);
+        // There is no 8 bit shift, so halve in 16 bit lanes and clear what crosses over from the neighbouring byte
+        const __m128i thresh = _mm_add_epi8(lo, _mm_and_si128(_mm_srli_epi16(range, 1), _mm_set1_epi8(0x7F)));
+        const __m128i dark = _mm_cmpeq_epi8(_mm_subs_epu8(v, thresh), zero);
+        const __m128i contrasted = _mm_cmpeq_epi8(_mm_subs_epu8(minContrast, range), zero);
+        return _mm_blendv_epi8(_mm_set1_epi8(127), _mm_xor_si128(dark, _mm_set1_epi8(-1)), contrasted);
+    }
+
+    WF_SSE41 static void thresholdTiles4SSE41(const uint8_t* src, uint8_t* dst, const uint8_t* mins, const uint8_t* maxs, size_t tiles, uint8_t minContrast) noexcept {
+        const __m128i spread = loadMask(GRAY_TO_4);
+        const __m128i contrast = _mm_set1_epi8(static_cast<char>(minContrast));
+        size_t t = 0;
+        for (; t + 4 <= tiles; t += 4) {
+            const __m128i lo = _mm_shuffle_epi8(load32(mins + t), spread);
+            const __m128i hi = _mm_shuffle_epi8(load32(maxs + t), spread);
+            store128(dst + 4 * t, thresholdPixels(load128(src + 4 * t), lo, hi, contrast));
+        }
+        scalar::thresholdTiles4(src + 4 * t, dst + 4 * t, mins + t, maxs + t, tiles - t, minContrast);
+    }
+
+    WF_SSE41 static void isolateEdgesSSE41(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint8_t* dst, size_t pixels) noexcept {
+        const __m128i gray = _mm_set1_epi8(127);
+        const __m128i ones = _mm_set1_epi8(-1);
+        size_t i = 0;
+        for (; i + 16 <= pixels; i += 16) {
+            const __m128i v = load128(row + i);
+            const __m128i opposite = _mm_xor_si128(v, ones);
+            __m128i edge = _mm_or_si128(_mm_cmpeq_epi8(load128(row + i - 1), opposite), _mm_cmpeq_epi8(load128(row + i + 1), opposite));
+            for (const uint8_t* neighbours : {above + i, below + i}) {
+                edge = _mm_or_si128(edge, _mm_cmpeq_epi8(load128(neighbours - 1), opposite));
+                edge = _mm_or_si128(edge, _mm_cmpeq_epi8(load128(neighbours), opposite));
+                edge = _mm_or_si128(edge, _mm_cmpeq_epi8(load128(neighbours + 1), opposite));
+            }
+            store128(dst + i, _mm_blendv_epi8(gray, v, edge));
+        }
+        scalar::isolateEdges(above + i, row + i, below + i, dst + i, pixels - i);
+    }
+
+    // AVX2. Kernels that don't gain much from the wider vectors keep their SSE4.1 versions
+
+    WF_AVX2 static void swapRB4AVX2(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept {
+        const __m256i mask = _mm256_broadcastsi128_si256(loadMask(SWAP_RB4));
+        size_t i = 0;
+        for (; i + 8 <= pixels; i += 8)
+            store256(dst + 4 * i, _mm256_shuffle_epi8(load256(src + 4 * i), mask));
+        swapRB4SSE41(src + 4 * i, dst + 4 * i, pixels - i);
+    }
+
+    WF_AVX2 static void normalizeAVX2(const uint8_t* src, float* dst, size_t samples, int channels, const float* scale, const float* bias) noexcept {
+        alignas(32) float scales[PATTERN_LENGTH];
+        alignas(32) float biases[PATTERN_LENGTH];
+        expandPattern(channels, scale, bias, scales, biases);
+        size_t i = 0;
+        for (; i + PATTERN_LENGTH <= samples; i += PATTERN_LENGTH) {
+            for (size_t k = 0; k < PATTERN_LENGTH; k += 8) {
+                const __m128i b = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i + k));
+                const __m256 v = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(b));
+                _mm256_storeu_ps(dst + i + k, _mm256_add_ps(_mm256_mul_ps(v, _mm256_load_ps(scales + k)), _mm256_load_ps(biases + k)));
+            }
+        }
+        scalar::normalize(src + i, dst + i, samples - i, channels, scale, bias);
+    }
+
+    WF_AVX2 static inline __m256i roundedQuarter(__m256i sums) noexcept {
+        return _mm256_srli_epi16(_mm256_add_epi16(sums, _mm256_set1_epi16(2)), 2);
+    }
+
+    WF_AVX2 static void boxDownsample2xAVX2(const uint8_t* row0, const uint8_t* row1, uint8_t* dst, size_t dstPixels, int channels) noexcept {
+        size_t x = 0;
+        if (channels == 1) {
+            const __m256i ones = _mm256_set1_epi8(1);
+            for (; x + 32 <= dstPixels; x += 32) {
+                const __m256i a = _mm256_add_epi16(_mm256_maddubs_epi16(load256(row0 + 2 * x), ones), _mm256_maddubs_epi16(load256(row1 + 2 * x), ones));
+                const __m256i b = _mm256_add_epi16(_mm256_maddubs_epi16(load256(row0 + 2 * x + 32), ones), _mm256_maddubs_epi16(load256(row1 + 2 * x + 32), ones));
+                // Packing works within 128 bit lanes, so the quadwords come out as a0 b0 a1 b1
+                store256(dst + x, _mm256_permute4x64_epi64(_mm256_packus_epi16(roundedQuarter(a), roundedQuarter(b)), 0xD8));
+            }
+        } else if (channels == 4) {
+            const __m256i order = _mm256_setr_epi32(0,4,1,5,2,6,3,7);
+            for (; x + 8 <= dstPixels; x += 8) {
+                __m256i s[4];
+                for (int k = 0; k < 4; ++k) {
+                    s[k] = _mm256_add_epi16(
+                        _mm256_cvtepu8_epi16(load128(row0 + 8 * x + 16 * k)),
+                        _mm256_cvtepu8_epi16(load128(row1 + 8 * x + 16 * k))
+                    );
+                }
+                // The low lanes hold the even output pixels and the high lanes the odd ones
+                const __m256i a = _mm256_add_epi16(_mm256_unpacklo_epi64(s[0], s[1]), _mm256_unpackhi_epi64(s[0], s[1]));
+                const __m256i b = _mm256_add_epi16(_mm256_unpacklo_epi64(s[2], s[3]), _mm256_unpackhi_epi64(s[2], s[3]));
+                const __m256i packed = _mm256_packus_epi16(roundedQuarter(a), roundedQuarter(b));
+                store256(dst + 4 * x, _mm256_permutevar8x32_epi32(packed, order));
+            }
+        }
+        const size_t cn = static_cast<size_t>(channels);
+        boxDownsample2xSSE41(row0 + 2 * x * cn, row1 + 2 * x * cn, dst + x * cn, dstPixels - x, channels);
+    }
+
+    WF_AVX2 static void fillAVX2(uint8_t* dst, size_t pixels, const uint8_t* pixel, int channels) noexcept {
+        alignas(32) uint8_t pattern[PATTERN_LENGTH];
+        expandPattern(channels, pixel, pattern);
+        const size_t bytes = pixels * channels;
+        const __m256i p0 = load256(pattern), p1 = load256(pattern + 32), p2 = load256(pattern + 64);
+        size_t i = 0;
+        for (; i + PATTERN_LENGTH <= bytes; i += PATTERN_LENGTH) {
+            store256(dst + i, p0);
+            store256(dst + i + 32, p1);
+            store256(dst + i + 64, p2);
+        }
+        if (i < bytes) std::memcpy(dst + i, pattern, bytes - i);
+    }
+
+    WF_AVX2 static inline __m256i lumaLanes(__m256i v, int offset) noexcept {
+        return offset ? _mm256_srli_epi16(v, 8) : _mm256_and_si256(v, _mm256_set1_epi16(0x00FF));
+    }
+
+    WF_AVX2 static void extractLumaAVX2(const uint8_t* src, uint8_t* dst, size_t pixels, int offset) noexcept {
+        size_t x = 0;
+        for (; x + 32 <= pixels; x += 32) {
+            const __m256i a = lumaLanes(load256(src + 2 * x), offset);
+            const __m256i b = lumaLanes(load256(src + 2 * x + 32), offset);
+            // Packing works within 128 bit lanes, so the quadwords come out as a0 b0 a1 b1
+            store256(dst + x, _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8));
+        }
+        extractLumaSSE41(src + 2 * x, dst + x, pixels - x, offset);
+    }
+
+    WF_AVX2 static void extractLumaDecimatedAVX2(const uint8_t* row0, const uint8_t* row1, uint8_t* dst, size_t dstPixels, int offset) noexcept {
+        const __m256i ones = _mm256_set1_epi16(1);
+        const __m256i two = _mm256_set1_epi32(2);
+        const __m256i order = _mm256_setr_epi32(0,4,1,5,2,6,3,7);
+        size_t x = 0;
+        for (; x + 16 <= dstPixels; x += 16) {
+            const __m256i s0 = _mm256_add_epi16(lumaLanes(load256(row0 + 4 * x), offset), lumaLanes(load256(row1 + 4 * x), offset));
+            const __m256i s1 = _mm256_add_epi16(lumaLanes(load256(row0 + 4 * x + 32), offset), lumaLanes(load256(row1 + 4 * x + 32), offset));
+            const __m256i h0 = _mm256_srli_epi32(_mm256_add_epi32(_mm256_madd_epi16(s0, ones), two), 2);
+            const __m256i h1 = _mm256_srli_epi32(_mm256_add_epi32(_mm256_madd_epi16(s1, ones), two), 2);
+            const __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(h0, h1), _mm256_setzero_si256());
+            // Each 128 bit lane holds its outputs in its low doubleword pair, put them back in order
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(packed, order)));
+        }
+        extractLumaDecimatedSSE41(row0 + 4 * x, row1 + 4 * x, dst + x, dstPixels - x, offset);
+    }
+
+    WF_AVX2 static void tileMinMax4AVX2(const uint8_t* src, size_t stride, uint8_t* mins, uint8_t* maxs, size_t tiles) noexcept {
+        const __m256i firsts = _mm256_broadcastsi128_si256(loadMask(TILE_FIRSTS));
+        size_t t = 0;
+        for (; t + 8 <= tiles; t += 8) {
+            const uint8_t* p = src + 4 * t;
+            const __m256i r0 = load256(p), r1 = load256(p + stride), r2 = load256(p + 2 * stride), r3 = load256(p + 3 * stride);
+            __m256i lo = _mm256_min_epu8(_mm256_min_epu8(r0, r1), _mm256_min_epu8(r2, r3));
+            __m256i hi = _mm256_max_epu8(_mm256_max_epu8(r0, r1), _mm256_max_epu8(r2, r3));
+            lo = _mm256_min_epu8(lo, _mm256_srli_epi32(lo, 8));
+            lo = _mm256_min_epu8(lo, _mm256_srli_epi32(lo, 16));
+            hi = _mm256_max_epu8(hi, _mm256_srli_epi32(hi, 8));
+            hi = _mm256_max_epu8(hi, _mm256_srli_epi32(hi, 16));
+            // The shuffle stays within 128 bit lanes, which leaves four tiles at the bottom of each
+            lo = _mm256_shuffle_epi8(lo, firsts);
+            hi = _mm256_shuffle_epi8(hi, firsts);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(mins + t), _mm_unpacklo_epi32(_mm256_castsi256_si128(lo), _mm256_extracti128_si256(lo, 1)));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(maxs + t), _mm_unpacklo_epi32(_mm256_castsi256_si128(hi), _mm256_extracti128_si256(hi, 1)));
+        }
+        tileMinMax4SSE41(src + 4 * t, stride, mins + t, maxs + t, tiles - t);
+    }
+
+    // Repeats each of 8 tile values over the 4 pixels of its tile
+    WF_AVX2 static inline __m256i spreadTiles(const uint8_t* values, __m256i spread) noexcept {
+        const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(values));
+        return _mm256_shuffle_epi8(_mm256_inserti128_si256(_mm256_castsi128_si256(v), _mm_srli_si128(v, 4), 1), spread);
+    }
+
+    WF_AVX2 static void thresholdTiles4AVX2(const uint8_t* src, uint8_t* dst, const uint8_t* mins, const uint8_t* maxs, size_t tiles, uint8_t minContrast) noexcept {
+        const __m256i spread = _mm256_broadcastsi128_si256(loadMask(GRAY_TO_4));
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i contrast = _mm256_set1_epi8(static_cast<char>(minContrast));
+        const __m256i gray = _mm256_set1_epi8(127);
+        const __m256i ones = _mm256_set1_epi8(-1);
+        const __m256i halfMask = _mm256_set1_epi8(0x7F);
+        size_t t = 0;
+        for (; t + 8 <= tiles; t += 8) {
+            const __m256i lo = spreadTiles(mins + t, spread);
+            const __m256i hi = spreadTiles(maxs + t, spread);
+            const __m256i range = _mm256_sub_epi8(hi, lo);
+            const __m256i thresh = _mm256_add_epi8(lo, _mm256_and_si256(_mm256_srli_epi16(range, 1), halfMask));
+            const __m256i dark = _mm256_cmpeq_epi8(_mm256_subs_epu8(load256(src + 4 * t), thresh), zero);
+            const __m256i contrasted = _mm256_cmpeq_epi8(_mm256_subs_epu8(contrast, range), zero);
+            store256(dst + 4 * t, _mm256_blendv_epi8(gray, _mm256_xor_si256(dark, ones), contrasted));
+        }
+        thresholdTiles4SSE41(src + 4 * t, dst + 4 * t, mins + t, maxs + t, tiles - t, minContrast);
+    }
+
+    WF_AVX2 static void isolateEdgesAVX2(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint8_t* dst, size_t pixels) noexcept {
+        const __m256i gray = _mm256_set1_epi8(127);
+        const __m256i ones = _mm256_set1_epi8(-1);
+        size_t i = 0;
+        for (; i + 32 <= pixels; i += 32) {
+            const __m256i v = load256(row + i);
+            const __m256i opposite = _mm256_xor_si256(v, ones);
+            __m256i edge = _mm256_or_si256(_mm256_cmpeq_epi8(load256(row + i - 1), opposite), _mm256_cmpeq_epi8(load256(row + i + 1), opposite));
+            for (const uint8_t* neighbours : {above + i, below + i}) {
+                edge = _mm256_or_si256(edge, _mm256_cmpeq_epi8(load256(neighbours - 1), opposite));
+                edge = _mm256_or_si256(edge, _mm256_cmpeq_epi8(load256(neighbours), opposite));
+                edge = _mm256_or_si256(edge, _mm256_cmpeq_epi8(load256(neighbours + 1), opposite));
+            }
+            store256(dst + i, _mm256_blendv_epi8(gray, v, edge));
+        }
+        isolateEdgesSSE41(above + i, row + i, below + i, dst + i, pixels - i);
+    }
+}
+
+namespace wf::simd::detail {
+
+    Kernels makeSSE41Kernels() noexcept {
+        return {
+            impl::swapRB3SSE41,
+            impl::swapRB4SSE41,
+            impl::addAlphaSSE41,
+            impl::addAlphaSwapRBSSE41,
+            impl::dropAlphaSSE41,
+            impl::dropAlphaSwapRBSSE41,
+            impl::grayTo3SSE41,
+            impl::grayTo4SSE41,
+            impl::deinterleave3SSE41,
+            impl::deinterleave4SSE41,
+            impl::normalizeSSE41,
+            impl::boxDownsample2xSSE41,
+            impl::fillSSE41,
+            impl::extractLumaSSE41,
+            impl::extractLumaDecimatedSSE41,
+            impl::tileMinMax4SSE41,
+            impl::thresholdTiles4SSE41,
+            impl::isolateEdgesSSE41
+        };
+    }
+
+    Kernels makeAVX2Kernels() noexcept {
+        Kernels kernels = makeSSE41Kernels();
+        kernels.swapRB4 = impl::swapRB4AVX2;
+        kernels.normalize = impl::normalizeAVX2;
+        kernels.boxDownsample2x = impl::boxDownsample2xAVX2;
+        kernels.fill = impl::fillAVX2;
+        kernels.extractLuma = impl::extractLumaAVX2;
+        kernels.extractLumaDecimated = impl::extractLumaDecimatedAVX2;
+        kernels.tileMinMax4 = impl::tileMinMax4AVX2;
+        kernels.thresholdTiles4 = impl::thresholdTiles4AVX2;
+        kernels.isolateEdges = impl::isolateEdgesAVX2;
+        return kernels;
+    }
+}
+
+#undef WF_SSE41
+#undef WF_AVX2
+
+#endif
@@ -0,0 +1,148 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "wfcore/simd/simd.h"
+#include "wfdetail/simd/simd_kernels.h"
+#include "wfcore/common/envutils.h"
+#include "wfcore/common/logging.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <optional>
+#include <string>
+
+namespace impl {
+    using namespace wf;
+    using namespace wf::simd;
+
+    static constexpr std::array<SimdLevel,4> LEVELS = {
+        SimdLevel::Scalar,
+        SimdLevel::SSE41,
+        SimdLevel::AVX2,
+        SimdLevel::NEON
+    };
+
+    static bool cpuSupports(SimdLevel level) noexcept {
+        switch (level) {
+            case SimdLevel::Scalar:
+                return true;
+#if defined(__x86_64__) || defined(__i386__)
+            case SimdLevel::SSE41:
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("sse4.1");
+            case SimdLevel::AVX2:
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("avx2");
+#endif
+#if defined(__ARM_NEON)
+            // The NEON kernels are only built when the compiler already targets NEON, which every aarch64 CPU has
+            case SimdLevel::NEON:
+                return true;
+#endif
+            default:
+                return false;
+        }
+    }
+
+    static std::array<Kernels,LEVELS.size()> buildTables() noexcept {
+        using namespace wf::simd::detail;
+        const Kernels scalar = makeScalarKernels();
+        std::array<Kernels,LEVELS.size()> tables;
+        tables.fill(scalar);
+#if defined(__x86_64__) || defined(__i386__)
+        if (cpuSupports(SimdLevel::SSE41)) tables[static_cast<size_t>(SimdLevel::SSE41)] = makeSSE41Kernels();
+        if (cpuSupports(SimdLevel::AVX2)) tables[static_cast<size_t>(SimdLevel::AVX2)] = makeAVX2Kernels();
+#endif
+#if defined(__ARM_NEON)
+        tables[static_cast<size_t>(SimdLevel::NEON)] = makeNEONKernels();
+#endif
+        return tables;
+    }
+
+    static const std::array<Kernels,LEVELS.size()>& tables() noexcept {
+        static const auto tables = buildTables();
+        return tables;
+    }
+
+    static std::optional<SimdLevel> parseLevel(std::string name) {
+        std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::tolower(c); });
+        for (auto level : LEVELS) {
+            if (name == getLevelName(level)) return level;
+        }
+        return std::nullopt;
+    }
+
+    static SimdLevel chooseLevel() {
+        static loggerPtr logger = LoggerManager::getInstance().getLogger("SIMD");
+        SimdLevel best = SimdLevel::Scalar;
+        for (auto level : LEVELS) {
+            if (cpuSupports(level)) best = level;
+        }
+        if (auto requested = env::getVar("WF_SIMD")) {
+            auto level = parseLevel(*requested);
+            if (!level) {
+                logger->warn("Unknown WF_SIMD level '{}', using {}", *requested, getLevelName(best));
+            } else if (!cpuSupports(*level)) {
+                logger->warn("WF_SIMD level {} isn't supported on this machine, using {}", *requested, getLevelName(best));
+            } else {
+                best = *level;
+            }
+        }
+        logger->info("Using {} image kernels", getLevelName(best));
+        return best;
+    }
+}
+
+namespace wf::simd {
+
+    std::string_view getLevelName(SimdLevel level) noexcept {
+        switch (level) {
+            case SimdLevel::Scalar: return "scalar";
+            case SimdLevel::SSE41: return "sse4.1";
+            case SimdLevel::AVX2: return "avx2";
+            case SimdLevel::NEON: return "neon";
+        }
+        return "unknown";
+    }
+
+    bool isSupported(SimdLevel level) noexcept {
+        return impl::cpuSupports(level);
+    }
+
+    SimdLevel getActiveLevel() noexcept {
+        static const SimdLevel active = [] {
+            try {
+                return impl::chooseLevel();
+            } catch (...) {
+                return SimdLevel::Scalar;
+            }
+        }();
+        return active;
+    }
+
+    const Kernels& getKernels(SimdLevel level) noexcept {
+        return impl::tables()[isSupported(level) ? static_cast<size_t>(level) : 0];
+    }
+
+    const Kernels& kernels() noexcept {
+        static const Kernels& active = getKernels(getActiveLevel());
+        return active;
+    }
+}
@@ -0,0 +1,116 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "wfcore/utils/LatencyHistogram.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace wf {
+
+    int LatencyHistogram::bucketIndex(uint64_t micros) noexcept {
+        if (micros < SUB_BUCKETS)
+            return static_cast<int>(micros);
+        const int magnitude = std::bit_width(micros) - 1; // floor(log2(micros)), at least SUB_BUCKET_BITS here
+        if (magnitude >= MAX_MAGNITUDE)
+            return NUM_BUCKETS - 1;
+        const int shift = magnitude - SUB_BUCKET_BITS;
+        const int sub = static_cast<int>(micros >> shift) - SUB_BUCKETS;
+        return SUB_BUCKETS + shift * SUB_BUCKETS + sub;
+    }
+
+    uint64_t LatencyHistogram::bucketLowerBound(int index) noexcept {
+        if (index < SUB_BUCKETS)
+            return static_cast<uint64_t>(index);
+        const int shift = (index - SUB_BUCKETS) / SUB_BUCKETS;
+        const int sub = (index - SUB_BUCKETS) % SUB_BUCKETS;
+        return static_cast<uint64_t>(SUB_BUCKETS + sub) << shift;
+    }
+
+    uint64_t LatencyHistogram::bucketUpperBound(int index) noexcept {
+        if (index < SUB_BUCKETS)
+            return static_cast<uint64_t>(index);
+        const int shift = (index - SUB_BUCKETS) / SUB_BUCKETS;
+        return bucketLowerBound(index) + (uint64_t{1} << shift) - 1;
+    }
+
+    void LatencyHistogram::record(uint64_t micros) noexcept {
+        buckets_[bucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(micros, std::memory_order_relaxed);
+        uint64_t prevMax = max_.load(std::memory_order_relaxed);
+        while (micros > prevMax && !max_.compare_exchange_weak(prevMax, micros, std::memory_order_relaxed));
+    }
+
+    void LatencyHistogram::reset() noexcept {
+        for (auto& bucket : buckets_)
+            bucket.store(0, std::memory_order_relaxed);
+        count_.store(0, std::memory_order_relaxed);
+        sum_.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    double LatencyHistogram::mean() const noexcept {
+        const auto n = count();
+        return n ? static_cast<double>(sum_.load(std::memory_order_relaxed)) / static_cast<double>(n) : 0.0;
+    }
+
+    uint64_t LatencyHistogram::percentile(double p) const noexcept {
+        // Sum the buckets instead of trusting count_, which may be slightly ahead of them while recording
+        uint64_t total = 0;
+        for (const auto& bucket : buckets_)
+            total += bucket.load(std::memory_order_relaxed);
+        if (total == 0) return 0;
+        const double clamped = std::clamp(p, 0.0, 100.0);
+        const uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(clamped / 100.0 * static_cast<double>(total))));
+        uint64_t seen = 0;
+        for (int i = 0; i < NUM_BUCKETS; ++i) {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen >= target)
+                return std::min(bucketUpperBound(i), max());
+        }
+        return max();
+    }
+
+    JSON LatencyHistogram::toJSON() const {
+        JSON buckets = JSON::array();
+        for (int i = 0; i < NUM_BUCKETS; ++i) {
+            auto n = buckets_[i].load(std::memory_order_relaxed);
+            if (n) buckets.push_back({bucketLowerBound(i), n});
+        }
+        return {
+            {"count",count()},
+            {"meanUs",mean()},
+            {"p50Us",percentile(50.0)},
+            {"p90Us",percentile(90.0)},
+            {"p99Us",percentile(99.0)},
+            {"p999Us",percentile(99.9)},
+            {"maxUs",max()},
+            {"buckets",std::move(buckets)}
+        };
+    }
+
+    JSON stageLatenciesToJSON(const std::vector<StageLatency>& stages) {
+        JSON jobject = JSON::object();
+        for (const auto& [stage,histogram] : stages)
+            jobject[stage] = histogram->toJSON();
+        return jobject;
+    }
+}
@@ -0,0 +1,137 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "wfcore/video/FramePool.h"
+#include "wfcore/video/video_utils.h"
+#include "wfcore/common/wfexcept.h"
+
+#include <new>
+
+namespace impl {
+    using namespace wf;
+
+    static void retain(FramePoolSlot* slot) noexcept {
+        if (slot) slot->refcount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void release(FramePoolSlot* slot) noexcept {
+        if (!slot) return;
+        if (slot->refcount.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+        // This was the last handle. The slot can't be retained again until it is marked free,
+        // so it is safe to take the owner reference out first. Marking the slot free before
+        // dropping the reference means the pool is never destroyed while a slot is still busy
+        auto keepAlive = std::move(slot->owner);
+        slot->inUse.store(false, std::memory_order_release);
+    }
+}
+
+namespace wf {
+
+    FrameHandle::FrameHandle(const FrameHandle& other) noexcept : slot_(other.slot_) {
+        impl::retain(slot_);
+    }
+
+    FrameHandle::FrameHandle(FrameHandle&& other) noexcept : slot_(other.slot_) {
+        other.slot_ = nullptr;
+    }
+
+    FrameHandle& FrameHandle::operator=(const FrameHandle& other) noexcept {
+        if (slot_ == other.slot_) return *this;
+        impl::retain(other.slot_);
+        impl::release(slot_);
+        slot_ = other.slot_;
+        return *this;
+    }
+
+    FrameHandle& FrameHandle::operator=(FrameHandle&& other) noexcept {
+        if (this == &other) return *this;
+        impl::release(slot_);
+        slot_ = other.slot_;
+        other.slot_ = nullptr;
+        return *this;
+    }
+
+    void FrameHandle::reset() noexcept {
+        impl::release(slot_);
+        slot_ = nullptr;
+    }
+
+    std::shared_ptr<FramePool> FramePool::create(FrameFormat format, size_t frames) {
+        // FramePool's constructor is private, so std::make_shared can't be used here
+        return std::shared_ptr<FramePool>(new FramePool(std::move(format), frames));
+    }
+
+    FramePool::FramePool(FrameFormat format, size_t frames)
+    : format_(std::move(format))
+    , numFrames_(frames)
+    , slots_(std::make_unique<FramePoolSlot[]>(frames))
+    , nextSlot_(0), acquisitions_(0), exhaustions_(0), allocations_(0) {
+        if (format_.width <= 0 || format_.height <= 0 || format_.encoding == ImageEncoding::MJPEG || format_.encoding == ImageEncoding::UNKNOWN)
+            throw invalid_stream_format("FramePool frames must have a raw encoding and a nonzero size");
+        const int cvType = getCVTypeFromEncoding(format_.encoding);
+        const size_t bytes = static_cast<size_t>(format_.width) * format_.height * CV_ELEM_SIZE(cvType);
+        for (size_t i = 0; i < numFrames_; ++i) {
+            auto& slot = slots_[i];
+            slot.data = ::operator new(bytes, std::align_val_t(ALIGNMENT));
+            allocations_.fetch_add(1, std::memory_order_relaxed);
+            slot.mat = cv::Mat(format_.height, format_.width, cvType, slot.data);
+        }
+    }
+
+    FramePool::~FramePool() {
+        // Every slot holds a reference to the pool while it is in use, so all slots are free here
+        for (size_t i = 0; i < numFrames_; ++i) {
+            slots_[i].mat.release();
+            ::operator delete(slots_[i].data, std::align_val_t(ALIGNMENT));
+        }
+    }
+
+    FrameHandle FramePool::acquire() noexcept {
+        // Start scanning where the last acquisition left off, so frames are recycled round-robin
+        const size_t start = nextSlot_.fetch_add(1, std::memory_order_relaxed);
+        for (size_t n = 0; n < numFrames_; ++n) {
+            auto& slot = slots_[(start + n) % numFrames_];
+            bool expected = false;
+            if (slot.inUse.load(std::memory_order_relaxed)
+                || !slot.inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                continue;
+            slot.owner = shared_from_this();
+            slot.refcount.store(1, std::memory_order_release);
+            acquisitions_.fetch_add(1, std::memory_order_relaxed);
+            return FrameHandle(&slot);
+        }
+        exhaustions_.fetch_add(1, std::memory_order_relaxed);
+        return FrameHandle();
+    }
+
+    FramePool::Stats FramePool::getStats() const noexcept {
+        size_t inUse = 0;
+        for (size_t i = 0; i < numFrames_; ++i) {
+            if (slots_[i].inUse.load(std::memory_order_relaxed))
+                ++inUse;
+        }
+        return {
+            numFrames_,
+            inUse,
+            acquisitions_.load(std::memory_order_relaxed),
+            exhaustions_.load(std::memory_order_relaxed),
+            allocations_.load(std::memory_order_relaxed)
+        };
+    }
+}
@@ -0,0 +1,88 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "wfcore/video/FramePyramid.h"
+#include "wfcore/simd/simd.h"
+
+#include <opencv2/imgproc.hpp>
+
+#include <algorithm>
+
+namespace wf {
+
+    void FramePyramid::reset(const cv::Mat& base_, ImageEncoding encoding_) noexcept {
+        levels[0] = base_;
+        levelCount = getLevelCount(encoding_);
+        while (levelCount > 1 && getLevelSize(base_.size(),levelCount - 1).area() == 0)
+            --levelCount;
+        built.store(1, std::memory_order_release);
+    }
+
+    const cv::Mat& FramePyramid::getLevel(int level) {
+        level = std::clamp(level,0,levelCount - 1);
+        if (level < built.load(std::memory_order_acquire))
+            return levels[level];
+        std::lock_guard lock(buildMutex);
+        for (int n = built.load(std::memory_order_relaxed); n <= level; ++n) {
+            const cv::Mat& above = levels[n - 1];
+            const cv::Size size = getLevelSize(above.size(),1);
+            if (above.depth() == CV_8U) {
+                // Same result as the exact 2x2 INTER_AREA path below, without depending on how OpenCV was built
+                levels[n].create(size,above.type());
+                const auto& kernels = simd::kernels();
+                for (int y = 0; y < size.height; ++y)
+                    kernels.boxDownsample2x(above.ptr(2 * y),above.ptr(2 * y + 1),levels[n].ptr(y),size.width,above.channels());
+            } else {
+                // Filtering an even sized region keeps OpenCV on its exact 2x2 path, an odd last row or column is dropped
+                cv::resize(
+                    above(cv::Rect(0,0,size.width * 2,size.height * 2)),
+                    levels[n],
+                    size,0,0,
+                    cv::INTER_AREA
+                );
+            }
+            built.store(n + 1, std::memory_order_release);
+        }
+        return levels[level];
+    }
+
+    int FramePyramid::getLevelCount(ImageEncoding encoding) noexcept {
+        switch (encoding) {
+            case ImageEncoding::BGR24:
+            case ImageEncoding::RGB24:
+            case ImageEncoding::BGRA:
+            case ImageEncoding::RGBA:
+            case ImageEncoding::Y8:
+            case ImageEncoding::Y16:
+                return LEVELS;
+            default:
+                return 1;
+        }
+    }
+
+    int FramePyramid::chooseLevel(const FrameFormat& format, cv::Size size) noexcept {
+        int level = 0;
+        while (level + 1 < getLevelCount(format.encoding)) {
+            const cv::Size next = getLevelSize(format.size(),level + 1);
+            if (next.width < size.width || next.height < size.height) break;
+            ++level;
+        }
+        return level;
+    }
+}
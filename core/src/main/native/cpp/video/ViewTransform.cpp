@@ -0,0 +1,126 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "wfcore/video/ViewTransform.h"
+
+#include <utility>
+
+namespace impl {
+    using namespace wf;
+
+    static cv::Size turned(cv::Size size, int quarterTurns) {
+        return (quarterTurns % 2) ? cv::Size(size.height,size.width) : size;
+    }
+
+    // Maps across a resize between frames of size from and to, keeping pixel centers on pixel centers like cv::resize
+    static double rescale(double coord, int from, int to) {
+        return (coord + 0.5) * to / from - 0.5;
+    }
+}
+
+namespace wf {
+
+    ViewTransform::ViewTransform(int quarterTurns_, cv::Size sourceSize_, cv::Size viewSize_)
+    : quarterTurns(((quarterTurns_ % 4) + 4) % 4), sourceSize(sourceSize_), viewSize(viewSize_) {}
+
+    ViewTransform ViewTransform::rotation(cv::Size size, int rotation) {
+        switch (rotation) {
+            case cv::ROTATE_90_CLOCKWISE: return ViewTransform(1,size,impl::turned(size,1));
+            case cv::ROTATE_180: return ViewTransform(2,size,size);
+            case cv::ROTATE_90_COUNTERCLOCKWISE: return ViewTransform(3,size,impl::turned(size,3));
+            default: return identity(size);
+        }
+    }
+
+    ViewTransform ViewTransform::then(const ViewTransform& next) const {
+        // A scale followed by a turn is the same turn followed by the scale with its axes swapped,
+        // so the turns add up and the scale still only depends on the sizes at either end
+        return ViewTransform(quarterTurns + next.quarterTurns,sourceSize,next.viewSize);
+    }
+
+    cv::Point2d ViewTransform::apply(cv::Point2d point) const noexcept {
+        const double right = sourceSize.width - 1;
+        const double bottom = sourceSize.height - 1;
+        cv::Point2d turnedPoint;
+        switch (quarterTurns) {
+            case 1: turnedPoint = cv::Point2d(bottom - point.y,point.x); break;
+            case 2: turnedPoint = cv::Point2d(right - point.x,bottom - point.y); break;
+            case 3: turnedPoint = cv::Point2d(point.y,right - point.x); break;
+            default: turnedPoint = point;
+        }
+        const cv::Size turnedSize = impl::turned(sourceSize,quarterTurns);
+        return cv::Point2d(
+            impl::rescale(turnedPoint.x,turnedSize.width,viewSize.width),
+            impl::rescale(turnedPoint.y,turnedSize.height,viewSize.height)
+        );
+    }
+
+    cv::Point2d ViewTransform::applyNormalized(cv::Point2d point) const noexcept {
+        switch (quarterTurns) {
+            case 1: return cv::Point2d(1.0 - point.y,point.x);
+            case 2: return cv::Point2d(1.0 - point.x,1.0 - point.y);
+            case 3: return cv::Point2d(point.y,1.0 - point.x);
+            default: return point;
+        }
+    }
+
+    CameraIntrinsics ViewTransform::apply(const CameraIntrinsics& intrinsics) const {
+        if (intrinsics.cameraMatrix.rows != 3 || intrinsics.cameraMatrix.cols != 3)
+            return intrinsics;
+        cv::Mat cameraMatrix;
+        intrinsics.cameraMatrix.convertTo(cameraMatrix,CV_64F);
+        double fx = cameraMatrix.at<double>(0,0);
+        double fy = cameraMatrix.at<double>(1,1);
+        double cx = cameraMatrix.at<double>(0,2);
+        double cy = cameraMatrix.at<double>(1,2);
+        cv::Mat distCoeffs;
+        intrinsics.distCoeffs.convertTo(distCoeffs,CV_64F);
+        // The calibration may have been made at another resolution than the source frames
+        const cv::Size calibrated = intrinsics.resolution.area() > 0 ? intrinsics.resolution : sourceSize;
+        cx = impl::rescale(cx,calibrated.width,sourceSize.width);
+        cy = impl::rescale(cy,calibrated.height,sourceSize.height);
+        fx *= static_cast<double>(sourceSize.width) / calibrated.width;
+        fy *= static_cast<double>(sourceSize.height) / calibrated.height;
+
+        cv::Size size = sourceSize;
+        for (int turn = 0; turn < quarterTurns; ++turn) {
+            // Turning the image clockwise takes (x,y) to (height - 1 - y,x), and normalized image coordinates
+            // from (x,y) to (-y,x). The radial terms don't notice, and (p1,p2) becomes (p2,-p1).
+            // Thin prism and tilt terms, if any, are kept as they are
+            const double nextCx = size.height - 1 - cy;
+            cy = cx;
+            cx = nextCx;
+            std::swap(fx,fy);
+            if (distCoeffs.total() >= 4) {
+                double* coeffs = distCoeffs.ptr<double>();
+                const double p1 = coeffs[2];
+                coeffs[2] = coeffs[3];
+                coeffs[3] = -p1;
+            }
+            size = impl::turned(size,1);
+        }
+        fx *= static_cast<double>(viewSize.width) / size.width;
+        fy *= static_cast<double>(viewSize.height) / size.height;
+        cx = impl::rescale(cx,size.width,viewSize.width);
+        cy = impl::rescale(cy,size.height,viewSize.height);
+
+        cv::Mat viewMatrix = (cv::Mat_<double>(3,3) << fx, 0, cx, 0, fy, cy, 0, 0, 1);
+        return CameraIntrinsics(viewSize,std::move(viewMatrix),std::move(distCoeffs));
+    }
+}
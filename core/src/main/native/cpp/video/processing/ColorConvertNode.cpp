@@ -19,10 +19,44 @@
 
 #include "wfcore/video/processing/ColorConvertNode.h"
 #include "wfcore/common/wfexcept.h"
+#include "wfcore/simd/simd.h"
 #include <opencv2/imgproc.hpp>
 
 #include <stdexcept>
 #include <cassert>
+#include <format>
+#include <type_traits>
+
+namespace impl {
+    using namespace wf;
+    using enum ImageEncoding;
+
+    using ShuffleKernel = void (*)(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept;
+
+    // Conversions that only move bytes around. The SIMD kernels give exactly the same result as cvtColor for these
+    static ShuffleKernel getShuffleKernel(ImageEncoding from, ImageEncoding to) noexcept {
+        const auto& kernels = simd::kernels();
+        if ((from == BGR24 && to == RGB24) || (from == RGB24 && to == BGR24)) return kernels.swapRB3;
+        if ((from == BGRA && to == RGBA) || (from == RGBA && to == BGRA)) return kernels.swapRB4;
+        if ((from == BGR24 && to == BGRA) || (from == RGB24 && to == RGBA)) return kernels.addAlpha;
+        if ((from == BGR24 && to == RGBA) || (from == RGB24 && to == BGRA)) return kernels.addAlphaSwapRB;
+        if ((from == BGRA && to == BGR24) || (from == RGBA && to == RGB24)) return kernels.dropAlpha;
+        if ((from == BGRA && to == RGB24) || (from == RGBA && to == BGR24)) return kernels.dropAlphaSwapRB;
+        if (from == Y8 && (to == BGR24 || to == RGB24)) return kernels.grayTo3;
+        if (from == Y8 && (to == BGRA || to == RGBA)) return kernels.grayTo4;
+        return nullptr;
+    }
+
+    static void shuffleRows(const cv::Mat& in, cv::Mat& out, int outType, ShuffleKernel kernel) {
+        out.create(in.size(),outType);
+        if (in.isContinuous() && out.isContinuous()) {
+            kernel(in.data,out.data,in.total());
+            return;
+        }
+        for (int y = 0; y < in.rows; ++y)
+            kernel(in.ptr(y),out.ptr(y),in.cols);
+    }
+}
 
 namespace wf {
 
@@ -48,6 +82,12 @@ namespace wf {
         colorConverter(*(this->inpad),this->outpad);
     }
 
+    template <CVImage T>
+    void ColorConvertNode<T>::processRows(const cv::Range& outRows, int stripe) noexcept {
+        T out = this->outpad.rowRange(outRows);
+        colorConverter(this->inpad->rowRange(outRows),out);
+    }
+
     template <CVImage T>
     void ColorConvertNode<T>::updateColorConverter() {
         switch (*(this->incoding)) {
@@ -162,7 +202,7 @@ namespace wf {
                         break;
                     case Y8:
                         colorConverter = [](const T& in,T& out){
-                            cv::cvtColor(out,in,cv::COLOR_BGR5652GRAY);
+                            cv::cvtColor(in,out,cv::COLOR_BGR5652GRAY);
                         };
                         break;
                     case Y16:
@@ -476,9 +516,28 @@ namespace wf {
             default:
                 throw invalid_image_encoding("Attempted to convert from unknown colorspace");
         };
+        const auto from = *(this->incoding);
+        pixelwise = from != this->outcoding
+            && from != Y16 && this->outcoding != Y16
+            && !((from == YUYV || from == UYVY) && this->outcoding == RGB565);
+
+        if constexpr (std::is_same_v<T,cv::Mat>) {
+            // Pure channel shuffles skip cvtColor, so they run at the same speed however OpenCV was built
+            if (auto kernel = impl::getShuffleKernel(from,this->outcoding)) {
+                const int outType = getCVTypeFromEncoding(this->outcoding);
+                colorConverter = [kernel,outType](const T& in,T& out){
+                    impl::shuffleRows(in,out,outType,kernel);
+                };
+            }
+        }
 
     }
 
+    template <CVImage T>
+    std::string ColorConvertNode<T>::describe() const {
+        return std::format("ColorConvert {} -> {}",getEncodingName(*(this->incoding)),getEncodingName(this->outcoding));
+    }
+
     template class ColorConvertNode<cv::Mat>;
     template class ColorConvertNode<cv::UMat>;
 }
@@ -0,0 +1,279 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "wfcore/video/processing/FusedNode.h"
+#include "wfcore/common/logging.h"
+
+#include <opencv2/imgproc.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <type_traits>
+
+namespace impl {
+    using namespace wf;
+
+    // Target size of one band of input, small enough to stay resident in L2 together with its stripe
+    static constexpr size_t BAND_BYTES = 64 * 1024;
+
+    // Interpolations that only read source rows inside the band for a downscale
+    static bool isBandSafe(int interpolation) {
+        return interpolation == cv::INTER_NEAREST
+            || interpolation == cv::INTER_LINEAR
+            || interpolation == cv::INTER_AREA;
+    }
+
+    // Splits a vertical rescale from srcRows to dstRows into steps of whole source and destination rows,
+    // so every band samples the source exactly like the full frame does. Scaling a band by the same
+    // rational factor as the full frame gives cv::resize bit-identical coefficients.
+    // Returns false for upscales, where interpolation reads across band edges, and for frames that fit in a single band
+    static bool planBands(int srcRows, int dstRows, size_t srcRowBytes, int& srcStep, int& dstStep, int& bandSteps) {
+        if (dstRows <= 0 || srcRows < dstRows || srcRowBytes == 0) return false;
+        const int steps = std::gcd(srcRows,dstRows);
+        srcStep = srcRows / steps;
+        dstStep = dstRows / steps;
+        bandSteps = std::max<int>(1, BAND_BYTES / (srcStep * srcRowBytes));
+        return bandSteps < steps;
+    }
+
+    static std::unique_ptr<CVProcessNode<cv::Mat>> fusePair(
+        std::unique_ptr<CVProcessNode<cv::Mat>>& first,
+        std::unique_ptr<CVProcessNode<cv::Mat>>& second
+    ) {
+        const bool secondConverts = dynamic_cast<ColorConvertNode<cv::Mat>*>(second.get()) != nullptr;
+        if (dynamic_cast<ResizeNode<cv::Mat>*>(first.get()) && secondConverts)
+            return std::make_unique<ResizeConvertNode>(std::move(first),std::move(second));
+        if (dynamic_cast<RotateNode<cv::Mat>*>(first.get()) && secondConverts)
+            return std::make_unique<RotateConvertNode>(std::move(first),std::move(second));
+        if (dynamic_cast<ColorConvertNode<cv::Mat>*>(first.get())) {
+            if (dynamic_cast<ResizeNode<cv::Mat>*>(second.get()))
+                return std::make_unique<ConvertResizeNode>(std::move(first),std::move(second));
+            if (dynamic_cast<LetterboxNode<cv::Mat>*>(second.get()))
+                return std::make_unique<ConvertLetterboxNode>(std::move(first),std::move(second));
+        }
+        return nullptr;
+    }
+}
+
+namespace wf {
+
+    static loggerPtr logger = LoggerManager::getInstance().getLogger("CVProcessPipe");
+
+    FusedNode::FusedNode(std::unique_ptr<CVProcessNode<cv::Mat>> first_, std::unique_ptr<CVProcessNode<cv::Mat>> second_)
+    : first(std::move(first_)), second(std::move(second_)) {}
+
+    void FusedNode::updateBuffers() {
+        first->setInpad(this->inpad,this->incoding);
+        second->setInpad(&(first->getOutpad()),&(first->getOutcoding()));
+        this->outcoding = second->getOutcoding();
+        fused = plan();
+        if (fused) {
+            this->outpad = cv::Mat(second->getOutpad().size(),second->getOutpad().type());
+            fused = verify();
+            if (!fused) logger->warn("Fused pass doesn't match its unfused nodes for this input, running them unfused");
+        }
+        if (!fused) {
+            stripe.release();
+            this->outpad = second->getOutpad();
+        }
+    }
+
+    void FusedNode::process() noexcept {
+        if (fused) {
+            processFused(*(this->inpad));
+            return;
+        }
+        first->process();
+        second->process();
+        this->outpad = second->getOutpad();
+    }
+
+    std::string FusedNode::describe() const {
+        return first->describe() + " + " + second->describe() + (fused ? " (fused)" : " (unfused)");
+    }
+
+    size_t FusedNode::estimateBytesTouched() const noexcept {
+        if (!fused) return first->estimateBytesTouched() + second->estimateBytesTouched();
+        return CVProcessNode<cv::Mat>::estimateBytesTouched();
+    }
+
+    // Runs both paths over a noise frame and compares them bit for bit
+    bool FusedNode::verify() {
+        cv::Mat probe(this->inpad->size(),this->inpad->type());
+        cv::RNG rng(0x5746);
+        rng.fill(probe,cv::RNG::UNIFORM,cv::Scalar::all(0),cv::Scalar::all(probe.depth() == CV_16U ? 65536 : 256));
+        first->setInpad(&probe,this->incoding);
+        first->process();
+        second->process();
+        cv::Mat expected = second->getOutpad().clone();
+        processFused(probe);
+        first->setInpad(this->inpad,this->incoding);
+        return expected.size() == this->outpad.size()
+            && expected.type() == this->outpad.type()
+            && cv::norm(expected,this->outpad,cv::NORM_INF) == 0;
+    }
+
+    bool ResizeConvertNode::plan() {
+        auto& resize = static_cast<ResizeNode<cv::Mat>&>(*first);
+        auto& convert = static_cast<ColorConvertNode<cv::Mat>&>(*second);
+        const auto& in = *(this->inpad);
+        if (!convert.isPixelwise() || !impl::isBandSafe(resize.getInterpolater())) return false;
+        if (!impl::planBands(in.rows,resize.getOutsize().height,in.cols * in.elemSize(),srcStep,dstStep,bandSteps)) return false;
+        stripe.create(dstStep * bandSteps,resize.getOutsize().width,in.type());
+        return true;
+    }
+
+    void ResizeConvertNode::processFused(const cv::Mat& in) noexcept {
+        auto& resize = static_cast<ResizeNode<cv::Mat>&>(*first);
+        auto& convert = static_cast<ColorConvertNode<cv::Mat>&>(*second);
+        for (int s0 = 0, d0 = 0; d0 < this->outpad.rows; s0 += srcStep * bandSteps, d0 += dstStep * bandSteps) {
+            const int s1 = std::min(s0 + srcStep * bandSteps,in.rows);
+            const int d1 = std::min(d0 + dstStep * bandSteps,this->outpad.rows);
+            cv::Mat band = stripe.rowRange(0,d1 - d0);
+            cv::resize(in.rowRange(s0,s1),band,band.size(),0,0,resize.getInterpolater());
+            cv::Mat dst = this->outpad.rowRange(d0,d1);
+            convert.convert(band,dst);
+        }
+    }
+
+    bool ConvertResizeNode::plan() {
+        auto& convert = static_cast<ColorConvertNode<cv::Mat>&>(*first);
+        auto& resize = static_cast<ResizeNode<cv::Mat>&>(*second);
+        const auto& in = *(this->inpad);
+        if (!convert.isPixelwise() || !impl::isBandSafe(resize.getInterpolater())) return false;
+        if (!impl::planBands(in.rows,resize.getOutsize().height,in.cols * in.elemSize(),srcStep,dstStep,bandSteps)) return false;
+        stripe.create(srcStep * bandSteps,in.cols,convert.getOutpad().type());
+        return true;
+    }
+
+    void ConvertResizeNode::processFused(const cv::Mat& in) noexcept {
+        auto& convert = static_cast<ColorConvertNode<cv::Mat>&>(*first);
+        auto& resize = static_cast<ResizeNode<cv::Mat>&>(*second);
+        for (int s0 = 0, d0 = 0; s0 < in.rows; s0 += srcStep * bandSteps, d0 += dstStep * bandSteps) {
+            const int s1 = std::min(s0 + srcStep * bandSteps,in.rows);
+            const int d1 = std::min(d0 + dstStep * bandSteps,this->outpad.rows);
+            cv::Mat band = stripe.rowRange(0,s1 - s0);
+            convert.convert(in.rowRange(s0,s1),band);
+            cv::Mat dst = this->outpad.rowRange(d0,d1);
+            cv::resize(band,dst,dst.size(),0,0,resize.getInterpolater());
+        }
+    }
+
+    bool ConvertLetterboxNode::plan() {
+        auto& convert = static_cast<ColorConvertNode<cv::Mat>&>(*first);
+        auto& letterbox = static_cast<LetterboxNode<cv::Mat>&>(*second);
+        const auto& in = *(this->inpad);
+        const auto content = letterbox.getContentRect();
+        if (!convert.isPixelwise() || !impl::isBandSafe(letterbox.getInterpolater())) return false;
+        // The letterbox resizes by its scale factor, which only matches a resize to the content size
+        // when both dimensions scale by exactly that factor
+        if (static_cast<double>(content.width) / in.cols != letterbox.getScale()
+            || static_cast<double>(content.height) / in.rows != letterbox.getScale()) return false;
+        if (!impl::planBands(in.rows,content.height,in.cols * in.elemSize(),srcStep,dstStep,bandSteps)) return false;
+        stripe.create(srcStep * bandSteps,in.cols,convert.getOutpad().type());
+        return true;
+    }
+
+    void ConvertLetterboxNode::processFused(const cv::Mat& in) noexcept {
+        auto& convert = static_cast<ColorConvertNode<cv::Mat>&>(*first);
+        auto& letterbox = static_cast<LetterboxNode<cv::Mat>&>(*second);
+        auto& out = this->outpad;
+        const auto content = letterbox.getContentRect();
+        const auto& fill = letterbox.getFillColor();
+        out.rowRange(0,content.y).setTo(fill);
+        out.rowRange(content.y + content.height,out.rows).setTo(fill);
+        for (int s0 = 0, d0 = 0; s0 < in.rows; s0 += srcStep * bandSteps, d0 += dstStep * bandSteps) {
+            const int s1 = std::min(s0 + srcStep * bandSteps,in.rows);
+            const cv::Range rows(content.y + d0,content.y + std::min(d0 + dstStep * bandSteps,content.height));
+            cv::Mat band = stripe.rowRange(0,s1 - s0);
+            convert.convert(in.rowRange(s0,s1),band);
+            cv::Mat dst = out(rows,cv::Range(content.x,content.x + content.width));
+            cv::resize(band,dst,dst.size(),0,0,letterbox.getInterpolater());
+            out(rows,cv::Range(0,content.x)).setTo(fill);
+            out(rows,cv::Range(content.x + content.width,out.cols)).setTo(fill);
+        }
+    }
+
+    bool RotateConvertNode::plan() {
+        auto& rotate = static_cast<RotateNode<cv::Mat>&>(*first);
+        auto& convert = static_cast<ColorConvertNode<cv::Mat>&>(*second);
+        const auto& in = *(this->inpad);
+        switch (rotate.getRotation()) {
+            case cv::ROTATE_90_CLOCKWISE:
+            case cv::ROTATE_180:
+            case cv::ROTATE_90_COUNTERCLOCKWISE:
+                break;
+            default:
+                return false;
+        }
+        // Rotating packed YUV splits up its macropixels, so converting first wouldn't give the same result
+        if (!convert.isPixelwise() || *(this->incoding) == ImageEncoding::YUYV || *(this->incoding) == ImageEncoding::UYVY) return false;
+        bandRows = std::max<int>(1, impl::BAND_BYTES / (in.cols * in.elemSize()));
+        if (bandRows >= in.rows) return false;
+        stripe.create(bandRows,in.cols,convert.getOutpad().type());
+        return true;
+    }
+
+    void RotateConvertNode::processFused(const cv::Mat& in) noexcept {
+        const int rotation = static_cast<RotateNode<cv::Mat>&>(*first).getRotation();
+        auto& convert = static_cast<ColorConvertNode<cv::Mat>&>(*second);
+        for (int r0 = 0; r0 < in.rows; r0 += bandRows) {
+            const int r1 = std::min(r0 + bandRows,in.rows);
+            cv::Mat band = stripe.rowRange(0,r1 - r0);
+            convert.convert(in.rowRange(r0,r1),band);
+            // Where rows [r0,r1) of the input end up after the rotation
+            cv::Mat dst;
+            switch (rotation) {
+                case cv::ROTATE_90_CLOCKWISE:
+                    dst = this->outpad.colRange(in.rows - r1,in.rows - r0);
+                    break;
+                case cv::ROTATE_90_COUNTERCLOCKWISE:
+                    dst = this->outpad.colRange(r0,r1);
+                    break;
+                default:
+                    dst = this->outpad.rowRange(in.rows - r1,in.rows - r0);
+            }
+            cv::rotate(band,dst,rotation);
+        }
+    }
+
+    template <CVImage T>
+    std::vector<std::unique_ptr<CVProcessNode<T>>> fuseNodes(std::vector<std::unique_ptr<CVProcessNode<T>>> nodes) {
+        if constexpr (!std::is_same_v<T,cv::Mat>) {
+            return nodes;
+        } else {
+            std::vector<std::unique_ptr<CVProcessNode<cv::Mat>>> fusedNodes;
+            fusedNodes.reserve(nodes.size());
+            for (size_t i = 0; i < nodes.size(); ++i) {
+                if (i + 1 < nodes.size()) {
+                    if (auto fusedNode = impl::fusePair(nodes[i],nodes[i + 1])) {
+                        fusedNodes.push_back(std::move(fusedNode));
+                        ++i;
+                        continue;
+                    }
+                }
+                fusedNodes.push_back(std::move(nodes[i]));
+            }
+            return fusedNodes;
+        }
+    }
+
+    template std::vector<std::unique_ptr<CVProcessNode<cv::Mat>>> fuseNodes(std::vector<std::unique_ptr<CVProcessNode<cv::Mat>>>);
+    template std::vector<std::unique_ptr<CVProcessNode<cv::UMat>>> fuseNodes(std::vector<std::unique_ptr<CVProcessNode<cv::UMat>>>);
+}
@@ -19,8 +19,11 @@
 
 #include "wfcore/video/processing/LetterboxNode.h"
 #include "wfcore/common/wfexcept.h"
+#include "wfcore/simd/simd.h"
 #include <array>
 #include <algorithm>
+#include <format>
+#include <type_traits>
 
 #define SOURCE_WIDTH this->inpad->cols
 #define SOURCE_HEIGHT this->inpad->rows
@@ -62,22 +65,35 @@ namespace wf {
             static_cast<double>(targetWidth)/SOURCE_WIDTH,
             static_cast<double>(targetHeight)/SOURCE_HEIGHT
         );
-        resizedWidth = static_cast<int>(SOURCE_WIDTH * scale);
-        resizedHeight = static_cast<int>(SOURCE_HEIGHT * scale);
+        // Round the same way cv::resize does, so the paddings always add up to the target size
+        resizedWidth = cvRound(SOURCE_WIDTH * scale);
+        resizedHeight = cvRound(SOURCE_HEIGHT * scale);
         leftPadding = (targetWidth - resizedWidth)/2;
         rightPadding = targetWidth - resizedWidth - leftPadding;
         topPadding = (targetHeight - resizedHeight)/2;
         bottomPadding = targetHeight - resizedHeight - topPadding;
 
-        resizedImageBuffer.create(
-            resizedHeight,
-            resizedWidth,
-            SOURCE_CVTYPE
-        );
+        // cv::Mat letterboxes resize straight into the outpad
+        if constexpr (std::is_same_v<T,cv::UMat>) {
+            resizedImageBuffer.create(
+                resizedHeight,
+                resizedWidth,
+                SOURCE_CVTYPE
+            );
+        }
+        for (int c = 0; c < 4; ++c)
+            fillPixel[c] = cv::saturate_cast<uint8_t>(fillColor[c]);
     }
 
     template <CVImage T>
     void LetterboxNode<T>::process() noexcept {
+        if constexpr (std::is_same_v<T,cv::Mat>) {
+            // Resize straight into the content rect and paint the bars around it, rather than copying the whole frame again
+            cv::Mat content = this->outpad(getContentRect());
+            cv::resize(*(this->inpad),content,{},scale,scale,interpolater);
+            fillBars();
+            return;
+        }
         cv::resize(*(this->inpad),resizedImageBuffer,{},scale,scale,interpolater);
         cv::copyMakeBorder(
             resizedImageBuffer,
@@ -90,6 +106,38 @@ namespace wf {
             fillColor
         );
     }
+
+    template <CVImage T>
+    void LetterboxNode<T>::fillBars() noexcept {
+        if constexpr (std::is_same_v<T,cv::Mat>) {
+            const auto& kernels = simd::kernels();
+            const int channels = this->outpad.channels();
+            auto fill = [&](int row, int col, int pixels) {
+                if (pixels > 0) kernels.fill(this->outpad.ptr(row) + col * channels,pixels,fillPixel.data(),channels);
+            };
+            for (int y = 0; y < topPadding; ++y)
+                fill(y,0,targetWidth);
+            for (int y = topPadding; y < topPadding + resizedHeight; ++y) {
+                fill(y,0,leftPadding);
+                fill(y,leftPadding + resizedWidth,rightPadding);
+            }
+            for (int y = topPadding + resizedHeight; y < targetHeight; ++y)
+                fill(y,0,targetWidth);
+        }
+    }
+
+    template <CVImage T>
+    std::string LetterboxNode<T>::describe() const {
+        return std::format(
+            "Letterbox {}x{} -> {}x{} (content {}x{})",
+            SOURCE_WIDTH,SOURCE_HEIGHT,
+            targetWidth,targetHeight,
+            resizedWidth,resizedHeight
+        );
+    }
+
+    template class LetterboxNode<cv::Mat>;
+    template class LetterboxNode<cv::UMat>;
 }
 
 #undef SOURCE_WIDTH
@@ -0,0 +1,88 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "wfcore/video/processing/LumaExtractNode.h"
+#include "wfcore/common/wfexcept.h"
+#include "wfcore/simd/simd.h"
+
+#include <format>
+
+namespace wf {
+
+    LumaExtractNode::LumaExtractNode(bool decimate_, bool view_) : decimate(decimate_), view(view_) {
+        this->outcoding = ImageEncoding::Y8;
+    }
+
+    void LumaExtractNode::updateBuffers() {
+        switch (*(this->incoding)) {
+            case ImageEncoding::YUYV: lumaOffset = 0; break;
+            case ImageEncoding::UYVY: lumaOffset = 1; break;
+            default: throw invalid_image_encoding("LumaExtractNodes only accept YUYV and UYVY frames");
+        }
+        if (decimate && (this->inpad->cols % 2 != 0 || this->inpad->rows % 2 != 0))
+            throw invalid_stream_format("A decimating LumaExtractNode needs a frame with an even width and height");
+        if (view) {
+            this->outpad = cv::Mat();
+            return;
+        }
+        this->outpad = cv::Mat(
+            decimate ? this->inpad->rows / 2 : this->inpad->rows,
+            decimate ? this->inpad->cols / 2 : this->inpad->cols,
+            CV_8UC1
+        );
+    }
+
+    void LumaExtractNode::process() noexcept {
+        if (view) return;
+        processRows(cv::Range(0,this->outpad.rows),0);
+    }
+
+    StridedPlane LumaExtractNode::getPlane() const noexcept {
+        const auto& in = *(this->inpad);
+        if (decimate)
+            return {in.data + lumaOffset,in.cols / 2,in.rows / 2,in.step[0] * 2,4};
+        return {in.data + lumaOffset,in.cols,in.rows,in.step[0],2};
+    }
+
+    cv::Range LumaExtractNode::getInputRows(const cv::Range& outRows) const noexcept {
+        return decimate ? cv::Range(outRows.start * 2,outRows.end * 2) : outRows;
+    }
+
+    void LumaExtractNode::processRows(const cv::Range& outRows, int stripe) noexcept {
+        const auto& in = *(this->inpad);
+        const auto& kernels = simd::kernels();
+        const size_t width = this->outpad.cols;
+        for (int y = outRows.start; y < outRows.end; ++y) {
+            if (decimate) {
+                kernels.extractLumaDecimated(in.ptr<uint8_t>(2 * y),in.ptr<uint8_t>(2 * y + 1),this->outpad.ptr<uint8_t>(y),width,lumaOffset);
+            } else {
+                kernels.extractLuma(in.ptr<uint8_t>(y),this->outpad.ptr<uint8_t>(y),width,lumaOffset);
+            }
+        }
+    }
+
+    std::string LumaExtractNode::describe() const {
+        return std::format(
+            "LumaExtract {}{}{}",
+            getEncodingName(*(this->incoding)),
+            decimate ? ", decimated" : "",
+            view ? ", view" : ""
+        );
+    }
+}
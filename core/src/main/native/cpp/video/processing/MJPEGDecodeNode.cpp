@@ -0,0 +1,162 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "wfcore/video/processing/MJPEGDecodeNode.h"
+#include "wfcore/common/logging.h"
+#include "wfcore/common/wfexcept.h"
+
+#include <opencv2/imgcodecs.hpp>
+
+#include <algorithm>
+#include <format>
+#include <iterator>
+#include <stdexcept>
+
+#ifdef WF_LIBJPEG_TURBO
+#include <turbojpeg.h>
+#endif
+
+namespace impl {
+    using namespace wf;
+
+    static loggerPtr logger = LoggerManager::getInstance().getLogger("MJPEGDecodeNode");
+
+    // libjpeg can scale by any of these in the DCT domain by computing fewer IDCT outputs per block
+    static constexpr int SCALE_DENOMS[] = {1, 2, 4, 8};
+
+    [[ maybe_unused ]]
+    static int getImreadFlags(ImageEncoding outcoding, int scaleDenom) noexcept {
+        const bool gray = outcoding == ImageEncoding::Y8;
+        switch (scaleDenom) {
+            case 2: return gray ? cv::IMREAD_REDUCED_GRAYSCALE_2 : cv::IMREAD_REDUCED_COLOR_2;
+            case 4: return gray ? cv::IMREAD_REDUCED_GRAYSCALE_4 : cv::IMREAD_REDUCED_COLOR_4;
+            case 8: return gray ? cv::IMREAD_REDUCED_GRAYSCALE_8 : cv::IMREAD_REDUCED_COLOR_8;
+            default: return gray ? cv::IMREAD_GRAYSCALE : cv::IMREAD_COLOR;
+        }
+    }
+}
+
+namespace wf {
+
+    MJPEGDecodeNode::MJPEGDecodeNode(cv::Size encodedSize_, ImageEncoding outcoding_, int scaleDenom_)
+    : encodedSize(encodedSize_), scaleDenom(scaleDenom_), decompressor(nullptr), failures(0) {
+        if (outcoding_ != ImageEncoding::Y8 && outcoding_ != ImageEncoding::BGR24)
+            throw invalid_image_encoding("MJPEGDecodeNodes only decode to Y8 or BGR24");
+        if (std::find(std::begin(impl::SCALE_DENOMS),std::end(impl::SCALE_DENOMS),scaleDenom) == std::end(impl::SCALE_DENOMS))
+            throw invalid_stream_format("MJPEGDecodeNodes only scale by 1/2, 1/4, or 1/8");
+        if (encodedSize.width <= 0 || encodedSize.height <= 0)
+            throw invalid_stream_format("MJPEGDecodeNodes need a nonzero encoded frame size");
+        this->outcoding = outcoding_;
+#ifdef WF_LIBJPEG_TURBO
+        decompressor = tjInitDecompress();
+        if (!decompressor)
+            throw std::runtime_error("Failed to create a libjpeg-turbo decompressor");
+#endif
+    }
+
+    MJPEGDecodeNode::~MJPEGDecodeNode() {
+#ifdef WF_LIBJPEG_TURBO
+        if (decompressor) tjDestroy(decompressor);
+#endif
+    }
+
+    cv::Size MJPEGDecodeNode::getDecodedSize(cv::Size encodedSize, int scaleDenom) noexcept {
+        return {
+            (encodedSize.width + scaleDenom - 1) / scaleDenom,
+            (encodedSize.height + scaleDenom - 1) / scaleDenom
+        };
+    }
+
+    int MJPEGDecodeNode::chooseScaleDenom(cv::Size encodedSize, cv::Size targetSize) noexcept {
+        int best = 1;
+        for (int denom : impl::SCALE_DENOMS) {
+            auto decoded = getDecodedSize(encodedSize,denom);
+            if (decoded.width >= targetSize.width && decoded.height >= targetSize.height)
+                best = denom;
+        }
+        return best;
+    }
+
+    void MJPEGDecodeNode::updateBuffers() {
+        if (*(this->incoding) != ImageEncoding::MJPEG)
+            throw invalid_image_encoding("MJPEGDecodeNodes only accept MJPEG frames");
+        // The inpad is a compressed bitstream, so its shape says nothing about the decoded image
+        this->outpad = cv::Mat(
+            getDecodedSize(encodedSize,scaleDenom),
+            this->outcoding == ImageEncoding::Y8 ? CV_8UC1 : CV_8UC3,
+            cv::Scalar::all(0)
+        );
+    }
+
+    std::string MJPEGDecodeNode::describe() const {
+        const cv::Size decodedSize = getDecodedSize(encodedSize,scaleDenom);
+        return std::format(
+            "MJPEGDecode {}x{} -> {}x{} {}",
+            encodedSize.width,encodedSize.height,
+            decodedSize.width,decodedSize.height,
+            getEncodingName(this->outcoding)
+        );
+    }
+
+    void MJPEGDecodeNode::process() noexcept {
+        const auto& in = *(this->inpad);
+        if (in.empty() || !in.isContinuous()) {
+            failures.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+#ifdef WF_LIBJPEG_TURBO
+        const auto* jpeg = in.ptr<unsigned char>();
+        const auto jpegSize = static_cast<unsigned long>(in.total() * in.elemSize());
+        int width, height, subsamp, colorspace;
+        // A frame that doesn't match the negotiated mode would be scaled to fit the outpad, reject it instead
+        if (tjDecompressHeader3(decompressor,jpeg,jpegSize,&width,&height,&subsamp,&colorspace) != 0
+            || width != encodedSize.width || height != encodedSize.height) {
+            failures.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        // Asking for the scaled size makes libjpeg-turbo pick the matching DCT scaling factor. With a gray
+        // pixel format the decompressor marks the chroma components as unneeded and skips their IDCTs
+        if (tjDecompress2(
+            decompressor,jpeg,jpegSize,
+            this->outpad.data,this->outpad.cols,static_cast<int>(this->outpad.step[0]),this->outpad.rows,
+            this->outcoding == ImageEncoding::Y8 ? TJPF_GRAY : TJPF_BGR,
+            0
+        ) != 0) {
+            // Warnings (e.g. a truncated frame) still produce an image, errors don't
+            if (tjGetErrorCode(decompressor) == TJERR_FATAL) {
+                failures.fetch_add(1, std::memory_order_relaxed);
+                WF_DEBUGLOG(impl::logger,"Failed to decode MJPEG frame: {}",tjGetErrorStr2(decompressor));
+            }
+        }
+#else
+        // OpenCV's JPEG decoder also drops to a grayscale output space and scales in the DCT domain for these flags,
+        // but it decodes into its own buffer, which is copied over so the outpad never reallocates
+        try {
+            cv::imdecode(in,impl::getImreadFlags(this->outcoding,scaleDenom),&decoded);
+        } catch (...) {
+            decoded.release();
+        }
+        if (decoded.size() != this->outpad.size() || decoded.type() != this->outpad.type()) {
+            failures.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        decoded.copyTo(this->outpad);
+#endif
+    }
+}
@@ -0,0 +1,333 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "wfcore/video/processing/PipePlanner.h"
+#include "wfcore/video/processing/ColorConvertNode.h"
+#include "wfcore/video/processing/ResizeNode.h"
+#include "wfcore/common/logging.h"
+
+#include <opencv2/core.hpp>
+
+#include <exception>
+#include <format>
+#include <utility>
+
+namespace impl {
+    using namespace wf;
+
+    template <CVImage T>
+    using NodeChain = std::vector<std::unique_ptr<CVProcessNode<T>>>;
+
+    static loggerPtr logger = LoggerManager::getInstance().getLogger("CVProcessPipe");
+
+    static std::string formatBytes(size_t bytes) {
+        if (bytes >= 1024 * 1024) return std::format("{:.1f} MiB",bytes / (1024.0 * 1024.0));
+        if (bytes >= 1024) return std::format("{:.1f} KiB",bytes / 1024.0);
+        return std::format("{} B",bytes);
+    }
+
+    static std::string formatFrame(const FrameFormat& format) {
+        return std::format("{}x{} {}",format.width,format.height,getEncodingName(format.encoding));
+    }
+
+    // Resizing interpolates between neighbouring pixels, which only commutes with a color conversion
+    // when every pixel holds its own samples. Packed YUV and RGB565 share or pack samples across pixels
+    static bool hasIndependentPixels(ImageEncoding encoding) {
+        switch (encoding) {
+            case ImageEncoding::BGR24:
+            case ImageEncoding::RGB24:
+            case ImageEncoding::BGRA:
+            case ImageEncoding::RGBA:
+            case ImageEncoding::Y8:
+            case ImageEncoding::Y16:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    template <CVImage T>
+    static void linkFrom(NodeChain<T>& nodes, size_t begin, const T* input, const ImageEncoding* encoding) {
+        if (begin > 0) {
+            input = &(nodes[begin - 1]->getOutpad());
+            encoding = &(nodes[begin - 1]->getOutcoding());
+        }
+        for (size_t k = begin; k < nodes.size(); ++k) {
+            nodes[k]->setInpad(input,encoding);
+            encoding = &(nodes[k]->getOutcoding());
+            input = &(nodes[k]->getOutpad());
+        }
+    }
+
+    template <CVImage T>
+    struct Trial {
+        T output;
+        size_t bytesTouched = 0;
+    };
+
+    // Runs probe through a short chain, returning a copy of its output and what it cost
+    template <CVImage T>
+    static Trial<T> runTrial(NodeChain<T>& chain, const T& probe, const ImageEncoding* encoding) {
+        linkFrom(chain,0,&probe,encoding);
+        Trial<T> trial;
+        for (auto& node : chain) {
+            node->process();
+            trial.bytesTouched += node->estimateBytesTouched();
+        }
+        trial.output = chain.back()->getOutpad().clone();
+        return trial;
+    }
+
+    template <CVImage T>
+    static bool sameOutput(const T& a, const T& b) {
+        return a.size() == b.size()
+            && a.type() == b.type()
+            && cv::norm(a,b,cv::NORM_INF) == 0;
+    }
+
+    // A candidate replacement for a pair of adjacent nodes
+    template <CVImage T>
+    struct Rewrite {
+        std::string verb; // What the rewrite does to the pair, e.g. "merging"
+        NodeChain<T> replacement;
+    };
+
+    // Tries out a rewrite of nodes[i] and nodes[i + 1]. The rewrite is applied if it is cheaper and gives
+    // exactly the same output as the original pair. Returns true if the chain was changed
+    template <CVImage T>
+    static bool tryRewrite(
+        NodeChain<T>& nodes,
+        size_t i,
+        const T* input,
+        const ImageEncoding* encoding,
+        Rewrite<T> rewrite,
+        std::vector<std::string>& rewrites
+    ) {
+        const ImageEncoding pairEncoding = *(nodes[i]->getIncoding());
+        const T& pairInput = *(nodes[i]->getInpad());
+        const std::string before = nodes[i]->describe() + " and " + nodes[i + 1]->describe();
+
+        T probe(pairInput.size(),pairInput.type());
+        cv::RNG rng(0x5746);
+        rng.fill(probe,cv::RNG::UNIFORM,cv::Scalar::all(0),cv::Scalar::all(CV_MAT_DEPTH(probe.type()) == CV_16U ? 65536 : 256));
+
+        NodeChain<T> original;
+        original.push_back(std::move(nodes[i]));
+        original.push_back(std::move(nodes[i + 1]));
+        bool accepted = false;
+        try {
+            auto expected = runTrial(original,probe,&pairEncoding);
+            auto candidate = runTrial(rewrite.replacement,probe,&pairEncoding);
+            // A rewrite that doesn't save anything isn't worth mentioning
+            if (candidate.bytesTouched < expected.bytesTouched) {
+                if (sameOutput(expected.output,candidate.output)) {
+                    std::string after = rewrite.replacement.front()->describe();
+                    for (size_t k = 1; k < rewrite.replacement.size(); ++k)
+                        after += " and " + rewrite.replacement[k]->describe();
+                    rewrites.push_back(std::format(
+                        "Replaced {} with {}, saving ~{} per frame",
+                        before,after,formatBytes(expected.bytesTouched - candidate.bytesTouched)
+                    ));
+                    accepted = true;
+                } else {
+                    rewrites.push_back(std::format("Kept {}: {} them would change the output",before,rewrite.verb));
+                }
+            }
+        } catch (const std::exception& e) {
+            // The replacement doesn't accept this input at all
+            WF_DEBUGLOG(logger,"Not {} {}: {}",rewrite.verb,before,e.what());
+        }
+
+        auto& chosen = accepted ? rewrite.replacement : original;
+        nodes.erase(nodes.begin() + i,nodes.begin() + i + 2);
+        nodes.insert(
+            nodes.begin() + i,
+            std::make_move_iterator(chosen.begin()),
+            std::make_move_iterator(chosen.end())
+        );
+        linkFrom(nodes,i,input,encoding);
+        return accepted;
+    }
+}
+
+namespace wf {
+
+    std::string PipePlan::explain() const {
+        std::string text = std::format("{} steps, ~{} touched per frame\n",steps.size(),impl::formatBytes(bytesTouched));
+        for (size_t k = 0; k < steps.size(); ++k) {
+            const auto& step = steps[k];
+            text += std::format(
+                "  {}. {}: {} -> {}, ~{}\n",
+                k + 1,step.node,
+                impl::formatFrame(step.input),impl::formatFrame(step.output),
+                impl::formatBytes(step.bytesTouched)
+            );
+        }
+        if (!rewrites.empty()) {
+            text += "Rewrites:\n";
+            for (const auto& rewrite : rewrites)
+                text += std::format("  - {}\n",rewrite);
+        }
+        return text;
+    }
+
+    JSON pipePlanToJSON(const PipePlan& plan) {
+        JSON steps = JSON::array();
+        for (const auto& step : plan.steps) {
+            steps.push_back({
+                {"node",step.node},
+                {"input",step.input},
+                {"output",step.output},
+                {"bytesTouched",step.bytesTouched}
+            });
+        }
+        return {
+            {"steps",std::move(steps)},
+            {"rewrites",plan.rewrites},
+            {"bytesTouched",plan.bytesTouched},
+            {"explain",plan.explain()}
+        };
+    }
+
+    template <CVImage T>
+    void linkChain(std::vector<std::unique_ptr<CVProcessNode<T>>>& nodes, const T* input, const ImageEncoding* encoding) {
+        impl::linkFrom(nodes,0,input,encoding);
+    }
+
+    template <CVImage T>
+    std::vector<std::string> optimizeNodes(
+        std::vector<std::unique_ptr<CVProcessNode<T>>>& nodes,
+        const T* input,
+        const ImageEncoding* encoding
+    ) {
+        std::vector<std::string> rewrites;
+        impl::linkFrom(nodes,0,input,encoding);
+
+        // A no-op leaves its inpad untouched, so dropping it doesn't change what any later node sees
+        for (size_t i = 0; i < nodes.size();) {
+            if (!nodes[i]->isNoOp()) {
+                ++i;
+                continue;
+            }
+            rewrites.push_back(std::format("Elided {}",nodes[i]->describe()));
+            nodes.erase(nodes.begin() + i);
+            impl::linkFrom(nodes,i,input,encoding);
+        }
+
+        for (size_t i = 0; i + 1 < nodes.size();) {
+            auto* firstResize = dynamic_cast<ResizeNode<T>*>(nodes[i].get());
+            auto* secondResize = dynamic_cast<ResizeNode<T>*>(nodes[i + 1].get());
+            auto* firstConvert = dynamic_cast<ColorConvertNode<T>*>(nodes[i].get());
+            auto* secondConvert = dynamic_cast<ColorConvertNode<T>*>(nodes[i + 1].get());
+
+            if (firstResize && secondResize && firstResize->getInterpolater() == secondResize->getInterpolater()) {
+                impl::Rewrite<T> merge{"merging",{}};
+                const cv::Size& outsize = secondResize->getOutsize();
+                merge.replacement.push_back(std::make_unique<ResizeNode<T>>(secondResize->getInterpolater(),outsize.width,outsize.height));
+                // A merged resize may merge again with the one after it
+                if (impl::tryRewrite(nodes,i,input,encoding,std::move(merge),rewrites)) continue;
+            } else if (firstResize && secondConvert && secondConvert->isPixelwise()
+                && impl::hasIndependentPixels(*(secondConvert->getIncoding()))
+                && impl::hasIndependentPixels(secondConvert->getOutcoding())) {
+                const cv::Size& outsize = firstResize->getOutsize();
+                impl::Rewrite<T> swap{"swapping",{}};
+                swap.replacement.push_back(std::make_unique<ColorConvertNode<T>>(secondConvert->getOutcoding()));
+                swap.replacement.push_back(std::make_unique<ResizeNode<T>>(firstResize->getInterpolater(),outsize.width,outsize.height));
+                impl::tryRewrite(nodes,i,input,encoding,std::move(swap),rewrites);
+            } else if (firstConvert && secondResize && firstConvert->isPixelwise()
+                && impl::hasIndependentPixels(*(firstConvert->getIncoding()))
+                && impl::hasIndependentPixels(firstConvert->getOutcoding())) {
+                const cv::Size& outsize = secondResize->getOutsize();
+                impl::Rewrite<T> swap{"swapping",{}};
+                swap.replacement.push_back(std::make_unique<ResizeNode<T>>(secondResize->getInterpolater(),outsize.width,outsize.height));
+                swap.replacement.push_back(std::make_unique<ColorConvertNode<T>>(firstConvert->getOutcoding()));
+                impl::tryRewrite(nodes,i,input,encoding,std::move(swap),rewrites);
+            }
+            ++i;
+        }
+
+        for (const auto& rewrite : rewrites)
+            WF_DEBUGLOG(impl::logger,"{}",rewrite);
+        return rewrites;
+    }
+
+    template <CVImage T>
+    ViewTransform elideGeometry(
+        std::vector<std::unique_ptr<CVProcessNode<T>>>& nodes,
+        const T* input,
+        const ImageEncoding* encoding,
+        GeometryElision elision,
+        std::vector<std::string>& rewrites
+    ) {
+        impl::linkFrom(nodes,0,input,encoding);
+        const cv::Size viewSize = nodes.empty() ? input->size() : nodes.back()->getOutpad().size();
+
+        // Walking back from the end, geometric nodes can go for as long as everything after them commutes with them
+        const size_t firstRewrite = rewrites.size();
+        int quarterTurns = 0;
+        bool elided = false;
+        for (size_t k = nodes.size(); k-- > 0;) {
+            auto geometry = nodes[k]->getGeometry();
+            if (geometry && elision == GeometryElision::Turns) {
+                const cv::Size from = geometry->getSourceSize();
+                const cv::Size turned = geometry->getQuarterTurns() % 2 ? cv::Size(from.height,from.width) : from;
+                if (turned != geometry->getViewSize()) break;
+            }
+            if (geometry && elision != GeometryElision::None) {
+                quarterTurns += geometry->getQuarterTurns();
+                rewrites.insert(
+                    rewrites.begin() + firstRewrite,
+                    std::format("Skipped {}, results are mapped onto its output instead",nodes[k]->describe())
+                );
+                nodes.erase(nodes.begin() + k);
+                elided = true;
+            } else if (!nodes[k]->commutesWithGeometry()) {
+                break;
+            }
+        }
+        if (elided) impl::linkFrom(nodes,0,input,encoding);
+
+        // Kept nodes only scale the frame evenly if at all, so the sizes at either end pin down the rest of the transform
+        const cv::Size sourceSize = nodes.empty() ? input->size() : nodes.back()->getOutpad().size();
+        return ViewTransform(quarterTurns,sourceSize,viewSize);
+    }
+
+    template <CVImage T>
+    std::vector<PipePlanStep> describeNodes(const std::vector<std::unique_ptr<CVProcessNode<T>>>& nodes, const FrameFormat& input) {
+        std::vector<PipePlanStep> steps;
+        steps.reserve(nodes.size());
+        FrameFormat format = input;
+        for (const auto& node : nodes) {
+            const T& out = node->getOutpad();
+            FrameFormat output(node->getOutcoding(),out.cols,out.rows);
+            steps.push_back({node->describe(),format,output,node->estimateBytesTouched()});
+            format = output;
+        }
+        return steps;
+    }
+
+    template void linkChain(std::vector<std::unique_ptr<CVProcessNode<cv::Mat>>>&, const cv::Mat*, const ImageEncoding*);
+    template void linkChain(std::vector<std::unique_ptr<CVProcessNode<cv::UMat>>>&, const cv::UMat*, const ImageEncoding*);
+    template std::vector<std::string> optimizeNodes(std::vector<std::unique_ptr<CVProcessNode<cv::Mat>>>&, const cv::Mat*, const ImageEncoding*);
+    template std::vector<std::string> optimizeNodes(std::vector<std::unique_ptr<CVProcessNode<cv::UMat>>>&, const cv::UMat*, const ImageEncoding*);
+    template ViewTransform elideGeometry(std::vector<std::unique_ptr<CVProcessNode<cv::Mat>>>&, const cv::Mat*, const ImageEncoding*, GeometryElision, std::vector<std::string>&);
+    template ViewTransform elideGeometry(std::vector<std::unique_ptr<CVProcessNode<cv::UMat>>>&, const cv::UMat*, const ImageEncoding*, GeometryElision, std::vector<std::string>&);
+    template std::vector<PipePlanStep> describeNodes(const std::vector<std::unique_ptr<CVProcessNode<cv::Mat>>>&, const FrameFormat&);
+    template std::vector<PipePlanStep> describeNodes(const std::vector<std::unique_ptr<CVProcessNode<cv::UMat>>>&, const FrameFormat&);
+}
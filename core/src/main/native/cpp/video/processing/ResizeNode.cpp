@@ -21,6 +21,26 @@
 #include "wfcore/common/wfexcept.h"
 #include <opencv2/imgproc.hpp>
 
+#include <algorithm>
+#include <format>
+#include <numeric>
+#include <string_view>
+
+namespace impl {
+    static std::string_view interpolationName(int interpolation) {
+        switch (interpolation) {
+            case cv::INTER_NEAREST: return "nearest";
+            case cv::INTER_LINEAR: return "linear";
+            case cv::INTER_CUBIC: return "cubic";
+            case cv::INTER_AREA: return "area";
+            case cv::INTER_LANCZOS4: return "lanczos4";
+            case cv::INTER_LINEAR_EXACT: return "linear exact";
+            case cv::INTER_NEAREST_EXACT: return "nearest exact";
+            default: return "unknown";
+        }
+    }
+}
+
 namespace wf {
 
     template <CVImage T>
@@ -40,6 +60,55 @@ namespace wf {
             this->inpad->type()
         );
         this->outcoding = *(this->incoding);
+
+        const int steps = std::gcd(this->inpad->rows,this->outsize.height);
+        srcStep = steps > 0 ? this->inpad->rows / steps : 1;
+        dstStep = steps > 0 ? this->outsize.height / steps : 1;
+        // Rows the interpolation reads past the rows a band maps onto. A linear or area downscale
+        // only ever samples inside the band
+        int taps;
+        switch (this->interpolater) {
+            case cv::INTER_NEAREST: taps = 0; break;
+            case cv::INTER_LINEAR:
+            case cv::INTER_AREA: taps = srcStep >= dstStep ? 0 : 1; break;
+            case cv::INTER_CUBIC: taps = 2; break;
+            case cv::INTER_LANCZOS4: taps = 4; break;
+            default: taps = -1;
+        }
+        stripeable = taps >= 0 && steps > 0;
+        // The halo is rounded up to whole steps, so a widened band is scaled by exactly the same ratio as the full frame
+        halo = taps > 0 ? srcStep * ((taps + srcStep - 1) / srcStep) : 0;
+        stripeScratch.clear();
+    }
+
+    template <CVImage T>
+    cv::Range ResizeNode<T>::getInputRows(const cv::Range& outRows) const noexcept {
+        return cv::Range(outRows.start / dstStep * srcStep,outRows.end / dstStep * srcStep);
+    }
+
+    template <CVImage T>
+    void ResizeNode<T>::prepareStripes(int stripes, int maxRows) {
+        stripeScratch.clear();
+        if (halo == 0) return;
+        stripeScratch.resize(stripes);
+        for (auto& scratch : stripeScratch)
+            scratch.create(maxRows + 2 * (halo / srcStep) * dstStep,this->outsize.width,this->outpad.type());
+    }
+
+    template <CVImage T>
+    void ResizeNode<T>::processRows(const cv::Range& outRows, int stripe) noexcept {
+        const cv::Range inRows = getInputRows(outRows);
+        T out = this->outpad.rowRange(outRows);
+        if (halo == 0) {
+            cv::resize(this->inpad->rowRange(inRows),out,out.size(),0,0,this->interpolater);
+            return;
+        }
+        // Resize a band widened by the halo, clamped to the frame just like the full resize is, and keep the rows asked for
+        const cv::Range wideRows(std::max(inRows.start - halo,0),std::min(inRows.end + halo,this->inpad->rows));
+        T band = stripeScratch[stripe].rowRange(0,wideRows.size() / srcStep * dstStep);
+        cv::resize(this->inpad->rowRange(wideRows),band,band.size(),0,0,this->interpolater);
+        const int offset = (inRows.start - wideRows.start) / srcStep * dstStep;
+        band.rowRange(offset,offset + outRows.size()).copyTo(out);
     }
 
     template <CVImage T>
@@ -52,6 +121,16 @@ namespace wf {
         );
     }
 
+    template <CVImage T>
+    std::string ResizeNode<T>::describe() const {
+        return std::format(
+            "Resize {}x{} -> {}x{} ({})",
+            this->inpad->cols,this->inpad->rows,
+            outsize.width,outsize.height,
+            impl::interpolationName(interpolater)
+        );
+    }
+
     template class ResizeNode<cv::Mat>;
     template class ResizeNode<cv::UMat>;
 }
\ No newline at end of file
@@ -20,10 +20,12 @@
 #include "wfcore/video/processing/RotateNode.h"
 #include <opencv2/imgproc.hpp>
 
+#include <format>
+
 namespace wf {
 
     template <CVImage T>
-    RotateNode<T>::RotateNode(int rotation_) : rotation(rotation) {}
+    RotateNode<T>::RotateNode(int rotation_) : rotation(rotation_) {}
 
     template <CVImage T>
     void RotateNode<T>::updateBuffers() {
@@ -43,6 +45,55 @@ namespace wf {
         cv::rotate(*(this->inpad),this->outpad,this->rotation);
     }
 
+    template <CVImage T>
+    bool RotateNode<T>::isStripeable() const noexcept {
+        return this->rotation == cv::ROTATE_90_CLOCKWISE
+            || this->rotation == cv::ROTATE_180
+            || this->rotation == cv::ROTATE_90_COUNTERCLOCKWISE;
+    }
+
+    template <CVImage T>
+    cv::Range RotateNode<T>::getInputRows(const cv::Range& outRows) const noexcept {
+        // A quarter turn builds each output row from an input column, which spans every input row
+        if (this->rotation != cv::ROTATE_180) return cv::Range(0,this->inpad->rows);
+        return cv::Range(this->inpad->rows - outRows.end,this->inpad->rows - outRows.start);
+    }
+
+    template <CVImage T>
+    int RotateNode<T>::getHalo() const noexcept {
+        return this->rotation == cv::ROTATE_180 ? 0 : this->inpad->rows;
+    }
+
+    template <CVImage T>
+    void RotateNode<T>::processRows(const cv::Range& outRows, int stripe) noexcept {
+        T out = this->outpad.rowRange(outRows);
+        switch (this->rotation) {
+            case cv::ROTATE_90_CLOCKWISE:
+                cv::rotate(this->inpad->colRange(outRows),out,this->rotation);
+                break;
+            case cv::ROTATE_90_COUNTERCLOCKWISE:
+                cv::rotate(this->inpad->colRange(this->inpad->cols - outRows.end,this->inpad->cols - outRows.start),out,this->rotation);
+                break;
+            default:
+                cv::rotate(this->inpad->rowRange(getInputRows(outRows)),out,this->rotation);
+        }
+    }
+
+    template <CVImage T>
+    std::string RotateNode<T>::describe() const {
+        switch (this->rotation) {
+            case cv::ROTATE_90_CLOCKWISE: return "Rotate 90 clockwise";
+            case cv::ROTATE_180: return "Rotate 180";
+            case cv::ROTATE_90_COUNTERCLOCKWISE: return "Rotate 90 counterclockwise";
+            default: return std::format("Rotate ({})",this->rotation);
+        }
+    }
+
+    template <CVImage T>
+    std::optional<ViewTransform> RotateNode<T>::getGeometry() const {
+        return ViewTransform::rotation(this->inpad->size(),this->rotation);
+    }
+
     template class RotateNode<cv::Mat>;
     template class RotateNode<cv::UMat>;
 }
\ No newline at end of file
@@ -0,0 +1,128 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "wfcore/video/processing/UndistortNode.h"
+#include "wfcore/common/wfexcept.h"
+
+#include <opencv2/calib3d.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <format>
+#include <mutex>
+#include <vector>
+
+namespace impl {
+    using namespace wf;
+
+    // Tables stay cached while any node holds them, so workers sharing a camera share one set
+    static std::mutex tableCacheMutex;
+    static std::vector<std::weak_ptr<const RemapTables>> tableCache;
+
+    static std::shared_ptr<const RemapTables> buildTables(const CameraIntrinsics& intrinsics, cv::Size size) {
+        cv::Mat cameraMatrix;
+        intrinsics.cameraMatrix.convertTo(cameraMatrix,CV_64F);
+        // Scale the calibration to the frame
+        const double sx = static_cast<double>(size.width) / intrinsics.resolution.width;
+        const double sy = static_cast<double>(size.height) / intrinsics.resolution.height;
+        for (int col = 0; col < 3; ++col) {
+            cameraMatrix.at<double>(0,col) *= sx;
+            cameraMatrix.at<double>(1,col) *= sy;
+        }
+        auto tables = std::make_shared<RemapTables>();
+        // Deep copy, so the cache key can't change under it
+        tables->intrinsics = CameraIntrinsics(intrinsics.resolution,intrinsics.cameraMatrix.clone(),intrinsics.distCoeffs.clone());
+        tables->size = size;
+        // The rectified image keeps the original camera matrix, which is what CameraIntrinsics::rectified() reports
+        cv::initUndistortRectifyMap(
+            cameraMatrix,intrinsics.distCoeffs,cv::noArray(),cameraMatrix,
+            size,CV_16SC2,tables->map1,tables->map2
+        );
+        return tables;
+    }
+}
+
+namespace wf {
+
+    UndistortNode::UndistortNode(CameraIntrinsics intrinsics_) : intrinsics(std::move(intrinsics_)) {
+        if (intrinsics.cameraMatrix.rows != 3 || intrinsics.cameraMatrix.cols != 3
+            || intrinsics.resolution.width <= 0 || intrinsics.resolution.height <= 0)
+            throw intrinsics_not_found("UndistortNodes need a complete camera calibration");
+    }
+
+    std::shared_ptr<const RemapTables> UndistortNode::getTables(const CameraIntrinsics& intrinsics, cv::Size size) {
+        std::lock_guard lock(impl::tableCacheMutex);
+        std::erase_if(impl::tableCache,[](const auto& entry){ return entry.expired(); });
+        for (const auto& entry : impl::tableCache) {
+            auto tables = entry.lock();
+            if (tables && tables->size == size && tables->intrinsics == intrinsics)
+                return tables;
+        }
+        auto tables = impl::buildTables(intrinsics,size);
+        impl::tableCache.push_back(tables);
+        return tables;
+    }
+
+    void UndistortNode::updateBuffers() {
+        switch (*(this->incoding)) {
+            case ImageEncoding::BGR24:
+            case ImageEncoding::RGB24:
+            case ImageEncoding::BGRA:
+            case ImageEncoding::RGBA:
+            case ImageEncoding::Y8:
+            case ImageEncoding::Y16:
+                break;
+            default:
+                // Remapping interpolates neighbouring pixels, which would mix the channels of packed YUV and RGB565
+                throw invalid_image_encoding("UndistortNodes only accept frames with one sample per channel");
+        }
+        this->outcoding = *(this->incoding);
+        const cv::Size size = this->inpad->size();
+        if (!tables || tables->size != size)
+            tables = getTables(intrinsics,size);
+        this->outpad = cv::Mat(size,this->inpad->type());
+    }
+
+    void UndistortNode::process() noexcept {
+        processRows(cv::Range(0,this->outpad.rows),0);
+    }
+
+    cv::Range UndistortNode::getInputRows(const cv::Range& outRows) const noexcept {
+        return cv::Range(0,this->inpad->rows);
+    }
+
+    void UndistortNode::processRows(const cv::Range& outRows, int stripe) noexcept {
+        cv::Mat out = this->outpad.rowRange(outRows);
+        cv::remap(
+            *(this->inpad),out,
+            tables->map1.rowRange(outRows),tables->map2.rowRange(outRows),
+            cv::INTER_LINEAR,cv::BORDER_CONSTANT
+        );
+    }
+
+    std::string UndistortNode::describe() const {
+        return std::format("Undistort {}x{}",this->inpad->cols,this->inpad->rows);
+    }
+
+    size_t UndistortNode::estimateBytesTouched() const noexcept {
+        size_t bytes = CVProcessNode<cv::Mat>::estimateBytesTouched();
+        if (tables)
+            bytes += tables->map1.total() * tables->map1.elemSize() + tables->map2.total() * tables->map2.elemSize();
+        return bytes;
+    }
+}
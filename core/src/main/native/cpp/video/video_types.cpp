@@ -62,6 +62,9 @@ namespace wf {
 
     using enum WFStatus;
 
+    std::string_view getEncodingName(ImageEncoding encoding) noexcept {
+        return impl::encodingToString(encoding);
+    }
 
     const jval::JSONValidationFunctor* FrameFormat::getValidator_impl() {
         return jval::get_FrameFormat_validator();
@@ -0,0 +1,63 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace wf {
+
+    // A single logical CPU, as described by sysfs
+    struct CPUCore {
+        int cpu; // Logical CPU id
+        int capacity; // Relative performance. cpu_capacity where the kernel exposes it (ARM), otherwise the max frequency in kHz
+        int package; // Physical package id
+        std::vector<int> smtSiblings; // Logical CPUs on the same physical core, including this one
+        std::vector<int> l2Siblings; // Logical CPUs sharing this CPU's L2 cache, including this one
+    };
+
+    // Snapshot of the machine's CPU topology: heterogeneous (big.LITTLE) capacity tiers, shared L2 domains, and SMT siblings
+    class CPUTopology {
+    public:
+        // Reads the topology of every online CPU. sysfsRoot is only overridden by tests.
+        // Anything sysfs doesn't expose falls back to treating the CPU as its own core with its own L2
+        static CPUTopology detect(const std::filesystem::path& sysfsRoot = "/sys/devices/system/cpu");
+
+        const std::vector<CPUCore>& getCores() const noexcept { return cores_; }
+        // True if the CPUs don't all have the same capacity
+        bool isHeterogeneous() const noexcept;
+        // CPUs in the highest capacity tier. On homogeneous systems this is every CPU
+        std::vector<int> getPerformanceCPUs() const;
+        // CPUs outside the highest capacity tier. Empty on homogeneous systems
+        std::vector<int> getEfficiencyCPUs() const;
+        // Physical cores of the performance tier, each given as its SMT siblings.
+        // Cores that share an L2 are adjacent, so contiguous runs of this list are cache friendly
+        std::vector<std::vector<int>> getPerformanceCores() const;
+    private:
+        explicit CPUTopology(std::vector<CPUCore> cores) : cores_(std::move(cores)) {}
+        int maxCapacity() const noexcept;
+        std::vector<CPUCore> cores_;
+    };
+
+    // Parses a sysfs CPU list such as "0-3,6,8-9". Malformed entries are skipped
+    std::vector<int> parseCPUList(std::string_view list);
+}
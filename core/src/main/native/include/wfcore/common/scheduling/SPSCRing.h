@@ -0,0 +1,138 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <chrono>
+#include <stop_token>
+#include <cstddef>
+#include <stdexcept>
+
+namespace wf {
+
+    // Bounded lock-free single-producer single-consumer ring buffer.
+    // Exactly one thread may push and exactly one (other) thread may pop.
+    // Slots are preallocated at construction, so pushing and popping never allocate.
+    // Elements only need to be move constructible, which lets structs with const members
+    // (such as FrameMetadata) travel through the ring
+    template <typename T>
+    class SPSCRing {
+    public:
+        explicit SPSCRing(size_t capacity)
+        : size(capacity + 1) // One slot is always left empty to tell a full ring from an empty one
+        , records(std::allocator<T>().allocate(capacity + 1))
+        , readIdx(0), writeIdx(0) {
+            if (capacity == 0) {
+                std::allocator<T>().deallocate(records, size);
+                throw std::invalid_argument("SPSCRing capacity must be nonzero");
+            }
+        }
+
+        ~SPSCRing() {
+            size_t r = readIdx.load(std::memory_order_relaxed);
+            size_t w = writeIdx.load(std::memory_order_relaxed);
+            while (r != w) {
+                std::destroy_at(records + r);
+                if (++r == size) r = 0;
+            }
+            std::allocator<T>().deallocate(records, size);
+        }
+
+        SPSCRing(const SPSCRing&) = delete;
+        SPSCRing& operator=(const SPSCRing&) = delete;
+        SPSCRing(SPSCRing&&) = delete;
+        SPSCRing& operator=(SPSCRing&&) = delete;
+
+        // Producer side. Constructs an element in place, returns false if the ring is full
+        template <typename... Args>
+        bool tryPush(Args&&... args) {
+            const size_t w = writeIdx.load(std::memory_order_relaxed);
+            size_t next = w + 1;
+            if (next == size) next = 0;
+            if (next == readIdx.load(std::memory_order_acquire))
+                return false;
+            std::construct_at(records + w, std::forward<Args>(args)...);
+            writeIdx.store(next, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer side. Moves the oldest element out of the ring, returns std::nullopt if the ring is empty
+        std::optional<T> tryPop() {
+            const size_t r = readIdx.load(std::memory_order_relaxed);
+            if (r == writeIdx.load(std::memory_order_acquire))
+                return std::nullopt;
+            std::optional<T> item(std::move(records[r]));
+            std::destroy_at(records + r);
+            size_t next = r + 1;
+            if (next == size) next = 0;
+            readIdx.store(next, std::memory_order_release);
+            return item;
+        }
+
+        // Blocking variants. These back off from spinning to sleeping while waiting,
+        // and give up once a stop is requested on stoken
+        template <typename... Args>
+        bool push(std::stop_token stoken, Args&&... args) {
+            for (unsigned int spins = 0; !stoken.stop_requested(); ++spins) {
+                if (tryPush(std::forward<Args>(args)...))
+                    return true;
+                backoff(spins);
+            }
+            return false;
+        }
+
+        std::optional<T> pop(std::stop_token stoken) {
+            for (unsigned int spins = 0; !stoken.stop_requested(); ++spins) {
+                auto item = tryPop();
+                if (item)
+                    return item;
+                backoff(spins);
+            }
+            return std::nullopt;
+        }
+
+        // Approximate when called concurrently with a push or pop
+        bool empty() const noexcept {
+            return readIdx.load(std::memory_order_acquire) == writeIdx.load(std::memory_order_acquire);
+        }
+
+        size_t capacity() const noexcept { return size - 1; }
+    private:
+        static void backoff(unsigned int spins) {
+            if (spins < 64) return;
+            if (spins < 128) {
+                std::this_thread::yield();
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+
+        // Keep the producer and consumer indices on separate cache lines
+        static constexpr size_t CACHE_LINE_SIZE = 64;
+
+        const size_t size;
+        T* const records;
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> readIdx;
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> writeIdx;
+    };
+}
@@ -0,0 +1,90 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace wf {
+
+    // A process-wide pool for short fork-join parallel sections, such as the ones inside apriltag detection.
+    // The thread that runs a section works through its tasks too, and idle pool threads take tasks from whichever
+    // sections are running, so the pool's size is the budget of extra threads for every section in the process combined.
+    // Tasks are plain function pointers, so running a section never allocates
+    class SharedWorkerPool {
+    public:
+        struct Task {
+            void (*fn)(void*);
+            void* arg;
+        };
+
+        struct Stats {
+            uint64_t sections; // Sections run
+            uint64_t tasks; // Tasks run, by callers and pool threads
+            uint64_t helped; // Tasks run by pool threads
+        };
+
+        // The pool shared by every apriltag detector. It holds WF_DETECTOR_THREADS threads, or one less than the
+        // number of performance CPUs if that isn't set, and its threads may run on any performance CPU
+        static SharedWorkerPool& getInstance();
+
+        // cpus are the CPUs the pool's threads are pinned to. Empty leaves them unpinned
+        explicit SharedWorkerPool(size_t numThreads, std::vector<int> cpus = {});
+        ~SharedWorkerPool();
+        SharedWorkerPool(const SharedWorkerPool&) = delete;
+        SharedWorkerPool& operator=(const SharedWorkerPool&) = delete;
+
+        // Runs every task, and returns once they are all done. At most maxHelpers pool threads join the calling thread,
+        // fewer if the rest of the pool is busy with other sections
+        void run(std::span<const Task> tasks, size_t maxHelpers) noexcept;
+
+        size_t getNumThreads() const noexcept { return workers.size(); }
+        Stats getStats() const noexcept;
+    private:
+        struct Section {
+            std::span<const Task> tasks;
+            size_t maxHelpers;
+            std::atomic<size_t> next = 0; // Index of the next task to claim
+            size_t helpers = 0; // Pool threads working on the section, guarded by the pool's mutex
+            std::condition_variable done; // Signalled when the last helper leaves
+        };
+
+        static bool isJoinable(const Section& section) noexcept;
+        // Claims and runs tasks until none are left, returns how many were run
+        static size_t runTasks(Section& section) noexcept;
+        void work(std::stop_token stoken, size_t index) noexcept;
+
+        const std::vector<int> cpus;
+        std::mutex mtx;
+        std::condition_variable_any available;
+        std::vector<Section*> sections; // Sections that may still have unclaimed tasks
+        size_t nextSection = 0; // Where idle threads start looking, so sections share the pool round-robin
+        std::atomic<uint64_t> sectionsRun = 0;
+        std::atomic<uint64_t> tasksRun = 0;
+        std::atomic<uint64_t> tasksHelped = 0;
+        std::vector<std::jthread> workers; // Declared last, so the threads are gone before anything they use
+    };
+}
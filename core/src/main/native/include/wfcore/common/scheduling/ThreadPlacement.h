@@ -0,0 +1,40 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "wfcore/common/scheduling/CPUTopology.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace wf {
+
+    // The CPUs a vision worker's threads are pinned to. An empty set leaves those threads unpinned
+    struct ThreadPlacement {
+        std::vector<int> computeCPUs; // The pipeline thread, and every thread it spawns (inference runtimes). Apriltag detection is helped by the shared pool, which spans the performance tier
+        std::vector<int> auxCPUs; // Acquisition, preprocessing, and output stages
+    };
+
+    // Splits the performance tier between workers. Each worker gets a contiguous run of physical cores,
+    // so its threads share an L2 where the topology allows it, and SMT siblings are never split between workers.
+    // If there are more workers than performance cores, they all share the whole performance tier instead.
+    // Auxiliary stages go to the efficiency tier on heterogeneous systems and stay with the compute cores otherwise
+    std::vector<ThreadPlacement> planThreadPlacements(const CPUTopology& topology, size_t workers);
+}
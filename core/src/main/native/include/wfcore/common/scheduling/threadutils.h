@@ -38,11 +38,16 @@ namespace wf {
     };
 
     // Sets a thread to only run on certain CPU cores
-    int setCPUAffinity(const std::thread& thread, const std::vector<int>& cores);
+    int setCPUAffinity(std::thread& thread, const std::vector<int>& cores);
 
     // Sets thread priority of a thread
-    int setThreadPriority(const std::thread& thread, ThreadPriority priority);
+    int setThreadPriority(std::thread& thread, ThreadPriority priority);
 
     // Returns the CPUs that a given thread is allowed to run on
-    std::vector<int> getCPUAffinity(const std::thread& thread);
+    std::vector<int> getCPUAffinity(std::thread& thread);
+
+    // Variants for the calling thread, for threads that place themselves (such as std::jthreads).
+    // Threads created afterwards by the calling thread inherit its affinity and priority
+    int setCurrentThreadAffinity(const std::vector<int>& cores);
+    int setCurrentThreadPriority(ThreadPriority priority);
 }
\ No newline at end of file
@@ -20,29 +20,30 @@
 
 #pragma once
 
+#include "wfcore/fiducial/TagFamily.h"
+
 #include <opencv2/core/types.hpp>
 
-#include <vector>
-#include <string>
 #include <array>
 
 namespace wf {
 
+    // Trivially copyable, so vectors of detections can be refilled every frame without touching the heap
     struct ApriltagDetection {
         int id;
         std::array<cv::Point2d, 4> corners;
         double decisionMargin;
         double hammingDistance;
-        std::string family;
+        TagFamily family;
         ApriltagDetection(
             int id_, 
             std::array<cv::Point2d, 4> corners_, 
             double decisionMargin_, double hammingDistance_,
-            std::string family_
+            TagFamily family_
         ) : id(id_), 
             corners(std::move(corners_)),
             decisionMargin(decisionMargin_), hammingDistance(hammingDistance_),
-            family(std::move(family_)) {}
+            family(family_) {}
     };
     
 }
\ No newline at end of file
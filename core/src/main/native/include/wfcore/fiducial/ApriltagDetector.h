@@ -25,6 +25,7 @@
 #include "wfcore/utils/geometry.h"
 #include "wfcore/utils/units.h"
 #include "wfcore/common/status/StatusfulObject.h"
+#include "wfcore/simd/simd.h"
 
 #include <gtsam/geometry/Rot2.h>
 
@@ -51,6 +52,13 @@ namespace wf {
             assert(im.type() == CV_8UC1); // Asserts that the matrix contains an 8 bit grayscale image
             return detect(im.cols,im.rows,im.step[0],im.data);
         };
+        // Appends the detections to out instead of returning a new vector, so callers can reuse one between frames
+        [[nodiscard]]
+        WFStatusResult detect(int width, int height, int stride, uint8_t* buf, std::vector<ApriltagDetection>& out) const noexcept;
+        // Detects with a different quad decimation for this call only. The configured one is swapped out for the call
+        // and back afterwards, so this isn't const, and the detector can't run other detections meanwhile
+        [[nodiscard]]
+        WFStatusResult detect(const cv::Mat& im, float quadDecimate, std::vector<ApriltagDetection>& out) noexcept;
         // Returns a copy of the QTPs
         QuadThresholdParams getQuadThresholdParams() const noexcept;
         // Returns a copy of the configs
@@ -62,9 +70,14 @@ namespace wf {
         [[ nodiscard ]]
         WFStatusResult removeFamily(const std::string& familyName) noexcept;
         void clearFamilies();
+        // The kernels the threshold and gradient clustering stages of quad detection run on, the active level by default.
+        // Scalar runs apriltag's own code for them. Every level finds exactly the same detections
+        void setSimdLevel(simd::SimdLevel level) noexcept { simdLevel = level; }
+        simd::SimdLevel getSimdLevel() const noexcept { return simdLevel; }
     private:
         std::unordered_map<std::string,void*> families;
         void* detectorHandle_;
+        simd::SimdLevel simdLevel = simd::getActiveLevel();
     };
 
 
@@ -0,0 +1,80 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "wfcore/simd/simd.h"
+#include "wfcore/common/scheduling/SharedWorkerPool.h"
+
+#include <opencv2/core.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace wf {
+
+    // apriltag's adaptive threshold, the first stage of quad detection, on the wf::simd kernels. Each pixel is compared
+    // against the midpoint of the darkest and brightest pixel around it, taken over 4x4 tiles and spread to the
+    // neighbouring tiles. Tiles with less contrast than minWhiteBlackDiff come out 127, as neither white nor black.
+    // Gives exactly the image apriltag's threshold() does, without deglitching. ApriltagDetector runs it in its place
+    class ApriltagThreshold {
+    public:
+        static constexpr int TILE_SIZE = 4;
+
+        explicit ApriltagThreshold(int minWhiteBlackDiff = 5) noexcept : minWhiteBlackDiff(minWhiteBlackDiff) {}
+
+        // Thresholds an 8 bit gray frame into out, which is reallocated only if its size or type differ.
+        // Frames smaller than a tile have no tile to threshold against and come out black
+        void apply(const cv::Mat& gray, cv::Mat& out, const simd::Kernels& kernels = simd::kernels());
+        // The same, with the per pixel passes split into bands of tile rows that up to maxHelpers of pool's threads work
+        // through alongside the caller, as apriltag's threshold() does on its workerpool
+        void apply(const cv::Mat& gray, cv::Mat& out, const simd::Kernels& kernels, SharedWorkerPool& pool, size_t maxHelpers);
+
+        int getMinWhiteBlackDiff() const noexcept { return minWhiteBlackDiff; }
+        void setMinWhiteBlackDiff(int diff) noexcept { minWhiteBlackDiff = diff; }
+    private:
+        // A run of whole tile rows of the frame being thresholded. The last band also takes the rows below them
+        struct Band {
+            ApriltagThreshold* self;
+            const cv::Mat* gray;
+            cv::Mat* out;
+            const simd::Kernels* kernels;
+            size_t firstTileRow;
+            size_t endTileRow;
+        };
+
+        void run(const cv::Mat& gray, cv::Mat& out, const simd::Kernels& kernels, SharedWorkerPool* pool, size_t maxHelpers);
+        // Runs a pass over every band, on the pool if there is one
+        void runBands(void (*pass)(void*) noexcept, SharedWorkerPool* pool, size_t maxHelpers);
+        static void findExtremes(void* band) noexcept;
+        static void binarize(void* band) noexcept;
+
+        int minWhiteBlackDiff;
+        size_t tilesWide = 0;
+        size_t tilesHigh = 0;
+        // Per tile extremes, room for the blur between its two passes, and the bands and their tasks.
+        // Only grow, so steady state frames don't allocate
+        std::vector<uint8_t> mins;
+        std::vector<uint8_t> maxs;
+        std::vector<uint8_t> scratch;
+        std::vector<Band> bands;
+        std::vector<SharedWorkerPool::Task> tasks;
+    };
+}
@@ -0,0 +1,79 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "wfcore/fiducial/ApriltagDetection.h"
+
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace wf {
+
+    // Picks the quad decimation for each frame from the smallest tag seen in recent frames. Decimating makes quad
+    // detection about quadratically cheaper, but a tag needs enough decimated pixels along its sides to be found at all,
+    // so the controller decimates as far as the smallest recent tag allows. It backs off as soon as a tag gets too small,
+    // and only decimates further once every recent tag has had room to spare for a while. Tags too small for the current
+    // level are never seen, so every so often a frame is detected at the finest level to look for them
+    class DecimationController {
+    public:
+        struct Params {
+            float minDecimate = 1.0f; // Finest level, also used by the probe frames
+            float maxDecimate = 3.0f; // Coarsest level
+            float initialDecimate = 2.0f; // Level used until tags are seen, and again once they have all been gone for a window
+            double minTagSide = 12.0; // Side length, in decimated pixels, the smallest recent tag needs at the current level
+            double raiseMargin = 1.5; // How far the smallest recent tag must clear minTagSide at a coarser level before moving to it
+            int raiseAfter = 10; // Consecutive frames the smallest recent tag must clear the coarser level for
+            int window = 15; // Frames of detections the controller remembers
+            int probeInterval = 30; // Frames between full resolution probes. 0 disables probing
+            bool operator==(const Params&) const = default;
+        };
+
+        explicit DecimationController(Params params_);
+
+        // The decimation to detect the next frame with
+        float next() noexcept;
+        // Reports the tags detected in the frame last returned by next(), in full resolution pixels
+        void observe(std::span<const ApriltagDetection> detections) noexcept;
+        // Forgets every observation and goes back to the initial level
+        void reset() noexcept;
+
+        // The level the controller has settled on, which probe frames don't change
+        float getDecimate() const noexcept { return levels[level]; }
+        // Whether the frame last returned by next() is a probe
+        bool isProbing() const noexcept { return probing; }
+        const Params& getParams() const noexcept { return params; }
+
+        // Area of a tag's quad, in pixels
+        static double getTagArea(const ApriltagDetection& detection) noexcept;
+    private:
+        size_t findLevel(float decimate) const noexcept;
+
+        Params params;
+        std::vector<float> levels; // Decimations the controller moves between, finest first
+        std::vector<std::optional<double>> smallestAreas; // Ring of the smallest tag area in each remembered frame
+        size_t head = 0;
+        size_t level = 0;
+        size_t initialLevel = 0;
+        int raiseStreak = 0;
+        int framesSinceProbe = 0;
+        bool probing = false;
+    };
+}
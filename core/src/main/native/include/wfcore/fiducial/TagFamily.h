@@ -0,0 +1,71 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace wf {
+
+    // Apriltag families wayfinder can detect. The values are the family ids sent over WIPS, so they must not change
+    enum class TagFamily : uint8_t {
+        Tag36h11 = 0,
+        Tag36h10 = 1,
+        Tag25h9 = 2,
+        Tag16h5 = 3,
+        TagCircle21h7 = 4,
+        TagCircle49h12 = 5,
+        TagCustom48h12 = 6,
+        TagStandard41h12 = 7,
+        TagStandard52h13 = 8
+    };
+
+    inline constexpr std::array<std::string_view,9> TAG_FAMILY_NAMES = {
+        "tag36h11",
+        "tag36h10",
+        "tag25h9",
+        "tag16h5",
+        "tagCircle21h7",
+        "tagCircle49h12",
+        "tagCustom48h12",
+        "tagStandard41h12",
+        "tagStandard52h13"
+    };
+
+    // The name apriltag and the configuration files use for a family
+    constexpr std::string_view getTagFamilyName(TagFamily family) noexcept {
+        return TAG_FAMILY_NAMES[static_cast<size_t>(family)];
+    }
+
+    constexpr std::optional<TagFamily> parseTagFamily(std::string_view name) noexcept {
+        for (size_t i = 0; i < TAG_FAMILY_NAMES.size(); ++i) {
+            if (TAG_FAMILY_NAMES[i] == name) return static_cast<TagFamily>(i);
+        }
+        return std::nullopt;
+    }
+
+    // Validates a family id received over the wire
+    constexpr std::optional<TagFamily> getTagFamily(uint8_t id) noexcept {
+        if (id >= TAG_FAMILY_NAMES.size()) return std::nullopt;
+        return static_cast<TagFamily>(id);
+    }
+}
@@ -0,0 +1,76 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "wfcore/fiducial/ApriltagDetection.h"
+
+#include <opencv2/core/types.hpp>
+
+#include <span>
+#include <vector>
+
+namespace wf {
+
+    // Predicts where the tags of the last frame will be in the next one, so the detector only has to search
+    // a few padded regions instead of the whole frame. Each tag's region is its last bounding box, moved by the
+    // tag's velocity over the last frame when the motion model is on. Tags that aren't tracked yet can only
+    // be found in a full frame pass, which runs every refreshInterval frames and right after a tracked tag is lost
+    class TagTracker {
+    public:
+        struct Params {
+            int refreshInterval = 10; // Frames between full frame passes. 1 or less searches every frame in full
+            double padding = 0.5; // Padding added on each side of a predicted region, as a fraction of its larger side
+            int minPadding = 16; // Padding added on each side of a predicted region at the least, in pixels
+            bool useVelocity = true; // Whether to move regions by the constant velocity of their tags
+            bool operator==(const Params&) const = default;
+        };
+
+        explicit TagTracker(Params params_);
+
+        // Works out where to search the next frame. Returns false when the whole frame has to be searched,
+        // otherwise the regions to search are in getRegions()
+        bool plan(cv::Size frameSize, bool forceFullFrame = false) noexcept;
+        // Reports the tags detected in the frame last planned for, in full frame coordinates
+        void observe(std::span<const ApriltagDetection> detections) noexcept;
+        // Forgets every tag, so the next frame is searched in full
+        void reset() noexcept;
+
+        // Regions planned for the next frame. They don't overlap, so a tag is never detected twice
+        const std::vector<cv::Rect>& getRegions() const noexcept { return regions; }
+        bool isFullFrame() const noexcept { return fullFrame; }
+        const Params& getParams() const noexcept { return params; }
+    private:
+        struct Track {
+            int id;
+            TagFamily family;
+            cv::Point2d center;
+            cv::Point2d velocity; // Pixels per frame
+            cv::Rect2d bounds; // Bounding box of the tag's corners
+        };
+
+        Params params;
+        std::vector<Track> tracks;
+        std::vector<Track> nextTracks;
+        std::vector<cv::Rect> regions;
+        int framesSinceRefresh = 0;
+        bool fullFrame = true;
+        bool lost = false;
+    };
+}
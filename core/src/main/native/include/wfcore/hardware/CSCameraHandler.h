@@ -21,19 +21,21 @@
 
 #include "wfcore/hardware/CameraHandler.h"
 #include "wfcore/hardware/CSCameraSink.h"
+#include "wfcore/hardware/CameraBroadcastHub.h"
 #include <unordered_set>
 #include <cscore_oo.h>
 #include <cscore_cv.h>
 
 namespace wf {
 
-    class CSCameraHandler : public CameraHandler, private std::enable_shared_from_this<CSCameraHandler> {
+    class CSCameraHandler : public CameraHandler, public std::enable_shared_from_this<CSCameraHandler> {
         friend void CSCameraSink::acquireSource(std::shared_ptr<CSCameraHandler>& handler);
     public:
 
         CameraBackend getBackend() const noexcept { return CameraBackend::CSCORE; }
 
-        WFResult<std::shared_ptr<CameraSink>> getCameraSink(const std::string& name) override;
+        // Every sink is a subscriber of the camera's broadcast hub, so the camera is only grabbed once per frame
+        WFResult<std::shared_ptr<CameraSink>> getCameraSink(const std::string& name, FrameDropPolicy policy) override;
 
         std::string getDevPath() const { return devpath_; }
 
@@ -73,7 +75,8 @@ namespace wf {
 
     private:
         CSCameraHandler(const CameraConfiguration& config);
-        std::unordered_map<std::string,std::weak_ptr<CSCameraSink>> sinks_;
+        std::unordered_map<std::string,std::weak_ptr<CameraSink>> sinks_;
+        std::shared_ptr<CameraBroadcastHub> hub_;
         cs::UsbCamera camera_;
         std::string name_;
         std::string devpath_;
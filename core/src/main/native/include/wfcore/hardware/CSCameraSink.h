@@ -21,11 +21,14 @@
 #pragma once
 
 #include "wfcore/hardware/CameraSink.h"
+#include "wfcore/hardware/LendSlots.h"
 #include <cscore_raw.h>
 #include <cscore_cpp.h>
 #include <wpi/RawFrame.h>
 #include <memory>
 #include <mutex>
+#include <array>
+#include <atomic>
 #include "wfcore/common/wfdef.h"
 // A CSCore-based implementation of CameraSink, which pulls frames from a USB camera 
 namespace wf {
@@ -34,8 +37,14 @@ namespace wf {
     class CSCameraSink : public CameraSink, private cs::RawSink {
         friend class CSCameraHandler;
     public:
+        // Number of raw buffers the sink rotates through when lending frames
+        static constexpr int LEND_SLOTS = 4;
+
         CSCameraSink(std::shared_ptr<CSCameraHandler> handler, std::string name);
         FrameMetadata getFrame(cv::Mat& data) noexcept override;
+        FrameMetadata acquireFrame(cv::Mat& data, FrameLease& lease) noexcept override;
+        void releaseFrame(FrameLease lease) noexcept override;
+        int getLendSlots() const noexcept override { return LEND_SLOTS; }
         std::string getName() const override;
         WFResult<std::string> getCameraNickname() const override;
         WFResult<StreamFormat> getStreamFormat() const noexcept override;
@@ -43,6 +52,10 @@ namespace wf {
         void acquireSource(std::shared_ptr<CSCameraHandler>& handler);
         //mutable std::mutex camera_guard_;
         std::weak_ptr<CSCameraHandler> handler_;
-        wpi::RawFrame raw_buffer_;
+        // Camera handlers are never deallocated once registered (see HardwareManager.h), so the hot path
+        // can use a plain view instead of locking the weak_ptr every frame
+        const CSCameraHandler* handlerView_;
+        std::array<wpi::RawFrame,LEND_SLOTS> lendBuffers_;
+        LendSlots<LEND_SLOTS> slots_;
     };
 }
\ No newline at end of file
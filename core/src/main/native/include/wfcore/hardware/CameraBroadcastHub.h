@@ -0,0 +1,117 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "wfcore/hardware/CameraSink.h"
+#include "wfcore/video/FramePyramid.h"
+
+#include <opencv2/core.hpp>
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace wf {
+
+    class CameraBroadcastHub;
+
+    // Grabs each frame from a single upstream CameraSink once and lends it to every subscriber.
+    // Subscribers are CameraSinks themselves, so workers use them exactly like a direct sink.
+    // Broadcast frames are shared read-only: subscribers must not write into the frames they acquire.
+    // Each frame carries a FramePyramid, so subscribers that downscale the frame share a single pass over it
+    class CameraBroadcastHub : public std::enable_shared_from_this<CameraBroadcastHub> {
+    public:
+        // Number of frames the hub can have in flight at once, across all subscribers, when its source doesn't limit how
+        // many frames it lends. Otherwise the hub has exactly as many as the source lends, so it never asks the source for
+        // a frame it can't hand out
+        static constexpr int DEFAULT_HUB_SLOTS = 8;
+        // Number of frames a Block subscriber can have queued before the hub waits on it
+        static constexpr size_t BLOCK_QUEUE_DEPTH = 2;
+
+        static std::shared_ptr<CameraBroadcastHub> create(std::shared_ptr<CameraSink> source) {
+            return std::shared_ptr<CameraBroadcastHub>(new CameraBroadcastHub(std::move(source)));
+        }
+
+        ~CameraBroadcastHub();
+        CameraBroadcastHub(const CameraBroadcastHub&) = delete;
+        CameraBroadcastHub& operator=(const CameraBroadcastHub&) = delete;
+
+        // Creates a new subscriber. The hub starts grabbing once it has its first subscriber
+        std::shared_ptr<CameraSink> subscribe(std::string name, FrameDropPolicy policy);
+
+        const std::shared_ptr<CameraSink>& getSource() const noexcept { return source_; }
+        // Number of frames the hub can have in flight at once
+        int getSlots() const noexcept { return slots_; }
+    private:
+        friend class BroadcastSubscriber;
+
+        struct Entry {
+            cv::Mat frame;
+            std::optional<FrameMetadata> meta;
+            FrameLease upstreamLease = NULL_LEASE;
+            FramePyramid pyramid; // Built on demand by whichever subscriber first asks for a level
+            std::atomic_bool inUse = false;
+            std::atomic<int> refs = 0;
+        };
+
+        // Per-subscriber queue of entry indices, shared between the hub and the subscriber sink
+        struct Subscription {
+            FrameDropPolicy policy;
+            size_t capacity;
+            std::mutex mtx;
+            std::condition_variable cv;
+            std::array<int,BLOCK_QUEUE_DEPTH> queue;
+            size_t head = 0;
+            size_t count = 0;
+            bool closed = false;
+            std::atomic<uint64_t> dropped = 0;
+        };
+
+        explicit CameraBroadcastHub(std::shared_ptr<CameraSink> source);
+
+        void run(std::stop_token stoken) noexcept;
+        void publish(int index, std::stop_token stoken);
+        void retain(int index) noexcept;
+        void release(int index) noexcept;
+        void unsubscribe(const std::shared_ptr<Subscription>& subscription) noexcept;
+        std::optional<int> takeNext(Subscription& subscription) noexcept;
+
+        // Waits until an entry is free, or the timeout passes. Returns the entry, marked in use, or -1
+        int claimEntry(std::stop_token stoken);
+
+        std::shared_ptr<CameraSink> source_;
+        const int slots_;
+        std::unique_ptr<Entry[]> entries_;
+        // Signalled whenever an entry is freed, for the hub thread to wait on when every entry is held
+        std::mutex entriesMtx_;
+        std::condition_variable_any entryFreed_;
+        std::mutex subscriptionsMtx_;
+        std::vector<std::shared_ptr<Subscription>> subscriptions_;
+        std::vector<std::shared_ptr<Subscription>> publishList_; // Hub thread only. Keeps its capacity between frames
+        std::atomic<WFStatus> lastStatus_;
+        std::jthread thread_;
+    };
+}
@@ -37,6 +37,7 @@ namespace wf {
         REALSENSE, //WIP
         GSTREAMER, //WIP
         LIBCAMERA, //WIP
+        REPLAY, // Plays back recorded footage, for running without cameras
         UNKNOWN
     };
 
@@ -69,6 +70,10 @@ namespace wf {
 
         CameraIntrinsics() = default;
         bool operator==(const CameraIntrinsics other) const noexcept;
+        // Intrinsics of frames that have had this calibration's lens distortion remapped away (see UndistortNode)
+        CameraIntrinsics rectified() const;
+        // True if the distortion model is the identity, so points need no undistortion
+        bool isDistortionFree() const noexcept;
 
         static WFResult<JSON> toJSON_impl(const CameraIntrinsics& object);
         static WFResult<CameraIntrinsics> fromJSON_impl(const JSON& jobject);
@@ -38,7 +38,8 @@ namespace wf {
 
         virtual CameraBackend getBackend() const noexcept = 0;
 
-        virtual WFResult<std::shared_ptr<CameraSink>> getCameraSink(const std::string& name) = 0;
+        // Sinks are cached by name. Asking for a live sink again with a different policy fails with BAD_ARGUMENT
+        virtual WFResult<std::shared_ptr<CameraSink>> getCameraSink(const std::string& name, FrameDropPolicy policy) = 0;
 
         virtual WFStatusResult setStreamFormat(const StreamFormat& format) = 0;
 
@@ -24,8 +24,18 @@
 #include "wfcore/common/status.h"
 
 namespace wf {
+    // How frames are handed to a sink's consumer when it falls behind the camera
+    enum class FrameDropPolicy {
+        LatestOnly, // Frames the consumer hasn't picked up yet are replaced by newer ones
+        Block // The camera side waits for the consumer
+    };
+
     class CameraSink : public FrameProvider {
     public:
         virtual WFResult<std::string> getCameraNickname() const = 0;
+        // Sinks that pull straight from the camera only ever see frames when they ask for them
+        virtual FrameDropPolicy getDropPolicy() const noexcept { return FrameDropPolicy::Block; }
+        // Number of frames the sink replaced before its consumer picked them up
+        virtual uint64_t getDroppedFrames() const noexcept { return 0; }
     };
 }
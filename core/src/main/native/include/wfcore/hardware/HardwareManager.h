@@ -45,7 +45,7 @@ namespace wf {
 
         WFResult<CameraBackend> getBackend(const std::string& nickname) const;
 
-        WFResult<std::shared_ptr<CameraSink>> getCameraSink(const std::string& nickname, const std::string& provider_name);
+        WFResult<std::shared_ptr<CameraSink>> getCameraSink(const std::string& nickname, const std::string& provider_name, FrameDropPolicy policy);
 
         WFStatusResult setStreamFormat(const std::string& nickname, const StreamFormat& format);
 
@@ -0,0 +1,73 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "wfcore/video/FrameProvider.h"
+
+#include <array>
+#include <atomic>
+
+namespace wf {
+
+    // Tracks which of a sink's N lendable buffers are out, for sinks that lend frames through acquireFrame().
+    // Slots are handed out round robin, so a released buffer isn't refilled straight away while another one is free.
+    // Finding and lending a slot is up to the sink's single consumer thread, releasing is safe from any thread
+    template <int N>
+    class LendSlots {
+    public:
+        static constexpr int SLOTS = N;
+
+        LendSlots() noexcept {
+            for (auto& leased : leased_) leased.store(false, std::memory_order_relaxed);
+        }
+
+        // Whether a lease could have come from these slots. NULL_LEASE never could
+        static constexpr bool isValid(FrameLease lease) noexcept { return lease >= 0 && lease < N; }
+
+        // The first slot that isn't lent out, starting after the last one lent, or NULL_LEASE if they all are.
+        // The slot isn't lent until lend() is called, so a sink can fill its buffer first and give up on failure
+        FrameLease findFree() const noexcept {
+            for (int i = 0; i < N; ++i) {
+                const int candidate = (next_ + i) % N;
+                if (!leased_[candidate].load(std::memory_order_acquire)) return candidate;
+            }
+            return NULL_LEASE;
+        }
+
+        // Marks a slot from findFree() as lent out
+        void lend(FrameLease slot) noexcept {
+            leased_[slot].store(true, std::memory_order_relaxed);
+            next_ = (slot + 1) % N;
+        }
+
+        // Returns a slot. Anything that isn't a valid lease is ignored
+        void release(FrameLease lease) noexcept {
+            if (!isValid(lease)) return;
+            leased_[lease].store(false, std::memory_order_release);
+        }
+
+        bool isLeased(FrameLease lease) const noexcept {
+            return isValid(lease) && leased_[lease].load(std::memory_order_acquire);
+        }
+    private:
+        std::array<std::atomic_bool,N> leased_;
+        int next_ = 0;
+    };
+}
@@ -0,0 +1,95 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "wfcore/hardware/CameraHandler.h"
+#include "wfcore/hardware/ReplayCameraSink.h"
+#include "wfcore/hardware/CameraBroadcastHub.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace wf {
+
+    /*
+    Plays back a recording as if it were a camera, so the full vision stack can run on recorded footage without
+    hardware. devpath is the recording (see openReplayReader for the formats). The fps of the configured format
+    picks the playback mode: 0 plays the recording in real time, a positive rate plays it at that fixed rate,
+    and a negative rate plays it as fast as the workers can take frames. A format with a zero size adopts the
+    recording's own format, otherwise it has to match the recording
+    */
+    class ReplayCameraHandler : public CameraHandler, public std::enable_shared_from_this<ReplayCameraHandler> {
+    public:
+        CameraBackend getBackend() const noexcept override { return CameraBackend::REPLAY; }
+
+        // Every sink is a subscriber of the replay's broadcast hub, so each frame is read once
+        WFResult<std::shared_ptr<CameraSink>> getCameraSink(const std::string& name, FrameDropPolicy policy) override;
+
+        std::string getNickname() const override { return name_; }
+
+        // Recordings have a single format, so this only accepts the format the replay already has
+        WFStatusResult setStreamFormat(const StreamFormat& format) override;
+
+        StreamFormat getStreamFormat() override { return format_; }
+
+        void periodic() override {}
+
+        std::optional<CameraIntrinsics> getIntrinsics() override;
+
+        // Recordings have no controls
+        WFStatusResult setControl(CamControl control, int value) override;
+
+        WFResult<int> getControl(CamControl control) override;
+
+        const std::unordered_set<CamControl>* getSupportedControls() override { return &supportedControls_; }
+
+        const std::vector<StreamFormat>* getSupportedFormats() override { return &supportedFormats_; }
+
+        CameraConfiguration getConfiguration() override;
+
+        WFStatusResult setConfiguration(const CameraConfiguration& config) override;
+
+        static std::shared_ptr<ReplayCameraHandler> create(const CameraConfiguration& config) {
+            return std::shared_ptr<ReplayCameraHandler>(new ReplayCameraHandler(config));
+        }
+
+        void checkConnection() override {}
+
+        void disable() override;
+
+        void enable() override;
+
+    private:
+        ReplayCameraHandler(const CameraConfiguration& config);
+        std::unordered_map<std::string,std::weak_ptr<CameraSink>> sinks_;
+        std::shared_ptr<CameraBroadcastHub> hub_;
+        std::unique_ptr<ReplayReader> reader_; // Handed to the hub's sink once the first worker subscribes
+        std::string name_;
+        std::string devpath_;
+        StreamFormat configuredFormat_; // The format as configured, fps included
+        StreamFormat format_;
+        ReplayMode mode_;
+        std::vector<StreamFormat> supportedFormats_;
+        std::vector<CameraIntrinsics> calibrations_;
+        std::unordered_set<CamControl> supportedControls_;
+    };
+}
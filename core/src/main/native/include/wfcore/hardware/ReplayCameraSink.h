@@ -0,0 +1,106 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "wfcore/hardware/CameraSink.h"
+#include "wfcore/hardware/LendSlots.h"
+#include "wfcore/hardware/ReplayReader.h"
+#include "wfcore/video/FramePool.h"
+#include "wfcore/common/scheduling/SPSCRing.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace wf {
+    class ReplayCameraHandler;
+
+    // How fast a recording is played back
+    enum class ReplayMode {
+        RealTime, // Frames are spaced out the way they were recorded
+        FixedRate, // Frames are delivered at a fixed rate, regardless of how they were recorded
+        AsFastAsPossible // Frames are delivered as soon as they are asked for
+    };
+
+    // A CameraSink that plays back a recording, looping at the end. Frames are stamped with the time they are
+    // delivered, so frame age and latency statistics read the same as they would with a live camera.
+    // Decoded recordings are read ahead on their own thread into pooled frames, raw dumps are lent straight out
+    // of their memory mapping, so playback is never limited by I/O or decoding on the consumer's thread
+    class ReplayCameraSink : public CameraSink {
+    public:
+        // Number of decoded frames the read-ahead thread keeps ready
+        static constexpr size_t READ_AHEAD_FRAMES = 8;
+        // Number of decoded frames that can be lent out at once
+        static constexpr int LEND_SLOTS = 4;
+
+        ReplayCameraSink(
+            std::shared_ptr<ReplayCameraHandler> handler,
+            std::unique_ptr<ReplayReader> reader,
+            ReplayMode mode, int fps,
+            std::string name
+        );
+        ~ReplayCameraSink() override;
+        FrameMetadata getFrame(cv::Mat& data) noexcept override;
+        FrameMetadata acquireFrame(cv::Mat& data, FrameLease& lease) noexcept override;
+        void releaseFrame(FrameLease lease) noexcept override;
+        // Raw dumps are lent straight out of their mapping, so only decoded recordings run out of slots
+        int getLendSlots() const noexcept override { return reader_->isZeroCopy() ? 0 : LEND_SLOTS; }
+        std::string getName() const override { return name_; }
+        WFResult<std::string> getCameraNickname() const override;
+        WFResult<StreamFormat> getStreamFormat() const noexcept override;
+    private:
+        using Clock = std::chrono::steady_clock;
+        struct DecodedFrame {
+            FrameHandle frame;
+            uint64_t micros;
+        };
+
+        void readAhead(std::stop_token stoken) noexcept;
+        // Reads the next frame on the calling thread, going back to the start at the end of the recording
+        bool readNext(cv::Mat& frame, uint64_t& micros);
+        // Sleeps until the frame recorded at micros is due
+        void pace(uint64_t micros);
+
+        std::weak_ptr<ReplayCameraHandler> handler_;
+        // Camera handlers are never deallocated once registered (see HardwareManager.h)
+        const ReplayCameraHandler* handlerView_;
+        std::unique_ptr<ReplayReader> reader_;
+        const ReplayMode mode_;
+        const Clock::duration period_;
+        const std::string name_;
+
+        std::shared_ptr<FramePool> pool_;
+        std::unique_ptr<SPSCRing<DecodedFrame>> decoded_;
+        std::array<FrameHandle,LEND_SLOTS> lent_;
+        LendSlots<LEND_SLOTS> slots_;
+        std::atomic_bool readerFailed_ = false;
+
+        bool started_ = false;
+        uint64_t firstMicros_ = 0;
+        uint64_t lastMicros_ = 0;
+        Clock::time_point playbackStart_;
+        Clock::time_point lastDue_;
+
+        std::jthread readAheadThread_; // Declared last, so it stops before anything it uses is destroyed
+    };
+}
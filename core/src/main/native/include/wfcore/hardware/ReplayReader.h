@@ -0,0 +1,79 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "wfcore/video/video_types.h"
+#include "wfcore/common/status.h"
+
+#include <opencv2/core.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+
+namespace wf {
+
+    /*
+    Layout of a raw dump (.wfraw). A RawDumpHeader is followed by back to back frame records, each made of a
+    uint64_t capture timestamp in microseconds and then height * stride bytes of pixel data. All integers are
+    stored in host byte order. Raw dumps are replayed straight out of a memory mapping, without decoding or copying
+    */
+    struct RawDumpHeader {
+        static constexpr char MAGIC[8] = {'W','F','R','A','W','0','0','1'};
+        char magic[8];
+        uint32_t encoding; // ImageEncoding
+        uint32_t width;
+        uint32_t height;
+        uint32_t stride; // Bytes per row
+    };
+
+    // Reads the frames of a recording in order, along with the timestamps they were captured at
+    class ReplayReader {
+    public:
+        virtual ~ReplayReader() = default;
+        // Reads the next frame into frame. Returns false at the end of the recording.
+        // Decoding readers write into frame's existing buffer when its size and type match
+        virtual bool next(cv::Mat& frame, uint64_t& micros) = 0;
+        // Goes back to the first frame
+        virtual void rewind() = 0;
+        // Format of every frame in the recording. fps is the recording's nominal rate, or 0 if unknown
+        virtual StreamFormat getFormat() const noexcept = 0;
+        // True if next() hands out read-only views into memory that stays valid for as long as the reader exists,
+        // rather than decoding into the caller's buffer
+        virtual bool isZeroCopy() const noexcept { return false; }
+    };
+
+    // Opens a recording. Directories are read as image sequences in filename order, with capture timestamps taken
+    // from a timestamps.txt file (one value in microseconds per frame) when there is one. Files ending in .wfraw
+    // are read as raw dumps, and anything else is handed to OpenCV's video decoder
+    WFResult<std::unique_ptr<ReplayReader>> openReplayReader(const std::string& path);
+
+    // Records frames of a single format to a raw dump
+    class RawDumpWriter {
+    public:
+        RawDumpWriter(const std::string& path, FrameFormat format);
+        WFStatusResult write(const cv::Mat& frame, uint64_t micros);
+    private:
+        std::ofstream file_;
+        FrameFormat format_;
+        size_t rowBytes_;
+    };
+}
@@ -21,6 +21,8 @@
 
 #include "wfcore/inference/inference_configs.h"
 #include <opencv2/core.hpp>
+#include <array>
+#include <cstdint>
 #include <vector>
 
 // Tensorization is an additionak preprocessing step that converts an input frame into a tensor format suitable for inference.
@@ -36,8 +38,13 @@ namespace wf {
         void tensorize(const cv::Mat& input, float* tensorBuffer) const noexcept;
         const TensorParameters& getTensorParameters() const noexcept { return params; }
     private:
+        // Path for anything but 8 bit frames, which the SIMD kernels don't cover
+        void tensorizeWithOpenCV(const cv::Mat& input, float* tensorBuffer) const noexcept;
         TensorParameters params; // Parameters for how the input frame should be tensorized
         cv::Mat temp; // Temporary buffer to hold input frame
         std::vector<cv::Mat> channels; // Temporary buffer to hold channels of the input frame. This is used as tensors store image data in planar format, where each channel is stored contiguously in memory, while OpenCV mats are stored in interleaved format, where each pixel contains all channels. This is used to convert the input frame into the correct tensor format
+        std::array<float,4> channelScales{}; // scale / std of each channel, so 8 bit frames take a single multiply and add per sample
+        std::array<float,4> channelBiases{}; // -mean of each channel
+        mutable std::vector<uint8_t> planeRow; // One row of an 8 bit frame split into planes, small enough to stay in cache between the split and the normalization
     };
 }
\ No newline at end of file
@@ -23,8 +23,11 @@
 #include <networktables/NetworkTableInstance.h>
 #include <networktables/NetworkTable.h>
 #include <networktables/RawTopic.h>
+#include <networktables/DoubleArrayTopic.h>
 
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace wf {
 
@@ -32,8 +35,11 @@ namespace wf {
     public:
         NTDataPublisher(const std::shared_ptr<nt::NetworkTable> devRootTable, const std::string& name);
         void publishPipelineResult(const PipelineResult& result);
+        // Publishes [p50, p99, max] in milliseconds for every stage, under the latency subtable
+        void publishStageLatencies(const std::vector<StageLatency>& stages);
     private:
         std::shared_ptr<nt::NetworkTable> table;
         nt::RawPublisher pipelineResultPub;
+        std::unordered_map<std::string,nt::DoubleArrayPublisher> latencyPubs;
     };
 }
\ No newline at end of file
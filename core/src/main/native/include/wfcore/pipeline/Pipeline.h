@@ -28,6 +28,7 @@
 #include <optional>
 #include <cstdint>
 #include "wfcore/pipeline/config/pipeline_config.h"
+#include "wfcore/utils/LatencyHistogram.h"
 
 namespace wf {
 
@@ -40,12 +41,15 @@ namespace wf {
 
     class Pipeline {
     public:
+        // Fills result in for the frame. Callers keep handing the same result back, see PipelineResult::reset
         [[nodiscard]] 
-        virtual WFResult<PipelineResult> process(const cv::Mat& data, const FrameMetadata& meta) noexcept = 0;
+        virtual WFStatusResult process(const cv::Mat& data, const FrameMetadata& meta, PipelineResult& result) noexcept = 0;
         virtual ~Pipeline() = default;
         // The dependencies pointer to enable injecting dependencies needed for config changes (Like inference engine factories, resource managers, etc.)
         virtual PipelineType getType() const = 0;
         virtual WFStatusResult accept(PipelineVisitor& visitor) = 0;
+        // Latencies of the pipeline's internal stages, if it times any
+        virtual std::vector<StageLatency> getStageLatencies() const { return {}; }
     };
     
 }
@@ -24,6 +24,7 @@
 #include "wfcore/fiducial/ApriltagDetection.h"
 #include "wfcore/pipeline/PipelineType.h"
 #include "wfcore/inference/ObjectDetection.h"
+#include "wfcore/video/ViewTransform.h"
 
 namespace wf {
 
@@ -55,6 +56,18 @@ namespace wf {
         , aprilTagDetections(std::move(aprilTagDetections_)), aprilTagPoses(std::move(aprilTagPoses_))
         , cameraPose(std::move(cameraPose_)), objectDetections(std::move(objectDetections_)) {}
         
+        // Starts the result over for a new frame. The vectors are cleared rather than replaced,
+        // so a result that is reused between frames stops allocating once it has seen its busiest frame
+        void reset(uint64_t micros_, int64_t server_time_, PipelineType type_) noexcept {
+            micros = micros_;
+            server_time = server_time_;
+            type = type_;
+            aprilTagDetections.clear();
+            aprilTagPoses.clear();
+            cameraPose.reset();
+            objectDetections.clear();
+        }
+
         static PipelineResult ApriltagResult(
             uint64_t micros,
             int64_t server_time,
@@ -90,4 +103,8 @@ namespace wf {
         }
     };
 
+    // Moves everything in a result from the frame the pipeline processed into the view it was configured for.
+    // Pixel coordinates go through the transform, and poses are turned with the camera about its optical axis
+    void mapResultToView(PipelineResult& result, const ViewTransform& view);
+
 }
\ No newline at end of file
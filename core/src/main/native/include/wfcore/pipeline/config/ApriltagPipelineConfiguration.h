@@ -33,6 +33,13 @@ namespace wf {
         std::unordered_set<int> detectorExcludes;
         std::unordered_set<int> SolvePNPExcludes; // Does not effect tag relative solvePNP
         bool solveTagRelative; // Whether or not to solve tag relative
+        bool adaptiveDecimate; // Whether to pick the quad decimation per frame from the size of recent tags, starting from detConfig.quadDecimate
+        float maxQuadDecimate; // Coarsest decimation the adaptive controller may use
+        int decimateProbeInterval; // Frames between full resolution detections while decimating adaptively. 0 disables them
+        bool trackTags; // Whether to only search the regions tags are predicted to be in, in between full frame detections
+        int trackRefreshInterval; // Frames between full frame detections while tracking
+        double trackPadding; // Padding around each tracked region, as a fraction of the tag's size
+        bool trackVelocity; // Whether to predict tracked regions with the constant velocity of their tags
 
         ApriltagPipelineConfiguration(
             bool solvePnP_,
@@ -43,17 +50,31 @@ namespace wf {
             double apriltagSize_,
             std::unordered_set<int> detectorExcludes_,
             std::unordered_set<int> SolvePNPExcludes_,
-            bool solveTagRelative_
+            bool solveTagRelative_,
+            bool adaptiveDecimate_ = false,
+            float maxQuadDecimate_ = 3.0f,
+            int decimateProbeInterval_ = 30,
+            bool trackTags_ = false,
+            int trackRefreshInterval_ = 10,
+            double trackPadding_ = 0.5,
+            bool trackVelocity_ = true
         ) 
         : solvePnP(solvePnP_)
         , detConfig(std::move(detConfig_))
-        , detQTPs(std::move(detQTPs))
+        , detQTPs(std::move(detQTPs_))
         , apriltagField(std::move(apriltagField_))
-        , apriltagFamily(std::move(apriltagFamily))
+        , apriltagFamily(std::move(apriltagFamily_))
         , apriltagSize(apriltagSize_)
         , detectorExcludes(std::move(detectorExcludes_))
         , SolvePNPExcludes(std::move(SolvePNPExcludes_))
-        , solveTagRelative(solveTagRelative_) {}
+        , solveTagRelative(solveTagRelative_)
+        , adaptiveDecimate(adaptiveDecimate_)
+        , maxQuadDecimate(maxQuadDecimate_)
+        , decimateProbeInterval(decimateProbeInterval_)
+        , trackTags(trackTags_)
+        , trackRefreshInterval(trackRefreshInterval_)
+        , trackPadding(trackPadding_)
+        , trackVelocity(trackVelocity_) {}
 
         ApriltagPipelineConfiguration(
             bool solvePnP_,
@@ -64,17 +85,31 @@ namespace wf {
             double apriltagSize_,
             std::vector<int> detectorExcludes_,
             std::vector<int> SolvePNPExcludes_,
-            bool solveTagRelative_
+            bool solveTagRelative_,
+            bool adaptiveDecimate_ = false,
+            float maxQuadDecimate_ = 3.0f,
+            int decimateProbeInterval_ = 30,
+            bool trackTags_ = false,
+            int trackRefreshInterval_ = 10,
+            double trackPadding_ = 0.5,
+            bool trackVelocity_ = true
         )
         : solvePnP(solvePnP_)
         , detConfig(std::move(detConfig_))
-        , detQTPs(std::move(detQTPs))
+        , detQTPs(std::move(detQTPs_))
         , apriltagField(std::move(apriltagField_))
-        , apriltagFamily(std::move(apriltagFamily))
+        , apriltagFamily(std::move(apriltagFamily_))
         , apriltagSize(apriltagSize_)
         , detectorExcludes(detectorExcludes_.begin(),detectorExcludes_.end())
         , SolvePNPExcludes(SolvePNPExcludes_.begin(),SolvePNPExcludes_.end())
-        , solveTagRelative(solveTagRelative_) {}
+        , solveTagRelative(solveTagRelative_)
+        , adaptiveDecimate(adaptiveDecimate_)
+        , maxQuadDecimate(maxQuadDecimate_)
+        , decimateProbeInterval(decimateProbeInterval_)
+        , trackTags(trackTags_)
+        , trackRefreshInterval(trackRefreshInterval_)
+        , trackPadding(trackPadding_)
+        , trackVelocity(trackVelocity_) {}
         
         static const jval::JSONValidationFunctor* getValidator_impl();
         static WFResult<ApriltagPipelineConfiguration> fromJSON_impl(const JSON& jobject);
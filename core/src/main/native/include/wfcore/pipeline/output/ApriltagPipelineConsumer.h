@@ -29,12 +29,14 @@
 
 namespace wf {
 
-    // An apriltag pipeline output consumer that posts to networktables and streams video to HTTP
+    // An apriltag pipeline output consumer that posts to networktables and streams video to HTTP.
+    // Frames come in as the pipeline processed them, and are streamed turned and scaled to the view,
+    // which is what the (already mapped) results and intrinsics refer to
     class ApriltagPipelineConsumer : public PipelineOutputConsumer {
     public:
         ApriltagPipelineConsumer(
             std::string pipelineName_, std::string camLabel_, 
-            CameraIntrinsics intrinsics_, FrameFormat inputFormat_,
+            CameraIntrinsics intrinsics_, FrameFormat inputFormat_, ViewTransform view_,
             int rawPort, int processedPort, 
             StreamFormat streamFormat,
             double tagSize_, std::weak_ptr<NTDataPublisher> ntpub_
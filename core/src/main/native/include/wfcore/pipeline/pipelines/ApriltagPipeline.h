@@ -27,32 +27,66 @@
 #include "wfcore/common/json_utils.h"
 #include "wfcore/pipeline/config/ApriltagPipelineConfiguration.h"
 #include "wfcore/fiducial/ApriltagFieldHandler.h"
+#include "wfcore/fiducial/DecimationController.h"
+#include "wfcore/fiducial/TagTracker.h"
+
+#include <atomic>
+#include <memory>
+#include <optional>
 
 namespace wf {
 
     class ApriltagPipeline : public Pipeline {
     public:
         ApriltagPipeline(ApriltagPipelineConfiguration config_, CameraIntrinsics intrinsics_, ApriltagFieldHandler fieldHandler_);
-        // This is an old API, It should not be invoked directly. Use visitors instead
+        // This is an old API, It should not be invoked directly. Use visitors instead.
+        // Safe to call while the pipeline is processing. The new detector state is built on the calling thread
+        // and swapped in between frames. The processing thread lets go of the old state at the start of its next frame
         WFStatusResult setConfig(PipelineConfigVariant config);
-        ApriltagPipelineConfiguration getConfig() {
-            return config;
+        ApriltagPipelineConfiguration getConfig() const {
+            return state.load(std::memory_order_acquire)->config;
         }
         void setIntrinsics(const CameraIntrinsics& intrinsics);
         [[nodiscard]] 
-        WFResult<PipelineResult> process(const cv::Mat& data, const FrameMetadata& meta) noexcept override;
+        WFStatusResult process(const cv::Mat& data, const FrameMetadata& meta, PipelineResult& result) noexcept override;
         ~ApriltagPipeline() override = default;
         PipelineType getType() const override {
             return PipelineType::Apriltag;
         }
         WFStatusResult accept(PipelineVisitor& visitor) override { return visitor(*this); }
+        std::vector<StageLatency> getStageLatencies() const override;
     private:
-        WFStatusResult updateFieldHandler();
-        WFStatusResult updateDetectorConfig(); // Updates the apriltag detector's configuration
-        ApriltagPipelineConfiguration config;
+        // Everything process() reads from the configuration. A state is never modified once it is published,
+        // reconfiguring builds a whole new one and swaps it in
+        struct DetectionState {
+            DetectionState(ApriltagPipelineConfiguration config_, ApriltagFieldHandler fieldHandler_)
+            : config(std::move(config_))
+            , tagConfig(config.apriltagFamily,config.apriltagSize)
+            , fieldHandler(std::move(fieldHandler_)) {}
+            ApriltagPipelineConfiguration config;
+            ApriltagConfiguration tagConfig;
+            ApriltagFieldHandler fieldHandler;
+            // Detecting at the frame's decimation swaps it into the detector for the call. Like decimation and tracker
+            // below, it is only ever used by the processing thread
+            mutable ApriltagDetector detector;
+            // Only set when adaptiveDecimate is on. The controller is one of the parts of a state process() writes to,
+            // which is fine as only the processing thread touches it
+            mutable std::optional<DecimationController> decimation;
+            mutable std::optional<TagTracker> tracker; // Only set when trackTags is on, same as decimation
+        };
+        // Moves what the decimation controller and tag tracker have learned over to a new state,
+        // as long as the reconfiguration didn't change what they were built for. Processing thread only
+        static void inheritAdaptiveState(const DetectionState& from, const DetectionState& to) noexcept;
+        static WFResult<std::shared_ptr<const DetectionState>> buildState(
+            ApriltagPipelineConfiguration config,
+            const ApriltagFieldHandler& fieldHandler
+        );
         CameraIntrinsics intrinsics;
-        ApriltagConfiguration tagConfig;
-        ApriltagFieldHandler fieldHandler;
-        ApriltagDetector detector;
+        std::atomic<std::shared_ptr<const DetectionState>> state;
+        // The state the last frame ran on. Only the processing thread touches it, so replaced states are destroyed there
+        std::shared_ptr<const DetectionState> frameState;
+        LatencyHistogram detectLatency;
+        LatencyHistogram tagPnPLatency; // All tag-relative solves for a frame
+        LatencyHistogram fieldPnPLatency;
     };
 }
\ No newline at end of file
@@ -26,6 +26,8 @@
 #include <atomic>
 #include <functional>
 #include <string>
+#include <vector>
+#include <memory>
 
 #include "wfcore/common/logging.h"
 #include "wfcore/common/status.h"
@@ -34,6 +36,12 @@
 #include "wfcore/hardware/CameraSink.h"
 #include "wfcore/video/processing/CVProcessPipe.h"
 #include "wfcore/processes/VisionWorkerConfig.h"
+#include "wfcore/processes/VisionWorkerStats.h"
+#include "wfcore/common/scheduling/SPSCRing.h"
+#include "wfcore/video/FramePool.h"
+#include "wfcore/video/FramePyramid.h"
+#include "wfcore/common/scheduling/ThreadPlacement.h"
+#include "wfcore/common/scheduling/threadutils.h"
 
 #include <mutex>
 namespace wf {
@@ -46,27 +54,124 @@ namespace wf {
             std::shared_ptr<CameraSink> frameProvider_, 
             CVProcessPipe<cv::Mat> preprocessor_,
             std::unique_ptr<Pipeline> pipeline_,
-            std::unique_ptr<PipelineOutputConsumer> outputConsumer_
+            std::unique_ptr<PipelineOutputConsumer> outputConsumer_,
+            bool pipelined_,
+            int pipelineDepth_,
+            ThreadPriority threadPriority_,
+            std::vector<int> cpuAffinity_,
+            std::vector<CVProcessPipe<cv::Mat>> extraPreprocessers_ = {},
+            int preprocessLevel_ = 0
         );
         ~VisionWorker();
         void start();
         void stop();
-        WFResult<VisionWorkerConfig> getConfig();
+        // Returns the latest published configuration snapshot. Never touches the worker's threads
+        WFResult<VisionWorkerConfig> getConfig() const;
+        // Applies the parts of a configuration that can change while the worker runs (the pipeline configuration
+        // and streaming), without dropping frames. Fails if the configuration requires rebuilding the worker
         WFStatusResult applyConfig(VisionWorkerConfig& config);
+        // True if moving to config changes anything applyConfig can't apply to a running worker
+        bool requiresRebuild(const VisionWorkerConfig& config) const;
+        VisionWorkerStats getStats() const noexcept;
+        // Latency of every stage of the worker, followed by the pipeline's internal stages prefixed with "pipeline/"
+        std::vector<StageLatency> getStageLatencies() const;
+        // How the worker's preprocessing pipe runs each frame. Fixed for the lifetime of the worker
+        const PipePlan& getPreprocessPlan() const noexcept { return preprocesser.getPlan(); }
+        // Sets the CPUs the worker's threads pin themselves to. Takes effect the next time the worker starts
+        void setPlacement(ThreadPlacement placement_) { placement = std::move(placement_); }
+        const ThreadPlacement& getPlacement() const noexcept { return placement; }
+        // CPUs requested by the worker's configuration. Empty if the placement engine should choose
+        const std::vector<int>& getCPUAffinityOverride() const noexcept { return cpuAffinity; }
         const char* getThreadName() const noexcept { return threadName.c_str(); }
         const std::string& getName() const noexcept { return name; }
         const bool isRunning() const noexcept { return running.load(); }
     private:
+        // A frame lent by the frame provider, in flight between the acquisition and preprocessing stages
+        struct RawStageFrame {
+            cv::Mat frame;
+            FrameMetadata meta;
+            FrameLease lease;
+        };
+        // A pooled frame in flight between the later stages. The frame goes back to the pool when this is dropped
+        struct StagedFrame {
+            FrameHandle frame;
+            FrameMetadata meta;
+            PipelineResult result;
+        };
+
+        // One preprocessing thread of pipelined mode, with its own preprocesser and hand-off rings.
+        // The acquisition stage deals consecutive frames to the lanes round robin, and the pipeline stage
+        // collects them in the same order, so frames stay in sequence however long each lane takes
+        struct PreprocessLane {
+            CVProcessPipe<cv::Mat>* preprocesser;
+            std::unique_ptr<FramePyramid> pyramid; // Used when the frame provider doesn't share its pyramids
+            cv::Mat frameBuffer;
+            std::unique_ptr<SPSCRing<RawStageFrame>> rawQueue;
+            std::unique_ptr<SPSCRing<StagedFrame>> preprocessedQueue;
+        };
+
         void run(std::stop_token stoken) noexcept;
+
+        // Pipelined mode. Acquisition, preprocessing, the pipeline proper, and output consumption
+        // each get their own thread, connected by bounded SPSC rings of pipelineDepth frames.
+        // With extra preprocessers, preprocessing gets one thread per preprocesser
+        void startPipelined();
+        void runAcquisition(std::stop_token stoken) noexcept;
+        void runPreprocessing(std::stop_token stoken, PreprocessLane& lane) noexcept;
+        void runPipeline(std::stop_token stoken) noexcept;
+        void runOutput(std::stop_token stoken) noexcept;
+        void drainStages() noexcept;
+        void recordPublished(const FrameMetadata& meta) noexcept;
+        // The image the preprocessers read for a raw frame: the frame itself, or the pyramid level they were built for
+        const cv::Mat& selectPreprocessInput(const cv::Mat& raw, const FrameMetadata& meta, FrameLease lease, FramePyramid& fallback);
+        void placeThread(const std::vector<int>& cpus) noexcept;
+        WFResult<VisionWorkerConfig> queryConfig();
+
         std::string threadName;
         std::string name;
         std::jthread thread;
         std::atomic_bool running;
         CVProcessPipe<cv::Mat> preprocesser;
+        // Preprocessers for the additional lanes of pipelined mode, each identical to preprocesser
+        std::vector<CVProcessPipe<cv::Mat>> extraPreprocessers;
+        // Pyramid level of the raw frames the preprocessers take their input from
+        const int preprocessLevel;
+        FramePyramid localPyramid;
+        // Maps results onto the frames the worker was configured for, when the preprocesser skipped turning or scaling them
+        const ViewTransform view;
         std::unique_ptr<Pipeline> pipeline;
         std::unique_ptr<PipelineOutputConsumer> outputConsumer;
         std::shared_ptr<CameraSink> frameProvider;
         cv::Mat rawFrameBuffer;
         cv::Mat ppFrameBuffer;
+
+        const bool pipelined;
+        const int pipelineDepth;
+        std::vector<std::jthread> stageThreads;
+        std::shared_ptr<FramePool> stagePool;
+        std::vector<PreprocessLane> lanes;
+        std::unique_ptr<SPSCRing<StagedFrame>> resultQueue;
+        std::unique_ptr<SPSCRing<PipelineResult>> recycledResults; // Results the output stage is done with, back to the pipeline stage
+        bool latestOnly = false; // Set from the frame provider's drop policy when the stages start
+
+        const ThreadPriority threadPriority;
+        const std::vector<int> cpuAffinity;
+        ThreadPlacement placement;
+
+        // Immutable configuration snapshot, replaced whole by applyConfig. Readers never block the worker
+        std::atomic<std::shared_ptr<const VisionWorkerConfig>> configSnapshot;
+        std::mutex configMutex; // Serializes writers only
+
+        std::atomic<uint64_t> framesProcessed = 0;
+        std::atomic<uint64_t> framesDropped = 0;
+        std::atomic<int64_t> lastCaptureAgeUs = 0;
+        std::atomic<int64_t> captureAgeSumUs = 0;
+        std::atomic<int64_t> maxCaptureAgeUs = 0;
+        std::atomic<int64_t> lastAcquireAgeUs = 0;
+
+        LatencyHistogram grabLatency;
+        LatencyHistogram preprocessLatency;
+        LatencyHistogram pipelineLatency;
+        LatencyHistogram outputLatency;
     };
 }
\ No newline at end of file
@@ -6,7 +6,10 @@
 #include "wfcore/pipeline/pipelines/ApriltagPipeline.h"
 #include "wfcore/pipeline/pipelines/ObjectDetectionPipeline.h"
 #include "wfcore/video/video_types.h"
+#include "wfcore/hardware/CameraSink.h"
 #include "wfcore/common/json_utils.h"
+#include "wfcore/common/scheduling/threadutils.h"
+#include <vector>
 
 namespace wf {
     struct VisionWorkerConfig : public JSONSerializable<VisionWorkerConfig> {
@@ -19,6 +22,15 @@ namespace wf {
         int processed_port;
         PipelineType pipelineType;
         PipelineConfigVariant pipelineConfig;
+        bool pipelined; // Run acquisition, preprocessing, the pipeline, and output on separate threads
+        int pipelineDepth; // Number of frames each hand-off queue between pipelined stages can hold
+        FrameDropPolicy dropPolicy; // What the camera broadcast does when this worker falls behind
+        ThreadPriority threadPriority; // Scheduling priority of the worker's threads
+        std::vector<int> cpuAffinity; // CPUs to pin the worker's threads to. Empty lets the placement engine choose
+        bool stripedPreprocessing; // Push horizontal stripes of each frame through the preprocessing nodes in parallel
+        int decoderThreads; // Preprocessing threads that decode consecutive MJPEG frames in parallel in pipelined mode
+        bool undistort; // Remap frames to remove lens distortion, so the pipeline works with the rectified camera matrix
+        int rotation; // Clockwise turn of the worker's view of the camera in degrees (0, 90, 180 or 270), for rotated mounts
 
         VisionWorkerConfig(
             std::string camera_nickname_, std::string name_,
@@ -26,11 +38,24 @@ namespace wf {
             bool stream_,
             int raw_port_, int processed_port_,
             PipelineType pipelineType_,
-            PipelineConfigVariant pipelineConfig_
+            PipelineConfigVariant pipelineConfig_,
+            bool pipelined_,
+            int pipelineDepth_,
+            FrameDropPolicy dropPolicy_,
+            ThreadPriority threadPriority_,
+            std::vector<int> cpuAffinity_,
+            bool stripedPreprocessing_,
+            int decoderThreads_,
+            bool undistort_,
+            int rotation_
         ) : camera_nickname(std::move(camera_nickname_)), name(std::move(name_))
         , inputFormat(std::move(inputFormat_)), outputFormat(std::move(outputFormat_))
         , stream(stream_), raw_port(raw_port_), processed_port(processed_port_)
-        , pipelineConfig(std::move(pipelineConfig_)) {}
+        , pipelineType(pipelineType_), pipelineConfig(std::move(pipelineConfig_))
+        , pipelined(pipelined_), pipelineDepth(pipelineDepth_), dropPolicy(dropPolicy_)
+        , threadPriority(threadPriority_), cpuAffinity(std::move(cpuAffinity_))
+        , stripedPreprocessing(stripedPreprocessing_), decoderThreads(decoderThreads_)
+        , undistort(undistort_), rotation(rotation_) {}
 
         static WFResult<VisionWorkerConfig> fromJSON_impl(const JSON& jobject);
         static WFResult<JSON> toJSON_impl(const VisionWorkerConfig& config);
@@ -29,7 +29,9 @@
 #include "wfcore/common/status.h"
 #include "wfcore/inference/InferenceEngineFactory.h"
 #include "wfcore/pipeline/pipelines/ApriltagPipelineFactory.h"
+#include "wfcore/common/scheduling/CPUTopology.h"
 #include <memory>
+#include <chrono>
 
 namespace wf {
 
@@ -47,12 +49,22 @@ namespace wf {
         void destroyAllWorkers();
         void periodic() noexcept;
         WFResult<VisionWorkerConfig> getWorkerConfig(const std::string& name);
+        // Applies config to a live worker. Changes the worker can't take while running rebuild it instead
+        WFStatusResult setWorkerConfig(const std::string& name, VisionWorkerConfig config);
+        WFResult<VisionWorkerStats> getWorkerStats(const std::string& name);
+        WFResult<JSON> getWorkerLatencies_JSON(const std::string& name);
+        WFResult<JSON> getWorkerPlan_JSON(const std::string& name);
     private:
+        // Splits the CPUs between every worker that doesn't request its own. Applied as workers start
+        void placeWorkers();
         std::unordered_map<std::string,std::shared_ptr<VisionWorker>> workers;
+        const CPUTopology topology;
 
         NetworkTablesManager& ntManager;
         HardwareManager& hardwareManager;
         InferenceEngineFactory& engineFactory;
         ApriltagPipelineFactory& apriltagPipelineFactory;
+
+        std::chrono::steady_clock::time_point lastLatencyPublish;
     };
 }
\ No newline at end of file
@@ -0,0 +1,39 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include "wfcore/common/json_utils.h"
+
+namespace wf {
+    // Runtime counters for a VisionWorker. This is a snapshot, it does not update on its own
+    struct VisionWorkerStats : public JSONSerializable<VisionWorkerStats> {
+        uint64_t framesProcessed = 0; // Frames handed to the output consumer
+        uint64_t framesDropped = 0; // Frames skipped in favor of newer ones, by the worker or by its camera sink
+        // Capture to publish age, measured from FrameMetadata::micros on the cscore clock
+        int64_t lastCaptureAgeUs = 0;
+        int64_t meanCaptureAgeUs = 0;
+        int64_t maxCaptureAgeUs = 0;
+        // Grab to publish age, measured from FrameMetadata::server_time_us on the master clock
+        int64_t lastAcquireAgeUs = 0;
+
+        static WFResult<JSON> toJSON_impl(const VisionWorkerStats& stats);
+    };
+}
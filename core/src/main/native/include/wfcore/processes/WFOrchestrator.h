@@ -64,9 +64,23 @@ namespace wf {
             return getCameraConfig(nickname).and_then(CameraConfiguration::toJSON);
         }
         WFResult<VisionWorkerConfig> getWorkerConfig(const std::string& name);
+        WFStatusResult setWorkerConfig(const std::string& name, VisionWorkerConfig config);
+        WFStatusResult setWorkerConfig_JSON(const std::string& name, const JSON& config) {
+            return VisionWorkerConfig::fromJSON(config).and_then(
+                [this,name](const VisionWorkerConfig& cfg){
+                    return setWorkerConfig(name,cfg);
+                }
+            );
+        }
         WFResult<JSON> getWorkerConfig_JSON(const std::string& name) {
             return getWorkerConfig(name).and_then(VisionWorkerConfig::toJSON);
         }
+        WFResult<VisionWorkerStats> getWorkerStats(const std::string& name);
+        WFResult<JSON> getWorkerStats_JSON(const std::string& name) {
+            return getWorkerStats(name).and_then(VisionWorkerStats::toJSON);
+        }
+        WFResult<JSON> getWorkerLatencies_JSON(const std::string& name);
+        WFResult<JSON> getWorkerPlan_JSON(const std::string& name);
         static WFOrchestrator createFromEnv();
     private:
         NetworkTablesManager ntManager_;
@@ -0,0 +1,93 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Hand vectorized versions of the pixel loops wayfinder runs on every frame. The kernels are picked at runtime from
+// what the CPU supports, so their speed doesn't depend on how the bundled OpenCV was configured
+namespace wf::simd {
+
+    enum class SimdLevel {
+        Scalar, // Plain C++, also the reference every other level is tested against
+        SSE41, // x86 with SSE4.1
+        AVX2, // x86 with AVX2
+        NEON // ARM with NEON/ASIMD
+    };
+
+    // All pixels are interleaved 8 bit samples. Buffers don't need to be aligned, but sources and destinations
+    // must not overlap. Every level gives exactly the same results as the scalar kernels, except for normalize,
+    // which may round differently in the last bit if the compiler fuses the multiply and add
+    struct Kernels {
+        // Swaps the first and third channel of 3 or 4 channel pixels (BGR <-> RGB), alpha is copied
+        void (*swapRB3)(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept;
+        void (*swapRB4)(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept;
+        // Expands 3 channel pixels to 4 with an opaque alpha, optionally swapping the first and third channel
+        void (*addAlpha)(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept;
+        void (*addAlphaSwapRB)(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept;
+        // Drops the alpha of 4 channel pixels, optionally swapping the first and third channel
+        void (*dropAlpha)(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept;
+        void (*dropAlphaSwapRB)(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept;
+        // Replicates gray pixels into 3 channels, or 4 with an opaque alpha
+        void (*grayTo3)(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept;
+        void (*grayTo4)(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept;
+        // Splits 3 or 4 channel pixels into one plane per channel
+        void (*deinterleave3)(const uint8_t* src, uint8_t* const* planes, size_t pixels) noexcept;
+        void (*deinterleave4)(const uint8_t* src, uint8_t* const* planes, size_t pixels) noexcept;
+        // dst[i] = src[i] * scale[c] + bias[c], where c = i % channels. Converts samples of 1 to 4 interleaved channels to floats
+        void (*normalize)(const uint8_t* src, float* dst, size_t samples, int channels, const float* scale, const float* bias) noexcept;
+        // Averages the 2x2 blocks of two rows of 1 to 4 channel pixels into dstPixels pixels, rounding half up.
+        // This matches an INTER_AREA resize to exactly half the size
+        void (*boxDownsample2x)(const uint8_t* row0, const uint8_t* row1, uint8_t* dst, size_t dstPixels, int channels) noexcept;
+        // Writes pixels copies of a pixel of 1 to 4 channels
+        void (*fill)(uint8_t* dst, size_t pixels, const uint8_t* pixel, int channels) noexcept;
+        // Copies the Y samples out of packed 4:2:2 YUV, which sit in every other byte from offset (0 for YUYV, 1 for UYVY)
+        void (*extractLuma)(const uint8_t* src, uint8_t* dst, size_t pixels, int offset) noexcept;
+        // Averages the 2x2 blocks of Y samples of two rows of packed 4:2:2 YUV into dstPixels pixels, rounding like boxDownsample2x
+        void (*extractLumaDecimated)(const uint8_t* row0, const uint8_t* row1, uint8_t* dst, size_t dstPixels, int offset) noexcept;
+        // The per tile stages of apriltag's adaptive threshold, which works on 4x4 tiles of a gray frame.
+        // Writes the min and max of tiles consecutive tiles, whose top left pixel is src and whose rows are stride bytes apart
+        void (*tileMinMax4)(const uint8_t* src, size_t stride, uint8_t* mins, uint8_t* maxs, size_t tiles) noexcept;
+        // Binarizes one row of 4 * tiles gray pixels against the min and max of the tile each pixel is in: 127 where
+        // max - min < minContrast, otherwise 255 above min + (max - min) / 2 and 0 at or below it. No min may exceed its max
+        void (*thresholdTiles4)(const uint8_t* src, uint8_t* dst, const uint8_t* mins, const uint8_t* maxs, size_t tiles, uint8_t minContrast) noexcept;
+        // Keeps the pixels of a row that have a neighbour n with v + n == 255 among the 8 around them, and sets the rest
+        // to 127. On a thresholded frame those are the pixels on a black and white edge, the only ones apriltag's gradient
+        // clustering looks at. above, row and below are the pixels' rows, and are read one pixel either side of them
+        void (*isolateEdges)(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint8_t* dst, size_t pixels) noexcept;
+    };
+
+    std::string_view getLevelName(SimdLevel level) noexcept;
+
+    // Whether this build has kernels for a level and the CPU can run them
+    bool isSupported(SimdLevel level) noexcept;
+
+    // The best supported level. The WF_SIMD environment variable (scalar, sse4.1, avx2 or neon) lowers it,
+    // which is useful for benchmarking and for ruling the kernels out when chasing a bug. Decided on first use
+    SimdLevel getActiveLevel() noexcept;
+
+    // The kernels of a level. Unsupported levels get the scalar kernels
+    const Kernels& getKernels(SimdLevel level) noexcept;
+
+    // The kernels of the active level
+    const Kernels& kernels() noexcept;
+}
@@ -0,0 +1,101 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "wfcore/common/json_utils.h"
+
+namespace wf {
+
+    // Lock-free HDR-style latency histogram with microsecond resolution.
+    // Values below 2^SUB_BUCKET_BITS us are recorded exactly. Above that, every power of two is split
+    // into 2^SUB_BUCKET_BITS linear buckets, which bounds the relative error of any reported value to ~6%.
+    // Recording is a handful of relaxed atomic operations, so it is safe to call from any number of threads
+    class LatencyHistogram {
+    public:
+        static constexpr int SUB_BUCKET_BITS = 4;
+        static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+        static constexpr int MAX_MAGNITUDE = 27; // Values of 2^27 us (~134 s) and up land in the last bucket
+        static constexpr int NUM_BUCKETS = SUB_BUCKETS + (MAX_MAGNITUDE - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+        LatencyHistogram() noexcept { reset(); }
+        LatencyHistogram(const LatencyHistogram&) = delete;
+        LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+        void record(uint64_t micros) noexcept;
+
+        template <typename Rep, typename Period>
+        void record(std::chrono::duration<Rep,Period> duration) noexcept {
+            auto micros = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+            record(static_cast<uint64_t>(micros > 0 ? micros : 0));
+        }
+
+        // Not atomic with respect to concurrent recording, a few samples may straddle the reset
+        void reset() noexcept;
+
+        uint64_t count() const noexcept { return count_.load(std::memory_order_relaxed); }
+        uint64_t max() const noexcept { return max_.load(std::memory_order_relaxed); }
+        double mean() const noexcept;
+        // Returns the highest value equivalent to the given percentile (0-100), clamped to the maximum recorded value
+        uint64_t percentile(double p) const noexcept;
+
+        static int bucketIndex(uint64_t micros) noexcept;
+        // Lowest value that falls in a bucket
+        static uint64_t bucketLowerBound(int index) noexcept;
+        // Highest value that falls in a bucket
+        static uint64_t bucketUpperBound(int index) noexcept;
+
+        // Summary statistics plus every nonempty bucket, as [lowerBoundUs, count] pairs
+        JSON toJSON() const;
+    private:
+        std::array<std::atomic<uint64_t>,NUM_BUCKETS> buckets_;
+        std::atomic<uint64_t> count_;
+        std::atomic<uint64_t> sum_;
+        std::atomic<uint64_t> max_;
+    };
+
+    // A histogram reported under a stage name, for example "detect"
+    struct StageLatency {
+        std::string stage;
+        const LatencyHistogram* histogram;
+    };
+
+    // Maps each stage name to its full histogram
+    JSON stageLatenciesToJSON(const std::vector<StageLatency>& stages);
+
+    // Records the time between its construction and destruction into a histogram
+    class ScopedLatencyTimer {
+    public:
+        explicit ScopedLatencyTimer(LatencyHistogram& histogram) noexcept
+        : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+        ~ScopedLatencyTimer() { histogram_.record(std::chrono::steady_clock::now() - start_); }
+        ScopedLatencyTimer(const ScopedLatencyTimer&) = delete;
+        ScopedLatencyTimer& operator=(const ScopedLatencyTimer&) = delete;
+    private:
+        LatencyHistogram& histogram_;
+        std::chrono::steady_clock::time_point start_;
+    };
+}
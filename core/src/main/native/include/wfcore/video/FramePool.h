@@ -0,0 +1,106 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+#include "wfcore/video/video_types.h"
+
+namespace wf {
+
+    class FramePool;
+
+    // Internal bookkeeping for a single pooled frame. Only FramePool and FrameHandle touch this
+    struct FramePoolSlot {
+        std::atomic_bool inUse = false;
+        std::atomic<uint32_t> refcount = 0;
+        cv::Mat mat; // Header over the slot's pooled memory
+        void* data = nullptr;
+        std::shared_ptr<FramePool> owner; // Keeps the pool alive while the slot is handed out
+    };
+
+    // Refcounted handle to a frame owned by a FramePool. Copies of a handle share the same frame,
+    // which goes back to its pool once the last handle is dropped. Handles may be copied,
+    // passed between threads, and dropped from any thread without allocating.
+    // Writing into mat() is fine, but anything that would reallocate it (e.g. create() with
+    // a different size or type) detaches the header from the pooled memory
+    class FrameHandle {
+    public:
+        FrameHandle() noexcept = default;
+        FrameHandle(const FrameHandle& other) noexcept;
+        FrameHandle(FrameHandle&& other) noexcept;
+        FrameHandle& operator=(const FrameHandle& other) noexcept;
+        FrameHandle& operator=(FrameHandle&& other) noexcept;
+        ~FrameHandle() { reset(); }
+
+        void reset() noexcept;
+
+        explicit operator bool() const noexcept { return slot_ != nullptr; }
+        cv::Mat& mat() const noexcept { return slot_->mat; }
+        uint32_t useCount() const noexcept { return slot_ ? slot_->refcount.load(std::memory_order_relaxed) : 0; }
+    private:
+        friend class FramePool;
+        explicit FrameHandle(FramePoolSlot* slot) noexcept : slot_(slot) {}
+        FramePoolSlot* slot_ = nullptr;
+    };
+
+    // A fixed set of preallocated, cache line aligned frames of a single format.
+    // Acquiring and releasing frames never allocates; when every frame is in use,
+    // acquire() returns an empty handle rather than growing the pool
+    class FramePool : public std::enable_shared_from_this<FramePool> {
+    public:
+        struct Stats {
+            size_t frames; // Frames in the pool
+            size_t inUse; // Frames currently held by at least one handle
+            uint64_t acquisitions; // Successful acquire() calls
+            uint64_t exhaustions; // acquire() calls that found no free frame
+            uint64_t allocations; // Buffer allocations made by the pool. Stays at frames once constructed
+        };
+
+        static constexpr size_t ALIGNMENT = 64;
+
+        static std::shared_ptr<FramePool> create(FrameFormat format, size_t frames);
+
+        ~FramePool();
+        FramePool(const FramePool&) = delete;
+        FramePool& operator=(const FramePool&) = delete;
+
+        FrameHandle acquire() noexcept;
+
+        const FrameFormat& getFormat() const noexcept { return format_; }
+        size_t size() const noexcept { return numFrames_; }
+        Stats getStats() const noexcept;
+    private:
+        FramePool(FrameFormat format, size_t frames);
+
+        const FrameFormat format_;
+        const size_t numFrames_;
+        std::unique_ptr<FramePoolSlot[]> slots_;
+        std::atomic<size_t> nextSlot_;
+        std::atomic<uint64_t> acquisitions_;
+        std::atomic<uint64_t> exhaustions_;
+        std::atomic<uint64_t> allocations_;
+    };
+}
@@ -21,6 +21,7 @@
 #pragma once
 
 #include "wfcore/video/video_types.h"
+#include "wfcore/video/FramePyramid.h"
 #include "wfcore/common/status/ConcurrentStatusfulObject.h"
 
 #include <string>
@@ -28,10 +29,42 @@
 
 namespace wf {
 
+    // Identifies a buffer lent out by a FrameProvider through acquireFrame()
+    using FrameLease = int;
+    inline constexpr FrameLease NULL_LEASE = -1;
+
     // FrameProvider does not fully subclass StatusfulObject because they can also just act as proxies for the status of their handlers
     class FrameProvider {
     public:
+        // Copies the next frame into mat
         virtual FrameMetadata getFrame(cv::Mat& mat) = 0;
+
+        /*
+        Lends the next frame to the caller without copying it. mat is set to a header wrapping one of the provider's
+        internal buffers, which stays valid until releaseFrame() is called with the returned lease. Every successful
+        acquire MUST be matched by a release, otherwise the provider will eventually run out of buffers.
+        Providers that cannot lend buffers fall back to getFrame() and hand out NULL_LEASE.
+        */
+        virtual FrameMetadata acquireFrame(cv::Mat& mat, FrameLease& lease) noexcept {
+            lease = NULL_LEASE;
+            try {
+                return getFrame(mat);
+            } catch (...) {
+                return FrameMetadata::badFrame(WFStatus::UNKNOWN);
+            }
+        }
+
+        // Returns a lent buffer to the provider. Releasing NULL_LEASE is a no-op
+        virtual void releaseFrame(FrameLease lease) noexcept {}
+
+        // Number of buffers the provider can have lent out at once, after which acquireFrame() fails with BAD_ACQUIRE
+        // until one is released. Providers that fall back to getFrame() have no limit and return 0
+        virtual int getLendSlots() const noexcept { return 0; }
+
+        // Image pyramid of a lent frame, shared with everyone else the same frame was lent to. Valid until the
+        // lease is released. Providers that don't share frames have none and return nullptr
+        virtual FramePyramid* getPyramid(FrameLease lease) noexcept { return nullptr; }
+
         virtual ~FrameProvider() noexcept = default;
         virtual std::string getName() const = 0;
         virtual WFResult<StreamFormat> getStreamFormat() const noexcept = 0;
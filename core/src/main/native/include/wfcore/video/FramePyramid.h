@@ -0,0 +1,65 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "wfcore/video/video_types.h"
+
+#include <opencv2/core.hpp>
+
+#include <array>
+#include <atomic>
+#include <mutex>
+
+namespace wf {
+
+    // Half and quarter resolution copies of a frame, built at most once per frame and shared by everything that
+    // wants the frame smaller. Level 0 is the frame itself, and each level after it averages 2x2 blocks of the
+    // one before (OpenCV's vectorized INTER_AREA path for exact halving). Levels are built on first use, so a
+    // frame nobody downscales costs nothing. Buffers are kept from frame to frame and only reallocated when
+    // the frame size changes
+    class FramePyramid {
+    public:
+        static constexpr int LEVELS = 3;
+
+        FramePyramid() = default;
+        FramePyramid(const FramePyramid&) = delete;
+        FramePyramid& operator=(const FramePyramid&) = delete;
+
+        // Points the pyramid at the next frame. Must not race with getLevel()
+        void reset(const cv::Mat& base_, ImageEncoding encoding_) noexcept;
+        // The frame at 1/2^level of its size, clamped to the deepest level its encoding supports.
+        // Several threads may ask for levels of the same frame at once
+        const cv::Mat& getLevel(int level);
+
+        // Number of levels, including the frame itself, for frames of an encoding. Packed and compressed
+        // encodings can't be box filtered without unpacking them, so they only have level 0
+        static int getLevelCount(ImageEncoding encoding) noexcept;
+        static cv::Size getLevelSize(cv::Size size, int level) noexcept {
+            return cv::Size(size.width >> level,size.height >> level);
+        }
+        // Deepest level of a format that is at least size in both dimensions
+        static int chooseLevel(const FrameFormat& format, cv::Size size) noexcept;
+    private:
+        std::mutex buildMutex;
+        std::array<cv::Mat,LEVELS> levels; // levels[0] is a header over the frame
+        int levelCount = 1;
+        std::atomic<int> built = 1; // Levels below this are ready for the current frame
+    };
+}
@@ -0,0 +1,64 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "wfcore/hardware/CameraConfiguration.h"
+
+#include <opencv2/core.hpp>
+
+namespace wf {
+
+    // Maps pixel coordinates in the frames a pipeline actually processed onto the frames it was configured for,
+    // when the preprocessing planner skipped geometric nodes and left the pixels where they were (see elideGeometry).
+    // Any chain of quarter turns and resizes comes down to a number of clockwise quarter turns followed by a scale,
+    // with the scale given by the frame sizes. Coordinates follow OpenCV's convention of integers at pixel centers
+    class ViewTransform {
+    public:
+        // The identity on frames of an unknown size
+        ViewTransform() = default;
+        ViewTransform(int quarterTurns_, cv::Size sourceSize_, cv::Size viewSize_);
+
+        static ViewTransform identity(cv::Size size) { return ViewTransform(0,size,size); }
+        // A cv::rotate of frames of size by rotation (a cv::RotateFlags)
+        static ViewTransform rotation(cv::Size size, int rotation);
+        static ViewTransform scale(cv::Size from, cv::Size to) { return ViewTransform(0,from,to); }
+
+        // This transform followed by next. next must start from the view of this one
+        ViewTransform then(const ViewTransform& next) const;
+
+        bool isIdentity() const noexcept { return quarterTurns == 0 && sourceSize == viewSize; }
+        int getQuarterTurns() const noexcept { return quarterTurns; }
+        cv::Size getSourceSize() const noexcept { return sourceSize; }
+        cv::Size getViewSize() const noexcept { return viewSize; }
+
+        cv::Point2d apply(cv::Point2d point) const noexcept;
+        // Maps a point in coordinates normalized to [0,1] by the frame size. Scaling leaves these as they are
+        cv::Point2d applyNormalized(cv::Point2d point) const noexcept;
+        // Intrinsics of a camera that sees the view, from the intrinsics of the camera that sees the source.
+        // A quarter turn is a quarter turn of the camera about its optical axis, so the focal lengths swap and the
+        // tangential distortion terms turn with it. A calibration made at another resolution than the source is scaled
+        // to it first. Calibrations without a camera matrix are returned as they are
+        CameraIntrinsics apply(const CameraIntrinsics& intrinsics) const;
+    private:
+        int quarterTurns = 0; // Clockwise, 0 to 3
+        cv::Size sourceSize;
+        cv::Size viewSize;
+    };
+}
@@ -25,3 +25,9 @@
 #include "wfcore/video/processing/ResizeNode.h"
 #include "wfcore/video/processing/RotateNode.h"
 #include "wfcore/video/processing/IdentityNode.h"
+#include "wfcore/video/processing/LetterboxNode.h"
+#include "wfcore/video/processing/LumaExtractNode.h"
+#include "wfcore/video/processing/MJPEGDecodeNode.h"
+#include "wfcore/video/processing/UndistortNode.h"
+#include "wfcore/video/processing/FusedNode.h"
+#include "wfcore/video/processing/PipePlanner.h"
@@ -21,6 +21,14 @@
 
 #include "wfcore/video/video_types.h"
 #include "wfcore/video/video_utils.h"
+#include "wfcore/video/ViewTransform.h"
+
+#include <opencv2/core.hpp>
+
+#include <cstddef>
+#include <optional>
+#include <string>
+
 namespace wf {
     template <CVImage T>
     class CVProcessNode {
@@ -38,6 +46,37 @@ namespace wf {
         inline const ImageEncoding& getOutcoding() { return outcoding; }
         inline T& getOutpad() { return outpad; }
         virtual void process() noexcept = 0;
+
+        // Striped execution. Nodes that can produce any band of their outpad rows on their own override these,
+        // which lets CVProcessPipe push horizontal stripes of a frame through the chain in parallel
+        virtual bool isStripeable() const noexcept { return false; }
+        // Stripes of the outpad must start and end on multiples of this many rows
+        virtual int getRowStep() const noexcept { return 1; }
+        // Rows of the inpad that map onto outRows of the outpad
+        virtual cv::Range getInputRows(const cv::Range& outRows) const noexcept { return outRows; }
+        // Rows past getInputRows, on either side, that the node also reads. A node with a halo reads rows that
+        // other stripes produce, so the pipe finishes the upstream nodes for every stripe before running it
+        virtual int getHalo() const noexcept { return 0; }
+        // Sets up scratch space for up to stripes concurrent processRows calls, each producing at most maxRows rows
+        virtual void prepareStripes(int stripes, int maxRows) {}
+        // Produces outRows of the outpad. Called concurrently for disjoint rows, each caller with its own stripe index
+        virtual void processRows(const cv::Range& outRows, int stripe) noexcept {}
+
+        // Planning. CVProcessPipe uses these to clean up its chain and to explain what it runs
+        // A short description of the node, for people reading the plan
+        virtual std::string describe() const { return "Node"; }
+        // True if the node's outpad always matches its inpad, so the node can be dropped
+        virtual bool isNoOp() const noexcept { return false; }
+        // Rough cost of processing one frame, in bytes read and written
+        virtual size_t estimateBytesTouched() const noexcept {
+            return inpad->total() * inpad->elemSize() + outpad.total() * outpad.elemSize();
+        }
+        // Where the node moves each pixel, for nodes that only turn or scale the frame. The planner may skip these
+        // and map whatever the pipeline finds through the transform instead, see elideGeometry
+        virtual std::optional<ViewTransform> getGeometry() const { return std::nullopt; }
+        // True if the node does the same thing to a frame however it is turned or scaled,
+        // so geometric nodes ahead of it may still be skipped
+        virtual bool commutesWithGeometry() const noexcept { return false; }
     protected:
         const ImageEncoding* incoding;
         const T* inpad;
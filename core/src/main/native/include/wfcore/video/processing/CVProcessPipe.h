@@ -21,17 +21,78 @@
 
 #include <vector>
 #include <ranges>
+#include <algorithm>
+#include <numeric>
 #include "wfcore/video/video_types.h"
 #include "wfcore/video/processing/CVProcessNode.h"
+#include "wfcore/video/processing/FusedNode.h"
+#include "wfcore/video/processing/PipePlanner.h"
 #include "wfcore/video/video_utils.h"
+#include "wfcore/common/logging.h"
+
+#include <opencv2/core.hpp>
 
 namespace wf {
+
+    enum class PipeExecution {
+        Sequential, // Each node processes the whole frame before the next one starts. Adjacent nodes may be fused
+        Striped // Horizontal stripes of the frame go through the whole chain while they're still in cache, spread across cores
+    };
+
     template <CVImage T>
     class CVProcessPipe {
     public:
-        CVProcessPipe(FrameFormat inputFormat, std::vector<std::unique_ptr<CVProcessNode<T>>> nodes_) : nodes(std::move(nodes_)), informat(inputFormat) {
+        // Target size of a stripe of input, small enough for a stripe and its intermediates to stay in L2
+        static constexpr size_t STRIPE_BYTES = 128 * 1024;
+
+        // The chain is planned for inputFormat: nodes that do nothing for it are dropped, and resizes and color conversions
+        // are merged or reordered where that is cheaper and gives the same output, see optimizeNodes.
+        // In sequential mode, recognized runs of adjacent nodes are then fused into single cache blocked passes, see FusedNode.
+        // Striped mode already keeps each stripe in cache from node to node, so the nodes are left as they are.
+        // A pipe whose consumer only needs the positions of things in the frame may elide geometry: turns, and resizes
+        // if the elision allows it, at the end of the chain are skipped, and getViewTransform() maps the output onto
+        // what they would have produced
+        CVProcessPipe(
+            FrameFormat inputFormat,
+            std::vector<std::unique_ptr<CVProcessNode<T>>> nodes_,
+            PipeExecution execution_ = PipeExecution::Sequential,
+            GeometryElision elision = GeometryElision::None
+        )
+        : nodes(std::move(nodes_))
+        , execution(execution_)
+        , informat(inputFormat) {
             inpad = generateEmptyCVImg<T>(inputFormat);
+            plan.rewrites = optimizeNodes(nodes,&inpad,&(informat.encoding));
+            if (elision != GeometryElision::None)
+                view = elideGeometry(nodes,&inpad,&(informat.encoding),elision,plan.rewrites);
+            if (execution == PipeExecution::Sequential)
+                nodes = fuseNodes(std::move(nodes));
+            linkNodes();
+            if (elision == GeometryElision::None)
+                view = ViewTransform::identity(outformat.size());
+        }
+
+        // The nodes point at the pipe's own pads, so they're relinked after a move
+        CVProcessPipe(CVProcessPipe&& other)
+        : nodes(std::move(other.nodes))
+        , execution(other.execution)
+        , informat(other.informat)
+        , inpad(std::move(other.inpad))
+        , plan(std::move(other.plan))
+        , view(other.view) {
+            linkNodes();
+        }
+
+        CVProcessPipe& operator=(CVProcessPipe&& other) {
+            if (this == &other) return *this;
+            nodes = std::move(other.nodes);
+            execution = other.execution;
+            informat = other.informat;
+            inpad = std::move(other.inpad);
+            plan = std::move(other.plan);
+            view = other.view;
             linkNodes();
+            return *this;
         }
         /*
         Processes an image without any internal allocations. NOTE: OUTPAD WILL BE CONNECTED TO INTERNAL BUFFERS AFTER THIS OPERATION!
@@ -53,12 +114,6 @@ namespace wf {
             outpad->copyTo(out);
         }
 
-        void setInputFormat(FrameFormat inputFormat) {
-            inpad = generateEmptyCVImg<T>(inputFormat);
-            this->informat = inputFormat;
-            linkNodes();
-            this->outformat = getFormat(*(this->outpad));
-        }
         inline const FrameFormat& getInputFormat() {return this->informat;}
 
         [[nodiscard]]
@@ -71,8 +126,45 @@ namespace wf {
         }
 
         const FrameFormat& getOutformat() { return outformat; }
+        PipeExecution getExecution() const noexcept { return execution; }
+        // The chain as it actually runs, with the rewrites made while planning it
+        const PipePlan& getPlan() const noexcept { return plan; }
+        // Maps coordinates in the pipe's output onto the output of the chain it was given. The identity unless geometry was elided
+        const ViewTransform& getViewTransform() const noexcept { return view; }
+        // True if any of the pipe's nodes is an N
+        template <typename N>
+        bool hasNode() const noexcept {
+            return std::any_of(nodes.begin(),nodes.end(),[](const auto& node){
+                return dynamic_cast<const N*>(node.get()) != nullptr;
+            });
+        }
 
     private:
+        // A run of nodes that is executed as a unit. Within a striped segment every stripe runs through all
+        // of the segment's nodes independently. A node with a halo always starts a new segment
+        struct Segment {
+            size_t begin;
+            size_t end;
+            bool striped;
+            int stripes;
+            std::vector<cv::Range> rows; // Outpad rows of node begin + k in stripe j, at rows[j * (end - begin) + k]
+        };
+
+        class StripeBody : public cv::ParallelLoopBody {
+        public:
+            StripeBody(const CVProcessPipe& pipe_, const Segment& segment_) : pipe(pipe_), segment(segment_) {}
+            void operator()(const cv::Range& stripes) const override {
+                const size_t width = segment.end - segment.begin;
+                for (int j = stripes.start; j < stripes.end; ++j) {
+                    for (size_t k = segment.begin; k < segment.end; ++k)
+                        pipe.nodes[k]->processRows(segment.rows[j * width + (k - segment.begin)],j);
+                }
+            }
+        private:
+            const CVProcessPipe& pipe;
+            const Segment& segment;
+        };
+
         void linkNodes() {
             const T* pad = &inpad;
             const ImageEncoding* encoding = &(informat.encoding);
@@ -84,20 +176,135 @@ namespace wf {
             this->outpad = pad;
             this->outformat = FrameFormat(
                 *encoding,
-                this->outpad->rows,
-                this->outpad->cols
+                this->outpad->cols,
+                this->outpad->rows
             );
+            plan.steps = describeNodes(nodes,informat);
+            plan.bytesTouched = 0;
+            for (const auto& step : plan.steps) plan.bytesTouched += step.bytesTouched;
+            if (execution == PipeExecution::Striped) planStripes();
         }
+
+        void planStripes() {
+            segments.clear();
+            size_t begin = 0;
+            while (begin < nodes.size()) {
+                size_t end = begin + 1;
+                if (nodes[begin]->isStripeable()) {
+                    while (end < nodes.size() && nodes[end]->isStripeable() && nodes[end]->getHalo() == 0)
+                        ++end;
+                }
+                segments.push_back(planSegment(begin,end));
+                begin = end;
+            }
+            if (!verifyStripes()) {
+                LoggerManager::getInstance().getLogger("CVProcessPipe")->warn(
+                    "Striped preprocessing doesn't match sequential preprocessing for this input, running nodes on whole frames"
+                );
+                for (auto& segment : segments) segment.striped = false;
+            }
+        }
+
+        Segment planSegment(size_t begin, size_t end) {
+            Segment segment{begin,end,false,1,{}};
+            if (!nodes[begin]->isStripeable()) return segment;
+            // Stripe boundaries have to land on a row step of every node. Walking back from the last node,
+            // grow the granularity (in rows of the last outpad) until each node's boundaries do
+            long long granularity = 1;
+            long long rowsPerUnit = 1; // Rows of the current node's outpad per unit of granularity
+            for (size_t k = end; k-- > begin;) {
+                const long long step = nodes[k]->getRowStep();
+                const long long scale = step / std::gcd(rowsPerUnit,step);
+                granularity *= scale;
+                rowsPerUnit *= scale;
+                rowsPerUnit = nodes[k]->getInputRows(cv::Range(0,static_cast<int>(rowsPerUnit))).size();
+            }
+            const int outRows = nodes[end - 1]->getOutpad().rows;
+            if (granularity > outRows || outRows % granularity != 0) return segment;
+            const int units = static_cast<int>(outRows / granularity);
+
+            const T& in = *(nodes[begin]->getInpad());
+            const size_t inBytes = in.total() * in.elemSize();
+            const int stripes = std::clamp<int>(
+                static_cast<int>((inBytes + STRIPE_BYTES - 1) / STRIPE_BYTES),
+                std::min(cv::getNumThreads(),units),
+                units
+            );
+            if (stripes < 2) return segment;
+
+            const size_t width = end - begin;
+            segment.rows.resize(stripes * width);
+            std::vector<int> maxRows(width,0);
+            for (int j = 0; j < stripes; ++j) {
+                const long long u0 = static_cast<long long>(j) * units / stripes;
+                const long long u1 = static_cast<long long>(j + 1) * units / stripes;
+                cv::Range rows(static_cast<int>(u0 * granularity),static_cast<int>(u1 * granularity));
+                for (size_t k = end; k-- > begin;) {
+                    segment.rows[j * width + (k - begin)] = rows;
+                    maxRows[k - begin] = std::max(maxRows[k - begin],rows.size());
+                    rows = nodes[k]->getInputRows(rows);
+                }
+            }
+            for (size_t k = begin; k < end; ++k)
+                nodes[k]->prepareStripes(stripes,maxRows[k - begin]);
+            segment.striped = true;
+            segment.stripes = stripes;
+            return segment;
+        }
+
+        // Runs a noise frame through the chain both ways and compares the results bit for bit
+        bool verifyStripes() {
+            if (std::none_of(segments.begin(),segments.end(),[](const Segment& segment){ return segment.striped; }))
+                return true;
+            T probe = generateEmptyCVImg<T>(informat);
+            cv::randu(probe,cv::Scalar::all(0),cv::Scalar::all(CV_MAT_DEPTH(probe.type()) == CV_16U ? 65536 : 256));
+            T saved = inpad;
+            inpad = probe;
+            processSequential();
+            T expected = outpad->clone();
+            processStriped();
+            const bool match = expected.size() == outpad->size()
+                && expected.type() == outpad->type()
+                && cv::norm(expected,*outpad,cv::NORM_INF) == 0;
+            inpad = saved;
+            return match;
+        }
+
         void process() noexcept {
+            if (execution == PipeExecution::Striped) {
+                processStriped();
+                return;
+            }
+            processSequential();
+        }
+
+        void processSequential() noexcept {
             for (auto& node : nodes) {
                 node->process();
             }
         }
+
+        void processStriped() noexcept {
+            for (const auto& segment : segments) {
+                if (!segment.striped) {
+                    for (size_t k = segment.begin; k < segment.end; ++k)
+                        nodes[k]->process();
+                    continue;
+                }
+                StripeBody body(*this,segment);
+                cv::parallel_for_(cv::Range(0,segment.stripes),body,segment.stripes);
+            }
+        }
+
         std::vector<std::unique_ptr<CVProcessNode<T>>> nodes;
+        PipeExecution execution;
+        std::vector<Segment> segments;
         FrameFormat informat;
         FrameFormat outformat;
         ImageEncoding incoding;
         T inpad;
         const T* outpad;
+        PipePlan plan;
+        ViewTransform view;
     };
-}
\ No newline at end of file
+}
@@ -30,8 +30,19 @@ namespace wf {
         ColorConvertNode(ImageEncoding outcoding_);
         void updateBuffers() override;
         void process() noexcept override;
+        // Whether the conversion is a single per-pixel pass that can run on any row range of the inpad.
+        // Identity conversions and conversions through a temporary buffer aren't
+        bool isPixelwise() const noexcept { return pixelwise; }
+        // Runs the conversion on an arbitrary image of the inpad's encoding
+        void convert(const T& in, T& out) const { colorConverter(in,out); }
+        bool isStripeable() const noexcept override { return pixelwise; }
+        void processRows(const cv::Range& outRows, int stripe) noexcept override;
+        std::string describe() const override;
+        bool isNoOp() const noexcept override { return *(this->incoding) == this->outcoding; }
+        bool commutesWithGeometry() const noexcept override { return true; }
     private:
         std::function<void(const T& in,T& out)> colorConverter;
+        bool pixelwise = false;
         void updateColorConverter();
     };
 }
\ No newline at end of file
@@ -0,0 +1,109 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "wfcore/video/processing/CVProcessNode.h"
+#include "wfcore/video/processing/ColorConvertNode.h"
+#include "wfcore/video/processing/LetterboxNode.h"
+#include "wfcore/video/processing/ResizeNode.h"
+#include "wfcore/video/processing/RotateNode.h"
+
+#include <opencv2/core.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace wf {
+
+    // Runs two adjacent nodes as a single cache blocked pass. The frame is processed in horizontal bands small
+    // enough to stay in cache, and each band goes through both operations before the next band is read, so the
+    // intermediate image never makes a round trip through main memory and the result is written straight to the final pad.
+    // The fused pass only takes over once it has been checked to give exactly the same output as the two nodes run
+    // one after the other; if the pair can't be fused for the current input, the nodes just run unfused
+    class FusedNode : public CVProcessNode<cv::Mat> {
+    public:
+        FusedNode(std::unique_ptr<CVProcessNode<cv::Mat>> first_, std::unique_ptr<CVProcessNode<cv::Mat>> second_);
+        void updateBuffers() override;
+        void process() noexcept override;
+        bool isFused() const noexcept { return fused; }
+        std::string describe() const override;
+        // Unfused, the intermediate image goes through memory like it would between two separate nodes
+        size_t estimateBytesTouched() const noexcept override;
+    protected:
+        // Prepares the fused pass for the current inpad. Returns false if the pair can't be fused
+        virtual bool plan() = 0;
+        virtual void processFused(const cv::Mat& in) noexcept = 0;
+        std::unique_ptr<CVProcessNode<cv::Mat>> first;
+        std::unique_ptr<CVProcessNode<cv::Mat>> second;
+        cv::Mat stripe; // Holds the intermediate result for one band
+    private:
+        bool verify();
+        bool fused = false;
+    };
+
+    // ResizeNode -> ColorConvertNode
+    class ResizeConvertNode : public FusedNode {
+    public:
+        using FusedNode::FusedNode;
+    protected:
+        bool plan() override;
+        void processFused(const cv::Mat& in) noexcept override;
+    private:
+        int srcStep, dstStep, bandSteps;
+    };
+
+    // ColorConvertNode -> ResizeNode
+    class ConvertResizeNode : public FusedNode {
+    public:
+        using FusedNode::FusedNode;
+    protected:
+        bool plan() override;
+        void processFused(const cv::Mat& in) noexcept override;
+    private:
+        int srcStep, dstStep, bandSteps;
+    };
+
+    // ColorConvertNode -> LetterboxNode
+    class ConvertLetterboxNode : public FusedNode {
+    public:
+        using FusedNode::FusedNode;
+    protected:
+        bool plan() override;
+        void processFused(const cv::Mat& in) noexcept override;
+    private:
+        int srcStep, dstStep, bandSteps;
+    };
+
+    // RotateNode -> ColorConvertNode
+    class RotateConvertNode : public FusedNode {
+    public:
+        using FusedNode::FusedNode;
+    protected:
+        bool plan() override;
+        void processFused(const cv::Mat& in) noexcept override;
+    private:
+        int bandRows;
+    };
+
+    // Replaces every recognized pair of adjacent nodes with the matching FusedNode.
+    // Only cv::Mat pipes are fused, UMat pipes are returned untouched
+    template <CVImage T>
+    std::vector<std::unique_ptr<CVProcessNode<T>>> fuseNodes(std::vector<std::unique_ptr<CVProcessNode<T>>> nodes);
+}
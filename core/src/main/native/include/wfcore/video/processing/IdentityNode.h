@@ -30,5 +30,9 @@ namespace wf {
         IdentityNode() = default;
         void updateBuffers();
         void process() noexcept override;
+        std::string describe() const override { return "Identity"; }
+        bool isNoOp() const noexcept override { return true; }
+        bool commutesWithGeometry() const noexcept override { return true; }
+        size_t estimateBytesTouched() const noexcept override { return 0; }
     };
 }
\ No newline at end of file
@@ -24,6 +24,9 @@
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
 
+#include <array>
+#include <cstdint>
+
 namespace wf {
     template <CVImage T>
     class LetterboxNode : public CVProcessNode<T> {
@@ -36,7 +39,15 @@ namespace wf {
         );
         void updateBuffers() override;
         void process() noexcept override;
+        double getScale() const noexcept { return scale; }
+        int getInterpolater() const noexcept { return interpolater; }
+        const cv::Scalar& getFillColor() const noexcept { return fillColor; }
+        // Where the resized image lands in the outpad
+        cv::Rect getContentRect() const noexcept { return {leftPadding,topPadding,resizedWidth,resizedHeight}; }
+        std::string describe() const override;
     private:
+        // Paints the padding around the content rect with the fill color
+        void fillBars() noexcept;
         int targetWidth;
         int targetHeight;
         double scale;
@@ -49,7 +60,8 @@ namespace wf {
         int rightPadding;
         int bottomPadding;
         cv::Scalar fillColor;
+        std::array<uint8_t,4> fillPixel{}; // fillColor as raw bytes
         int interpolater;
-        T resizedImageBuffer; // Temporary buffer to store resized image before applying the border
+        T resizedImageBuffer; // Temporary buffer to store resized image before applying the border. Only used by cv::UMat letterboxes
     };
 }
\ No newline at end of file
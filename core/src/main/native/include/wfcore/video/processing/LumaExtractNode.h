@@ -0,0 +1,69 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "wfcore/video/processing/CVProcessNode.h"
+#include "wfcore/video/video_types.h"
+
+#include <opencv2/core.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace wf {
+
+    // A plane of 8 bit samples that sit pixelStride bytes apart within a row, such as the Y samples of a packed YUV frame
+    struct StridedPlane {
+        const uint8_t* data;
+        int width;
+        int height;
+        size_t rowStride;
+        int pixelStride;
+    };
+
+    // Pulls the luma plane out of a YUYV or UYVY frame into a Y8 outpad, optionally decimating 2x in the same pass.
+    // This replaces a YUV to BGR conversion followed by a BGR to gray conversion. Decimation averages each 2x2 block,
+    // which gives the same result as resizing the frame to half size with INTER_AREA and then extracting the luma.
+    // In view mode nothing is copied: the outpad is left empty, and getPlane() describes the Y samples in place
+    // (with decimation, the top left sample of each 2x2 block) for consumers that accept a strided plane.
+    // AprilTag detection doesn't, apriltag's images need the samples of a row next to each other
+    class LumaExtractNode : public CVProcessNode<cv::Mat> {
+    public:
+        explicit LumaExtractNode(bool decimate_ = false, bool view_ = false);
+        void updateBuffers() override;
+        void process() noexcept override;
+        // The luma plane of the last processed frame
+        StridedPlane getPlane() const noexcept;
+        bool isStripeable() const noexcept override { return !view; }
+        cv::Range getInputRows(const cv::Range& outRows) const noexcept override;
+        void processRows(const cv::Range& outRows, int stripe) noexcept override;
+        std::string describe() const override;
+        // A view only touches the samples its consumer reads
+        size_t estimateBytesTouched() const noexcept override {
+            return view ? 0 : CVProcessNode<cv::Mat>::estimateBytesTouched();
+        }
+        // Every output sample depends only on the samples under it. A view has no outpad to measure the frame by
+        bool commutesWithGeometry() const noexcept override { return !view; }
+    private:
+        const bool decimate;
+        const bool view;
+        int lumaOffset; // Byte offset of the first Y sample in a macropixel
+    };
+}
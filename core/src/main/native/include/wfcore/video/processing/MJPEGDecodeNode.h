@@ -0,0 +1,63 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "wfcore/video/processing/CVProcessNode.h"
+#include "wfcore/video/video_types.h"
+
+#include <opencv2/core.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace wf {
+
+    // Decodes an MJPEG frame into a Y8 or BGR24 outpad. MJPEG frames travel through the pipe as a single row of
+    // CV_8UC1 holding the compressed bitstream, so the node is told the size of the encoded image up front.
+    // A Y8 outpad only decodes the luma component; the chroma components are entropy decoded but never transformed
+    // or upsampled. With a scale denominator of 2, 4, or 8 the decoder scales in the DCT domain, producing an image
+    // ceil(width / denominator) by ceil(height / denominator) pixels for a fraction of the cost of a full decode.
+    // Built with libjpeg-turbo, the node keeps its own decompressor. Otherwise it falls back to OpenCV's imdecode.
+    // A frame that fails to decode leaves the outpad holding the previous frame, and is counted in getFailures()
+    class MJPEGDecodeNode : public CVProcessNode<cv::Mat> {
+    public:
+        MJPEGDecodeNode(cv::Size encodedSize_, ImageEncoding outcoding_, int scaleDenom_ = 1);
+        ~MJPEGDecodeNode() override;
+        MJPEGDecodeNode(const MJPEGDecodeNode&) = delete;
+        MJPEGDecodeNode& operator=(const MJPEGDecodeNode&) = delete;
+        void updateBuffers() override;
+        void process() noexcept override;
+        int getScaleDenom() const noexcept { return scaleDenom; }
+        uint64_t getFailures() const noexcept { return failures.load(std::memory_order_relaxed); }
+        std::string describe() const override;
+
+        // Size of an encodedSize image decoded with a scale denominator of scaleDenom
+        static cv::Size getDecodedSize(cv::Size encodedSize, int scaleDenom) noexcept;
+        // Largest supported scale denominator that still decodes an encodedSize image to at least targetSize
+        static int chooseScaleDenom(cv::Size encodedSize, cv::Size targetSize) noexcept;
+    private:
+        const cv::Size encodedSize;
+        const int scaleDenom;
+        void* decompressor; // tjhandle when built with libjpeg-turbo
+        cv::Mat decoded; // Output of the imdecode fallback
+        std::atomic<uint64_t> failures;
+    };
+}
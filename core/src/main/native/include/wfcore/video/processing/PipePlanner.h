@@ -0,0 +1,93 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "wfcore/video/processing/CVProcessNode.h"
+#include "wfcore/video/video_types.h"
+#include "wfcore/video/ViewTransform.h"
+#include "wfcore/common/json_utils.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace wf {
+
+    // One node of a planned chain, with the formats it sees and its estimated memory traffic per frame
+    struct PipePlanStep {
+        std::string node;
+        FrameFormat input;
+        FrameFormat output;
+        size_t bytesTouched;
+    };
+
+    // What a CVProcessPipe runs for every frame, and how the planner got there from the nodes it was given
+    struct PipePlan {
+        std::vector<PipePlanStep> steps;
+        std::vector<std::string> rewrites; // Changes made to the chain, and changes that were turned down
+        size_t bytesTouched = 0;
+        // Human readable plan, one line per step followed by the rewrites
+        std::string explain() const;
+    };
+
+    JSON pipePlanToJSON(const PipePlan& plan);
+
+    // Points every node at the outpad of the node before it, and the first node at input
+    template <CVImage T>
+    void linkChain(std::vector<std::unique_ptr<CVProcessNode<T>>>& nodes, const T* input, const ImageEncoding* encoding);
+
+    // Rewrites a chain into a cheaper one with the same output. Nodes that are no-ops for the input are dropped,
+    // consecutive resizes with the same interpolation are merged into one, and a resize is moved to the other side of
+    // an adjacent color conversion when that moves fewer bytes. A merge or move is only kept once a noise frame has
+    // been checked to come out bit for bit the same as before. The chain is left linked to input.
+    // Returns a description of every rewrite that was made or turned down
+    template <CVImage T>
+    std::vector<std::string> optimizeNodes(
+        std::vector<std::unique_ptr<CVProcessNode<T>>>& nodes,
+        const T* input,
+        const ImageEncoding* encoding
+    );
+
+    // Which of the geometric nodes at the end of a chain elideGeometry may skip
+    enum class GeometryElision {
+        None,
+        Turns, // Quarter turns only, so whatever consumes the output still sees it at the size the chain gives it
+        All // Resizes too, so the output stays at the size of whatever came before them, however large that is
+    };
+
+    // Drops the geometric nodes (see CVProcessNode::getGeometry) that only have nodes which commute with geometry after
+    // them, so the chain's output keeps the geometry of its input. Returns the transform from the new chain's output
+    // onto the old one's, which whoever consumes the output applies to the points it finds instead of the pixels.
+    // With GeometryElision::Turns, the first node from the end that changes the frame's scale is kept, along with
+    // everything before it. Rewrites made are appended to rewrites. The chain is left linked to input
+    template <CVImage T>
+    ViewTransform elideGeometry(
+        std::vector<std::unique_ptr<CVProcessNode<T>>>& nodes,
+        const T* input,
+        const ImageEncoding* encoding,
+        GeometryElision elision,
+        std::vector<std::string>& rewrites
+    );
+
+    // Describes a linked chain, step by step
+    template <CVImage T>
+    std::vector<PipePlanStep> describeNodes(const std::vector<std::unique_ptr<CVProcessNode<T>>>& nodes, const FrameFormat& input);
+}
@@ -23,6 +23,8 @@
 #include "wfcore/video/video_types.h"
 #include <opencv2/core.hpp>
 
+#include <vector>
+
 namespace wf {
     template <CVImage T>
     class ResizeNode : public CVProcessNode<T> {
@@ -31,8 +33,27 @@ namespace wf {
         ResizeNode(int outWidth_, int outHeight_);
         void updateBuffers() override;
         void process() noexcept override;
+        int getInterpolater() const noexcept { return interpolater; }
+        const cv::Size& getOutsize() const noexcept { return outsize; }
+        bool isStripeable() const noexcept override { return stripeable; }
+        int getRowStep() const noexcept override { return dstStep; }
+        cv::Range getInputRows(const cv::Range& outRows) const noexcept override;
+        int getHalo() const noexcept override { return halo; }
+        void prepareStripes(int stripes, int maxRows) override;
+        void processRows(const cv::Range& outRows, int stripe) noexcept override;
+        std::string describe() const override;
+        // cv::resize copies a frame that is already the right size
+        bool isNoOp() const noexcept override { return this->inpad->size() == outsize; }
+        std::optional<ViewTransform> getGeometry() const override { return ViewTransform::scale(this->inpad->size(),outsize); }
+        bool commutesWithGeometry() const noexcept override { return true; }
     private:
         int interpolater;
         cv::Size outsize;
+        // The vertical scale as a ratio of whole rows. Every srcStep inpad rows map onto dstStep outpad rows
+        int srcStep = 1;
+        int dstStep = 1;
+        int halo = 0;
+        bool stripeable = false;
+        std::vector<T> stripeScratch; // Per stripe buffers for resizing a band widened by the halo
     };
 }
\ No newline at end of file
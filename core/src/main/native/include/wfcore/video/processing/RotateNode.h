@@ -28,6 +28,14 @@ namespace wf {
         RotateNode(int rotation_);
         void updateBuffers() override;
         void process() noexcept override;
+        int getRotation() const noexcept { return rotation; }
+        bool isStripeable() const noexcept override;
+        cv::Range getInputRows(const cv::Range& outRows) const noexcept override;
+        int getHalo() const noexcept override;
+        void processRows(const cv::Range& outRows, int stripe) noexcept override;
+        std::string describe() const override;
+        std::optional<ViewTransform> getGeometry() const override;
+        bool commutesWithGeometry() const noexcept override { return true; }
     private:
         int rotation;
     };
@@ -0,0 +1,66 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "wfcore/video/processing/CVProcessNode.h"
+#include "wfcore/hardware/CameraConfiguration.h"
+
+#include <opencv2/core.hpp>
+
+#include <memory>
+
+namespace wf {
+
+    // Lookup tables for remapping a frame of one size to remove the lens distortion of one calibration.
+    // map1 holds the integer source coordinates and map2 the fixed point interpolation weights (CV_16SC2 and CV_16UC1)
+    struct RemapTables {
+        CameraIntrinsics intrinsics;
+        cv::Size size;
+        cv::Mat map1;
+        cv::Mat map2;
+    };
+
+    // Removes lens distortion with a single bilinear remap, so the pipeline can work with the rectified camera
+    // matrix (CameraIntrinsics::rectified()) and skip the distortion model for every detected point.
+    // The remap tables are built once per calibration and frame size, and shared by every node that needs them.
+    // Frames smaller or larger than the calibration resolution use a camera matrix scaled to match
+    class UndistortNode : public CVProcessNode<cv::Mat> {
+    public:
+        explicit UndistortNode(CameraIntrinsics intrinsics_);
+        void updateBuffers() override;
+        void process() noexcept override;
+        // Every output row can read from anywhere in the inpad, so stripes wait for the whole inpad
+        bool isStripeable() const noexcept override { return true; }
+        cv::Range getInputRows(const cv::Range& outRows) const noexcept override;
+        int getHalo() const noexcept override { return this->inpad->rows; }
+        void processRows(const cv::Range& outRows, int stripe) noexcept override;
+        std::string describe() const override;
+        // The remap tables are read once per frame too
+        size_t estimateBytesTouched() const noexcept override;
+        // The tables follow the frame size, and a frame that was never turned is the frame the calibration describes
+        bool commutesWithGeometry() const noexcept override { return true; }
+
+        // Returns the tables for intrinsics at size, building them if no other node already has
+        static std::shared_ptr<const RemapTables> getTables(const CameraIntrinsics& intrinsics, cv::Size size);
+    private:
+        const CameraIntrinsics intrinsics;
+        std::shared_ptr<const RemapTables> tables;
+    };
+}
@@ -24,6 +24,7 @@
 #include <opencv2/core/mat.hpp>
 #include <cstdint>
 #include <concepts>
+#include <string_view>
 
 namespace wf {
 
@@ -44,6 +45,9 @@ namespace wf {
         UNKNOWN
     };
 
+    // Name of the encoding, as it is spelled in configuration files
+    std::string_view getEncodingName(ImageEncoding encoding) noexcept;
+
     // TODO: Change order to be (width,height,encoding)
     struct FrameFormat : public JSONSerializable<FrameFormat> {
         ImageEncoding encoding;
@@ -110,7 +114,7 @@ namespace wf {
         }
 
         static constexpr FrameMetadata badFrame(WFStatus status) noexcept {
-            return FrameMetadata(0,0,FrameFormat(),WFStatus::UNKNOWN);
+            return FrameMetadata(0,0,FrameFormat(),status);
         }
     };
 }
\ No newline at end of file
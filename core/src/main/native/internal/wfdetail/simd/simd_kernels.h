@@ -0,0 +1,66 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "wfcore/simd/simd.h"
+
+// Shared between the kernel translation units. The vectorized kernels fall back to the scalar ones for the pixels
+// left over after their last full vector
+namespace wf::simd::detail {
+
+    // Long enough to hold a whole number of pixels of 1 to 4 channels and a whole number of vectors of up to 32 bytes
+    inline constexpr size_t PATTERN_LENGTH = 96;
+
+    namespace scalar {
+        void swapRB3(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept;
+        void swapRB4(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept;
+        void addAlpha(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept;
+        void addAlphaSwapRB(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept;
+        void dropAlpha(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept;
+        void dropAlphaSwapRB(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept;
+        void grayTo3(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept;
+        void grayTo4(const uint8_t* src, uint8_t* dst, size_t pixels) noexcept;
+        void deinterleave3(const uint8_t* src, uint8_t* const* planes, size_t pixels) noexcept;
+        void deinterleave4(const uint8_t* src, uint8_t* const* planes, size_t pixels) noexcept;
+        void normalize(const uint8_t* src, float* dst, size_t samples, int channels, const float* scale, const float* bias) noexcept;
+        void boxDownsample2x(const uint8_t* row0, const uint8_t* row1, uint8_t* dst, size_t dstPixels, int channels) noexcept;
+        void fill(uint8_t* dst, size_t pixels, const uint8_t* pixel, int channels) noexcept;
+        void extractLuma(const uint8_t* src, uint8_t* dst, size_t pixels, int offset) noexcept;
+        void extractLumaDecimated(const uint8_t* row0, const uint8_t* row1, uint8_t* dst, size_t dstPixels, int offset) noexcept;
+        void tileMinMax4(const uint8_t* src, size_t stride, uint8_t* mins, uint8_t* maxs, size_t tiles) noexcept;
+        void thresholdTiles4(const uint8_t* src, uint8_t* dst, const uint8_t* mins, const uint8_t* maxs, size_t tiles, uint8_t minContrast) noexcept;
+        void isolateEdges(const uint8_t* above, const uint8_t* row, const uint8_t* below, uint8_t* dst, size_t pixels) noexcept;
+    }
+
+    // Repeats the per channel scale and bias over PATTERN_LENGTH samples, so vector loops can load them
+    // for any number of channels without shuffling
+    void expandPattern(int channels, const float* scale, const float* bias, float* scalePattern, float* biasPattern) noexcept;
+    // Repeats a pixel over PATTERN_LENGTH bytes
+    void expandPattern(int channels, const uint8_t* pixel, uint8_t* pattern) noexcept;
+
+    Kernels makeScalarKernels() noexcept;
+#if defined(__x86_64__) || defined(__i386__)
+    Kernels makeSSE41Kernels() noexcept;
+    Kernels makeAVX2Kernels() noexcept;
+#endif
+#if defined(__ARM_NEON)
+    Kernels makeNEONKernels() noexcept;
+#endif
+}
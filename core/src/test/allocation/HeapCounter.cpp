@@ -0,0 +1,96 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "HeapCounter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    // Live ScopedHeapCounts. Allocations are only counted while there is one
+    std::atomic<int> activeCounts = 0;
+    std::atomic<uint64_t> heapAllocations = 0;
+
+    void* allocate(std::size_t size) noexcept {
+        if (activeCounts.load(std::memory_order_relaxed) > 0)
+            heapAllocations.fetch_add(1, std::memory_order_relaxed);
+        return std::malloc(size ? size : 1);
+    }
+
+    void* allocate(std::size_t size, std::align_val_t align) noexcept {
+        if (activeCounts.load(std::memory_order_relaxed) > 0)
+            heapAllocations.fetch_add(1, std::memory_order_relaxed);
+        // aligned_alloc wants a size that is a multiple of the alignment
+        const auto alignment = std::max(static_cast<std::size_t>(align), sizeof(void*));
+        const std::size_t rounded = (std::max<std::size_t>(size, 1) + alignment - 1) / alignment * alignment;
+        return std::aligned_alloc(alignment, rounded);
+    }
+
+    void* allocateOrThrow(std::size_t size) {
+        if (void* ptr = allocate(size)) return ptr;
+        throw std::bad_alloc();
+    }
+
+    void* allocateOrThrow(std::size_t size, std::align_val_t align) {
+        if (void* ptr = allocate(size, align)) return ptr;
+        throw std::bad_alloc();
+    }
+}
+
+namespace wf::test {
+
+    ScopedHeapCount::ScopedHeapCount() noexcept {
+        activeCounts.fetch_add(1, std::memory_order_seq_cst);
+        start = heapAllocations.load(std::memory_order_seq_cst);
+    }
+
+    ScopedHeapCount::~ScopedHeapCount() {
+        activeCounts.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    uint64_t ScopedHeapCount::allocations() const noexcept {
+        return heapAllocations.load(std::memory_order_seq_cst) - start;
+    }
+}
+
+void* operator new(std::size_t size) { return allocateOrThrow(size); }
+void* operator new[](std::size_t size) { return allocateOrThrow(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new(std::size_t size, std::align_val_t align) { return allocateOrThrow(size, align); }
+void* operator new[](std::size_t size, std::align_val_t align) { return allocateOrThrow(size, align); }
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept { return allocate(size, align); }
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept { return allocate(size, align); }
+
+// Both allocators hand out memory that free() releases
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { std::free(ptr); }
@@ -0,0 +1,41 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace wf::test {
+
+    // Counts the heap allocations made through operator new, from any thread, while it is alive, so tests can
+    // check that a hot loop never hits the heap. HeapCounter.cpp replaces every replaceable form of operator new
+    // and delete to do this, which is why these tests build into wfcore_alloc_tests rather than wfcore_tests
+    class ScopedHeapCount {
+    public:
+        ScopedHeapCount() noexcept;
+        ~ScopedHeapCount();
+        ScopedHeapCount(const ScopedHeapCount&) = delete;
+        ScopedHeapCount& operator=(const ScopedHeapCount&) = delete;
+
+        // Allocations made since this count started
+        uint64_t allocations() const noexcept;
+    private:
+        uint64_t start;
+    };
+}
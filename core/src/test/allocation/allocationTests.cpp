@@ -0,0 +1,143 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "HeapCounter.h"
+
+#include "wfcore/video/FramePool.h"
+#include "wfcore/configuration/ResourceManager.h"
+#include "wfcore/fiducial/ApriltagFieldHandler.h"
+#include "wfcore/hardware/CameraConfiguration.h"
+#include "wfcore/pipeline/PipelineResult.h"
+#include "wfcore/pipeline/config/ApriltagPipelineConfiguration.h"
+#include "wfcore/pipeline/pipelines/ApriltagPipeline.h"
+
+#include <atomic>
+#include <cstdint>
+#include <format>
+#include <new>
+#include <thread>
+#include <unordered_set>
+
+#include <gtest/gtest.h>
+#include <opencv2/imgcodecs.hpp>
+
+// This is for development environments only. Tests will NOT work once installed
+#define RESOURCE_PATH "../../../test-resources"
+
+// Tests that every form of operator new is counted, and only while a count is alive
+TEST(allocationTests, HeapCounterTest){
+    constexpr auto align = std::align_val_t(64);
+    {
+        wf::test::ScopedHeapCount count;
+        void* ptrs[] = {
+            ::operator new(24),
+            ::operator new[](24),
+            ::operator new(24,std::nothrow),
+            ::operator new[](24,std::nothrow),
+            ::operator new(24,align),
+            ::operator new[](24,align),
+            ::operator new(24,align,std::nothrow),
+            ::operator new[](24,align,std::nothrow)
+        };
+        EXPECT_EQ(count.allocations(),8u);
+        for (int i = 4; i < 8; ++i) EXPECT_EQ(reinterpret_cast<uintptr_t>(ptrs[i]) % 64,0u);
+        ::operator delete(ptrs[0]);
+        ::operator delete[](ptrs[1]);
+        ::operator delete(ptrs[2],std::nothrow);
+        ::operator delete[](ptrs[3],std::nothrow);
+        ::operator delete(ptrs[4],align);
+        ::operator delete[](ptrs[5],24,align);
+        ::operator delete(ptrs[6],align,std::nothrow);
+        ::operator delete[](ptrs[7],align,std::nothrow);
+        EXPECT_EQ(count.allocations(),8u);
+    }
+    void* uncounted = ::operator new(24);
+    ::operator delete(uncounted,24);
+    wf::test::ScopedHeapCount count;
+    EXPECT_EQ(count.allocations(),0u);
+}
+
+// Tests that handing pooled frames between threads never allocates once the pool is built
+TEST(allocationTests, FramePoolSteadyStateAllocationTest){
+    auto pool = wf::FramePool::create(wf::FrameFormat(wf::ImageEncoding::BGR24,1280,720),4);
+    std::atomic<int> handedOff = 0;
+    wf::FrameHandle mailbox[2];
+    std::atomic_bool full[2] = {false,false};
+    constexpr int iterations = 10000;
+
+    wf::test::ScopedHeapCount count;
+    {
+        std::jthread consumer([&]() {
+            for (int i = 0; i < iterations; ++i) {
+                auto& slot = mailbox[i % 2];
+                while (!full[i % 2].load(std::memory_order_acquire)) std::this_thread::yield();
+                wf::FrameHandle frame = std::move(slot);
+                full[i % 2].store(false, std::memory_order_release);
+                frame.mat().at<cv::Vec3b>(0,0)[0] = static_cast<uchar>(i);
+                handedOff.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+        const auto threadStart = count.allocations();
+
+        for (int i = 0; i < iterations; ++i) {
+            wf::FrameHandle frame;
+            while (!(frame = pool->acquire())) std::this_thread::yield();
+            while (full[i % 2].load(std::memory_order_acquire)) std::this_thread::yield();
+            mailbox[i % 2] = frame;
+            full[i % 2].store(true, std::memory_order_release);
+        }
+        consumer.join();
+        // Starting the consumer thread may allocate, the handoffs mustn't
+        EXPECT_EQ(count.allocations() - threadStart,0u);
+    }
+
+    EXPECT_EQ(handedOff.load(),iterations);
+    auto stats = pool->getStats();
+    EXPECT_EQ(stats.allocations,4u);
+    EXPECT_EQ(stats.acquisitions,static_cast<uint64_t>(iterations));
+    EXPECT_EQ(stats.inUse,0u);
+}
+
+// Tests that an AprilTag pipeline stops allocating once its result and the detector's scratch have seen a frame.
+// apriltag's own C allocations and cv::solvePnP are outside of what this covers, so PnP is off
+TEST(allocationTests, ApriltagPipelineSteadyStateAllocationTest){
+    const cv::Mat image = cv::imread(RESOURCE_PATH "/apriltag/robots.jpg",cv::IMREAD_GRAYSCALE);
+    ASSERT_FALSE(image.empty());
+    const wf::FrameMetadata meta(0,0,wf::FrameFormat(wf::ImageEncoding::Y8,image.cols,image.rows));
+    wf::ResourceManager resources;
+    for (int numThreads : {1,4}) {
+        SCOPED_TRACE(std::format("{} threads",numThreads));
+        wf::ApriltagPipelineConfiguration config(
+            false,{.numThreads = numThreads,.quadDecimate = 2.0f},{},"","tag36h11",0.1651,
+            std::unordered_set<int>{},std::unordered_set<int>{},false
+        );
+        wf::ApriltagPipeline pipeline(std::move(config),wf::CameraIntrinsics(),wf::ApriltagFieldHandler(resources));
+        wf::PipelineResult result;
+        ASSERT_TRUE(pipeline.process(image,meta,result));
+        const auto detections = result.aprilTagDetections.size();
+        EXPECT_GT(detections,0u);
+
+        wf::test::ScopedHeapCount count;
+        for (int i = 0; i < 10; ++i) {
+            ASSERT_TRUE(pipeline.process(image,meta,result));
+            EXPECT_EQ(result.aprilTagDetections.size(),detections);
+        }
+        EXPECT_EQ(count.allocations(),0u);
+    }
+}
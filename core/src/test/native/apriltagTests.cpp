@@ -18,15 +18,29 @@
  */
 
 #include "wfcore/fiducial/ApriltagDetector.h"
+#include "wfcore/fiducial/ApriltagThreshold.h"
+#include "wfcore/fiducial/DecimationController.h"
+#include "wfcore/fiducial/TagTracker.h"
 #include "wfcore/common/logging/LoggerManager.h"
+#include "wfcore/common/scheduling/SharedWorkerPool.h"
 #include "wfcore/pipeline/annotations.h"
+#include "wfcore/simd/simd.h"
+
+#include <apriltag.h>
+#include <common/image_u8.h>
+#include <common/workerpool.h>
 
 #include <opencv2/core.hpp>
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
 #include <opencv2/highgui.hpp>
+#include <algorithm>
 #include <iostream>
 #include <filesystem>
+#include <format>
+#include <string>
+#include <type_traits>
+#include <vector>
 #include <gtest/gtest.h>
 
 // This is for development environments only. Tests will NOT work once installed
@@ -118,4 +132,282 @@ DETECTION_TEST(
     "tag36h11",
     {},
     {}
-)
\ No newline at end of file
+)
+
+TEST(apriltagTests,tagFamilyTest) {
+    for (auto name : wf::TAG_FAMILY_NAMES) {
+        auto family = wf::parseTagFamily(name);
+        ASSERT_TRUE(family.has_value()) << name;
+        EXPECT_EQ(wf::getTagFamilyName(*family),name);
+        EXPECT_EQ(wf::getTagFamily(static_cast<uint8_t>(*family)),family);
+    }
+    // Family ids go over the wire, so they are pinned
+    EXPECT_EQ(static_cast<int>(wf::TagFamily::Tag36h11),0);
+    EXPECT_EQ(static_cast<int>(wf::TagFamily::TagStandard52h13),8);
+    EXPECT_FALSE(wf::parseTagFamily("tag37h11").has_value());
+    EXPECT_FALSE(wf::getTagFamily(9).has_value());
+    static_assert(std::is_trivially_copyable_v<wf::ApriltagDetection>);
+}
+
+// Detecting into the same vector frame after frame shouldn't reallocate it once it has grown
+TEST(apriltagTests,reusedDetectionStorageTest) {
+    cv::Mat image = cv::imread(RESOURCE_PATH "/apriltag/robots.jpg");
+    ASSERT_FALSE(image.empty());
+    cv::Mat gray;
+    cv::cvtColor(image,gray,cv::COLOR_BGR2GRAY);
+    wf::ApriltagDetector detector;
+    ASSERT_TRUE(detector.addFamily("tag36h11"));
+    std::vector<wf::ApriltagDetection> detections;
+    detections.reserve(64);
+    const auto* storage = detections.data();
+    ASSERT_TRUE(detector.detect(gray,2.0f,detections));
+    const auto expected = detections.size();
+    EXPECT_EQ(detections.data(),storage);
+    for (int i = 0; i < 3; ++i) {
+        detections.clear();
+        ASSERT_TRUE(detector.detect(gray,2.0f,detections));
+        EXPECT_EQ(detections.size(),expected);
+        EXPECT_EQ(detections.data(),storage);
+    }
+    for (const auto& detection : detections)
+        EXPECT_EQ(detection.family,wf::TagFamily::Tag36h11);
+    // The per-call decimation doesn't stick
+    EXPECT_FLOAT_EQ(detector.getConfig().quadDecimate,wf::ApriltagDetectorConfig().quadDecimate);
+}
+
+// Detectors run their parallel sections on the shared pool, not on threads of apriltag's own workerpool
+TEST(apriltagTests,sharedWorkerPoolTest) {
+    cv::Mat image = cv::imread(RESOURCE_PATH "/apriltag/robots.jpg");
+    ASSERT_FALSE(image.empty());
+    cv::Mat gray;
+    cv::cvtColor(image,gray,cv::COLOR_BGR2GRAY);
+    wf::ApriltagDetector detector;
+    detector.setConfig({.numThreads = 4});
+    ASSERT_TRUE(detector.addFamily("tag36h11"));
+    const auto before = wf::SharedWorkerPool::getInstance().getStats();
+    ASSERT_TRUE(detector.detect(gray));
+    const auto after = wf::SharedWorkerPool::getInstance().getStats();
+    EXPECT_GT(after.sections,before.sections);
+    EXPECT_GT(after.tasks,before.tasks);
+}
+
+static wf::ApriltagDetection squareTag(double side) {
+    return wf::ApriltagDetection(
+        0,
+        {cv::Point2d(0,0),cv::Point2d(side,0),cv::Point2d(side,side),cv::Point2d(0,side)},
+        100.0,0.0,
+        wf::TagFamily::Tag36h11
+    );
+}
+
+TEST(apriltagTests,decimationTagAreaTest) {
+    EXPECT_DOUBLE_EQ(wf::DecimationController::getTagArea(squareTag(10.0)),100.0);
+    // Opposite winding
+    wf::ApriltagDetection flipped(
+        0,
+        {cv::Point2d(0,0),cv::Point2d(0,10),cv::Point2d(10,10),cv::Point2d(10,0)},
+        100.0,0.0,
+        wf::TagFamily::Tag36h11
+    );
+    EXPECT_DOUBLE_EQ(wf::DecimationController::getTagArea(flipped),100.0);
+}
+
+TEST(apriltagTests,decimationControllerTest) {
+    wf::DecimationController::Params params;
+    params.probeInterval = 0;
+    wf::DecimationController controller(params);
+    EXPECT_FLOAT_EQ(controller.next(),2.0f);
+
+    // A tag too small for decimate 2 backs off at once
+    std::vector<wf::ApriltagDetection> small{squareTag(20.0)};
+    controller.observe(small);
+    EXPECT_FLOAT_EQ(controller.getDecimate(),1.5f);
+
+    // Large tags only raise the decimation once the small one has left the window, and then one level per streak
+    std::vector<wf::ApriltagDetection> large{squareTag(200.0)};
+    int frames = 0;
+    while (controller.getDecimate() < 2.0f && frames < 100) {
+        controller.next();
+        controller.observe(large);
+        ++frames;
+    }
+    EXPECT_EQ(frames,params.window - 1 + params.raiseAfter);
+    for (int i = 0; i < params.raiseAfter; ++i) {
+        controller.next();
+        controller.observe(large);
+    }
+    EXPECT_FLOAT_EQ(controller.getDecimate(),3.0f);
+
+    // With nothing in view for a whole window, the controller goes back to where it started
+    for (int i = 0; i < params.window; ++i) {
+        controller.next();
+        controller.observe({});
+    }
+    EXPECT_FLOAT_EQ(controller.getDecimate(),2.0f);
+}
+
+TEST(apriltagTests,decimationProbeTest) {
+    wf::DecimationController::Params params;
+    params.probeInterval = 5;
+    wf::DecimationController controller(params);
+    std::vector<wf::ApriltagDetection> large{squareTag(200.0)};
+    int probes = 0;
+    for (int i = 0; i < 18; ++i) {
+        float decimate = controller.next();
+        if (controller.isProbing()) {
+            EXPECT_FLOAT_EQ(decimate,1.0f);
+            ++probes;
+        }
+        controller.observe(large);
+    }
+    EXPECT_EQ(probes,3);
+}
+
+static wf::ApriltagDetection squareTagAt(int id, double x, double y, double side) {
+    return wf::ApriltagDetection(
+        id,
+        {cv::Point2d(x,y),cv::Point2d(x + side,y),cv::Point2d(x + side,y + side),cv::Point2d(x,y + side)},
+        100.0,0.0,
+        wf::TagFamily::Tag36h11
+    );
+}
+
+TEST(apriltagTests,tagTrackerRegionTest) {
+    wf::TagTracker::Params params;
+    params.minPadding = 0;
+    wf::TagTracker tracker(params);
+    const cv::Size frame(1600,1200);
+    // Nothing is tracked yet
+    EXPECT_FALSE(tracker.plan(frame));
+
+    std::vector<wf::ApriltagDetection> tags{squareTagAt(1,100,100,100),squareTagAt(2,1000,800,100)};
+    tracker.observe(tags);
+    ASSERT_TRUE(tracker.plan(frame));
+    ASSERT_EQ(tracker.getRegions().size(),2);
+    EXPECT_EQ(tracker.getRegions()[0],cv::Rect(50,50,200,200));
+    EXPECT_EQ(tracker.getRegions()[1],cv::Rect(1000 - 50,800 - 50,200,200));
+
+    // Moving 10 pixels right per frame shifts the region ahead of the tag and widens it by the velocity
+    std::vector<wf::ApriltagDetection> moved{squareTagAt(1,110,100,100),squareTagAt(2,1000,800,100)};
+    tracker.observe(moved);
+    ASSERT_TRUE(tracker.plan(frame));
+    ASSERT_EQ(tracker.getRegions().size(),2);
+    EXPECT_EQ(tracker.getRegions()[0],cv::Rect(110 + 10 - 60,100 - 60,220,220));
+
+    // Regions clipped to the frame, and overlapping regions merged into one
+    std::vector<wf::ApriltagDetection> close{squareTagAt(3,0,0,100),squareTagAt(4,150,0,100)};
+    tracker.reset();
+    EXPECT_FALSE(tracker.plan(frame));
+    tracker.observe(close);
+    ASSERT_TRUE(tracker.plan(frame));
+    ASSERT_EQ(tracker.getRegions().size(),1);
+    EXPECT_EQ(tracker.getRegions()[0],cv::Rect(0,0,300,150));
+}
+
+TEST(apriltagTests,tagTrackerRefreshTest) {
+    wf::TagTracker::Params params;
+    params.refreshInterval = 4;
+    wf::TagTracker tracker(params);
+    const cv::Size frame(1600,1200);
+    std::vector<wf::ApriltagDetection> tags{squareTagAt(1,500,500,100),squareTagAt(2,900,500,100)};
+
+    int fullFrames = 0;
+    for (int i = 0; i < 11; ++i) {
+        if (!tracker.plan(frame)) ++fullFrames;
+        tracker.observe(tags);
+    }
+    // The first frame, then every fourth
+    EXPECT_EQ(fullFrames,3);
+
+    // Losing a tracked tag searches the whole next frame, even when a refresh isn't due
+    EXPECT_TRUE(tracker.plan(frame));
+    tracker.observe(std::span(tags).first(1));
+    EXPECT_FALSE(tracker.plan(frame));
+    tracker.observe(tags);
+    EXPECT_TRUE(tracker.plan(frame));
+
+    // Forcing a full frame, as the pipeline does for decimation probes
+    EXPECT_FALSE(tracker.plan(frame,true));
+}
+
+// apriltag's own threshold(), through the shim thirdparty/apriltag's patch adds next to it
+extern "C" image_u8_t* wf_apriltag_upstream_threshold(apriltag_detector_t* td, image_u8_t* im);
+
+static cv::Mat upstreamThreshold(const cv::Mat& im, int minWhiteBlackDiff) {
+    apriltag_detector_t* td = apriltag_detector_create();
+    td->qtp.min_white_black_diff = minWhiteBlackDiff;
+    td->nthreads = 1;
+    if (!td->wp) td->wp = workerpool_create(td->nthreads);
+    image_u8_t in = {im.cols,im.rows,static_cast<int32_t>(im.step),const_cast<uint8_t*>(im.ptr())};
+    image_u8_t* threshim = wf_apriltag_upstream_threshold(td,&in);
+    cv::Mat out = cv::Mat(threshim->height,threshim->width,CV_8UC1,threshim->buf,threshim->stride).clone();
+    image_u8_destroy(threshim);
+    apriltag_detector_destroy(td);
+    return out;
+}
+
+// Every SIMD level thresholds the test images exactly like apriltag, on one thread or several, including a crop with partial tiles on both edges
+TEST(apriltagTests,thresholdMatchesUpstreamTest) {
+    for (const char* name : {"cubes.jpg","no_tags.jpg","robots.jpg"}) {
+        SCOPED_TRACE(name);
+        cv::Mat image = cv::imread(std::string(RESOURCE_PATH "/apriltag/") + name);
+        ASSERT_FALSE(image.empty());
+        cv::Mat gray;
+        cv::cvtColor(image,gray,cv::COLOR_BGR2GRAY);
+        const cv::Mat crop = gray(cv::Rect(1,2,gray.cols - 6,gray.rows - 5));
+        for (const cv::Mat& frame : {gray,crop}) {
+            for (int minWhiteBlackDiff : {5,40}) {
+                const cv::Mat expected = upstreamThreshold(frame,minWhiteBlackDiff);
+                wf::ApriltagThreshold threshold(minWhiteBlackDiff);
+                for (auto level : {wf::simd::SimdLevel::Scalar,wf::simd::SimdLevel::SSE41,wf::simd::SimdLevel::AVX2,wf::simd::SimdLevel::NEON}) {
+                    if (!wf::simd::isSupported(level)) continue;
+                    SCOPED_TRACE(wf::simd::getLevelName(level));
+                    cv::Mat actual;
+                    threshold.apply(frame,actual,wf::simd::getKernels(level));
+                    EXPECT_EQ(cv::countNonZero(actual != expected),0);
+                    // Split into bands for the shared pool
+                    cv::Mat banded;
+                    threshold.apply(frame,banded,wf::simd::getKernels(level),wf::SharedWorkerPool::getInstance(),3);
+                    EXPECT_EQ(cv::countNonZero(banded != expected),0);
+                }
+            }
+        }
+    }
+}
+
+// The quad detection stages that run on the SIMD kernels find exactly the detections apriltag's own code does
+TEST(apriltagTests,simdDetectionMatchesUpstreamTest) {
+    for (const char* name : {"cubes.jpg","no_tags.jpg","robots.jpg"}) {
+        SCOPED_TRACE(name);
+        cv::Mat image = cv::imread(std::string(RESOURCE_PATH "/apriltag/") + name);
+        ASSERT_FALSE(image.empty());
+        cv::Mat gray;
+        cv::cvtColor(image,gray,cv::COLOR_BGR2GRAY);
+        for (int numThreads : {1,4}) {
+            for (float quadDecimate : {1.0f,2.0f}) {
+                SCOPED_TRACE(std::format("{} threads, decimation {}",numThreads,quadDecimate));
+                wf::ApriltagDetector detector;
+                detector.setConfig({.numThreads = numThreads});
+                ASSERT_TRUE(detector.addFamily("tag36h11"));
+                detector.setSimdLevel(wf::simd::SimdLevel::Scalar);
+                std::vector<wf::ApriltagDetection> expected;
+                ASSERT_TRUE(detector.detect(gray,quadDecimate,expected));
+                for (auto level : {wf::simd::SimdLevel::SSE41,wf::simd::SimdLevel::AVX2,wf::simd::SimdLevel::NEON}) {
+                    if (!wf::simd::isSupported(level)) continue;
+                    SCOPED_TRACE(wf::simd::getLevelName(level));
+                    detector.setSimdLevel(level);
+                    std::vector<wf::ApriltagDetection> actual;
+                    ASSERT_TRUE(detector.detect(gray,quadDecimate,actual));
+                    ASSERT_EQ(actual.size(),expected.size());
+                    for (size_t i = 0; i < actual.size(); ++i) {
+                        EXPECT_EQ(actual[i].id,expected[i].id);
+                        EXPECT_EQ(actual[i].family,expected[i].family);
+                        EXPECT_EQ(actual[i].corners,expected[i].corners);
+                        EXPECT_EQ(actual[i].decisionMargin,expected[i].decisionMargin);
+                        EXPECT_EQ(actual[i].hammingDistance,expected[i].hammingDistance);
+                    }
+                }
+            }
+        }
+    }
+}
@@ -18,4 +18,503 @@
  */
 
 
+#include "wfcore/video/FramePool.h"
+#include "wfcore/video/FramePyramid.h"
+#include "wfcore/hardware/ReplayReader.h"
+#include "wfcore/video/processing.h"
+#include "wfcore/inference/Tensorizer.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
 #include <gtest/gtest.h>
+#include <opencv2/calib3d.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+// Tests that pooled frames are shared by refcount and recycled once every handle is dropped
+TEST(cvprocessTests, FramePoolRefcountTest){
+    auto pool = wf::FramePool::create(wf::FrameFormat(wf::ImageEncoding::Y8,640,480),2);
+    auto a = pool->acquire();
+    ASSERT_TRUE(a);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(a.mat().data) % wf::FramePool::ALIGNMENT,0u);
+    EXPECT_EQ(a.mat().rows,480);
+    EXPECT_EQ(a.mat().cols,640);
+    EXPECT_EQ(a.mat().type(),CV_8UC1);
+
+    auto b = a;
+    EXPECT_EQ(a.useCount(),2u);
+    EXPECT_EQ(a.mat().data,b.mat().data);
+
+    auto c = pool->acquire();
+    ASSERT_TRUE(c);
+    EXPECT_FALSE(pool->acquire()); // Both frames are held
+    EXPECT_EQ(pool->getStats().exhaustions,1u);
+
+    a.reset();
+    EXPECT_FALSE(pool->acquire()); // b still holds the first frame
+    b.reset();
+    auto d = pool->acquire();
+    EXPECT_TRUE(d);
+    EXPECT_EQ(pool->getStats().inUse,2u);
+
+    // Handles keep their pool alive
+    std::weak_ptr<wf::FramePool> weakPool = pool;
+    pool.reset();
+    EXPECT_FALSE(weakPool.expired());
+    c.reset();
+    d.reset();
+    EXPECT_TRUE(weakPool.expired());
+}
+
+// Frames written to a raw dump come back unchanged, with their timestamps, straight out of the mapping
+TEST(cvprocessTests, RawDumpReplayTest){
+    const auto path = (std::filesystem::temp_directory_path() / "wf_replay_test.wfraw").string();
+    const wf::FrameFormat format(wf::ImageEncoding::Y8,64,48);
+    {
+        wf::RawDumpWriter writer(path,format);
+        for (int i = 0; i < 3; ++i) {
+            cv::Mat frame(format.height,format.width,CV_8UC1,cv::Scalar(i * 40));
+            ASSERT_TRUE(writer.write(frame,1000 + i * 33333).ok());
+        }
+    }
+
+    auto readerRes = wf::openReplayReader(path);
+    ASSERT_TRUE(readerRes.ok());
+    auto& reader = readerRes.value();
+    EXPECT_TRUE(reader->isZeroCopy());
+    EXPECT_EQ(reader->getFormat().frameFormat,format);
+    cv::Mat frame;
+    uint64_t micros;
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(reader->next(frame,micros));
+        EXPECT_EQ(micros,static_cast<uint64_t>(1000 + i * 33333));
+        EXPECT_EQ(frame.at<uint8_t>(47,63),i * 40);
+    }
+    EXPECT_FALSE(reader->next(frame,micros));
+    reader->rewind();
+    ASSERT_TRUE(reader->next(frame,micros));
+    EXPECT_EQ(micros,1000u);
+    reader.reset();
+    std::filesystem::remove(path);
+}
+
+
+// Fused node pairs write exactly what their nodes write when run one after the other
+TEST(cvprocessTests, FusedNodeTest){
+    using namespace wf;
+    cv::Mat in(720,1280,CV_8UC3);
+    cv::randu(in,cv::Scalar::all(0),cv::Scalar::all(256));
+    const ImageEncoding encoding = ImageEncoding::BGR24;
+
+    auto runFused = [&](std::unique_ptr<CVProcessNode<cv::Mat>> first, std::unique_ptr<CVProcessNode<cv::Mat>> second) {
+        std::vector<std::unique_ptr<CVProcessNode<cv::Mat>>> nodes;
+        nodes.push_back(std::move(first));
+        nodes.push_back(std::move(second));
+        nodes = fuseNodes(std::move(nodes));
+        EXPECT_EQ(nodes.size(),1u);
+        auto* fused = dynamic_cast<FusedNode*>(nodes[0].get());
+        EXPECT_NE(fused,nullptr);
+        cv::Mat inpad = in;
+        nodes[0]->setInpad(&inpad,&encoding);
+        EXPECT_TRUE(fused && fused->isFused());
+        nodes[0]->process();
+        return nodes[0]->getOutpad().clone();
+    };
+    auto expectIdentical = [](const cv::Mat& actual, const cv::Mat& expected) {
+        ASSERT_EQ(actual.size(),expected.size());
+        ASSERT_EQ(actual.type(),expected.type());
+        EXPECT_EQ(cv::norm(actual,expected,cv::NORM_INF),0);
+    };
+    cv::Mat tmp, expected;
+
+    cv::resize(in,tmp,cv::Size(640,360));
+    cv::cvtColor(tmp,expected,cv::COLOR_BGR2GRAY);
+    expectIdentical(runFused(
+        std::make_unique<ResizeNode<cv::Mat>>(640,360),
+        std::make_unique<ColorConvertNode<cv::Mat>>(ImageEncoding::Y8)
+    ),expected);
+
+    cv::cvtColor(in,tmp,cv::COLOR_BGR2GRAY);
+    cv::resize(tmp,expected,cv::Size(640,360));
+    expectIdentical(runFused(
+        std::make_unique<ColorConvertNode<cv::Mat>>(ImageEncoding::Y8),
+        std::make_unique<ResizeNode<cv::Mat>>(640,360)
+    ),expected);
+
+    cv::Mat resized;
+    cv::resize(tmp,resized,{},0.5,0.5,cv::INTER_LINEAR);
+    cv::copyMakeBorder(resized,expected,140,140,0,0,cv::BORDER_CONSTANT,cv::Scalar(114,114,114));
+    expectIdentical(runFused(
+        std::make_unique<ColorConvertNode<cv::Mat>>(ImageEncoding::Y8),
+        std::make_unique<LetterboxNode<cv::Mat>>(640,640)
+    ),expected);
+
+    for (int rotation : {cv::ROTATE_90_CLOCKWISE,cv::ROTATE_180,cv::ROTATE_90_COUNTERCLOCKWISE}) {
+        cv::rotate(in,tmp,rotation);
+        cv::cvtColor(tmp,expected,cv::COLOR_BGR2RGB);
+        expectIdentical(runFused(
+            std::make_unique<RotateNode<cv::Mat>>(rotation),
+            std::make_unique<ColorConvertNode<cv::Mat>>(ImageEncoding::RGB24)
+        ),expected);
+    }
+}
+
+// A striped pipe, including nodes with a halo, produces the same frames as a sequential one
+TEST(cvprocessTests, StripedPipeTest){
+    using namespace wf;
+    const FrameFormat format(ImageEncoding::BGR24,1600,1200);
+    auto makeNodes = []() {
+        std::vector<std::unique_ptr<CVProcessNode<cv::Mat>>> nodes;
+        nodes.push_back(std::make_unique<ResizeNode<cv::Mat>>(800,600));
+        nodes.push_back(std::make_unique<ColorConvertNode<cv::Mat>>(ImageEncoding::Y8));
+        nodes.push_back(std::make_unique<RotateNode<cv::Mat>>(cv::ROTATE_90_CLOCKWISE));
+        nodes.push_back(std::make_unique<ResizeNode<cv::Mat>>(cv::INTER_LINEAR,1200,1600));
+        return nodes;
+    };
+    CVProcessPipe<cv::Mat> sequential(format,makeNodes());
+    // Moving the pipe relinks its nodes to the new pads
+    CVProcessPipe<cv::Mat> striped = CVProcessPipe<cv::Mat>(format,makeNodes(),PipeExecution::Striped);
+    EXPECT_EQ(striped.getExecution(),PipeExecution::Striped);
+    EXPECT_EQ(striped.getOutformat(),FrameFormat(ImageEncoding::Y8,1200,1600));
+
+    cv::Mat in(1200,1600,CV_8UC3);
+    for (int i = 0; i < 3; ++i) {
+        cv::randu(in,cv::Scalar::all(0),cv::Scalar::all(256));
+        cv::Mat expected, actual;
+        sequential.processSafe(in,expected);
+        striped.processSafe(in,actual);
+        ASSERT_EQ(actual.size(),expected.size());
+        EXPECT_EQ(cv::norm(actual,expected,cv::NORM_INF),0);
+    }
+}
+
+// Luma extraction matches OpenCV's gray conversion, with and without decimation, and the view points at the Y samples in place
+TEST(cvprocessTests, LumaExtractNodeTest){
+    using namespace wf;
+    cv::Mat in(480,646,CV_8UC2);
+    cv::randu(in,cv::Scalar::all(0),cv::Scalar::all(256));
+    for (auto [encoding, code] : {
+        std::pair{ImageEncoding::YUYV,cv::COLOR_YUV2GRAY_YUYV},
+        std::pair{ImageEncoding::UYVY,cv::COLOR_YUV2GRAY_UYVY}
+    }) {
+        cv::Mat expected, halved;
+        LumaExtractNode full;
+        full.setInpad(&in,&encoding);
+        full.process();
+        cv::cvtColor(in,expected,code);
+        EXPECT_EQ(cv::norm(full.getOutpad(),expected,cv::NORM_INF),0);
+
+        LumaExtractNode decimated(true);
+        decimated.setInpad(&in,&encoding);
+        decimated.process();
+        cv::resize(in,halved,cv::Size(323,240),0,0,cv::INTER_AREA);
+        cv::cvtColor(halved,expected,code);
+        EXPECT_EQ(cv::norm(decimated.getOutpad(),expected,cv::NORM_INF),0);
+
+        LumaExtractNode view(false,true);
+        view.setInpad(&in,&encoding);
+        view.process();
+        EXPECT_TRUE(view.getOutpad().empty());
+        const auto plane = view.getPlane();
+        EXPECT_EQ(plane.width,646);
+        EXPECT_EQ(plane.pixelStride,2);
+        EXPECT_EQ(plane.data[100 * plane.rowStride + 7 * plane.pixelStride],full.getOutpad().at<uint8_t>(100,7));
+    }
+}
+
+TEST(cvprocessTests, MJPEGDecodeNodeTest){
+    using namespace wf;
+    cv::Mat bgr(480,640,CV_8UC3);
+    cv::randu(bgr,cv::Scalar::all(0),cv::Scalar::all(256));
+    cv::GaussianBlur(bgr,bgr,cv::Size(9,9),3);
+    std::vector<uchar> jpeg;
+    ASSERT_TRUE(cv::imencode(".jpg",bgr,jpeg));
+    const cv::Mat frame(1,static_cast<int>(jpeg.size()),CV_8UC1,jpeg.data());
+    const auto mjpeg = ImageEncoding::MJPEG;
+
+    EXPECT_EQ(MJPEGDecodeNode::chooseScaleDenom(cv::Size(640,480),cv::Size(640,480)),1);
+    EXPECT_EQ(MJPEGDecodeNode::chooseScaleDenom(cv::Size(640,480),cv::Size(320,240)),2);
+    EXPECT_EQ(MJPEGDecodeNode::chooseScaleDenom(cv::Size(640,480),cv::Size(300,200)),2);
+    EXPECT_EQ(MJPEGDecodeNode::chooseScaleDenom(cv::Size(640,480),cv::Size(160,120)),4);
+
+    // Different libjpeg builds may round their IDCTs differently, so allow a little slack against OpenCV's decoder
+    for (auto [denom, flags] : {
+        std::pair{1,cv::IMREAD_GRAYSCALE},
+        std::pair{2,cv::IMREAD_REDUCED_GRAYSCALE_2},
+        std::pair{4,cv::IMREAD_REDUCED_GRAYSCALE_4}
+    }) {
+        MJPEGDecodeNode node(cv::Size(640,480),ImageEncoding::Y8,denom);
+        node.setInpad(&frame,&mjpeg);
+        node.process();
+        const cv::Mat expected = cv::imdecode(jpeg,flags);
+        ASSERT_EQ(node.getOutpad().size(),expected.size());
+        EXPECT_LE(cv::norm(node.getOutpad(),expected,cv::NORM_INF),2);
+        EXPECT_EQ(node.getFailures(),0u);
+    }
+
+    MJPEGDecodeNode color(cv::Size(640,480),ImageEncoding::BGR24,2);
+    color.setInpad(&frame,&mjpeg);
+    color.process();
+    EXPECT_LE(cv::norm(color.getOutpad(),cv::imdecode(jpeg,cv::IMREAD_REDUCED_COLOR_2),cv::NORM_INF),2);
+
+    // A frame of a different size than the node was built for is rejected rather than scaled
+    MJPEGDecodeNode mismatched(cv::Size(1280,720),ImageEncoding::Y8);
+    mismatched.setInpad(&frame,&mjpeg);
+    mismatched.process();
+    EXPECT_EQ(mismatched.getFailures(),1u);
+}
+
+TEST(cvprocessTests, UndistortNodeTest){
+    using namespace wf;
+    cv::Mat cameraMatrix = (cv::Mat_<double>(3,3) << 500.0, 0.0, 320.0, 0.0, 500.0, 240.0, 0.0, 0.0, 1.0);
+    cv::Mat distCoeffs = (cv::Mat_<double>(1,5) << -0.3, 0.1, 0.001, -0.001, 0.0);
+    const CameraIntrinsics intrinsics(cv::Size(640,480),cameraMatrix,distCoeffs);
+    EXPECT_FALSE(intrinsics.isDistortionFree());
+    EXPECT_TRUE(intrinsics.rectified().isDistortionFree());
+
+    // Nodes with the same calibration and frame size share their tables
+    EXPECT_EQ(UndistortNode::getTables(intrinsics,cv::Size(640,480)),UndistortNode::getTables(intrinsics,cv::Size(640,480)));
+
+    const FrameFormat format(ImageEncoding::Y8,640,480);
+    auto makeNodes = [&]() {
+        std::vector<std::unique_ptr<CVProcessNode<cv::Mat>>> nodes;
+        nodes.push_back(std::make_unique<UndistortNode>(intrinsics));
+        return nodes;
+    };
+    CVProcessPipe<cv::Mat> sequential(format,makeNodes());
+    CVProcessPipe<cv::Mat> striped(format,makeNodes(),PipeExecution::Striped);
+    cv::Mat in(480,640,CV_8UC1);
+    cv::randu(in,cv::Scalar::all(0),cv::Scalar::all(256));
+    cv::Mat actual, stripedActual, expected;
+    sequential.processSafe(in,actual);
+    striped.processSafe(in,stripedActual);
+    cv::undistort(in,expected,cameraMatrix,distCoeffs);
+    EXPECT_LE(cv::norm(actual,expected,cv::NORM_INF),1);
+    EXPECT_EQ(cv::norm(actual,stripedActual,cv::NORM_INF),0);
+}
+
+// The planner drops no-ops, merges and reorders resizes only where the output stays the same, and explains the result
+TEST(cvprocessTests, PipePlannerTest){
+    using namespace wf;
+    const FrameFormat format(ImageEncoding::BGR24,1280,960);
+    std::vector<std::unique_ptr<CVProcessNode<cv::Mat>>> nodes;
+    nodes.push_back(std::make_unique<IdentityNode<cv::Mat>>());
+    nodes.push_back(std::make_unique<ResizeNode<cv::Mat>>(cv::INTER_NEAREST,1280,960));
+    nodes.push_back(std::make_unique<ResizeNode<cv::Mat>>(cv::INTER_NEAREST,640,480));
+    nodes.push_back(std::make_unique<ResizeNode<cv::Mat>>(cv::INTER_NEAREST,320,240));
+    nodes.push_back(std::make_unique<ResizeNode<cv::Mat>>(cv::INTER_NEAREST,640,480));
+    nodes.push_back(std::make_unique<ColorConvertNode<cv::Mat>>(ImageEncoding::Y8));
+    CVProcessPipe<cv::Mat> pipe(format,std::move(nodes));
+    EXPECT_EQ(pipe.getOutformat(),FrameFormat(ImageEncoding::Y8,640,480));
+
+    const auto& plan = pipe.getPlan();
+    auto countRewrites = [&plan](std::string_view prefix) {
+        return std::count_if(plan.rewrites.begin(),plan.rewrites.end(),[prefix](const std::string& rewrite){
+            return rewrite.starts_with(prefix);
+        });
+    };
+    // The identity and the same size resize are dropped, the two downscales merge, the upscale can't merge
+    // into them without changing the output, and the conversion to gray moves ahead of the upscale
+    EXPECT_EQ(countRewrites("Elided"),2);
+    EXPECT_EQ(countRewrites("Replaced"),2);
+    EXPECT_EQ(countRewrites("Kept"),1);
+    EXPECT_FALSE(plan.steps.empty());
+    EXPECT_GT(plan.bytesTouched,0);
+    EXPECT_NE(plan.explain().find("Elided Identity"),std::string::npos);
+
+    cv::Mat in(960,1280,CV_8UC3), tmp, expected, actual;
+    cv::randu(in,cv::Scalar::all(0),cv::Scalar::all(256));
+    cv::resize(in,tmp,cv::Size(640,480),0,0,cv::INTER_NEAREST);
+    cv::resize(tmp,tmp,cv::Size(320,240),0,0,cv::INTER_NEAREST);
+    cv::resize(tmp,tmp,cv::Size(640,480),0,0,cv::INTER_NEAREST);
+    cv::cvtColor(tmp,expected,cv::COLOR_BGR2GRAY);
+    pipe.processSafe(in,actual);
+    EXPECT_EQ(cv::norm(actual,expected,cv::NORM_INF),0);
+
+    // Whatever the planner decides for interpolating resizes, the output matches the chain as written
+    std::vector<std::unique_ptr<CVProcessNode<cv::Mat>>> linear;
+    linear.push_back(std::make_unique<ResizeNode<cv::Mat>>(cv::INTER_LINEAR,800,600));
+    linear.push_back(std::make_unique<ResizeNode<cv::Mat>>(cv::INTER_LINEAR,320,240));
+    CVProcessPipe<cv::Mat> linearPipe(format,std::move(linear));
+    cv::resize(in,tmp,cv::Size(800,600),0,0,cv::INTER_LINEAR);
+    cv::resize(tmp,expected,cv::Size(320,240),0,0,cv::INTER_LINEAR);
+    linearPipe.processSafe(in,actual);
+    EXPECT_EQ(cv::norm(actual,expected,cv::NORM_INF),0);
+}
+
+// Tests that pyramid levels are 2x2 box filters of the level above, and that concurrent readers share one build
+TEST(cvprocessTests, FramePyramidTest){
+    using namespace wf;
+    cv::Mat in(483,645,CV_8UC3);
+    cv::randu(in,cv::Scalar::all(0),cv::Scalar::all(256));
+    FramePyramid pyramid;
+    pyramid.reset(in,ImageEncoding::BGR24);
+
+    std::vector<const cv::Mat*> seen(4,nullptr);
+    std::vector<std::thread> readers;
+    for (size_t i = 0; i < seen.size(); ++i)
+        readers.emplace_back([&pyramid,&seen,i]{ seen[i] = &pyramid.getLevel(2); });
+    for (auto& reader : readers) reader.join();
+    for (auto level : seen) EXPECT_EQ(level,seen.front());
+
+    cv::Mat half, quarter;
+    cv::resize(in(cv::Rect(0,0,644,482)),half,cv::Size(322,241),0,0,cv::INTER_AREA);
+    cv::resize(half(cv::Rect(0,0,322,240)),quarter,cv::Size(161,120),0,0,cv::INTER_AREA);
+    EXPECT_EQ(pyramid.getLevel(0).data,in.data);
+    EXPECT_EQ(cv::norm(pyramid.getLevel(1),half,cv::NORM_INF),0);
+    EXPECT_EQ(cv::norm(pyramid.getLevel(2),quarter,cv::NORM_INF),0);
+    EXPECT_EQ(&pyramid.getLevel(7),&pyramid.getLevel(2));
+
+    // Packed encodings only have the frame itself
+    cv::Mat packed(480,640,CV_8UC2,cv::Scalar::all(0));
+    pyramid.reset(packed,ImageEncoding::YUYV);
+    EXPECT_EQ(pyramid.getLevel(1).data,packed.data);
+
+    EXPECT_EQ(FramePyramid::chooseLevel(FrameFormat(ImageEncoding::BGR24,1280,720),cv::Size(640,360)),1);
+    EXPECT_EQ(FramePyramid::chooseLevel(FrameFormat(ImageEncoding::Y8,1920,1080),cv::Size(320,240)),2);
+    EXPECT_EQ(FramePyramid::chooseLevel(FrameFormat(ImageEncoding::BGR24,1280,720),cv::Size(700,400)),0);
+    EXPECT_EQ(FramePyramid::chooseLevel(FrameFormat(ImageEncoding::YUYV,1280,720),cv::Size(320,180)),0);
+}
+
+// Skipped turns and resizes map points, and the calibration, onto where the chain as written would have put them
+TEST(cvprocessTests, GeometryElisionTest){
+    using namespace wf;
+    const FrameFormat format(ImageEncoding::BGR24,640,480);
+    auto buildNodes = []{
+        std::vector<std::unique_ptr<CVProcessNode<cv::Mat>>> nodes;
+        nodes.push_back(std::make_unique<ResizeNode<cv::Mat>>(cv::INTER_NEAREST,320,240));
+        nodes.push_back(std::make_unique<ColorConvertNode<cv::Mat>>(ImageEncoding::Y8));
+        nodes.push_back(std::make_unique<RotateNode<cv::Mat>>(cv::ROTATE_90_CLOCKWISE));
+        return nodes;
+    };
+    CVProcessPipe<cv::Mat> full(format,buildNodes());
+    CVProcessPipe<cv::Mat> elided(format,buildNodes(),PipeExecution::Sequential,GeometryElision::All);
+    const ViewTransform& view = elided.getViewTransform();
+    EXPECT_TRUE(full.getViewTransform().isIdentity());
+    EXPECT_EQ(elided.getOutformat(),FrameFormat(ImageEncoding::Y8,640,480));
+    EXPECT_EQ(view.getViewSize(),full.getOutformat().size());
+    EXPECT_EQ(view.getQuarterTurns(),1);
+    EXPECT_EQ(std::count_if(elided.getPlan().rewrites.begin(),elided.getPlan().rewrites.end(),[](const std::string& rewrite){
+        return rewrite.starts_with("Skipped");
+    }),2);
+
+    // Eliding only turns keeps the resize, so the frame comes out at the size the chain as written gives it
+    CVProcessPipe<cv::Mat> turnsOnly(format,buildNodes(),PipeExecution::Sequential,GeometryElision::Turns);
+    EXPECT_EQ(turnsOnly.getOutformat(),FrameFormat(ImageEncoding::Y8,320,240));
+    EXPECT_EQ(turnsOnly.getViewTransform().getQuarterTurns(),1);
+    EXPECT_EQ(turnsOnly.getViewTransform().getViewSize(),full.getOutformat().size());
+
+    // A bright 2x2 block ends up where the transform sends its center
+    cv::Mat in(480,640,CV_8UC3,cv::Scalar::all(0)), out;
+    in(cv::Rect(100,50,2,2)).setTo(cv::Scalar::all(255));
+    full.processSafe(in,out);
+    cv::Point brightest;
+    cv::minMaxLoc(out,nullptr,nullptr,nullptr,&brightest);
+    const cv::Point2d mapped = view.apply(cv::Point2d(100.5,50.5));
+    EXPECT_DOUBLE_EQ(mapped.x,brightest.x);
+    EXPECT_DOUBLE_EQ(mapped.y,brightest.y);
+
+    // Projecting with the view's calibration matches projecting with the original one and mapping the points
+    const CameraIntrinsics native(
+        cv::Size(1280,960),
+        (cv::Mat_<double>(3,3) << 900, 0, 630, 0, 910, 470, 0, 0, 1),
+        (cv::Mat_<double>(1,5) << 0.1, -0.05, 0.002, -0.003, 0.01)
+    );
+    const CameraIntrinsics source = ViewTransform::identity(cv::Size(640,480)).apply(native);
+    const CameraIntrinsics turned = view.apply(source);
+    EXPECT_EQ(turned.resolution,view.getViewSize());
+    const std::vector<cv::Point3d> points{{0.3,-0.2,2.0},{-0.5,0.4,3.0},{0.05,0.1,1.0}};
+    std::vector<cv::Point3d> turnedPoints; // The turned camera sees (x,y,z) at (-y,x,z)
+    for (const auto& point : points) turnedPoints.emplace_back(-point.y,point.x,point.z);
+    std::vector<cv::Point2d> projected, turnedProjected;
+    cv::projectPoints(points,cv::Vec3d(),cv::Vec3d(),source.cameraMatrix,source.distCoeffs,projected);
+    cv::projectPoints(turnedPoints,cv::Vec3d(),cv::Vec3d(),turned.cameraMatrix,turned.distCoeffs,turnedProjected);
+    for (size_t k = 0; k < points.size(); ++k) {
+        const cv::Point2d point = view.apply(projected[k]);
+        EXPECT_NEAR(point.x,turnedProjected[k].x,1e-6);
+        EXPECT_NEAR(point.y,turnedProjected[k].y,1e-6);
+    }
+}
+
+// Channel shuffles run on the SIMD kernels rather than cvtColor, and must match it exactly, on row ranges too
+TEST(cvprocessTests, ShuffleConvertTest){
+    using namespace wf;
+    using enum ImageEncoding;
+    cv::Mat bgr(241,333,CV_8UC3), bgra(241,333,CV_8UC4), gray(241,333,CV_8UC1);
+    cv::randu(bgr,cv::Scalar::all(0),cv::Scalar::all(256));
+    cv::randu(bgra,cv::Scalar::all(0),cv::Scalar::all(256));
+    cv::randu(gray,cv::Scalar::all(0),cv::Scalar::all(256));
+    struct Case {
+        ImageEncoding from;
+        const cv::Mat* in;
+        ImageEncoding to;
+        int code;
+    };
+    for (const auto& [from, in, to, code] : {
+        Case{BGR24,&bgr,RGB24,cv::COLOR_BGR2RGB},
+        Case{BGR24,&bgr,BGRA,cv::COLOR_BGR2BGRA},
+        Case{RGB24,&bgr,BGRA,cv::COLOR_RGB2BGRA},
+        Case{BGRA,&bgra,BGR24,cv::COLOR_BGRA2BGR},
+        Case{RGBA,&bgra,BGR24,cv::COLOR_RGBA2BGR},
+        Case{BGRA,&bgra,RGBA,cv::COLOR_BGRA2RGBA},
+        Case{Y8,&gray,RGB24,cv::COLOR_GRAY2RGB},
+        Case{Y8,&gray,BGRA,cv::COLOR_GRAY2BGRA}
+    }) {
+        SCOPED_TRACE(std::string(getEncodingName(from)) + " -> " + std::string(getEncodingName(to)));
+        ColorConvertNode<cv::Mat> node(to);
+        node.setInpad(in,&from);
+        node.process();
+        cv::Mat expected, actual;
+        cv::cvtColor(*in,expected,code);
+        EXPECT_EQ(cv::norm(node.getOutpad(),expected,cv::NORM_INF),0);
+
+        const cv::Mat roi = (*in)(cv::Rect(3,5,200,100));
+        node.convert(roi,actual);
+        cv::cvtColor(roi,expected,code);
+        EXPECT_EQ(cv::norm(actual,expected,cv::NORM_INF),0);
+    }
+}
+
+// 8 bit frames are tensorized by the SIMD kernels, and land within float rounding of the OpenCV arithmetic
+TEST(cvprocessTests, TensorizerTest){
+    using namespace wf;
+    cv::Mat in(64,99,CV_8UC3);
+    cv::randu(in,cv::Scalar::all(0),cv::Scalar::all(256));
+    TensorParameters params;
+    params.height = in.rows;
+    params.width = in.cols;
+    params.channels = 3;
+    params.scale = 1.0f / 255.0f;
+    params.stds = {0.229,0.224,0.225};
+    params.means = {0.485,0.456,0.406};
+
+    cv::Mat expected;
+    in.convertTo(expected,CV_32F,params.scale);
+    cv::divide(expected,params.stds,expected);
+    cv::subtract(expected,params.means,expected);
+    std::vector<cv::Mat> planes;
+    cv::split(expected,planes);
+
+    for (bool interleaved : {false,true}) {
+        params.interleaved = interleaved;
+        Tensorizer tensorizer;
+        tensorizer.setTensorParameters(params);
+        std::vector<float> tensor(in.total() * 3);
+        tensorizer.tensorize(in,tensor.data());
+        for (int y = 0; y < in.rows; ++y) {
+            for (int x = 0; x < in.cols; ++x) {
+                for (int c = 0; c < 3; ++c) {
+                    const size_t index = interleaved
+                        ? (static_cast<size_t>(y) * in.cols + x) * 3 + c
+                        : c * in.total() + static_cast<size_t>(y) * in.cols + x;
+                    EXPECT_NEAR(tensor[index],planes[c].at<float>(y,x),1e-5f);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,266 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "wfcore/hardware/CameraBroadcastHub.h"
+#include "wfcore/hardware/CameraConfiguration.h"
+#include "wfcore/hardware/CameraSink.h"
+#include "wfcore/hardware/LendSlots.h"
+#include "wfcore/hardware/ReplayCameraHandler.h"
+#include "wfcore/hardware/ReplayCameraSink.h"
+#include "wfcore/hardware/ReplayReader.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+namespace {
+    // A camera that lends out a fixed number of numbered frames, like CSCameraSink does, and counts the times it
+    // was asked for a frame with all of them out
+    class LendingSink : public wf::CameraSink {
+    public:
+        static constexpr int LEND_SLOTS = 4;
+
+        LendingSink() {
+            for (auto& buffer : buffers_) buffer = cv::Mat(8,8,CV_8UC1);
+        }
+
+        wf::FrameMetadata getFrame(cv::Mat& data) noexcept override {
+            cv::Mat view;
+            wf::FrameLease lease;
+            auto meta = acquireFrame(view,lease);
+            if (meta) view.copyTo(data);
+            releaseFrame(lease);
+            return meta;
+        }
+
+        wf::FrameMetadata acquireFrame(cv::Mat& data, wf::FrameLease& lease) noexcept override {
+            lease = wf::NULL_LEASE;
+            for (int i = 0; i < LEND_SLOTS; ++i) {
+                bool expected = false;
+                if (leased_[i].compare_exchange_strong(expected,true)) {
+                    // The frame number goes out as its timestamp
+                    const uint64_t number = next_++;
+                    buffers_[i].setTo(static_cast<uint8_t>(number));
+                    data = buffers_[i];
+                    lease = i;
+                    return wf::FrameMetadata(number,0,FORMAT);
+                }
+            }
+            exhausted.fetch_add(1);
+            return wf::FrameMetadata::badFrame(wf::WFStatus::BAD_ACQUIRE);
+        }
+
+        void releaseFrame(wf::FrameLease lease) noexcept override {
+            if (lease < 0 || lease >= LEND_SLOTS) return;
+            leased_[lease].store(false);
+        }
+
+        int getLendSlots() const noexcept override { return LEND_SLOTS; }
+        std::string getName() const override { return "lending"; }
+        wf::WFResult<std::string> getCameraNickname() const override {
+            return wf::WFResult<std::string>::success("lending");
+        }
+        wf::WFResult<wf::StreamFormat> getStreamFormat() const noexcept override {
+            return wf::WFResult<wf::StreamFormat>::success(wf::StreamFormat(30,FORMAT));
+        }
+
+        std::atomic<uint64_t> exhausted = 0;
+    private:
+        static constexpr wf::FrameFormat FORMAT{wf::ImageEncoding::Y8,8,8};
+        std::array<cv::Mat,LEND_SLOTS> buffers_;
+        std::array<std::atomic_bool,LEND_SLOTS> leased_{};
+        uint64_t next_ = 0;
+    };
+}
+
+// Two Block subscribers that each hold on to a frame while they pick up the next get every frame in order,
+// and the hub never asks the camera for more frames than it lends
+TEST(hardwareTests, BroadcastHubBlockSubscribersTest) {
+    auto source = std::make_shared<LendingSink>();
+    auto hub = wf::CameraBroadcastHub::create(source);
+    EXPECT_EQ(hub->getSlots(),LendingSink::LEND_SLOTS);
+
+    constexpr int frames = 200;
+    std::array<std::shared_ptr<wf::CameraSink>,2> subscribers{
+        hub->subscribe("first",wf::FrameDropPolicy::Block),
+        hub->subscribe("second",wf::FrameDropPolicy::Block)
+    };
+    std::array<int,2> received{};
+    std::array<int,2> outOfOrder{};
+    std::vector<std::thread> consumers;
+    for (int s = 0; s < 2; ++s) {
+        consumers.emplace_back([&,s] {
+            auto& sink = *subscribers[s];
+            EXPECT_EQ(sink.getLendSlots(),LendingSink::LEND_SLOTS);
+            wf::FrameLease held = wf::NULL_LEASE;
+            int64_t last = -1;
+            while (received[s] < frames) {
+                cv::Mat frame;
+                wf::FrameLease lease;
+                auto meta = sink.acquireFrame(frame,lease);
+                ASSERT_TRUE(meta.ok());
+                // Subscribing second may miss the first frames, but never one after them
+                if (last >= 0 && meta.micros != static_cast<uint64_t>(last + 1)) ++outOfOrder[s];
+                EXPECT_EQ(frame.at<uint8_t>(0,0),static_cast<uint8_t>(meta.micros));
+                last = static_cast<int64_t>(meta.micros);
+                EXPECT_EQ(sink.getDroppedFrames(),0u);
+                sink.releaseFrame(held);
+                held = lease;
+                ++received[s];
+            }
+            sink.releaseFrame(held);
+            // A Block subscriber that stops picking up frames holds up the hub, so the one that finishes first leaves
+            subscribers[s].reset();
+        });
+    }
+    for (auto& consumer : consumers) consumer.join();
+
+    for (int s = 0; s < 2; ++s) {
+        EXPECT_EQ(received[s],frames);
+        EXPECT_EQ(outOfOrder[s],0);
+    }
+    EXPECT_EQ(source->exhausted.load(),0u);
+}
+
+// Tests the lend/return protocol CSCameraSink and ReplayCameraSink share
+TEST(hardwareTests, LendSlotsTest) {
+    wf::LendSlots<4> slots;
+    // Finding a slot doesn't lend it
+    EXPECT_EQ(slots.findFree(),0);
+    EXPECT_EQ(slots.findFree(),0);
+    for (int i = 0; i < 4; ++i) {
+        const auto slot = slots.findFree();
+        EXPECT_EQ(slot,i);
+        slots.lend(slot);
+        EXPECT_TRUE(slots.isLeased(slot));
+    }
+    // Every slot is out
+    EXPECT_EQ(slots.findFree(),wf::NULL_LEASE);
+
+    // Released slots are reused round robin, starting after the last slot lent
+    slots.release(2);
+    EXPECT_FALSE(slots.isLeased(2));
+    EXPECT_EQ(slots.findFree(),2);
+    slots.lend(2);
+    slots.release(0);
+    slots.release(3);
+    EXPECT_EQ(slots.findFree(),3);
+    slots.lend(3);
+    EXPECT_EQ(slots.findFree(),0);
+
+    // Leases that can't have come from the slots are ignored
+    for (wf::FrameLease lease : {wf::NULL_LEASE,4,-7}) {
+        EXPECT_FALSE(wf::LendSlots<4>::isValid(lease));
+        slots.release(lease);
+    }
+    EXPECT_TRUE(slots.isLeased(1));
+    EXPECT_TRUE(slots.isLeased(2));
+    EXPECT_TRUE(slots.isLeased(3));
+}
+
+// A replay of decoded images lends its frames out through its slots, refuses to lend a fifth without losing a frame,
+// and reports its camera's status rather than a generic failure when the camera is down
+TEST(hardwareTests, ReplayCameraSinkLendTest) {
+    const auto dir = std::filesystem::temp_directory_path() / "wf_replay_lend_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    constexpr int images = 6;
+    for (int i = 0; i < images; ++i)
+        ASSERT_TRUE(cv::imwrite((dir / std::format("frame{}.png",i)).string(),cv::Mat(12,16,CV_8UC1,cv::Scalar(i * 40))));
+
+    // A negative rate plays the recording as fast as frames are asked for
+    auto handler = wf::ReplayCameraHandler::create(wf::CameraConfiguration(
+        "replay",dir.string(),wf::CameraBackend::REPLAY,wf::StreamFormat(-1,wf::FrameFormat()),{},{},{}
+    ));
+    auto readerRes = wf::openReplayReader(dir.string());
+    ASSERT_TRUE(readerRes.ok());
+    ASSERT_FALSE(readerRes.value()->isZeroCopy());
+    wf::ReplayCameraSink sink(handler,std::move(readerRes.value()),wf::ReplayMode::AsFastAsPossible,-1,"replay_lend");
+    EXPECT_EQ(sink.getLendSlots(),wf::ReplayCameraSink::LEND_SLOTS);
+
+    int nextImage = 0;
+    auto acquire = [&](cv::Mat& frame, wf::FrameLease& lease) {
+        // The read-ahead thread may not have decoded the next frame yet
+        for (int tries = 0; tries < 2000; ++tries) {
+            auto meta = sink.acquireFrame(frame,lease);
+            if (meta.status != wf::WFStatus::BAD_ACQUIRE) return meta;
+        }
+        return sink.acquireFrame(frame,lease);
+    };
+    auto expectLent = [&](wf::FrameLease expectedLease) {
+        cv::Mat frame;
+        wf::FrameLease lease;
+        auto meta = acquire(frame,lease);
+        EXPECT_TRUE(meta.ok());
+        EXPECT_EQ(lease,expectedLease);
+        if (meta.ok()) EXPECT_EQ(frame.at<uint8_t>(0,0),(nextImage % images) * 40);
+        ++nextImage;
+        return frame;
+    };
+
+    std::array<cv::Mat,wf::ReplayCameraSink::LEND_SLOTS> lent;
+    for (int i = 0; i < wf::ReplayCameraSink::LEND_SLOTS; ++i) lent[i] = expectLent(i);
+
+    // Every slot is out. The refusal hands out nothing and doesn't use up a frame
+    cv::Mat refusedFrame;
+    wf::FrameLease refusedLease = 0;
+    auto refused = sink.acquireFrame(refusedFrame,refusedLease);
+    EXPECT_EQ(refused.status,wf::WFStatus::BAD_ACQUIRE);
+    EXPECT_EQ(refusedLease,wf::NULL_LEASE);
+    // Frames that are lent out are left alone
+    for (int i = 0; i < wf::ReplayCameraSink::LEND_SLOTS; ++i) EXPECT_EQ(lent[i].at<uint8_t>(0,0),i * 40);
+
+    // Released slots are reused round robin
+    sink.releaseFrame(2);
+    expectLent(2);
+    sink.releaseFrame(0);
+    sink.releaseFrame(3);
+    expectLent(3);
+    expectLent(0);
+
+    // A disabled camera's status comes through, without lending anything
+    handler->disable();
+    cv::Mat frame;
+    wf::FrameLease lease = 0;
+    EXPECT_EQ(sink.acquireFrame(frame,lease).status,wf::WFStatus::HARDWARE_DISABLED);
+    EXPECT_EQ(lease,wf::NULL_LEASE);
+    EXPECT_EQ(sink.getFrame(frame).status,wf::WFStatus::HARDWARE_DISABLED);
+    handler->enable();
+    sink.releaseFrame(1);
+    expectLent(1);
+
+    // Releasing something that was never lent is a no-op
+    sink.releaseFrame(wf::NULL_LEASE);
+    sink.releaseFrame(wf::ReplayCameraSink::LEND_SLOTS);
+    for (int i = 0; i < wf::ReplayCameraSink::LEND_SLOTS; ++i) sink.releaseFrame(i);
+    expectLent(2);
+    sink.releaseFrame(2);
+
+    std::filesystem::remove_all(dir);
+}
@@ -21,8 +21,16 @@
 #include <iostream>
 
 #include "wfcore/common/scheduling/ThreadPool.h"
+#include "wfcore/common/scheduling/SharedWorkerPool.h"
+#include "wfcore/common/scheduling/SPSCRing.h"
+#include "wfcore/utils/LatencyHistogram.h"
+#include "wfcore/common/scheduling/CPUTopology.h"
+#include "wfcore/common/scheduling/ThreadPlacement.h"
 #include <thread>
 #include <chrono>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
 
 #include <gtest/gtest.h>
 
@@ -55,4 +63,166 @@ TEST(processTests, ThreadPoolTest){
     EXPECT_NEAR((std::chrono::duration<double>(message2time.get()-start)).count(),4.0,0.1);
     EXPECT_NEAR((std::chrono::duration<double>(message3time.get()-start)).count(),6.0,0.1);
     EXPECT_NEAR((std::chrono::duration<double>(message4time.get()-start)).count(),8.0,0.1);
-}
\ No newline at end of file
+}
+
+// Tests the SPSC ring across a producer and consumer thread
+TEST(processTests, SPSCRingTest){
+    wf::SPSCRing<int> ring(4);
+    EXPECT_EQ(ring.capacity(),4u);
+    EXPECT_TRUE(ring.empty());
+    for (int i = 0; i < 4; ++i)
+        EXPECT_TRUE(ring.tryPush(i));
+    EXPECT_FALSE(ring.tryPush(4));
+    for (int i = 0; i < 4; ++i)
+        EXPECT_EQ(ring.tryPop().value_or(-1),i);
+    EXPECT_FALSE(ring.tryPop().has_value());
+
+    constexpr int count = 100000;
+    std::jthread producer([&ring](std::stop_token stoken) {
+        for (int i = 0; i < count; ++i)
+            ring.push(stoken,i);
+    });
+    std::stop_source ssource;
+    bool inOrder = true;
+    for (int i = 0; i < count; ++i) {
+        auto item = ring.pop(ssource.get_token());
+        if (!item || *item != i) inOrder = false;
+    }
+    EXPECT_TRUE(inOrder);
+    EXPECT_TRUE(ring.empty());
+}
+
+// Tests latency histogram bucketing and percentiles
+TEST(processTests, LatencyHistogramTest){
+    using wf::LatencyHistogram;
+    // Buckets tile the value range with no gaps or overlaps
+    for (int i = 0; i + 1 < LatencyHistogram::NUM_BUCKETS; ++i)
+        ASSERT_EQ(LatencyHistogram::bucketUpperBound(i) + 1,LatencyHistogram::bucketLowerBound(i + 1));
+    for (uint64_t v : {0ull,7ull,15ull,16ull,17ull,1000ull,123456ull,99999999ull}) {
+        int index = LatencyHistogram::bucketIndex(v);
+        EXPECT_LE(LatencyHistogram::bucketLowerBound(index),v);
+        EXPECT_GE(LatencyHistogram::bucketUpperBound(index),v);
+    }
+
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.percentile(50.0),0u);
+    for (uint64_t i = 1; i <= 1000; ++i)
+        histogram.record(i * 100);
+    EXPECT_EQ(histogram.count(),1000u);
+    EXPECT_EQ(histogram.max(),100000u);
+    EXPECT_NEAR(histogram.mean(),50050.0,1e-6);
+    // Reported percentiles are within the histogram's ~6% precision
+    EXPECT_NEAR(static_cast<double>(histogram.percentile(50.0)),50000.0,50000.0 * 0.07);
+    EXPECT_NEAR(static_cast<double>(histogram.percentile(99.0)),99000.0,99000.0 * 0.07);
+    EXPECT_EQ(histogram.percentile(100.0),100000u);
+    histogram.reset();
+    EXPECT_EQ(histogram.count(),0u);
+}
+
+// Lays out a fake sysfs tree shaped like an RK3588: four little cores sharing an L2,
+// and two pairs of big cores, each pair sharing its own L2
+TEST(processTests, CPUTopologyTest) {
+    namespace fs = std::filesystem;
+    const auto root = fs::temp_directory_path() / "wf_cpu_topology_test";
+    fs::remove_all(root);
+    auto write = [](const fs::path& path, const std::string& contents) {
+        fs::create_directories(path.parent_path());
+        std::ofstream(path) << contents << "\n";
+    };
+    write(root / "online", "0-7");
+    for (int cpu = 0; cpu < 8; ++cpu) {
+        const auto dir = root / ("cpu" + std::to_string(cpu));
+        const bool big = cpu >= 4;
+        write(dir / "cpu_capacity", big ? "1024" : "414");
+        write(dir / "topology" / "physical_package_id", "0");
+        write(dir / "topology" / "core_cpus_list", std::to_string(cpu));
+        write(dir / "cache" / "index0" / "level", "1");
+        write(dir / "cache" / "index0" / "type", "Data");
+        write(dir / "cache" / "index0" / "shared_cpu_list", std::to_string(cpu));
+        write(dir / "cache" / "index1" / "level", "2");
+        write(dir / "cache" / "index1" / "type", "Unified");
+        write(dir / "cache" / "index1" / "shared_cpu_list", big ? (cpu < 6 ? "4-5" : "6-7") : "0-3");
+    }
+
+    auto topology = wf::CPUTopology::detect(root);
+    fs::remove_all(root);
+    ASSERT_EQ(topology.getCores().size(), 8);
+    EXPECT_TRUE(topology.isHeterogeneous());
+    EXPECT_EQ(topology.getPerformanceCPUs(), (std::vector<int>{4,5,6,7}));
+    EXPECT_EQ(topology.getEfficiencyCPUs(), (std::vector<int>{0,1,2,3}));
+    EXPECT_EQ(topology.getCores()[5].l2Siblings, (std::vector<int>{4,5}));
+
+    // Two workers each get a big core pair that shares an L2, and leave the auxiliary stages on the little cores
+    auto placements = wf::planThreadPlacements(topology, 2);
+    ASSERT_EQ(placements.size(), 2);
+    EXPECT_EQ(placements[0].computeCPUs, (std::vector<int>{4,5}));
+    EXPECT_EQ(placements[1].computeCPUs, (std::vector<int>{6,7}));
+    EXPECT_EQ(placements[0].auxCPUs, (std::vector<int>{0,1,2,3}));
+
+    // More workers than big cores share all of them
+    placements = wf::planThreadPlacements(topology, 5);
+    EXPECT_EQ(placements[4].computeCPUs, (std::vector<int>{4,5,6,7}));
+
+    EXPECT_EQ(wf::parseCPUList("0-2, 5,7-8\n"), (std::vector<int>{0,1,2,5,7,8}));
+}
+
+// Several callers running sections on one small pool at once. Every task must run exactly once,
+// and no section may run on more threads than its caller allows
+TEST(processTests, SharedWorkerPoolTest) {
+    struct SectionState {
+        std::atomic<int> running = 0;
+        std::atomic<int> peak = 0;
+        std::vector<std::atomic<int>> counts = std::vector<std::atomic<int>>(64);
+    };
+    struct TaskArg {
+        SectionState* state;
+        int index;
+    };
+    auto task = [](void* p) {
+        auto* arg = static_cast<TaskArg*>(p);
+        auto& state = *arg->state;
+        int running = state.running.fetch_add(1) + 1;
+        int peak = state.peak.load();
+        while (running > peak && !state.peak.compare_exchange_weak(peak,running));
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        state.counts[arg->index].fetch_add(1);
+        state.running.fetch_sub(1);
+    };
+
+    wf::SharedWorkerPool pool(3);
+    EXPECT_EQ(pool.getNumThreads(),3);
+    constexpr int callers = 4;
+    constexpr int rounds = 20;
+    std::vector<SectionState> states(callers);
+    std::vector<std::thread> threads;
+    for (int c = 0; c < callers; ++c) {
+        threads.emplace_back([&,c] {
+            std::vector<TaskArg> args;
+            std::vector<wf::SharedWorkerPool::Task> tasks;
+            for (int i = 0; i < 64; ++i) args.push_back({&states[c],i});
+            for (auto& arg : args) tasks.push_back({task,&arg});
+            for (int r = 0; r < rounds; ++r) pool.run(tasks,1);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    for (auto& state : states) {
+        for (auto& count : state.counts) EXPECT_EQ(count.load(),rounds);
+        EXPECT_LE(state.peak.load(),2); // The caller and a single helper
+    }
+    auto stats = pool.getStats();
+    EXPECT_EQ(stats.sections,callers * rounds);
+    EXPECT_EQ(stats.tasks,callers * rounds * 64);
+    EXPECT_GT(stats.helped,0);
+
+    // A pool without threads runs everything on the caller
+    wf::SharedWorkerPool empty(0);
+    SectionState state;
+    std::vector<TaskArg> args{{&state,0},{&state,1}};
+    std::vector<wf::SharedWorkerPool::Task> tasks{{task,&args[0]},{task,&args[1]}};
+    empty.run(tasks,4);
+    EXPECT_EQ(state.counts[0].load(),1);
+    EXPECT_EQ(state.counts[1].load(),1);
+    EXPECT_EQ(state.peak.load(),1);
+    EXPECT_EQ(empty.getStats().helped,0);
+}
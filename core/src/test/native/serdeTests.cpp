@@ -63,6 +63,26 @@ TEST(serdeTests, FPOSerdeTest) {
         << "Deserialized error 1 should not have a value";
 }
 
+TEST(serdeTests, ApriltagDetectionSerdeTest) {
+    wf::ApriltagDetection detection(
+        7,
+        {cv::Point2d(1.0,2.0),cv::Point2d(3.0,4.0),cv::Point2d(5.0,6.0),cv::Point2d(7.0,8.0)},
+        42.5,
+        1.0,
+        wf::TagFamily::TagStandard41h12
+    );
+    auto wipsbin = wf::packApriltagDetection(detection);
+    wipsbin->offset = 0; // Reset offset to read the whole data
+    auto deserializedDetection = wf::unpackApriltagDetection(wipsbin);
+    wips_blob_destroy(wipsbin);
+    EXPECT_EQ(detection.id, deserializedDetection.id);
+    EXPECT_EQ(detection.family, deserializedDetection.family) << "Tag family does not survive the family id";
+    for (size_t i = 0; i < detection.corners.size(); ++i)
+        EXPECT_EQ(detection.corners[i], deserializedDetection.corners[i]);
+    EXPECT_DOUBLE_EQ(detection.decisionMargin, deserializedDetection.decisionMargin);
+    EXPECT_DOUBLE_EQ(detection.hammingDistance, deserializedDetection.hammingDistance);
+}
+
 TEST(serdeTests, pose3WIPSCharacterizationTest) {
     using clock = std::chrono::steady_clock;
     std::chrono::time_point<clock> start, end;
@@ -0,0 +1,208 @@
+/*
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Copyright (C) 2025 Jesse Kane
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "wfcore/simd/simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+    using namespace wf::simd;
+
+    // Lengths around every vector width and block size the kernels use, so both the vector loops and their scalar tails run
+    constexpr size_t LENGTHS[] = {0,1,3,4,5,6,7,15,16,17,31,32,33,47,48,49,63,64,65,95,96,97,191,640,641,1283};
+
+    std::vector<uint8_t> randomBytes(size_t n, std::mt19937& rng) {
+        std::vector<uint8_t> bytes(n);
+        for (auto& b : bytes) b = static_cast<uint8_t>(rng());
+        return bytes;
+    }
+
+    // Runs the same kernel from two tables into fresh buffers of exactly the output size, so overruns show up under ASan
+    template <typename Run>
+    void expectSameBytes(const Kernels& kernels, const Kernels& reference, size_t outBytes, Run run) {
+        std::vector<uint8_t> actual(outBytes, 0xA5), expected(outBytes, 0xA5);
+        run(kernels, actual.data());
+        run(reference, expected.data());
+        EXPECT_EQ(actual, expected);
+    }
+}
+
+// Every supported level gives the same results as the scalar kernels
+TEST(simdTests, KernelsMatchScalarTest){
+    const Kernels& reference = getKernels(SimdLevel::Scalar);
+    for (auto level : {SimdLevel::SSE41,SimdLevel::AVX2,SimdLevel::NEON}) {
+        if (!isSupported(level)) continue;
+        SCOPED_TRACE(getLevelName(level));
+        const Kernels& kernels = getKernels(level);
+        std::mt19937 rng(0x5746);
+        for (size_t n : LENGTHS) {
+            SCOPED_TRACE(n);
+            const auto gray = randomBytes(n,rng);
+            const auto bgr = randomBytes(3 * n,rng);
+            const auto bgra = randomBytes(4 * n,rng);
+
+            expectSameBytes(kernels,reference,3 * n,[&](const Kernels& k, uint8_t* dst){ k.swapRB3(bgr.data(),dst,n); });
+            expectSameBytes(kernels,reference,4 * n,[&](const Kernels& k, uint8_t* dst){ k.swapRB4(bgra.data(),dst,n); });
+            expectSameBytes(kernels,reference,4 * n,[&](const Kernels& k, uint8_t* dst){ k.addAlpha(bgr.data(),dst,n); });
+            expectSameBytes(kernels,reference,4 * n,[&](const Kernels& k, uint8_t* dst){ k.addAlphaSwapRB(bgr.data(),dst,n); });
+            expectSameBytes(kernels,reference,3 * n,[&](const Kernels& k, uint8_t* dst){ k.dropAlpha(bgra.data(),dst,n); });
+            expectSameBytes(kernels,reference,3 * n,[&](const Kernels& k, uint8_t* dst){ k.dropAlphaSwapRB(bgra.data(),dst,n); });
+            expectSameBytes(kernels,reference,3 * n,[&](const Kernels& k, uint8_t* dst){ k.grayTo3(gray.data(),dst,n); });
+            expectSameBytes(kernels,reference,4 * n,[&](const Kernels& k, uint8_t* dst){ k.grayTo4(gray.data(),dst,n); });
+            expectSameBytes(kernels,reference,3 * n,[&](const Kernels& k, uint8_t* dst){
+                uint8_t* const planes[3] = {dst,dst + n,dst + 2 * n};
+                k.deinterleave3(bgr.data(),planes,n);
+            });
+            expectSameBytes(kernels,reference,4 * n,[&](const Kernels& k, uint8_t* dst){
+                uint8_t* const planes[4] = {dst,dst + n,dst + 2 * n,dst + 3 * n};
+                k.deinterleave4(bgra.data(),planes,n);
+            });
+
+            // Packed 4:2:2 YUV, for both luma positions
+            const auto yuyv = randomBytes(2 * n,rng);
+            const auto yuyvRow1 = randomBytes(4 * n,rng);
+            const auto yuyvRow0 = randomBytes(4 * n,rng);
+            for (int offset : {0,1}) {
+                SCOPED_TRACE(offset);
+                expectSameBytes(kernels,reference,n,[&](const Kernels& k, uint8_t* dst){ k.extractLuma(yuyv.data(),dst,n,offset); });
+                expectSameBytes(kernels,reference,n,[&](const Kernels& k, uint8_t* dst){
+                    k.extractLumaDecimated(yuyvRow0.data(),yuyvRow1.data(),dst,n,offset);
+                });
+            }
+
+            // n tiles of 4 rows, with a row stride that isn't a multiple of the vector width
+            const size_t stride = 4 * n + 3;
+            const auto tileRows = randomBytes(3 * stride + 4 * n,rng);
+            expectSameBytes(kernels,reference,2 * n,[&](const Kernels& k, uint8_t* dst){
+                k.tileMinMax4(tileRows.data(),stride,dst,dst + n,n);
+            });
+            std::vector<uint8_t> mins(n), maxs(n);
+            for (size_t t = 0; t < n; ++t) {
+                const uint8_t a = static_cast<uint8_t>(rng()), b = static_cast<uint8_t>(rng());
+                mins[t] = std::min(a,b);
+                maxs[t] = std::max(a,b);
+            }
+            for (int minContrast : {0,5,128,255}) {
+                SCOPED_TRACE(minContrast);
+                expectSameBytes(kernels,reference,4 * n,[&](const Kernels& k, uint8_t* dst){
+                    k.thresholdTiles4(tileRows.data(),dst,mins.data(),maxs.data(),n,static_cast<uint8_t>(minContrast));
+                });
+            }
+            // Three rows of thresholded pixels, with one more on either side
+            const auto thresholded = [&]{
+                auto bytes = randomBytes(3 * (n + 2),rng);
+                for (auto& v : bytes) v = v < 86 ? 0 : (v < 171 ? 127 : 255);
+                return bytes;
+            }();
+            for (const auto* rows : {&thresholded,&tileRows}) {
+                const uint8_t* above = rows->data() + 1;
+                expectSameBytes(kernels,reference,n,[&](const Kernels& k, uint8_t* dst){
+                    k.isolateEdges(above,above + n + 2,above + 2 * (n + 2),dst,n);
+                });
+            }
+
+            for (int channels = 1; channels <= 4; ++channels) {
+                SCOPED_TRACE(channels);
+                const size_t samples = n * channels;
+                const auto row0 = randomBytes(2 * samples,rng);
+                const auto row1 = randomBytes(2 * samples,rng);
+                expectSameBytes(kernels,reference,samples,[&](const Kernels& k, uint8_t* dst){
+                    k.boxDownsample2x(row0.data(),row1.data(),dst,n,channels);
+                });
+
+                const uint8_t pixel[4] = {114,0,255,7};
+                expectSameBytes(kernels,reference,samples,[&](const Kernels& k, uint8_t* dst){
+                    k.fill(dst,n,pixel,channels);
+                });
+
+                // Typical YOLO and ImageNet style normalizations
+                const float scale[4] = {1.0f / 255.0f,1.0f / (255.0f * 0.224f),1.0f / (255.0f * 0.225f),0.5f};
+                const float bias[4] = {0.0f,-0.485f / 0.229f,-0.406f / 0.225f,-1.0f};
+                const auto src = randomBytes(samples,rng);
+                std::vector<float> actual(samples,-1.0f), expected(samples,-1.0f);
+                kernels.normalize(src.data(),actual.data(),samples,channels,scale,bias);
+                reference.normalize(src.data(),expected.data(),samples,channels,scale,bias);
+                for (size_t i = 0; i < samples; ++i)
+                    EXPECT_NEAR(actual[i],expected[i],1e-5f * (1.0f + std::fabs(expected[i])));
+            }
+        }
+    }
+}
+
+// The scalar kernels are the reference for everything else, so check them against plain definitions of each operation
+TEST(simdTests, ScalarKernelsTest){
+    const Kernels& k = getKernels(SimdLevel::Scalar);
+    const uint8_t bgr[6] = {1,2,3,4,5,6};
+    uint8_t out[8];
+    k.swapRB3(bgr,out,2);
+    EXPECT_EQ(std::vector<uint8_t>(out,out + 6),(std::vector<uint8_t>{3,2,1,6,5,4}));
+    k.addAlphaSwapRB(bgr,out,2);
+    EXPECT_EQ(std::vector<uint8_t>(out,out + 8),(std::vector<uint8_t>{3,2,1,255,6,5,4,255}));
+    const uint8_t bgra[8] = {1,2,3,4,5,6,7,8};
+    k.dropAlphaSwapRB(bgra,out,2);
+    EXPECT_EQ(std::vector<uint8_t>(out,out + 6),(std::vector<uint8_t>{3,2,1,7,6,5}));
+
+    // Rounds half up, like an exact 2x INTER_AREA resize
+    const uint8_t row0[4] = {0,1,10,10};
+    const uint8_t row1[4] = {0,1,10,11};
+    k.boxDownsample2x(row0,row1,out,2,1);
+    EXPECT_EQ(out[0],1);
+    EXPECT_EQ(out[1],10);
+
+    const uint8_t src[3] = {0,128,255};
+    const float scale[3] = {1.0f,2.0f,1.0f / 255.0f};
+    const float bias[3] = {0.5f,-1.0f,0.0f};
+    float normalized[3];
+    k.normalize(src,normalized,3,3,scale,bias);
+    EXPECT_FLOAT_EQ(normalized[0],0.5f);
+    EXPECT_FLOAT_EQ(normalized[1],255.0f);
+    EXPECT_FLOAT_EQ(normalized[2],1.0f);
+
+    // One 4x4 tile, then the same pixels against a tile with enough contrast (midpoint 20) and one without
+    const uint8_t tile[16] = {9,40,12,13, 20,21,22,23, 30,31,7,33, 14,15,16,17};
+    uint8_t lo, hi;
+    k.tileMinMax4(tile,4,&lo,&hi,1);
+    EXPECT_EQ(lo,7);
+    EXPECT_EQ(hi,40);
+    const uint8_t mins[2] = {0,20}, maxs[2] = {40,22};
+    const uint8_t pixels[8] = {19,20,21,255,0,21,22,255};
+    k.thresholdTiles4(pixels,out,mins,maxs,2,5);
+    EXPECT_EQ(std::vector<uint8_t>(out,out + 8),(std::vector<uint8_t>{0,0,255,255,127,127,127,127}));
+
+    // Only pixels next to one of the opposite value, diagonally too, are kept
+    const uint8_t above[5] = {0,0,0,0,255};
+    const uint8_t middle[5] = {0,0,255,0,0};
+    const uint8_t below[5] = {0,0,0,0,127};
+    k.isolateEdges(above + 1,middle + 1,below + 1,out,3);
+    EXPECT_EQ(std::vector<uint8_t>(out,out + 3),(std::vector<uint8_t>{0,255,0}));
+    const uint8_t flat[5] = {0,0,0,0,0};
+    const uint8_t corner[5] = {0,0,0,0,255};
+    k.isolateEdges(flat + 1,flat + 1,corner + 1,out,3);
+    EXPECT_EQ(std::vector<uint8_t>(out,out + 3),(std::vector<uint8_t>{127,127,0}));
+
+    EXPECT_TRUE(isSupported(SimdLevel::Scalar));
+    EXPECT_TRUE(isSupported(getActiveLevel()));
+    EXPECT_EQ(&kernels(),&getKernels(getActiveLevel()));
+}
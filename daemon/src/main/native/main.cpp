@@ -23,6 +23,7 @@
 #include "wfcore/processes/WFOrchestrator.h"
 #include "wfd.h"
 #include <exception>
+#include <chrono>
 
 // signals to the launcher
 
@@ -39,6 +40,9 @@
 // Reboot request, signals the launcher to execute shutdown -r now
 #define WAYFINDER_REBOOT 5
 
+// How often the orchestrator runs its periodic health checks
+static constexpr auto PERIODIC_INTERVAL = std::chrono::milliseconds(50);
+
 
 int main() {
     std::cout << "Starting Wayfinder v" << PROJECT_VERSION << std::endl;
@@ -46,10 +50,20 @@ int main() {
         auto orch = wf::WFOrchestrator::createFromEnv();
         orch.configureHardware();
         orch.configureWorkers();
+        auto nextPeriodic = std::chrono::steady_clock::now();
         while (true) {
-            // main loop
-            auto lock = wfd::getLock();
-            orch.periodic();
+            // main loop. Sleeps until the next periodic tick, waking early if a request comes in
+            if (!wfd::waitForRequest(nextPeriodic)) {
+                {
+                    auto lock = wfd::getLock();
+                    orch.periodic();
+                }
+                nextPeriodic += PERIODIC_INTERVAL;
+                // Don't try to catch up on ticks missed while periodic() or the system was stalled
+                auto now = std::chrono::steady_clock::now();
+                if (nextPeriodic < now) nextPeriodic = now + PERIODIC_INTERVAL;
+                continue;
+            }
             if (wfd::shutdownRequested()) {
                 std::cout << "Shutdown requested, exiting..." << std::endl;
                 return WAYFINDER_SHUTDOWN;
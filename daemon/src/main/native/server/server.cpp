@@ -192,6 +192,30 @@ namespace impl {
             )
         );
 
+        srv.Get(
+            "/api/live/pipelines/([^/]+)/stats",
+            makeHandler_live_resource_GET<&wf::WFOrchestrator::getWorkerStats_JSON>(
+                [](const httplib::Request& req){ return req.matches[1].str(); },
+                orch
+            )
+        );
+
+        srv.Get(
+            "/api/live/pipelines/([^/]+)/latency",
+            makeHandler_live_resource_GET<&wf::WFOrchestrator::getWorkerLatencies_JSON>(
+                [](const httplib::Request& req){ return req.matches[1].str(); },
+                orch
+            )
+        );
+
+        srv.Get(
+            "/api/live/pipelines/([^/]+)/plan",
+            makeHandler_live_resource_GET<&wf::WFOrchestrator::getWorkerPlan_JSON>(
+                [](const httplib::Request& req){ return req.matches[1].str(); },
+                orch
+            )
+        );
+
         srv.Put(
             "/api/live/hardware/([^/]+)",
             makeHandler_live_resource_PUT<&wf::WFOrchestrator::setCameraConfig_JSON>(
@@ -199,6 +223,14 @@ namespace impl {
                 orch
             )
         );
+
+        srv.Put(
+            "/api/live/pipelines/([^/]+)",
+            makeHandler_live_resource_PUT<&wf::WFOrchestrator::setWorkerConfig_JSON>(
+                [](const httplib::Request& req){ return req.matches[1].str(); },
+                orch
+            )
+        );
     }
 }
 
@@ -212,6 +244,7 @@ namespace wfsrv {
         impl::configure_env_endpoints(srv_,orch_);
         impl::configure_local_endpoints(srv_,orch_);
         impl::configure_resource_endpoints(srv_,orch_);
+        impl::configure_live_endpoints(srv_,orch_);
         
     }
 
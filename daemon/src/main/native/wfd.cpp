@@ -20,6 +20,7 @@
 #include "wfd.h"
 #include <atomic>
 #include <cstdint>
+#include <condition_variable>
 
 namespace impl {
     static std::mutex daemon_mutex;
@@ -32,6 +33,16 @@ namespace impl {
         REBOOT = 0x04
     };
     std::atomic<Request> reqstore(Request::NONE);
+    static std::condition_variable reqs_cv;
+
+    // The store happens under reqs_mutex so a waiter can't miss the notification between checking and sleeping
+    static void request(Request req) {
+        {
+            std::lock_guard lock(reqs_mutex);
+            reqstore.store(req);
+        }
+        reqs_cv.notify_all();
+    }
 }
 
 namespace wfd {
@@ -39,16 +50,16 @@ namespace wfd {
         return std::lock_guard(impl::daemon_mutex);
     }
     void shutdown() {
-        impl::reqstore.store(impl::Request::SHUTDOWN);
+        impl::request(impl::Request::SHUTDOWN);
     }
     void reload() {
-        impl::reqstore.store(impl::Request::RELOAD);
+        impl::request(impl::Request::RELOAD);
     }
     void restart() {
-        impl::reqstore.store(impl::Request::RESTART);
+        impl::request(impl::Request::RESTART);
     }
     void reboot() {
-        impl::reqstore.store(impl::Request::REBOOT);
+        impl::request(impl::Request::REBOOT);
     }
     void clearReqstore() {
         impl::reqstore.store(impl::Request::NONE);
@@ -65,4 +76,10 @@ namespace wfd {
     bool rebootRequested() {
         return (impl::reqstore.load() == impl::Request::REBOOT);
     }
+    bool waitForRequest(std::chrono::steady_clock::time_point deadline) {
+        std::unique_lock lock(impl::reqs_mutex);
+        return impl::reqs_cv.wait_until(lock, deadline, []{
+            return impl::reqstore.load() != impl::Request::NONE;
+        });
+    }
 }
\ No newline at end of file
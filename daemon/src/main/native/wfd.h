@@ -20,6 +20,7 @@
 #pragma once
 
 #include <mutex>
+#include <chrono>
 
 // header for utility functions to control the daemon process
 namespace wfd {
@@ -34,4 +35,6 @@ namespace wfd {
     bool reloadRequested();
     bool restartRequested();
     bool rebootRequested();
+    // Blocks until a request is made or the deadline passes. Returns true if a request is pending
+    bool waitForRequest(std::chrono::steady_clock::time_point deadline);
 }
\ No newline at end of file